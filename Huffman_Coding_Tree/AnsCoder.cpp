@@ -0,0 +1,287 @@
+/** Filename: AnsCoder.cpp
+ *  Name: Loc Chuong
+ *  Description: Table-based asymmetric numeral systems (tANS) coder for the
+ *               block format.
+ *  Date: 10/18/2026
+ */
+
+#include "AnsCoder.hpp"
+#include "Trace.hpp"
+#include <cmath>
+#include <cstring>
+
+#define ANS_FLUSH_BITS 32 /** The encoder stores 32 bits at a time */
+#define ANS_DECODE_BATCH 4 /** Symbols decoded per 64 bit load */
+
+/** Function Name: highBit(unsigned int value)
+ *  Description: Index of the highest set bit of value
+ *  PRECONDITION: value is not 0
+ *  Return Value: floor(log2(value))
+ */
+static int highBit(unsigned int value) {
+	int bit = 0;
+	while (value >>= 1) {
+		bit++;
+	}
+	return bit;
+}
+
+/** Function Name: normalize(const vector<int>& freqs)
+ *  Description: Scales freqs to sum to ANS_TABLE_SIZE, keeping every
+ *               present byte at 1 or more. The rounding error goes to, or
+ *               comes from, the most frequent bytes, where it costs least.
+ *  Return Value: The normalized frequencies
+ */
+vector<int> AnsTable::normalize(const vector<int>& freqs) {
+	vector<int> normalized(ASCII_MAX, 0);
+	long long total = 0;
+	for (int i = 0; i < ASCII_MAX; i++) {
+		total += freqs[i];
+	}
+	int sum = 0;
+	int largest = 0;
+	for (int i = 0; i < ASCII_MAX; i++) {
+		if (freqs[i] == 0) {
+			continue;
+		}
+		normalized[i] = (int)((long long)freqs[i] * ANS_TABLE_SIZE / total);
+		if (normalized[i] == 0) {
+			normalized[i] = 1;
+		}
+		sum += normalized[i];
+		if (normalized[i] > normalized[largest]) {
+			largest = i;
+		}
+	}
+	if (sum < ANS_TABLE_SIZE) {
+		normalized[largest] += ANS_TABLE_SIZE - sum;
+		return normalized;
+	}
+	/** Rounding rare bytes up to 1 overshot, take it back from the top */
+	while (sum > ANS_TABLE_SIZE) {
+		largest = 0;
+		for (int i = 1; i < ASCII_MAX; i++) {
+			if (normalized[i] > normalized[largest]) {
+				largest = i;
+			}
+		}
+		/** Shave a little at a time so the top bytes share the loss */
+		int take = normalized[largest] / 16;
+		if (take < 1) {
+			take = 1;
+		}
+		if (take > sum - ANS_TABLE_SIZE) {
+			take = sum - ANS_TABLE_SIZE;
+		}
+		normalized[largest] -= take;
+		sum -= take;
+	}
+	return normalized;
+}
+
+/** Function Name: build(const vector<int>& normalized)
+ *  Description: Spreads the symbols over the states, then derives the
+ *               decode entry of every state and the encode transitions
+ *               of every symbol from that spread
+ *  Return Value: False if normalized does not sum to ANS_TABLE_SIZE
+ */
+bool AnsTable::build(const vector<int>& normalized) {
+	int sum = 0;
+	for (int i = 0; i < ASCII_MAX; i++) {
+		if (normalized[i] < 0) {
+			return false;
+		}
+		sum += normalized[i];
+	}
+	if (sum != ANS_TABLE_SIZE) {
+		return false;
+	}
+	norm = normalized;
+
+	/** An odd step visits every state of the power of two table once */
+	vector<byte> spread(ANS_TABLE_SIZE);
+	int step = (ANS_TABLE_SIZE >> 1) + (ANS_TABLE_SIZE >> 3) + 3;
+	int position = 0;
+	for (int s = 0; s < ASCII_MAX; s++) {
+		for (int i = 0; i < norm[s]; i++) {
+			spread[position] = (byte)s;
+			position = (position + step) & (ANS_TABLE_SIZE - 1);
+		}
+	}
+
+	/** Decode: the k-th state of symbol s leads back to state k of s */
+	decodeTable.resize(ANS_TABLE_SIZE);
+	vector<int> next(norm);
+	for (int u = 0; u < ANS_TABLE_SIZE; u++) {
+		byte s = spread[u];
+		int k = next[s]++;
+		int nbBits = ANS_TABLE_LOG - highBit((unsigned int)k);
+		decodeTable[u].symbol = s;
+		decodeTable[u].nbBits = (byte)nbBits;
+		decodeTable[u].newState = (unsigned short)((k << nbBits)
+			- ANS_TABLE_SIZE);
+	}
+
+	/** Encode: the states of each symbol, in spread order */
+	stateTable.resize(ANS_TABLE_SIZE);
+	symbolTable.resize(ASCII_MAX);
+	vector<int> cumulative(ASCII_MAX + 1, 0);
+	for (int s = 0; s < ASCII_MAX; s++) {
+		cumulative[s + 1] = cumulative[s] + norm[s];
+	}
+	vector<int> fill(cumulative.begin(), cumulative.end() - 1);
+	for (int u = 0; u < ANS_TABLE_SIZE; u++) {
+		stateTable[fill[spread[u]]++] = (unsigned short)(ANS_TABLE_SIZE + u);
+	}
+	for (int s = 0; s < ASCII_MAX; s++) {
+		AnsEncodeSymbol& symbol = symbolTable[s];
+		if (norm[s] == 0) {
+			symbol.deltaNbBits = 0;
+			symbol.deltaFindState = 0;
+			continue;
+		}
+		/** States from minStatePlus up shed maxBitsOut bits, the rest one
+		 *  bit fewer
+		 */
+		int maxBitsOut = norm[s] == 1 ? ANS_TABLE_LOG
+			: ANS_TABLE_LOG - highBit((unsigned int)(norm[s] - 1));
+		unsigned int minStatePlus = (unsigned int)norm[s] << maxBitsOut;
+		symbol.deltaNbBits = ((unsigned int)maxBitsOut << 16) - minStatePlus;
+		symbol.deltaFindState = cumulative[s] - norm[s];
+	}
+	return true;
+}
+
+/** Function Name: estimateBits(const vector<int>& freqs) const
+ *  Description: Approximate number of bits encode() writes for a block
+ *               with histogram freqs, from the normalized probabilities
+ *  Return Value: The estimated payload size in bits
+ */
+double AnsTable::estimateBits(const vector<int>& freqs) const {
+	double bits = ANS_TABLE_LOG + 1;
+	for (int s = 0; s < ASCII_MAX; s++) {
+		if (freqs[s] != 0) {
+			bits += freqs[s] * log2((double)ANS_TABLE_SIZE / norm[s]);
+		}
+	}
+	return bits;
+}
+
+/** Function Name: encode(const byte* data, size_t size,
+ *                        vector<byte>& out) const
+ *  Description: Codes data from its last byte to its first, so the decoder,
+ *               which reads the bits back in reverse, emits it forwards
+ *  Return Value: None
+ */
+void AnsTable::encode(const byte* data, size_t size, vector<byte>& out) const {
+	TRACE_SPAN("ans encode");
+	/** Every byte costs at most ANS_TABLE_LOG bits */
+	size_t start = out.size();
+	out.resize(start + (size * ANS_TABLE_LOG + ANS_TABLE_LOG + 1) / 8 + 8);
+	byte* write = out.data() + start;
+	unsigned long long acc = 0;
+	unsigned int accBits = 0;
+	unsigned int state = ANS_TABLE_SIZE;
+	for (size_t i = size; i-- > 0;) {
+		const AnsEncodeSymbol& symbol = symbolTable[data[i]];
+		unsigned int nbBits = (state + symbol.deltaNbBits) >> 16;
+		acc |= (unsigned long long)(state & ((1u << nbBits) - 1)) << accBits;
+		accBits += nbBits;
+		state = stateTable[(state >> nbBits) + symbol.deltaFindState];
+		if (accBits >= ANS_FLUSH_BITS) {
+			unsigned int word = (unsigned int)acc;
+			memcpy(write, &word, sizeof(word));
+			write += 4;
+			acc >>= ANS_FLUSH_BITS;
+			accBits -= ANS_FLUSH_BITS;
+		}
+	}
+	/** The final state, then the end marker */
+	acc |= (unsigned long long)(state - ANS_TABLE_SIZE) << accBits;
+	accBits += ANS_TABLE_LOG;
+	acc |= 1ULL << accBits;
+	accBits++;
+	while (accBits > 0) {
+		*write++ = (byte)acc;
+		acc >>= BUFFER_SIZE;
+		accBits = accBits > BUFFER_SIZE ? accBits - BUFFER_SIZE : 0;
+	}
+	out.resize(write - out.data());
+}
+
+/** Function Name: decode(const byte* in, size_t inSize, byte* out,
+ *                        size_t count) const
+ *  Description: Decodes count bytes written by encode(), reading the bits
+ *               back from the end marker
+ *  Return Value: False if in is not a valid coding of count bytes
+ */
+bool AnsTable::decode(const byte* in, size_t inSize, byte* out,
+	size_t count) const {
+	TRACE_SPAN("ans decode");
+	if (inSize == 0 || in[inSize - 1] == 0) {
+		return false;
+	}
+	/** Bits below pos are still to be read, the newest on top */
+	size_t pos = (inSize - 1) * BUFFER_SIZE + highBit(in[inSize - 1]);
+	auto readBits = [&](unsigned int nbBits, unsigned int& value) {
+		if (nbBits > pos) {
+			return false;
+		}
+		pos -= nbBits;
+		size_t index = pos >> 3;
+		unsigned long long word = 0;
+		if (index + 8 <= inSize) {
+			memcpy(&word, in + index, sizeof(word));
+		}
+		else {
+			for (size_t i = index; i < inSize; i++) {
+				word |= (unsigned long long)in[i] << (8 * (i - index));
+			}
+		}
+		value = (unsigned int)(word >> (pos & 7)) & ((1u << nbBits) - 1);
+		return true;
+	};
+	const AnsDecodeEntry* table = decodeTable.data();
+	unsigned int state;
+	if (!readBits(ANS_TABLE_LOG, state)) {
+		return false;
+	}
+	size_t i = 0;
+	/** Load the 8 bytes ending at pos once for ANS_DECODE_BATCH symbols,
+	 *  which need at most ANS_DECODE_BATCH * ANS_TABLE_LOG of the 56 or
+	 *  more bits below pos it holds
+	 */
+	while (i + ANS_DECODE_BATCH <= count && pos >= 64) {
+		size_t index = (pos >> 3) - 7;
+		unsigned long long word;
+		memcpy(&word, in + index, sizeof(word));
+		unsigned int avail = (unsigned int)(pos - index * BUFFER_SIZE);
+		for (int k = 0; k < ANS_DECODE_BATCH; k++) {
+			const AnsDecodeEntry& entry = table[state];
+			out[i++] = entry.symbol;
+			avail -= entry.nbBits;
+			state = entry.newState + ((unsigned int)(word >> avail)
+				& ((1u << entry.nbBits) - 1));
+		}
+		pos = index * BUFFER_SIZE + avail;
+	}
+	for (; i < count; i++) {
+		const AnsDecodeEntry& entry = table[state];
+		out[i] = entry.symbol;
+		unsigned int bits;
+		if (!readBits(entry.nbBits, bits)) {
+			return false;
+		}
+		state = entry.newState + bits;
+	}
+	/** The encoder started in the first state with nothing written */
+	return pos == 0 && state == 0;
+}
+
+/** Function Name: getNormalized() const
+ *  Description: Getter for the normalized frequencies
+ *  Return Value: A reference to norm
+ */
+const vector<int>& AnsTable::getNormalized() const {
+	return norm;
+}
@@ -0,0 +1,101 @@
+/** Filename: AnsCoder.hpp
+ *  Name: Loc Chuong
+ *  Description: Table-based asymmetric numeral systems (tANS) coder for the
+ *               block format. A Huffman code spends a whole number of bits
+ *               per symbol, so a byte that makes up 90% of a block still
+ *               costs a full bit; tANS spends close to its -log2(p) instead.
+ *               The frequencies are normalized to sum to ANS_TABLE_SIZE and
+ *               stored with the same frequency header HCTree uses.
+ *
+ *               The encoder runs over the block backwards, writing the bits
+ *               of every state transition LSB first, then the final state
+ *               and a 1 bit marking the end. The decoder starts at that
+ *               marker and reads the bits back in reverse, so it emits the
+ *               block forwards.
+ *  Date: 10/18/2026
+ */
+
+#ifndef ANSCODER_HPP
+#define ANSCODER_HPP
+
+#include <vector>
+#include "HCTree.hpp"
+
+#define ANS_TABLE_LOG 11 /** Log2 of the number of coder states */
+#define ANS_TABLE_SIZE (1 << ANS_TABLE_LOG) /** Number of coder states */
+
+using namespace std;
+
+/** Struct Name: AnsDecodeEntry
+ *  Description: What the decoder does in one state
+ */
+struct AnsDecodeEntry {
+	unsigned short newState; /** Next state, before the bits read are added */
+	byte symbol; /** Symbol emitted in this state */
+	byte nbBits; /** Number of bits to read for the next state */
+};
+
+/** Struct Name: AnsEncodeSymbol
+ *  Description: How the encoder moves from a state on one symbol
+ */
+struct AnsEncodeSymbol {
+	unsigned int deltaNbBits; /** (state + deltaNbBits) >> 16 bits go out */
+	int deltaFindState; /** Offset of the symbol's run in stateTable */
+};
+
+/** Class Name: AnsTable
+ *  Description: Encode and decode tables of one normalized histogram
+ */
+class AnsTable {
+private:
+	vector<int> norm; /** Normalized frequencies, summing to ANS_TABLE_SIZE */
+	vector<AnsDecodeEntry> decodeTable; /** Entry per state */
+	vector<unsigned short> stateTable; /** Next states, grouped by symbol */
+	vector<AnsEncodeSymbol> symbolTable; /** Entry per symbol */
+
+public:
+	/** Function Name: normalize(const vector<int>& freqs)
+	 *  Description: Scales freqs to sum to ANS_TABLE_SIZE, keeping every
+	 *               present byte at 1 or more
+	 *  PRECONDITION: freqs has at least one non-zero frequency
+	 *  Return Value: The normalized frequencies
+	 */
+	static vector<int> normalize(const vector<int>& freqs);
+
+	/** Function Name: build(const vector<int>& normalized)
+	 *  Description: Builds the tables of a normalized histogram
+	 *  Return Value: False if normalized does not sum to ANS_TABLE_SIZE
+	 */
+	bool build(const vector<int>& normalized);
+
+	/** Function Name: estimateBits(const vector<int>& freqs) const
+	 *  Description: Approximate number of bits encode() writes for a block
+	 *               with histogram freqs
+	 *  Return Value: The estimated payload size in bits
+	 */
+	double estimateBits(const vector<int>& freqs) const;
+
+	/** Function Name: encode(const byte* data, size_t size,
+	 *                        vector<byte>& out) const
+	 *  Description: Appends the coded bytes of data to out
+	 *  PRECONDITION: Every byte of data has a non-zero normalized frequency
+	 *  Return Value: None
+	 */
+	void encode(const byte* data, size_t size, vector<byte>& out) const;
+
+	/** Function Name: decode(const byte* in, size_t inSize, byte* out,
+	 *                        size_t count) const
+	 *  Description: Decodes count bytes written by encode() from the inSize
+	 *               bytes at in
+	 *  Return Value: False if in is not a valid coding of count bytes
+	 */
+	bool decode(const byte* in, size_t inSize, byte* out, size_t count) const;
+
+	/** Function Name: getNormalized() const
+	 *  Description: Getter for the normalized frequencies
+	 *  Return Value: A reference to norm
+	 */
+	const vector<int>& getNormalized() const;
+};
+
+#endif // ANSCODER_HPP
@@ -0,0 +1,290 @@
+/** Filename: AppendCodec.cpp
+ *  Name: Loc Chuong
+ *  Description: Appends block coded segments to a log behind a chain of
+ *               footers, and decodes them back.
+ *  Date: 10/18/2026
+ */
+
+#include "AppendCodec.hpp"
+#include "Crc32.hpp"
+#include "LittleEndian.hpp"
+#include "Trace.hpp"
+#include <algorithm>
+
+#define FOOTER_CRC_OFFSET 40 /** Bytes of a footer covered by its CRC-32 */
+
+/** Struct Name: AppendFooter
+ *  Description: The fields of one footer
+ */
+struct AppendFooter {
+	unsigned long long segmentOffset; /** Where its segment starts */
+	unsigned long long rawSize; /** Bytes its segment decodes to */
+	unsigned long long prevFooter; /** Offset of the footer before it */
+	unsigned long long totalSize; /** Raw bytes up to its segment */
+	unsigned int segmentCount; /** Segments up to its own */
+	unsigned int crc; /** CRC-32 of its decoded segment */
+};
+
+/** Function Name: writeFooter(ostream& out, const AppendFooter& footer)
+ *  Description: Writes footer with its CRC-32 and the magic
+ *  Return Value: None
+ */
+static void writeFooter(ostream& out, const AppendFooter& footer) {
+	vector<byte> bytes;
+	putNumber(bytes, footer.segmentOffset, 8);
+	putNumber(bytes, footer.rawSize, 8);
+	putNumber(bytes, footer.prevFooter, 8);
+	putNumber(bytes, footer.totalSize, 8);
+	putNumber(bytes, footer.segmentCount, 4);
+	putNumber(bytes, footer.crc, 4);
+	putNumber(bytes, crc32(bytes.data(), bytes.size()), 4);
+	bytes.insert(bytes.end(), APPEND_MAGIC, APPEND_MAGIC + APPEND_MAGIC_SIZE);
+	out.write((const char*)bytes.data(), bytes.size());
+}
+
+/** Function Name: readFooter(istream& in, unsigned long long offset,
+ *                            AppendFooter& footer)
+ *  Description: Reads the footer at offset and checks its CRC-32, its
+ *               magic, and that its segment sits right after the footer
+ *               before it
+ *  Return Value: False if the footer is damaged
+ */
+static bool readFooter(istream& in, unsigned long long offset,
+	AppendFooter& footer) {
+	byte bytes[APPEND_FOOTER_SIZE];
+	in.clear();
+	in.seekg(offset);
+	if (!in.read((char*)bytes, APPEND_FOOTER_SIZE)
+		|| string((const char*)bytes + APPEND_FOOTER_SIZE - APPEND_MAGIC_SIZE,
+			APPEND_MAGIC_SIZE) != APPEND_MAGIC
+		|| crc32(bytes, FOOTER_CRC_OFFSET)
+		!= loadNumber(bytes + FOOTER_CRC_OFFSET, 4)) {
+		return false;
+	}
+	footer.segmentOffset = loadNumber(bytes, 8);
+	footer.rawSize = loadNumber(bytes + 8, 8);
+	footer.prevFooter = loadNumber(bytes + 16, 8);
+	footer.totalSize = loadNumber(bytes + 24, 8);
+	footer.segmentCount = (unsigned int)loadNumber(bytes + 32, 4);
+	footer.crc = (unsigned int)loadNumber(bytes + 36, 4);
+	if (footer.segmentCount == 0
+		|| (footer.segmentCount == 1) != (footer.prevFooter == APPEND_NO_FOOTER)
+		|| footer.rawSize == 0 || footer.totalSize < footer.rawSize) {
+		return false;
+	}
+	unsigned long long expected = footer.prevFooter == APPEND_NO_FOOTER
+		? APPEND_HEADER_SIZE : footer.prevFooter + APPEND_FOOTER_SIZE;
+	return footer.segmentOffset == expected && footer.segmentOffset < offset
+		&& footer.prevFooter < footer.segmentOffset;
+}
+
+/** Function Name: readHeader(istream& in, unsigned long long& size)
+ *  Description: Checks the magic and version and measures the log
+ *  Return Value: False if the file is not a log
+ */
+static bool readHeader(istream& in, unsigned long long& size) {
+	in.clear();
+	in.seekg(0, ios::end);
+	streamoff end = in.tellg();
+	char header[APPEND_HEADER_SIZE];
+	in.seekg(0);
+	if (end < APPEND_HEADER_SIZE || !in.read(header, APPEND_HEADER_SIZE)
+		|| string(header, APPEND_MAGIC_SIZE) != APPEND_MAGIC
+		|| header[APPEND_MAGIC_SIZE] != APPEND_VERSION) {
+		return false;
+	}
+	size = (unsigned long long)end;
+	return true;
+}
+
+/** Constructor
+ *  Description: Creates an AppendEncoder appending to the log in fs
+ */
+AppendEncoder::AppendEncoder(iostream& fs) : file(fs), encoder(fs),
+	segmentOffset(0), lastFooter(APPEND_NO_FOOTER), rawSize(0),
+	totalSize(0), segmentCount(0), crc(0) {
+}
+
+/** Function Name: open()
+ *  Description: Starts a new log in an empty file, or picks up the totals
+ *               of an existing one from its last footer alone
+ *  Return Value: False if the file is not a log or its last footer is
+ *                damaged
+ */
+bool AppendEncoder::open() {
+	file.clear();
+	file.seekg(0, ios::end);
+	if (file.tellg() == 0) {
+		file.seekp(0);
+		file.write(APPEND_MAGIC, APPEND_MAGIC_SIZE);
+		file.put((char)APPEND_VERSION);
+	}
+	else {
+		unsigned long long size;
+		if (!readHeader(file, size)) {
+			return false;
+		}
+		if (size > APPEND_HEADER_SIZE) {
+			AppendFooter footer;
+			if (size < APPEND_HEADER_SIZE + APPEND_FOOTER_SIZE
+				|| !readFooter(file, size - APPEND_FOOTER_SIZE, footer)) {
+				return false;
+			}
+			lastFooter = size - APPEND_FOOTER_SIZE;
+			totalSize = footer.totalSize;
+			segmentCount = footer.segmentCount;
+		}
+		file.clear();
+		file.seekp(0, ios::end);
+	}
+	segmentOffset = (unsigned long long)file.tellp();
+	return (bool)file;
+}
+
+/** Function Name: writeBlock(const byte* data, size_t size)
+ *  Description: Writes data as one block of the new segment
+ *  Return Value: None
+ */
+void AppendEncoder::writeBlock(const byte* data, size_t size) {
+	encoder.writeBlock(data, size);
+	crc = crc32(data, size, crc);
+	rawSize += size;
+}
+
+/** Function Name: finish()
+ *  Description: Ends the block stream and writes the footer of the new
+ *               segment, which points back at the last one
+ *  Return Value: None
+ */
+void AppendEncoder::finish() {
+	if (rawSize == 0) {
+		file.flush();
+		return;
+	}
+	encoder.finish();
+	AppendFooter footer;
+	footer.segmentOffset = segmentOffset;
+	footer.rawSize = rawSize;
+	footer.prevFooter = lastFooter;
+	footer.totalSize = totalSize + rawSize;
+	footer.segmentCount = segmentCount + 1;
+	footer.crc = crc;
+	lastFooter = (unsigned long long)file.tellp();
+	writeFooter(file, footer);
+	file.flush();
+	totalSize = footer.totalSize;
+	segmentCount = footer.segmentCount;
+	rawSize = 0;
+}
+
+/** Function Name: getSegmentCount() const
+ *  Description: Getter for the number of segments in the log
+ *  Return Value: The value of segmentCount
+ */
+unsigned int AppendEncoder::getSegmentCount() const {
+	return segmentCount;
+}
+
+/** Function Name: getTotalSize() const
+ *  Description: Getter for the number of raw bytes in the log
+ *  Return Value: The value of totalSize
+ */
+unsigned long long AppendEncoder::getTotalSize() const {
+	return totalSize;
+}
+
+/** Constructor
+ *  Description: Creates an AppendDecoder reading the log in is
+ */
+AppendDecoder::AppendDecoder(istream& is) : in(is) {
+}
+
+/** Function Name: readIndex()
+ *  Description: Follows the chain of footers from the end of the file back
+ *               to the first, checking the counts and totals step down
+ *               with every segment
+ *  Return Value: False if the log is malformed
+ */
+bool AppendDecoder::readIndex() {
+	TRACE_SPAN("index");
+	segments.clear();
+	unsigned long long size;
+	if (!readHeader(in, size)) {
+		return false;
+	}
+	if (size == APPEND_HEADER_SIZE) {
+		return true;
+	}
+	if (size < APPEND_HEADER_SIZE + APPEND_FOOTER_SIZE) {
+		return false;
+	}
+	unsigned long long offset = size - APPEND_FOOTER_SIZE;
+	AppendFooter footer;
+	if (!readFooter(in, offset, footer)) {
+		return false;
+	}
+	while (1) {
+		AppendSegment segment;
+		segment.offset = footer.segmentOffset;
+		segment.size = offset - footer.segmentOffset;
+		segment.rawSize = footer.rawSize;
+		segment.crc = footer.crc;
+		segments.push_back(segment);
+		if (footer.prevFooter == APPEND_NO_FOOTER) {
+			break;
+		}
+		AppendFooter prev;
+		offset = footer.prevFooter;
+		if (!readFooter(in, offset, prev)
+			|| prev.segmentCount + 1 != footer.segmentCount
+			|| prev.totalSize + footer.rawSize != footer.totalSize) {
+			return false;
+		}
+		footer = prev;
+	}
+	if (footer.totalSize != footer.rawSize) {
+		return false;
+	}
+	reverse(segments.begin(), segments.end());
+	return true;
+}
+
+/** Function Name: getSegments() const
+ *  Description: Getter for the segments read by readIndex()
+ *  Return Value: The segments
+ */
+const vector<AppendSegment>& AppendDecoder::getSegments() const {
+	return segments;
+}
+
+/** Function Name: decodeSegment(size_t index, ostream* out)
+ *  Description: Decodes the block stream of segment index into out a
+ *               block at a time, or only checks it if out is nullptr
+ *  Return Value: False if the segment is corrupt
+ */
+bool AppendDecoder::decodeSegment(size_t index, ostream* out) {
+	TRACE_SPAN("segment");
+	const AppendSegment& segment = segments[index];
+	in.clear();
+	in.seekg(segment.offset);
+	BlockDecoder decoder(in);
+	vector<byte> block;
+	unsigned long long rawSize = 0;
+	unsigned int crc = 0;
+	int mode;
+	while ((mode = decoder.readBlock(block)) != BLOCK_END) {
+		if (mode == BLOCK_ERROR) {
+			return false;
+		}
+		rawSize += block.size();
+		if (rawSize > segment.rawSize) {
+			return false;
+		}
+		crc = crc32(block.data(), block.size(), crc);
+		if (out) {
+			out->write((const char*)block.data(), block.size());
+		}
+	}
+	return (unsigned long long)in.tellg() == segment.offset + segment.size
+		&& rawSize == segment.rawSize && crc == segment.crc;
+}
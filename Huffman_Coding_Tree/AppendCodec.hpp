@@ -0,0 +1,151 @@
+/** Filename: AppendCodec.hpp
+ *  Name: Loc Chuong
+ *  Description: An appendable log format for the Huffman Coding Tree. Every
+ *               append adds a segment, a block stream of BlockCodec.hpp
+ *               coded on its own, followed by a footer pointing back at the
+ *               footer before it. Appending reads only the last footer and
+ *               writes only past the end of the file, so it costs as much
+ *               as the new data and never touches the bytes already there.
+ *
+ *               A log is laid out as
+ *                 "HCLG" | version (1 byte)
+ *                 segment | footer, once per append
+ *               and every footer as
+ *                 segment offset (8 bytes) | raw size (8 bytes) |
+ *                 previous footer offset (8 bytes) | total raw size
+ *                 (8 bytes) | segment count (4 bytes) | CRC-32 of the raw
+ *                 segment (4 bytes) | CRC-32 of the fields before
+ *                 (4 bytes) | "HCLG"
+ *               with every number little endian. The previous footer
+ *               offset of the first footer is 0, and the totals count every
+ *               segment up to and including the footer's own.
+ *  Date: 10/18/2026
+ */
+
+#ifndef APPENDCODEC_HPP
+#define APPENDCODEC_HPP
+
+#include <iostream>
+#include <vector>
+#include "BlockCodec.hpp"
+
+#define APPEND_MAGIC "HCLG" /** First bytes of a log and last of a footer */
+#define APPEND_MAGIC_SIZE 4 /** Number of bytes in APPEND_MAGIC */
+#define APPEND_VERSION 1 /** Format version written after the magic */
+#define APPEND_HEADER_SIZE 5 /** Magic and version */
+#define APPEND_FOOTER_SIZE 48 /** Number of bytes in a footer */
+#define APPEND_NO_FOOTER 0 /** Previous footer offset of the first footer */
+
+using namespace std;
+
+/** Struct Name: AppendSegment
+ *  Description: One appended segment, as its footer records it
+ */
+struct AppendSegment {
+	unsigned long long offset; /** Log offset of the block stream */
+	unsigned long long size; /** Bytes of the block stream */
+	unsigned long long rawSize; /** Bytes the segment decodes to */
+	unsigned int crc; /** CRC-32 of the decoded segment */
+};
+
+/** Class Name: AppendEncoder
+ *  Description: Appends one segment to a new or existing log. The blocks
+ *               of the segment go through a BlockEncoder of their own, so
+ *               no table reaches back into earlier segments.
+ */
+class AppendEncoder {
+private:
+	iostream& file; /** The log, open for reading and writing */
+	BlockEncoder encoder; /** Codes the blocks of the new segment */
+	unsigned long long segmentOffset; /** Where the new segment starts */
+	unsigned long long lastFooter; /** Offset of the last footer, if any */
+	unsigned long long rawSize; /** Bytes written to the new segment */
+	unsigned long long totalSize; /** Raw bytes in the whole log */
+	unsigned int segmentCount; /** Segments in the whole log */
+	unsigned int crc; /** CRC-32 of the new segment so far */
+
+public:
+	/** Constructor
+	 *  Description: Creates an AppendEncoder appending to the log in fs
+	 */
+	explicit AppendEncoder(iostream& fs);
+
+	/** Function Name: open()
+	 *  Description: Writes the header of an empty file, or checks the
+	 *               header and reads the last footer of an existing log,
+	 *               then moves to the end of the file
+	 *  Return Value: False if the file is not a log or its last footer is
+	 *                damaged, as after an append that did not finish
+	 */
+	bool open();
+
+	/** Function Name: writeBlock(const byte* data, size_t size)
+	 *  Description: Writes data as one block of the new segment
+	 *  PRECONDITION: open() succeeded and 0 < size <= BLOCK_SIZE
+	 *  Parameters: data - The bytes of the block
+	 *              size - Number of bytes in data
+	 *  Return Value: None
+	 */
+	void writeBlock(const byte* data, size_t size);
+
+	/** Function Name: finish()
+	 *  Description: Ends the block stream of the new segment and writes
+	 *               its footer. Nothing is written when no block was.
+	 *  Return Value: None
+	 */
+	void finish();
+
+	/** Function Name: getSegmentCount() const
+	 *  Description: Getter for the number of segments in the log
+	 *  Return Value: The value of segmentCount
+	 */
+	unsigned int getSegmentCount() const;
+
+	/** Function Name: getTotalSize() const
+	 *  Description: Getter for the number of raw bytes in the log
+	 *  Return Value: The value of totalSize
+	 */
+	unsigned long long getTotalSize() const;
+};
+
+/** Class Name: AppendDecoder
+ *  Description: Walks the footers of a log from the last one back to the
+ *               first and decodes its segments.
+ */
+class AppendDecoder {
+private:
+	istream& in; /** The log */
+	vector<AppendSegment> segments; /** Segments, in the order appended */
+
+public:
+	/** Constructor
+	 *  Description: Creates an AppendDecoder reading the log in is
+	 */
+	explicit AppendDecoder(istream& is);
+
+	/** Function Name: readIndex()
+	 *  Description: Checks the header, then follows the footers back from
+	 *               the end of the file, checking every one
+	 *  Return Value: False if the log is malformed
+	 */
+	bool readIndex();
+
+	/** Function Name: getSegments() const
+	 *  Description: Getter for the segments read by readIndex()
+	 *  Return Value: The segments
+	 */
+	const vector<AppendSegment>& getSegments() const;
+
+	/** Function Name: decodeSegment(size_t index, ostream* out)
+	 *  Description: Decodes segment index a block at a time into out, and
+	 *               checks it fills its place in the log exactly and
+	 *               matches its size and CRC-32
+	 *  Parameters: index - The segment, below getSegments().size()
+	 *              out - Stream the decoded bytes are written to, or
+	 *                    nullptr to only check the segment
+	 *  Return Value: False if the segment is corrupt
+	 */
+	bool decodeSegment(size_t index, ostream* out);
+};
+
+#endif // APPENDCODEC_HPP
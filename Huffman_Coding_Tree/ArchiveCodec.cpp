@@ -0,0 +1,349 @@
+/** Filename: ArchiveCodec.cpp
+ *  Name: Loc Chuong
+ *  Description: A high-ratio archive format for the Huffman Coding Tree. Every
+ *               block goes through the BWT front end and is Huffman coded,
+ *               and a batch of blocks is coded on several threads at once.
+ *  Date: 10/18/2026
+ */
+
+#include "ArchiveCodec.hpp"
+#include "BitKernels.hpp"
+#include "Crc32.hpp"
+#include "LittleEndian.hpp"
+#include "Trace.hpp"
+#include <sstream>
+#include <string>
+#include <thread>
+
+#define ARCHIVE_BITMAP_BYTES (ASCII_MAX / BUFFER_SIZE) /** Bytes-present map */
+#define ARCHIVE_FIXED_BYTES (4 * BWT_STREAMS + ARCHIVE_BITMAP_BYTES)
+
+/** Constructor
+ *  Description: Creates an ArchiveEncoder writing to os and writes the
+ *               magic
+ */
+ArchiveEncoder::ArchiveEncoder(ostream& os, int threads) : out(os),
+	threads(threads < 1 ? 1 : threads) {
+	for (int i = 0; i < ARCHIVE_MODES; i++) {
+		modeCounts[i] = 0;
+	}
+	out.write(ARCHIVE_MAGIC, ARCHIVE_MAGIC_SIZE);
+	out.put((char)ARCHIVE_VERSION);
+}
+
+/** Function Name: encodeBlock(const byte* data, size_t size,
+ *                             vector<byte>& body)
+ *  Description: Runs the BWT, move-to-front and zero-run front end over the
+ *               block and Huffman codes the symbols it leaves
+ *  Return Value: The mode of the block
+ */
+int ArchiveEncoder::encodeBlock(const byte* data, size_t size,
+	vector<byte>& body) {
+	TRACE_SPAN("archive block");
+	body.clear();
+	/** Move-to-front only ranks the bytes that occur */
+	bool present[ASCII_MAX] = { false };
+	for (size_t i = 0; i < size; i++) {
+		present[data[i]] = true;
+	}
+	vector<byte> alphabet;
+	for (int c = 0; c < ASCII_MAX; c++) {
+		if (present[c]) {
+			alphabet.push_back((byte)c);
+		}
+	}
+
+	vector<byte> transformed(size);
+	unsigned int starts[BWT_STREAMS];
+	bwtEncode(data, size, transformed.data(), starts);
+	vector<unsigned short> symbols;
+	mtfEncode(transformed.data(), size, alphabet, symbols);
+
+	vector<int> freqs(ARCHIVE_ALPHABET, 0);
+	for (size_t i = 0; i < symbols.size(); i++) {
+		freqs[symbols[i]]++;
+	}
+	HCTree tree;
+	tree.build(freqs);
+
+	for (int q = 0; q < BWT_STREAMS; q++) {
+		putNumber(body, starts[q], 4);
+	}
+	for (int i = 0; i < ARCHIVE_BITMAP_BYTES; i++) {
+		byte bits = 0;
+		for (int b = 0; b < BUFFER_SIZE; b++) {
+			if (present[i * BUFFER_SIZE + b]) {
+				bits |= (byte)(1 << b);
+			}
+		}
+		body.push_back(bits);
+	}
+	ostringstream header;
+	BitOutputStream headerBOS(header);
+	HCTree::writeHeader(freqs, headerBOS, ARCHIVE_SYMBOL_BITS);
+	while (headerBOS.getnbits() != 0) {
+		headerBOS.writeBit(0);
+	}
+	string bytes = header.str();
+	body.insert(body.end(), bytes.begin(), bytes.end());
+	{
+		TRACE_SPAN("encode");
+		size_t start = body.size();
+		body.resize(start + encodeBound(tree, symbols.size()));
+		size_t bits = encodeSymbols(tree, symbols.data(), symbols.size(),
+			body.data() + start);
+		body.resize(start + (bits + 7) / 8);
+	}
+
+	/** Data the front end cannot shrink is stored as is */
+	if (body.size() >= size) {
+		body.assign(data, data + size);
+		return ARCHIVE_RAW;
+	}
+	return ARCHIVE_BWT;
+}
+
+/** Function Name: flush()
+ *  Description: Codes every pending block, one per thread with the first on
+ *               the calling thread, and writes them in order
+ *  Return Value: None
+ */
+void ArchiveEncoder::flush() {
+	size_t count = pending.size();
+	vector<vector<byte>> bodies(count);
+	vector<int> modes(count);
+	vector<unsigned int> crcs(count);
+	auto work = [this, &bodies, &modes, &crcs](size_t i) {
+		crcs[i] = crc32(pending[i].data(), pending[i].size());
+		modes[i] = encodeBlock(pending[i].data(), pending[i].size(),
+			bodies[i]);
+	};
+	vector<thread> workers;
+	for (size_t i = 1; i < count; i++) {
+		workers.push_back(thread(work, i));
+	}
+	if (count > 0) {
+		work(0);
+	}
+	for (size_t i = 0; i < workers.size(); i++) {
+		workers[i].join();
+	}
+	for (size_t i = 0; i < count; i++) {
+		modeCounts[modes[i]]++;
+		out.put((char)modes[i]);
+		writeU32(out, crcs[i]);
+		writeU32(out, (unsigned int)pending[i].size());
+		writeU32(out, (unsigned int)bodies[i].size());
+		out.write((const char*)bodies[i].data(), bodies[i].size());
+	}
+	pending.clear();
+}
+
+/** Function Name: writeBlock(const byte* data, size_t size)
+ *  Description: Queues data as one block, coding the batch once it is full
+ *  Return Value: None
+ */
+void ArchiveEncoder::writeBlock(const byte* data, size_t size) {
+	pending.push_back(vector<byte>(data, data + size));
+	if ((int)pending.size() >= threads) {
+		flush();
+	}
+}
+
+/** Function Name: finish()
+ *  Description: Writes the blocks still queued and the ARCHIVE_END marker
+ *  Return Value: None
+ */
+void ArchiveEncoder::finish() {
+	flush();
+	out.put((char)ARCHIVE_END);
+	out.flush();
+}
+
+/** Function Name: getModeCount(int mode) const
+ *  Description: Getter for the number of blocks written in mode
+ *  Return Value: The number of blocks written in mode
+ */
+unsigned long long ArchiveEncoder::getModeCount(int mode) const {
+	return modeCounts[mode];
+}
+
+/** Constructor
+ *  Description: Creates an ArchiveDecoder reading from is
+ */
+ArchiveDecoder::ArchiveDecoder(istream& is, int threads) : in(is),
+	threads(threads < 1 ? 1 : threads), nextReady(0), started(false),
+	ended(false), checkedCount(0) {
+}
+
+/** Function Name: decodeBlock(int mode, const vector<byte>& body,
+ *                             size_t rawSize, unsigned int crc,
+ *                             vector<byte>& data)
+ *  Description: Huffman decodes the symbols of one block, undoes the
+ *               zero-run, move-to-front and BWT front end, and checks the
+ *               CRC-32 of the result while it is still in cache
+ *  Return Value: False if the body is malformed or the CRC-32 does not
+ *                match
+ */
+bool ArchiveDecoder::decodeBlock(int mode, const vector<byte>& body,
+	size_t rawSize, unsigned int crc, vector<byte>& data) {
+	TRACE_SPAN("archive block");
+	if (mode == ARCHIVE_RAW) {
+		if (body.size() != rawSize) {
+			return false;
+		}
+		data = body;
+		return crc32(data.data(), data.size()) == crc;
+	}
+	if (body.size() < ARCHIVE_FIXED_BYTES || rawSize == 0) {
+		return false;
+	}
+	unsigned int starts[BWT_STREAMS];
+	for (int q = 0; q < BWT_STREAMS; q++) {
+		starts[q] = (unsigned int)loadNumber(body.data() + 4 * q, 4);
+	}
+	vector<byte> alphabet;
+	const byte* bitmap = body.data() + 4 * BWT_STREAMS;
+	for (int c = 0; c < ASCII_MAX; c++) {
+		if (bitmap[c / BUFFER_SIZE] & (1 << (c % BUFFER_SIZE))) {
+			alphabet.push_back((byte)c);
+		}
+	}
+
+	istringstream header(string((const char*)body.data() + ARCHIVE_FIXED_BYTES,
+		body.size() - ARCHIVE_FIXED_BYTES));
+	BitInputStream headerBIS(header);
+	vector<int> freqs;
+	int count = HCTree::readHeader(headerBIS, freqs, ARCHIVE_SYMBOL_BITS);
+	/** A block never has more symbols than bytes */
+	if (count <= 0 || (size_t)count > rawSize) {
+		return false;
+	}
+	size_t codeStart = ARCHIVE_FIXED_BYTES
+		+ (HCTree::headerBits(freqs, ARCHIVE_SYMBOL_BITS) + 7) / 8;
+	if (codeStart > body.size()) {
+		return false;
+	}
+	HCTree tree;
+	tree.build(freqs);
+	vector<unsigned short> symbols(count);
+	{
+		TRACE_SPAN("decode");
+		if (!decodeSymbols(tree, body.data() + codeStart,
+			body.size() - codeStart, symbols.data(), count)) {
+			return false;
+		}
+	}
+	vector<byte> transformed(rawSize);
+	if (!mtfDecode(symbols.data(), count, alphabet, transformed.data(),
+		rawSize)) {
+		return false;
+	}
+	data.resize(rawSize);
+	return bwtDecode(transformed.data(), rawSize, starts, data.data())
+		&& crc32(data.data(), data.size()) == crc;
+}
+
+/** Function Name: fill()
+ *  Description: Reads up to one block per thread and decodes them side by
+ *               side, the first on the calling thread
+ *  Return Value: False if a block is malformed
+ */
+bool ArchiveDecoder::fill() {
+	ready.clear();
+	readyModes.clear();
+	nextReady = 0;
+	vector<vector<byte>> bodies;
+	vector<size_t> rawSizes;
+	vector<unsigned int> crcs;
+	if (!started) {
+		char header[ARCHIVE_MAGIC_SIZE + 1];
+		if (!in.read(header, ARCHIVE_MAGIC_SIZE + 1)
+			|| string(header, ARCHIVE_MAGIC_SIZE) != ARCHIVE_MAGIC
+			|| header[ARCHIVE_MAGIC_SIZE] != ARCHIVE_VERSION) {
+			return false;
+		}
+		started = true;
+	}
+	while ((int)bodies.size() < threads) {
+		int mode = in.get();
+		if (mode == EOF) {
+			return false;
+		}
+		if (mode == ARCHIVE_END) {
+			ended = true;
+			break;
+		}
+		unsigned int crc = 0;
+		unsigned int rawSize = 0;
+		unsigned int bodySize = 0;
+		if (mode >= ARCHIVE_MODES || !readU32(in, crc)
+			|| !readU32(in, rawSize) || !readU32(in, bodySize)
+			|| rawSize > ARCHIVE_BLOCK_SIZE || bodySize > rawSize) {
+			return false;
+		}
+		/** Pull the whole body in so the bit reader cannot run past it */
+		bodies.push_back(vector<byte>(bodySize));
+		if (!in.read((char*)bodies.back().data(), bodySize)) {
+			return false;
+		}
+		readyModes.push_back(mode);
+		rawSizes.push_back(rawSize);
+		crcs.push_back(crc);
+	}
+	size_t count = bodies.size();
+	ready.resize(count);
+	vector<char> valid(count, 0);
+	auto work = [this, &bodies, &rawSizes, &crcs, &valid](size_t i) {
+		valid[i] = decodeBlock(readyModes[i], bodies[i], rawSizes[i],
+			crcs[i], ready[i]);
+	};
+	vector<thread> workers;
+	for (size_t i = 1; i < count; i++) {
+		workers.push_back(thread(work, i));
+	}
+	if (count > 0) {
+		work(0);
+	}
+	for (size_t i = 0; i < workers.size(); i++) {
+		workers[i].join();
+	}
+	for (size_t i = 0; i < count; i++) {
+		if (!valid[i]) {
+			return false;
+		}
+	}
+	checkedCount += count;
+	return true;
+}
+
+/** Function Name: readBlock(vector<byte>& data)
+ *  Description: Hands out the next decoded block, decoding the next batch
+ *               when the current one is used up
+ *  Return Value: The mode of the block, ARCHIVE_END once the stream is done,
+ *                or ARCHIVE_ERROR if the block is malformed
+ */
+int ArchiveDecoder::readBlock(vector<byte>& data) {
+	data.clear();
+	if (nextReady == ready.size()) {
+		if (ended) {
+			return ARCHIVE_END;
+		}
+		if (!fill()) {
+			return ARCHIVE_ERROR;
+		}
+		if (ready.empty()) {
+			return ARCHIVE_END;
+		}
+	}
+	data.swap(ready[nextReady]);
+	return readyModes[nextReady++];
+}
+
+/** Function Name: getCheckedCount() const
+ *  Description: Getter for the number of blocks whose CRC-32 was checked
+ *  Return Value: The value of checkedCount
+ */
+unsigned long long ArchiveDecoder::getCheckedCount() const {
+	return checkedCount;
+}
@@ -0,0 +1,168 @@
+/** Filename: ArchiveCodec.hpp
+ *  Name: Loc Chuong
+ *  Description: A high-ratio archive format for the Huffman Coding Tree. The
+ *               input is cut into blocks of at most ARCHIVE_BLOCK_SIZE bytes
+ *               and every block goes through the BWT, move-to-front and
+ *               zero-run front end of Bwt.hpp before it is Huffman coded
+ *               with an HCTree over ARCHIVE_ALPHABET symbols. Blocks are
+ *               independent, so a batch of them is coded on several threads
+ *               at once, in both directions.
+ *
+ *               The stream starts with ARCHIVE_MAGIC and a version byte,
+ *               and every block is laid out as
+ *                 mode (1 byte) | CRC-32 of the block (4 bytes) |
+ *                 raw size (4 bytes) | body size (4 bytes) | body
+ *               where the body of an ARCHIVE_BWT block is the BWT_STREAMS
+ *               stream start rows (4 bytes each), a bitmap of the bytes in
+ *               the block (ASCII_MAX bits), the frequency header of the
+ *               symbols with ARCHIVE_SYMBOL_BITS bits per symbol padded to a
+ *               byte, and the padded code bits, and the body of an
+ *               ARCHIVE_RAW block is the bytes themselves. The stream ends
+ *               with an ARCHIVE_END block. Sizes are little endian. The
+ *               CRC-32 covers the decoded bytes and is checked by the thread
+ *               that decoded them.
+ *  Date: 10/18/2026
+ */
+
+#ifndef ARCHIVECODEC_HPP
+#define ARCHIVECODEC_HPP
+
+#include <iostream>
+#include <vector>
+#include "Bwt.hpp"
+
+#define ARCHIVE_BLOCK_SIZE (1 << 20) /** Max number of input bytes in a block */
+#define ARCHIVE_MODES 3 /** Number of archive block modes */
+#define ARCHIVE_END 0 /** Marks the end of the archive stream */
+#define ARCHIVE_BWT 1 /** Block went through the BWT front end */
+#define ARCHIVE_RAW 2 /** Block is stored as is */
+#define ARCHIVE_ERROR -1 /** Returned when a block cannot be read */
+#define ARCHIVE_SYMBOL_BITS 9 /** Bits per symbol in the frequency header */
+#define ARCHIVE_MAGIC "HCBW" /** First bytes of every archive stream */
+#define ARCHIVE_MAGIC_SIZE 4 /** Number of bytes in ARCHIVE_MAGIC */
+#define ARCHIVE_VERSION 1 /** Format version written after the magic */
+
+using namespace std;
+
+/** Class Name: ArchiveEncoder
+ *  Description: Writes archive blocks to an ostream. Blocks are collected
+ *               until there is one per thread, then coded side by side and
+ *               written in order.
+ */
+class ArchiveEncoder {
+private:
+	ostream& out; /** The stream blocks are written to */
+	int threads; /** Number of blocks coded at once */
+	vector<vector<byte>> pending; /** Blocks waiting to be coded */
+	unsigned long long modeCounts[ARCHIVE_MODES]; /** Blocks written per mode */
+
+	/** Function Name: flush()
+	 *  Description: Codes every pending block and writes them in order
+	 *  Return Value: None
+	 */
+	void flush();
+
+public:
+	/** Constructor
+	 *  Description: Creates an ArchiveEncoder writing to os, coding up to
+	 *               threads blocks at once, and writes the magic
+	 */
+	ArchiveEncoder(ostream& os, int threads);
+
+	/** Function Name: writeBlock(const byte* data, size_t size)
+	 *  Description: Queues data as one block, coding the batch once it is
+	 *               full
+	 *  PRECONDITION: 0 < size <= ARCHIVE_BLOCK_SIZE
+	 *  Parameters: data - The bytes of the block
+	 *              size - Number of bytes in data
+	 *  Return Value: None
+	 */
+	void writeBlock(const byte* data, size_t size);
+
+	/** Function Name: finish()
+	 *  Description: Writes the blocks still queued and the ARCHIVE_END marker
+	 *  Return Value: None
+	 */
+	void finish();
+
+	/** Function Name: getModeCount(int mode) const
+	 *  Description: Getter for the number of blocks written in mode
+	 *  Return Value: The number of blocks written in mode
+	 */
+	unsigned long long getModeCount(int mode) const;
+
+	/** Function Name: encodeBlock(const byte* data, size_t size,
+	 *                             vector<byte>& body)
+	 *  Description: Codes one block into its body, falling back to raw
+	 *               when the coded body would not be smaller
+	 *  Parameters: data - The bytes of the block
+	 *              size - Number of bytes in data
+	 *              body - Set to the body of the block
+	 *  Return Value: The mode of the block
+	 */
+	static int encodeBlock(const byte* data, size_t size, vector<byte>& body);
+};
+
+/** Class Name: ArchiveDecoder
+ *  Description: Reads blocks written by an ArchiveEncoder back from an
+ *               istream, decoding a batch of them side by side
+ */
+class ArchiveDecoder {
+private:
+	istream& in; /** The stream blocks are read from */
+	int threads; /** Number of blocks decoded at once */
+	vector<vector<byte>> ready; /** Decoded blocks of the current batch */
+	vector<int> readyModes; /** Mode of every block in ready */
+	size_t nextReady; /** Index of the next block of ready to hand out */
+	bool started; /** Whether the magic has been read */
+	bool ended; /** Whether ARCHIVE_END has been read */
+	unsigned long long checkedCount; /** Blocks whose CRC-32 matched */
+
+	/** Function Name: fill()
+	 *  Description: Reads and decodes the next batch into ready
+	 *  Return Value: False if a block is malformed or its CRC-32 does not
+	 *                match
+	 */
+	bool fill();
+
+public:
+	/** Constructor
+	 *  Description: Creates an ArchiveDecoder reading from is, decoding up
+	 *               to threads blocks at once
+	 */
+	ArchiveDecoder(istream& is, int threads);
+
+	/** Function Name: readBlock(vector<byte>& data)
+	 *  Description: Hands out the next decoded block
+	 *  Parameters: data - Set to the bytes of the block
+	 *  Return Value: The mode of the block, ARCHIVE_END once the stream is
+	 *                done, or ARCHIVE_ERROR if the stream is not an
+	 *                archive, or the block is malformed or its CRC-32 does
+	 *                not match
+	 */
+	int readBlock(vector<byte>& data);
+
+	/** Function Name: getCheckedCount() const
+	 *  Description: Getter for the number of blocks read whose CRC-32 was
+	 *               checked
+	 *  Return Value: The value of checkedCount
+	 */
+	unsigned long long getCheckedCount() const;
+
+	/** Function Name: decodeBlock(int mode, const vector<byte>& body,
+	 *                             size_t rawSize, unsigned int crc,
+	 *                             vector<byte>& data)
+	 *  Description: Decodes the body of one block and checks its CRC-32
+	 *  Parameters: mode - The mode of the block
+	 *              body - The body of the block
+	 *              rawSize - Number of bytes the block decodes to
+	 *              crc - CRC-32 the decoded bytes must have
+	 *              data - Set to the bytes of the block
+	 *  Return Value: False if the body is malformed or the CRC-32 does not
+	 *                match
+	 */
+	static bool decodeBlock(int mode, const vector<byte>& body,
+		size_t rawSize, unsigned int crc, vector<byte>& data);
+};
+
+#endif // ARCHIVECODEC_HPP
@@ -0,0 +1,356 @@
+/** Filename: BatchIO.cpp
+ *  Name: Loc Chuong
+ *  Description: Reads and writes many whole files at once for batch runs,
+ *               through io_uring on Linux and plain streams elsewhere.
+ *  Date: 10/18/2026
+ */
+
+#include "BatchIO.hpp"
+#include "Trace.hpp"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+#if HC_IO_URING
+#include <linux/io_uring.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+/** Constructor
+ *  Description: Sets up the io_uring backend if allowUring is set and the
+ *               kernel allows it, otherwise uses plain reads and writes
+ */
+BatchIO::BatchIO(bool allowUring) : uring(false) {
+#if HC_IO_URING
+	ringFd = -1;
+	sqRing = cqRing = sqes = MAP_FAILED;
+	if (allowUring) {
+		uring = setupRing();
+	}
+#endif
+}
+
+/** Destructor
+ *  Description: Tears the ring down
+ */
+BatchIO::~BatchIO() {
+#if HC_IO_URING
+	if (sqes != MAP_FAILED) {
+		munmap(sqes, sqesSize);
+	}
+	if (cqRing != MAP_FAILED && cqRing != sqRing) {
+		munmap(cqRing, cqRingSize);
+	}
+	if (sqRing != MAP_FAILED) {
+		munmap(sqRing, sqRingSize);
+	}
+	if (ringFd >= 0) {
+		close(ringFd);
+	}
+#endif
+}
+
+#if HC_IO_URING
+/** Function Name: setupRing()
+ *  Description: Creates the io_uring, maps its rings and registers slots.
+ *               Talks to the kernel directly so no liburing is needed.
+ *  Return Value: False if the kernel refused any step
+ */
+bool BatchIO::setupRing() {
+	io_uring_params params;
+	memset(&params, 0, sizeof(params));
+	ringFd = (int)syscall(__NR_io_uring_setup, BATCH_QUEUE_DEPTH, &params);
+	if (ringFd < 0) {
+		return false;
+	}
+	sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+	cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+	/** Newer kernels map both rings with one mmap */
+	bool single = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+	if (single && cqRingSize > sqRingSize) {
+		sqRingSize = cqRingSize;
+	}
+	sqRing = mmap(nullptr, sqRingSize, PROT_READ | PROT_WRITE,
+		MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQ_RING);
+	if (sqRing == MAP_FAILED) {
+		return false;
+	}
+	cqRing = single ? sqRing : mmap(nullptr, cqRingSize,
+		PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd,
+		IORING_OFF_CQ_RING);
+	if (cqRing == MAP_FAILED) {
+		return false;
+	}
+	sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+	sqes = mmap(nullptr, sqesSize, PROT_READ | PROT_WRITE,
+		MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQES);
+	if (sqes == MAP_FAILED) {
+		return false;
+	}
+	byte* sq = (byte*)sqRing;
+	byte* cq = (byte*)cqRing;
+	sqHead = (unsigned*)(sq + params.sq_off.head);
+	sqTail = (unsigned*)(sq + params.sq_off.tail);
+	sqMask = (unsigned*)(sq + params.sq_off.ring_mask);
+	sqArray = (unsigned*)(sq + params.sq_off.array);
+	cqHead = (unsigned*)(cq + params.cq_off.head);
+	cqTail = (unsigned*)(cq + params.cq_off.tail);
+	cqMask = (unsigned*)(cq + params.cq_off.ring_mask);
+	cqes = cq + params.cq_off.cqes;
+
+	/** Pin the slots once so every transfer skips the page lookups */
+	slots.resize((size_t)BATCH_QUEUE_DEPTH * BATCH_SLOT_SIZE);
+	iovec iovs[BATCH_QUEUE_DEPTH];
+	for (int i = 0; i < BATCH_QUEUE_DEPTH; i++) {
+		iovs[i].iov_base = slots.data() + (size_t)i * BATCH_SLOT_SIZE;
+		iovs[i].iov_len = BATCH_SLOT_SIZE;
+	}
+	return syscall(__NR_io_uring_register, ringFd, IORING_REGISTER_BUFFERS,
+		iovs, BATCH_QUEUE_DEPTH) == 0;
+}
+
+/** Function Name: runTransfers(vector<BatchFile>& files,
+ *                              vector<Transfer>& transfers, bool write)
+ *  Description: Runs every transfer through the ring, BATCH_QUEUE_DEPTH at
+ *               a time, resubmitting the rest of short transfers
+ *  Parameters: files - The batch, read into or written from
+ *              transfers - What to move
+ *              write - Whether to write to the files instead of reading
+ *  Return Value: False if the ring failed, with every file that had a
+ *                transfer in flight or still queued marked as failed
+ */
+bool BatchIO::runTransfers(vector<BatchFile>& files,
+	vector<Transfer>& transfers, bool write) {
+	io_uring_sqe* sqeRing = (io_uring_sqe*)sqes;
+	io_uring_cqe* cqeRing = (io_uring_cqe*)cqes;
+	Transfer inFlight[BATCH_QUEUE_DEPTH];
+	size_t next = 0;
+	while (next < transfers.size()) {
+		/** Fill the submission ring, one registered slot per transfer */
+		unsigned tail = *sqTail;
+		unsigned queued = 0;
+		while (queued < BATCH_QUEUE_DEPTH && next < transfers.size()) {
+			Transfer transfer = transfers[next++];
+			if (!files[transfer.file].ok) {
+				continue;
+			}
+			byte* slot = slots.data() + (size_t)queued * BATCH_SLOT_SIZE;
+			if (write) {
+				memcpy(slot, files[transfer.file].output.data()
+					+ transfer.offset, transfer.size);
+			}
+			unsigned index = tail & *sqMask;
+			io_uring_sqe& sqe = sqeRing[index];
+			memset(&sqe, 0, sizeof(sqe));
+			sqe.opcode = write ? IORING_OP_WRITE_FIXED : IORING_OP_READ_FIXED;
+			sqe.fd = transfer.fd;
+			sqe.off = transfer.offset;
+			sqe.addr = (unsigned long long)(size_t)slot;
+			sqe.len = (unsigned)transfer.size;
+			sqe.buf_index = (unsigned short)queued;
+			sqe.user_data = queued;
+			sqArray[index] = index;
+			inFlight[queued++] = transfer;
+			tail++;
+		}
+		if (queued == 0) {
+			continue;
+		}
+		__atomic_store_n(sqTail, tail, __ATOMIC_RELEASE);
+
+		/** One call submits them all and waits for every completion */
+		unsigned toSubmit = queued;
+		unsigned reaped = 0;
+		while (reaped < queued) {
+			long entered = syscall(__NR_io_uring_enter, ringFd, toSubmit,
+				queued - reaped, IORING_ENTER_GETEVENTS, nullptr, 0);
+			if (entered < 0 && errno != EINTR) {
+				/** The ring is unusable, fail what is in flight or queued */
+				for (unsigned i = 0; i < queued; i++) {
+					files[inFlight[i].file].ok = false;
+				}
+				for (size_t i = next; i < transfers.size(); i++) {
+					files[transfers[i].file].ok = false;
+				}
+				/** Drop the completions already posted, none will be read */
+				__atomic_store_n(cqHead,
+					__atomic_load_n(cqTail, __ATOMIC_ACQUIRE), __ATOMIC_RELEASE);
+				return false;
+			}
+			if (entered > 0) {
+				toSubmit -= (unsigned)entered < toSubmit ? entered : toSubmit;
+			}
+			unsigned head = *cqHead;
+			while (head != __atomic_load_n(cqTail, __ATOMIC_ACQUIRE)) {
+				io_uring_cqe& cqe = cqeRing[head & *cqMask];
+				Transfer& transfer = inFlight[cqe.user_data];
+				BatchFile& file = files[transfer.file];
+				if (cqe.res <= 0) {
+					file.ok = false;
+				}
+				else {
+					size_t moved = (size_t)cqe.res;
+					if (!write) {
+						memcpy(file.input.data() + transfer.offset,
+							slots.data() + cqe.user_data * BATCH_SLOT_SIZE, moved);
+					}
+					/** Short transfers go round again for the rest */
+					if (moved < transfer.size) {
+						Transfer rest = transfer;
+						rest.offset += moved;
+						rest.size -= moved;
+						transfers.push_back(rest);
+					}
+				}
+				head++;
+				reaped++;
+			}
+			__atomic_store_n(cqHead, head, __ATOMIC_RELEASE);
+		}
+	}
+	return true;
+}
+#endif
+
+/** Function Name: readPlain(BatchFile& file)
+ *  Description: Reads one file with an ifstream
+ *  Return Value: None
+ */
+void BatchIO::readPlain(BatchFile& file) {
+	ifstream in(file.inputPath, ios::binary);
+	if (!in) {
+		file.ok = false;
+		return;
+	}
+	in.seekg(0, ios::end);
+	file.input.resize((size_t)in.tellg());
+	in.seekg(0, ios::beg);
+	in.read((char*)file.input.data(), file.input.size());
+	file.ok = (size_t)in.gcount() == file.input.size();
+}
+
+/** Function Name: writePlain(BatchFile& file)
+ *  Description: Writes one file with an ofstream
+ *  Return Value: None
+ */
+void BatchIO::writePlain(BatchFile& file) {
+	ofstream out(file.outputPath, ios::binary);
+	out.write((const char*)file.output.data(), file.output.size());
+	file.ok = (bool)out;
+}
+
+/** Function Name: readFiles(vector<BatchFile>& files)
+ *  Description: Reads every inputPath into input, setting ok
+ *  Return Value: None
+ */
+void BatchIO::readFiles(vector<BatchFile>& files) {
+	TRACE_SPAN("batch read");
+	if (!uring) {
+		for (size_t i = 0; i < files.size(); i++) {
+			readPlain(files[i]);
+		}
+		return;
+	}
+#if HC_IO_URING
+	vector<Transfer> transfers;
+	vector<int> fds(files.size(), -1);
+	for (size_t i = 0; i < files.size(); i++) {
+		struct stat info;
+		fds[i] = open(files[i].inputPath.c_str(), O_RDONLY);
+		files[i].ok = fds[i] >= 0 && fstat(fds[i], &info) == 0;
+		if (!files[i].ok) {
+			continue;
+		}
+		files[i].input.resize((size_t)info.st_size);
+		for (size_t offset = 0; offset < files[i].input.size();
+			offset += BATCH_SLOT_SIZE) {
+			Transfer transfer = { i, fds[i], offset,
+				min((size_t)BATCH_SLOT_SIZE, files[i].input.size() - offset) };
+			transfers.push_back(transfer);
+		}
+	}
+	bool ringOk = runTransfers(files, transfers, false);
+	for (size_t i = 0; i < files.size(); i++) {
+		if (fds[i] >= 0) {
+			close(fds[i]);
+		}
+	}
+	/** A broken ring is not used again, the files it failed are read the
+	 *  plain way so none is left holding zeros
+	 */
+	if (!ringOk) {
+		uring = false;
+		for (size_t i = 0; i < files.size(); i++) {
+			if (fds[i] >= 0 && !files[i].ok) {
+				readPlain(files[i]);
+			}
+		}
+	}
+#endif
+}
+
+/** Function Name: writeFiles(vector<BatchFile>& files)
+ *  Description: Writes output to outputPath for every file still ok,
+ *               clearing ok where that fails
+ *  Return Value: None
+ */
+void BatchIO::writeFiles(vector<BatchFile>& files) {
+	TRACE_SPAN("batch write");
+	if (!uring) {
+		for (size_t i = 0; i < files.size(); i++) {
+			if (files[i].ok) {
+				writePlain(files[i]);
+			}
+		}
+		return;
+	}
+#if HC_IO_URING
+	vector<Transfer> transfers;
+	vector<int> fds(files.size(), -1);
+	for (size_t i = 0; i < files.size(); i++) {
+		if (!files[i].ok) {
+			continue;
+		}
+		fds[i] = open(files[i].outputPath.c_str(),
+			O_WRONLY | O_CREAT | O_TRUNC, 0644);
+		files[i].ok = fds[i] >= 0;
+		for (size_t offset = 0; files[i].ok && offset < files[i].output.size();
+			offset += BATCH_SLOT_SIZE) {
+			Transfer transfer = { i, fds[i], offset,
+				min((size_t)BATCH_SLOT_SIZE, files[i].output.size() - offset) };
+			transfers.push_back(transfer);
+		}
+	}
+	bool ringOk = runTransfers(files, transfers, true);
+	for (size_t i = 0; i < files.size(); i++) {
+		if (fds[i] >= 0) {
+			close(fds[i]);
+		}
+	}
+	/** Every file opened here was ok before, so the ones failed since are
+	 *  written again the plain way
+	 */
+	if (!ringOk) {
+		uring = false;
+		for (size_t i = 0; i < files.size(); i++) {
+			if (fds[i] >= 0 && !files[i].ok) {
+				writePlain(files[i]);
+			}
+		}
+	}
+#endif
+}
+
+/** Function Name: getBackendName() const
+ *  Description: Getter for the backend in use
+ *  Return Value: "io_uring" or "plain"
+ */
+const char* BatchIO::getBackendName() const {
+	return uring ? "io_uring" : "plain";
+}
@@ -0,0 +1,147 @@
+/** Filename: BatchIO.hpp
+ *  Name: Loc Chuong
+ *  Description: Reads and writes many whole files at once for batch runs.
+ *               On Linux the reads and writes of a batch go through one
+ *               io_uring with registered buffers, so a batch of small files
+ *               costs a handful of io_uring_enter calls instead of a read
+ *               and a write call per file. Everywhere else, or when the
+ *               kernel refuses io_uring, plain stream reads and writes are
+ *               used instead.
+ *  Date: 10/18/2026
+ */
+
+#ifndef BATCHIO_HPP
+#define BATCHIO_HPP
+
+#include <string>
+#include <vector>
+#include "HCNode.hpp"
+
+/** HC_IO_URING is set when the io_uring backend can be compiled */
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#define HC_IO_URING 1
+#endif
+#endif
+#ifndef HC_IO_URING
+#define HC_IO_URING 0
+#endif
+
+#define BATCH_QUEUE_DEPTH 64 /** Reads or writes in flight at once */
+#define BATCH_SLOT_SIZE (1 << 16) /** Bytes in one registered buffer */
+#define BATCH_FILES 256 /** Files held in memory at once by a batch run */
+
+using namespace std;
+
+/** Struct Name: BatchFile
+ *  Description: One file of a batch, with its contents on both sides
+ */
+struct BatchFile {
+	string inputPath; /** File readFiles() reads */
+	string outputPath; /** File writeFiles() writes */
+	vector<byte> input; /** Contents of inputPath */
+	vector<byte> output; /** Contents to write to outputPath */
+	bool ok; /** False once reading or writing this file failed */
+};
+
+/** Class Name: BatchIO
+ *  Description: Moves the contents of a batch of files in and out of
+ *               memory, through io_uring when it is available.
+ */
+class BatchIO {
+private:
+	/** Struct Name: Transfer
+	 *  Description: One read or write of up to BATCH_SLOT_SIZE bytes
+	 */
+	struct Transfer {
+		size_t file; /** Index of the file in the batch */
+		int fd; /** Open descriptor of the file */
+		size_t offset; /** Offset of the transfer in the file */
+		size_t size; /** Number of bytes to move */
+	};
+
+	bool uring; /** The io_uring backend is in use */
+#if HC_IO_URING
+	int ringFd; /** The io_uring instance */
+	unsigned* sqHead; /** Submission ring head, moved by the kernel */
+	unsigned* sqTail; /** Submission ring tail, moved by us */
+	unsigned* sqMask; /** Submission ring index mask */
+	unsigned* sqArray; /** Submission ring slots, indexes into sqes */
+	void* sqes; /** Submission queue entries */
+	unsigned* cqHead; /** Completion ring head, moved by us */
+	unsigned* cqTail; /** Completion ring tail, moved by the kernel */
+	unsigned* cqMask; /** Completion ring index mask */
+	void* cqes; /** Completion queue entries */
+	void* sqRing; /** Mapping of the submission ring */
+	size_t sqRingSize; /** Size of sqRing */
+	void* cqRing; /** Mapping of the completion ring, may be sqRing */
+	size_t cqRingSize; /** Size of cqRing */
+	size_t sqesSize; /** Size of the sqes mapping */
+	vector<byte> slots; /** Registered buffers, BATCH_SLOT_SIZE each */
+
+	/** Function Name: setupRing()
+	 *  Description: Creates the io_uring, maps its rings and registers slots
+	 *  Return Value: False if the kernel refused any step
+	 */
+	bool setupRing();
+
+	/** Function Name: runTransfers(vector<BatchFile>& files,
+	 *                              vector<Transfer>& transfers, bool write)
+	 *  Description: Runs every transfer through the ring, BATCH_QUEUE_DEPTH
+	 *               at a time, resubmitting the rest of short transfers
+	 *  Parameters: files - The batch, read into or written from
+	 *              transfers - What to move
+	 *              write - Whether to write to the files instead of reading
+	 *  Return Value: False if the ring failed, with every file that had a
+	 *                transfer in flight or still queued marked as failed
+	 */
+	bool runTransfers(vector<BatchFile>& files, vector<Transfer>& transfers,
+		bool write);
+#endif
+
+	/** Function Name: readPlain(BatchFile& file)
+	 *  Description: Reads one file with an ifstream
+	 *  Return Value: None
+	 */
+	static void readPlain(BatchFile& file);
+
+	/** Function Name: writePlain(BatchFile& file)
+	 *  Description: Writes one file with an ofstream
+	 *  Return Value: None
+	 */
+	static void writePlain(BatchFile& file);
+
+public:
+	/** Constructor
+	 *  Description: Sets up the io_uring backend if allowUring is set and the
+	 *               kernel allows it, otherwise uses plain reads and writes
+	 *  Parameters: allowUring - Whether io_uring may be used at all
+	 */
+	BatchIO(bool allowUring = true);
+
+	/** Destructor
+	 *  Description: Tears the ring down
+	 */
+	~BatchIO();
+
+	/** Function Name: readFiles(vector<BatchFile>& files)
+	 *  Description: Reads every inputPath into input, setting ok
+	 *  Return Value: None
+	 */
+	void readFiles(vector<BatchFile>& files);
+
+	/** Function Name: writeFiles(vector<BatchFile>& files)
+	 *  Description: Writes output to outputPath for every file still ok,
+	 *               clearing ok where that fails
+	 *  Return Value: None
+	 */
+	void writeFiles(vector<BatchFile>& files);
+
+	/** Function Name: getBackendName() const
+	 *  Description: Getter for the backend in use
+	 *  Return Value: "io_uring" or "plain"
+	 */
+	const char* getBackendName() const;
+};
+
+#endif // BATCHIO_HPP
@@ -0,0 +1,271 @@
+/** Filename: Benchmark.cpp
+ *  Name: Loc Chuong
+ *  Description: Times the compiled variants of the hot loops on a file and
+ *               prints which variant was picked for this host and the
+ *               throughput of each one.
+ *  Date: 10/18/2026
+ */
+
+#include "Benchmark.hpp"
+#include "BitKernels.hpp"
+#include "CpuFeatures.hpp"
+#include "Crc32.hpp"
+#include "HCTableCache.hpp"
+#include "MessageCodec.hpp"
+#include "StaticCodec.hpp"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+
+#define BENCH_BYTES (64 << 20) /** Roughly how many bytes each timing codes */
+#define MESSAGE_BENCH_SIZE 1024 /** Bytes per message in the latency timings */
+#define MESSAGE_BENCH_COUNT 20000 /** Messages each latency timing codes */
+
+/** Function Name: megabytesPerSecond(size_t bytes, double seconds)
+ *  Description: Converts a byte count and a duration to MB/s
+ *  Return Value: The throughput in MB/s
+ */
+static double megabytesPerSecond(size_t bytes, double seconds) {
+	return seconds > 0 ? bytes / seconds / (1 << 20) : 0;
+}
+
+/** Function Name: percentileMicros(vector<double>& seconds, int percent)
+ *  Description: The timing percent percent of the way up seconds
+ *  Return Value: That timing in microseconds
+ */
+static double percentileMicros(vector<double>& seconds, int percent) {
+	size_t rank = (seconds.size() - 1) * percent / 100;
+	nth_element(seconds.begin(), seconds.begin() + rank, seconds.end());
+	return seconds[rank] * 1e6;
+}
+
+/** Function Name: benchmark(string inputFile)
+ *  Description: Loads inputFile, codes it with every kernel variant the host
+ *               can run, checks they all agree with the scalar one and
+ *               prints their encode and decode speed, then does the same
+ *               with the static English table, times every message of
+ *               MESSAGE_BENCH_SIZE bytes through a MessageCodec and through
+ *               a tree built per message, and times every CRC-32 variant
+ *  Parameters: inputFile - The file to benchmark on
+ *  Return Value: 0 on success, -1 if the file is empty or a variant
+ *                disagrees
+ */
+int benchmark(string inputFile) {
+	/** Load the whole file */
+	ifstream inFile(inputFile, ios::binary);
+	vector<byte> data((istreambuf_iterator<char>(inFile)),
+		istreambuf_iterator<char>());
+	if (data.empty()) {
+		cout << "Nothing to benchmark in " << inputFile << endl;
+		return -1;
+	}
+	vector<int> freqs(ASCII_MAX, 0);
+	for (size_t i = 0; i < data.size(); i++) {
+		freqs[data[i]]++;
+	}
+	shared_ptr<const HCTree> tree = HCTableCache::global().acquire(freqs);
+
+	const CpuFeatures& cpu = cpuFeatures();
+	cout << "CPU: bmi2 " << cpu.bmi2 << ", lzcnt " << cpu.lzcnt
+		<< ", sse4.1 " << cpu.sse41 << ", avx2 " << cpu.avx2
+		<< ", pclmul " << cpu.pclmul << endl;
+	cout << "Selected kernel: " << bitKernels().name << ", CRC-32 "
+		<< crc32Kernel().name << endl;
+
+	/** Repeat small files so every timing covers about BENCH_BYTES */
+	size_t reps = BENCH_BYTES / data.size() + 1;
+	vector<byte> reference;
+	size_t referenceBits = 0;
+	vector<byte> coded(encodeBound(*tree, data.size()));
+	vector<byte> decoded(data.size());
+	int status = 0;
+	vector<const BitKernels*> kernels = availableBitKernels();
+	for (size_t k = 0; k < kernels.size(); k++) {
+		const BitKernels& kernel = *kernels[k];
+		size_t bits = 0;
+		chrono::steady_clock::time_point start = chrono::steady_clock::now();
+		for (size_t r = 0; r < reps; r++) {
+			bits = kernel.encode(*tree, data.data(), data.size(), coded.data());
+		}
+		chrono::duration<double> encodeTime =
+			chrono::steady_clock::now() - start;
+		size_t codedBytes = (bits + 7) / 8;
+
+		bool ok = true;
+		start = chrono::steady_clock::now();
+		for (size_t r = 0; r < reps; r++) {
+			ok = kernel.decode(*tree, coded.data(), codedBytes,
+				decoded.data(), decoded.size()) && ok;
+		}
+		chrono::duration<double> decodeTime =
+			chrono::steady_clock::now() - start;
+
+		/** Same again through the multi-symbol table, if the tree has one */
+		bool multi = tree->getMultiDecodeTable() != nullptr;
+		vector<byte> multiDecoded(data.size());
+		start = chrono::steady_clock::now();
+		for (size_t r = 0; multi && r < reps; r++) {
+			ok = kernel.decodeMulti(*tree, coded.data(), codedBytes,
+				multiDecoded.data(), multiDecoded.size()) && ok;
+		}
+		chrono::duration<double> multiTime =
+			chrono::steady_clock::now() - start;
+		ok = ok && (!multi || multiDecoded == data);
+
+		/** Every variant has to write the scalar variant's bits */
+		if (k == 0) {
+			reference.assign(coded.begin(), coded.begin() + codedBytes);
+			referenceBits = bits;
+		}
+		ok = ok && decoded == data && bits == referenceBits
+			&& equal(reference.begin(), reference.end(), coded.begin());
+
+		cout << "Kernel " << kernel.name << ": encode " << fixed
+			<< setprecision(1)
+			<< megabytesPerSecond(data.size() * reps, encodeTime.count())
+			<< " MB/s, decode "
+			<< megabytesPerSecond(data.size() * reps, decodeTime.count())
+			<< " MB/s";
+		if (multi) {
+			cout << ", multi-symbol decode "
+				<< megabytesPerSecond(data.size() * reps, multiTime.count())
+				<< " MB/s";
+		}
+		cout << (ok ? "" : " MISMATCH") << endl;
+		if (!ok) {
+			status = -1;
+		}
+	}
+
+	/** The compile-time English table needs no build and no header */
+	vector<byte> staticCoded(StaticCodec<EnglishText>::encodeBound(data.size()));
+	size_t staticBits = 0;
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+	for (size_t r = 0; r < reps; r++) {
+		staticBits = StaticCodec<EnglishText>::encode(data.data(), data.size(),
+			staticCoded.data());
+	}
+	chrono::duration<double> encodeTime = chrono::steady_clock::now() - start;
+	bool ok = true;
+	start = chrono::steady_clock::now();
+	for (size_t r = 0; r < reps; r++) {
+		ok = StaticCodec<EnglishText>::decode(staticCoded.data(),
+			(staticBits + 7) / 8, decoded.data(), decoded.size()) && ok;
+	}
+	chrono::duration<double> decodeTime = chrono::steady_clock::now() - start;
+	ok = ok && decoded == data;
+	cout << "Static English table: encode "
+		<< megabytesPerSecond(data.size() * reps, encodeTime.count())
+		<< " MB/s, decode "
+		<< megabytesPerSecond(data.size() * reps, decodeTime.count())
+		<< " MB/s, " << (staticBits + 7) / 8 << " bytes"
+		<< (ok ? "" : " MISMATCH") << endl;
+	if (!ok) {
+		status = -1;
+	}
+
+	/** Latency per message of a reused context, against setting up a tree,
+	 *  header streams and buffers for every message as compress() does
+	 */
+	size_t messageSize = min(data.size(), (size_t)MESSAGE_BENCH_SIZE);
+	size_t messages = data.size() / messageSize;
+	MessageCodec codec;
+	vector<byte> message(MessageCodec::encodeBound(messageSize));
+	vector<double> encodeTimes(MESSAGE_BENCH_COUNT);
+	vector<double> decodeTimes(MESSAGE_BENCH_COUNT);
+	vector<double> treeEncodeTimes(MESSAGE_BENCH_COUNT);
+	vector<double> treeDecodeTimes(MESSAGE_BENCH_COUNT);
+	unsigned long long messageBytes = 0;
+	unsigned long long treeMessageBytes = 0;
+	ok = true;
+	for (size_t m = 0; m < MESSAGE_BENCH_COUNT; m++) {
+		const byte* raw = data.data() + (m % messages) * messageSize;
+		start = chrono::steady_clock::now();
+		size_t codedSize = codec.encode(raw, messageSize, message.data());
+		chrono::steady_clock::time_point encoded = chrono::steady_clock::now();
+		size_t decodedSize = 0;
+		bool decodedOk = codec.decode(message.data(), codedSize,
+			decoded.data(), messageSize, decodedSize);
+		chrono::steady_clock::time_point done = chrono::steady_clock::now();
+		encodeTimes[m] = chrono::duration<double>(encoded - start).count();
+		decodeTimes[m] = chrono::duration<double>(done - encoded).count();
+		messageBytes += codedSize;
+		ok = ok && decodedOk && decodedSize == messageSize
+			&& equal(raw, raw + messageSize, decoded.begin());
+
+		start = chrono::steady_clock::now();
+		vector<int> messageFreqs(ASCII_MAX, 0);
+		for (size_t i = 0; i < messageSize; i++) {
+			messageFreqs[raw[i]]++;
+		}
+		HCTree* messageTree = new HCTree();
+		messageTree->build(messageFreqs);
+		ostringstream header;
+		BitOutputStream headerBOS(header);
+		HCTree::writeHeader(messageFreqs, headerBOS);
+		while (headerBOS.getnbits() != 0) {
+			headerBOS.writeBit(0);
+		}
+		string headerBytes = header.str();
+		vector<byte> treeCoded(headerBytes.begin(), headerBytes.end());
+		messageTree->encodeBytes(raw, messageSize, treeCoded);
+		delete messageTree;
+		encoded = chrono::steady_clock::now();
+		istringstream headerIn(string(treeCoded.begin(), treeCoded.end()));
+		BitInputStream headerBIS(headerIn);
+		vector<int> readFreqs;
+		HCTree::readHeader(headerBIS, readFreqs);
+		HCTree* readTree = new HCTree();
+		readTree->build(readFreqs);
+		size_t headerSize = (HCTree::headerBits(readFreqs) + 7) / 8;
+		decodedOk = readTree->decodeBytes(treeCoded.data() + headerSize,
+			treeCoded.size() - headerSize, decoded.data(), messageSize);
+		delete readTree;
+		done = chrono::steady_clock::now();
+		treeEncodeTimes[m] = chrono::duration<double>(encoded - start).count();
+		treeDecodeTimes[m] = chrono::duration<double>(done - encoded).count();
+		treeMessageBytes += treeCoded.size();
+		ok = ok && decodedOk && equal(raw, raw + messageSize, decoded.begin());
+	}
+	cout << setprecision(2) << "Message context, " << messageSize
+		<< " byte messages: encode p50 " << percentileMicros(encodeTimes, 50)
+		<< " us, p99 " << percentileMicros(encodeTimes, 99)
+		<< " us, decode p50 " << percentileMicros(decodeTimes, 50)
+		<< " us, p99 " << percentileMicros(decodeTimes, 99) << " us, "
+		<< messageBytes / MESSAGE_BENCH_COUNT << " bytes each" << endl;
+	cout << "Tree per message: encode p50 "
+		<< percentileMicros(treeEncodeTimes, 50)
+		<< " us, p99 " << percentileMicros(treeEncodeTimes, 99)
+		<< " us, decode p50 " << percentileMicros(treeDecodeTimes, 50)
+		<< " us, p99 " << percentileMicros(treeDecodeTimes, 99) << " us, "
+		<< treeMessageBytes / MESSAGE_BENCH_COUNT << " bytes each"
+		<< (ok ? "" : " MISMATCH") << setprecision(1) << endl;
+	if (!ok) {
+		status = -1;
+	}
+
+	/** Every CRC-32 variant has to agree with the bytewise one */
+	vector<const Crc32Kernel*> crcKernels = availableCrc32Kernels();
+	unsigned int referenceCrc = crcKernels[0]->update(data.data(),
+		data.size(), 0);
+	for (size_t k = 0; k < crcKernels.size(); k++) {
+		unsigned int crc = 0;
+		start = chrono::steady_clock::now();
+		for (size_t r = 0; r < reps; r++) {
+			crc = crcKernels[k]->update(data.data(), data.size(), 0);
+		}
+		chrono::duration<double> crcTime = chrono::steady_clock::now() - start;
+		ok = crc == referenceCrc;
+		cout << "CRC-32 " << crcKernels[k]->name << ": "
+			<< megabytesPerSecond(data.size() * reps, crcTime.count())
+			<< " MB/s" << (ok ? "" : " MISMATCH") << endl;
+		if (!ok) {
+			status = -1;
+		}
+	}
+	return status;
+}
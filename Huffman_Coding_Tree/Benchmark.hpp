@@ -0,0 +1,27 @@
+/** Filename: Benchmark.hpp
+ *  Name: Loc Chuong
+ *  Description: Times the compiled variants of the hot loops on a file and
+ *               prints which variant was picked for this host and the
+ *               throughput of each one.
+ *  Date: 10/18/2026
+ */
+
+#ifndef BENCHMARK_HPP
+#define BENCHMARK_HPP
+
+#include <string>
+
+using namespace std;
+
+/** Function Name: benchmark(string inputFile)
+ *  Description: Loads inputFile, codes it with every kernel variant the
+ *               host can run, checks they all agree with the scalar one
+ *               and prints their encode and decode speed, and the p50 and
+ *               p99 latency of coding it as small messages
+ *  Parameters: inputFile - The file to benchmark on
+ *  Return Value: 0 on success, -1 if the file is empty or a variant
+ *                disagrees
+ */
+int benchmark(string inputFile);
+
+#endif // BENCHMARK_HPP
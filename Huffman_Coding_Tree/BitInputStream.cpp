@@ -12,21 +12,57 @@
   *  Description: Initializes a bit input stream using istream is
   */
 BitInputStream::BitInputStream(std::istream& is) :in(is) {
-	/** Initialize empty buffer */
-	buf = 0;
-	/** Denote that the buffer needs to be filled */
-	nbits = 8;
+	/** Initialize empty window */
+	window = 0;
+	/** Denote that the window needs to be filled */
+	windowBits = 0;
+	/** Nothing has been consumed yet */
+	bitsRead = 0;
 }
 
 /** Function Name: fill()
- *  Description: Fill the buffer from the input
+ *  Description: Top up the lookahead window from the input a byte at a time.
+ *               Bytes past the end of the input read as 0.
  *  Return Value: None
  */
 void BitInputStream::fill() {
-	/** Fill buffer from input */
-	buf = in.get();
-	/** Set number of bits already read to 0 */
-	nbits = 0;
+	/** Append whole bytes below the valid bits until the window is full */
+	while (windowBits <= WINDOW_SIZE - BUF_SIZE) {
+		int next = in.get();
+		/** Pad with zeros once the input runs out */
+		if (next == EOF) {
+			next = 0;
+		}
+		window |= (unsigned long long)(byte)next
+			<< (WINDOW_SIZE - BUF_SIZE - windowBits);
+		windowBits += BUF_SIZE;
+	}
+}
+
+/** Function Name: peekBits(int n)
+ *  Description: Returns the next n bits without consuming them. The first bit
+ *               in the stream is the most significant bit of the returned
+ *               value.
+ *  Parameters: n - The number of bits to look at (1 to MAX_PEEK_BITS)
+ *  Return Value: The next n bits of the stream
+ */
+unsigned int BitInputStream::peekBits(int n) {
+	/** Fill the window if it does not hold n bits */
+	if (windowBits < n) {
+		fill();
+	}
+	return (unsigned int)(window >> (WINDOW_SIZE - n));
+}
+
+/** Function Name: skipBits(int n)
+ *  Description: Consumes n bits that were looked at with peekBits()
+ *  Parameters: n - The number of bits to consume
+ *  Return Value: None
+ */
+void BitInputStream::skipBits(int n) {
+	window <<= n;
+	windowBits -= n;
+	bitsRead += n;
 }
 
 /** Function Name: readBits()
@@ -36,20 +72,10 @@ void BitInputStream::fill() {
  *                0
  */
 int BitInputStream::readBits() {
-	/* Fill the buffer if all bits in the buffer are read */
-	if (nbits == BUF_SIZE) {
-		fill();
-	}
-	if (buf & (1 << (7 - nbits))) {
-		/** Increment the index */
-		nbits++;
-		return 1;
-	}
-	else {
-		/** Increment the index */
-		nbits++;
-		return 0;
-	}
+	/** Look at the next bit and consume it */
+	int bit = (int)peekBits(1);
+	skipBits(1);
+	return bit;
 }
 
 /** Function Name: readByte()
@@ -104,6 +130,29 @@ int BitInputStream::readInt(int bitFreqs) {
 	}
 	return ret;
 }
+
+/** Function Name: alignToByte()
+ *  Description: Skips the padding bits left in the current byte so the next
+ *               read starts on a byte boundary
+ *  Return Value: None
+ */
+void BitInputStream::alignToByte() {
+	int padding = (int)((BUF_SIZE - bitsRead % BUF_SIZE) % BUF_SIZE);
+	if (padding != 0) {
+		peekBits(padding);
+		skipBits(padding);
+	}
+}
+
+/** Function Name: getnbits()
+ *  Description: Getter method for how many bits of the current byte have
+ *               been read
+ *  Return Value: Number of bits read from the current byte (1 to 8)
+ */
 int BitInputStream::getnbits() {
-	return nbits;
+	/** A fresh stream reports a fully read byte, same as an empty buffer */
+	if (bitsRead == 0) {
+		return BUF_SIZE;
+	}
+	return (int)((bitsRead - 1) % BUF_SIZE) + 1;
 }
\ No newline at end of file
@@ -11,13 +11,17 @@
 
 #define BUF_SIZE 8 /** Size of bit buffer in terms of bits */
 
+#define WINDOW_SIZE 64 /** Size of the lookahead window in terms of bits */
+#define MAX_PEEK_BITS 32 /** Max number of bits peekBits() can return */
+
 #include <iostream>
 #include "HCNode.hpp"
 
 class BitInputStream {
 private:
-	char buf; /** One byte buffer of bits */
-	int nbits; /** How many bits have been read from buf */
+	unsigned long long window; /** Lookahead bits, next bit in the MSB */
+	int windowBits; /** How many valid bits are left in window */
+	unsigned long long bitsRead; /** How many bits have been consumed */
 	std::istream& in; /** The input stream to use */
 public:
 	/** Constructor
@@ -26,11 +30,30 @@ public:
 	BitInputStream(std::istream& is);
 
 	/** Function Name: fill()
-	 *  Description: Fill the buffer from the input
+	 *  Description: Top up the lookahead window from the input a byte at
+	 *               a time. Bytes past the end of the input read as 0.
 	 *  Return Value: None
 	 */
 	void fill();
 
+	/** Function Name: peekBits(int n)
+	 *  Description: Returns the next n bits without consuming them. The
+	 *               first bit in the stream is the most significant bit
+	 *               of the returned value, which is the order HCTree
+	 *               writes its codes in.
+	 *  Parameters: n - The number of bits to look at (1 to MAX_PEEK_BITS)
+	 *  Return Value: The next n bits of the stream
+	 */
+	unsigned int peekBits(int n);
+
+	/** Function Name: skipBits(int n)
+	 *  Description: Consumes n bits that were looked at with peekBits()
+	 *  Parameters: n - The number of bits to consume (at most the n
+	 *                  passed to the last peekBits())
+	 *  Return Value: None
+	 */
+	void skipBits(int n);
+
 	/** Function Name: readBits()
 	 *  Description: Read the next bit from the bit buffer
 	 *               Fills the buffer from the input stream first if
@@ -55,6 +78,18 @@ public:
 	 */
 	int readInt(int bitFreqs);
 
+	/** Function Name: alignToByte()
+	 *  Description: Skips the padding bits left in the current byte so
+	 *               the next read starts on a byte boundary
+	 *  Return Value: None
+	 */
+	void alignToByte();
+
+	/** Function Name: getnbits()
+	 *  Description: Getter method for how many bits of the current byte
+	 *               have been read
+	 *  Return Value: Number of bits read from the current byte (1 to 8)
+	 */
 	int getnbits();
 };
 #endif // BITINPUTSTREAM_HPP
@@ -0,0 +1,815 @@
+/** Filename: BitKernels.cpp
+ *  Name: Loc Chuong
+ *  Description: Bulk encode and decode loops for HCTree codes over byte
+ *               buffers, compiled in a scalar, a 64 bit word and a BMI2
+ *               variant. The variant is picked once from CPUID.
+ *  Date: 10/18/2026
+ */
+
+#include "BitKernels.hpp"
+#include "CpuFeatures.hpp"
+#include "HCTree.hpp"
+#include <cstring>
+
+#if HC_X64
+#include <immintrin.h>
+#endif
+
+#if defined(_MSC_VER)
+#define HC_INLINE __forceinline
+#else
+#define HC_INLINE inline __attribute__((always_inline))
+#endif
+
+#define ENCODE_FLUSH_BITS 32 /** The encoder stores 32 bits at a time */
+#define REFILL_BITS 32 /** The decoder refills below this many bits */
+#define SIMD_MAX_CODE_LENGTH 28 /** Two codes plus 7 bits fit in a word */
+#define SIMD_MIN_SYMBOLS 1024 /** Below this the table setup outweighs SIMD */
+#define SIMD_SLACK_BYTES 8 /** SIMD encoders store whole words at the end */
+
+/** Function Name: shiftLeft<BMI2>(unsigned long long x, unsigned int n)
+ *  Description: x << n. GCC and Clang emit shlx on their own inside a BMI2
+ *               function; MSVC is asked for it explicitly.
+ *  Return Value: x shifted left by n
+ */
+template <bool BMI2>
+HC_INLINE unsigned long long shiftLeft(unsigned long long x, unsigned int n) {
+#if HC_X64 && defined(_MSC_VER)
+	if (BMI2) return _shlx_u64(x, n);
+#endif
+	return x << n;
+}
+
+/** Function Name: shiftRight<BMI2>(unsigned long long x, unsigned int n)
+ *  Description: x >> n, as shrx in the BMI2 variant
+ *  Return Value: x shifted right by n
+ */
+template <bool BMI2>
+HC_INLINE unsigned long long shiftRight(unsigned long long x, unsigned int n) {
+#if HC_X64 && defined(_MSC_VER)
+	if (BMI2) return _shrx_u64(x, n);
+#endif
+	return x >> n;
+}
+
+/** Function Name: lowBits<BMI2>(unsigned long long x, unsigned int n)
+ *  Description: The low n bits of x, as bzhi in the BMI2 variant
+ *  PRECONDITION: n < 64
+ *  Return Value: x with every bit from n up cleared
+ */
+template <bool BMI2>
+HC_INLINE unsigned long long lowBits(unsigned long long x, unsigned int n) {
+#if HC_X64 && defined(_MSC_VER)
+	if (BMI2) return _bzhi_u64(x, n);
+#endif
+	return x & ((1ULL << n) - 1);
+}
+
+/** Function Name: loadBigEndian64(const byte* in)
+ *  Description: Reads 8 bytes so that in[0] lands in the top byte
+ *  Return Value: The loaded word
+ */
+HC_INLINE unsigned long long loadBigEndian64(const byte* in) {
+	unsigned long long word;
+	memcpy(&word, in, sizeof(word));
+#if defined(_MSC_VER)
+	return _byteswap_uint64(word);
+#else
+	return __builtin_bswap64(word);
+#endif
+}
+
+/** Function Name: storeBigEndian32(byte* out, unsigned int value)
+ *  Description: Writes value with its top byte first
+ *  Return Value: None
+ */
+HC_INLINE void storeBigEndian32(byte* out, unsigned int value) {
+#if defined(_MSC_VER)
+	value = _byteswap_ulong(value);
+#else
+	value = __builtin_bswap32(value);
+#endif
+	memcpy(out, &value, sizeof(value));
+}
+
+/** Struct Name: TableLookup<Symbol>
+ *  Description: Looks the code of every symbol of data up in one tree's
+ *               tables, for encodeCodes()
+ */
+template <typename Symbol>
+struct TableLookup {
+	const Symbol* data; /** The symbols to code */
+	const unsigned long long* codes; /** Code of every symbol */
+	const byte* lengths; /** Length of every code */
+
+	/** operator()(size_t i, unsigned long long& code, unsigned int& length)
+	 *  Description: Sets code and length to those of data[i]
+	 */
+	HC_INLINE void operator()(size_t i, unsigned long long& code,
+		unsigned int& length) const {
+		code = codes[data[i]];
+		length = lengths[data[i]];
+	}
+};
+
+/** Struct Name: ContextLookup
+ *  Description: Looks the code of every byte of data up in the tables of
+ *               the byte before it, for encodeCodes()
+ */
+struct ContextLookup {
+	const byte* data; /** The bytes to code */
+	const unsigned long long* const* codes; /** Code table per context */
+	const byte* const* lengths; /** Length table per context */
+	byte prev; /** The byte before the next one, 0 at the start */
+
+	/** operator()(size_t i, unsigned long long& code, unsigned int& length)
+	 *  Description: Sets code and length to those of data[i] after prev
+	 *  PRECONDITION: Called for i = 0, 1, 2 ... in order
+	 */
+	HC_INLINE void operator()(size_t i, unsigned long long& code,
+		unsigned int& length) {
+		byte symbol = data[i];
+		code = codes[prev][symbol];
+		length = lengths[prev][symbol];
+		prev = symbol;
+	}
+};
+
+/** Function Name: encodeCodes<WORD, BMI2, Lookup>(Lookup& lookup,
+ *                                                 size_t size, byte* out)
+ *  Description: Shared body of every encoder. lookup(i, code, length) gives
+ *               the code of the i-th symbol. Codes collect in a 64 bit
+ *               accumulator and leave it 32 bits at a time, either as one
+ *               word store (WORD) or as four byte stores.
+ *  Return Value: The number of code bits written, without padding
+ */
+template <bool WORD, bool BMI2, typename Lookup>
+HC_INLINE size_t encodeCodes(Lookup& lookup, size_t size, byte* out) {
+	/** Pending bits sit in the low accBits bits of acc */
+	unsigned long long acc = 0;
+	unsigned int accBits = 0;
+	size_t totalBits = 0;
+	for (size_t i = 0; i < size; i++) {
+		unsigned long long code;
+		unsigned int length;
+		lookup(i, code, length);
+		totalBits += length;
+		/** Codes over 32 bits go in as two halves so acc never overflows */
+		if (length > ENCODE_FLUSH_BITS) {
+			unsigned int high = length - ENCODE_FLUSH_BITS;
+			acc = shiftLeft<BMI2>(acc, high)
+				| shiftRight<BMI2>(code, ENCODE_FLUSH_BITS);
+			accBits += high;
+			if (accBits >= ENCODE_FLUSH_BITS) {
+				accBits -= ENCODE_FLUSH_BITS;
+				unsigned int word = (unsigned int)shiftRight<BMI2>(acc, accBits);
+				if (WORD) {
+					storeBigEndian32(out, word);
+				}
+				else {
+					out[0] = (byte)(word >> 24);
+					out[1] = (byte)(word >> 16);
+					out[2] = (byte)(word >> 8);
+					out[3] = (byte)word;
+				}
+				out += 4;
+			}
+			code = lowBits<BMI2>(code, ENCODE_FLUSH_BITS);
+			length = ENCODE_FLUSH_BITS;
+		}
+		acc = shiftLeft<BMI2>(acc, length) | code;
+		accBits += length;
+		if (accBits >= ENCODE_FLUSH_BITS) {
+			accBits -= ENCODE_FLUSH_BITS;
+			unsigned int word = (unsigned int)shiftRight<BMI2>(acc, accBits);
+			if (WORD) {
+				storeBigEndian32(out, word);
+			}
+			else {
+				out[0] = (byte)(word >> 24);
+				out[1] = (byte)(word >> 16);
+				out[2] = (byte)(word >> 8);
+				out[3] = (byte)word;
+			}
+			out += 4;
+		}
+	}
+	/** Write what is left, padded with 0 bits to a whole byte */
+	while (accBits > 0) {
+		if (accBits >= BUFFER_SIZE) {
+			accBits -= BUFFER_SIZE;
+			*out++ = (byte)shiftRight<BMI2>(acc, accBits);
+		}
+		else {
+			*out++ = (byte)shiftLeft<BMI2>(acc, BUFFER_SIZE - accBits);
+			accBits = 0;
+		}
+	}
+	return totalBits;
+}
+
+/** Function Name: encodeLoop<WORD, BMI2>(const HCTree& tree,
+ *                                        const byte* data, size_t size,
+ *                                        byte* out)
+ *  Description: Shared body of the encode variants, encodeCodes() over the
+ *               tables of tree
+ *  Return Value: The number of code bits written, without padding
+ */
+template <bool WORD, bool BMI2>
+HC_INLINE size_t encodeLoop(const HCTree& tree, const byte* data,
+	size_t size, byte* out) {
+	TableLookup<byte> lookup = { data, tree.getCodeTable().data(),
+		tree.getCodeLengthTable().data() };
+	return encodeCodes<WORD, BMI2>(lookup, size, out);
+}
+
+/** Struct Name: BitReader
+ *  Description: State of the decode loops' bit reader. The next bits sit
+ *               at the top of buf; bytes past the end of in read as 0.
+ */
+struct BitReader {
+	const byte* in; /** The coded bytes */
+	size_t inSize; /** Number of bytes in in */
+	size_t pos; /** Bytes pulled into buf so far, including the padding */
+	unsigned long long buf; /** Lookahead bits, next bit in the MSB */
+	unsigned int bits; /** How many bits of buf are valid */
+};
+
+/** Function Name: refill<WORD, BMI2>(BitReader& reader)
+ *  Description: Tops buf up to at least 56 bits, a 64 bit word at a time
+ *               (WORD) while 8 bytes are left, else a byte at a time
+ *  Return Value: None
+ */
+template <bool WORD, bool BMI2>
+HC_INLINE void refill(BitReader& reader) {
+	if (WORD && reader.pos + 8 <= reader.inSize) {
+		/** Load 8 bytes, count the whole ones that fit */
+		reader.buf |= shiftRight<BMI2>(loadBigEndian64(reader.in + reader.pos),
+			reader.bits);
+		reader.pos += (63 - reader.bits) >> 3;
+		reader.bits |= 56;
+		return;
+	}
+	while (reader.bits <= 56) {
+		byte next = (reader.pos < reader.inSize) ? reader.in[reader.pos] : 0;
+		reader.pos++;
+		reader.buf |= shiftLeft<BMI2>((unsigned long long)next,
+			56 - reader.bits);
+		reader.bits += BUFFER_SIZE;
+	}
+}
+
+/** Function Name: decodeOne<BMI2>(BitReader& reader,
+ *                                 const DecodeEntry* table, HCNode* root)
+ *  Description: Decodes one symbol with the single-symbol table, walking
+ *               the tree for codes longer than the table
+ *  PRECONDITION: reader holds at least DECODE_TABLE_BITS bits
+ *  Return Value: The decoded symbol, a byte unless the tree's alphabet is
+ *                wider
+ */
+template <bool BMI2>
+HC_INLINE unsigned short decodeOne(BitReader& reader,
+	const DecodeEntry* table, HCNode* root) {
+	const DecodeEntry& entry =
+		table[shiftRight<BMI2>(reader.buf, 64 - DECODE_TABLE_BITS)];
+	if (entry.length != 0) {
+		reader.buf = shiftLeft<BMI2>(reader.buf, entry.length);
+		reader.bits -= entry.length;
+		return entry.symbol;
+	}
+	/** Code is longer than the table, walk the tree bit by bit */
+	HCNode* currNode = root;
+	while (currNode->c0 != nullptr) {
+		if (reader.bits == 0) {
+			byte next = (reader.pos < reader.inSize) ? reader.in[reader.pos] : 0;
+			reader.pos++;
+			reader.buf = (unsigned long long)next << 56;
+			reader.bits = BUFFER_SIZE;
+		}
+		currNode = (reader.buf >> 63) ? currNode->c1 : currNode->c0;
+		reader.buf <<= 1;
+		reader.bits--;
+	}
+	return currNode->symbol;
+}
+
+/** Function Name: decodeLoop<WORD, MULTI, BMI2>(const HCTree& tree,
+ *                                               const byte* in,
+ *                                               size_t inSize, byte* out,
+ *                                               size_t count)
+ *  Description: Shared body of the decode variants. Looks the next bits up
+ *               DECODE_TABLE_BITS at a time, or, with MULTI, first tries the
+ *               multi-symbol table and emits every code it holds at once.
+ *  Return Value: False if the codes run past the end of in
+ */
+template <bool WORD, bool MULTI, bool BMI2>
+HC_INLINE bool decodeLoop(const HCTree& tree, const byte* in, size_t inSize,
+	byte* out, size_t count) {
+	HCNode* root = tree.getRoot();
+	if (root == nullptr) {
+		return count == 0;
+	}
+	/** A lone leaf is coded in 0 bits, see HCTree::decode() */
+	if (root->c0 == nullptr && root->c1 == nullptr) {
+		memset(out, root->symbol, count);
+		return true;
+	}
+	const DecodeEntry* table = tree.getDecodeTable().data();
+	const MultiDecodeEntry* multi = MULTI ? tree.getMultiDecodeTable() : nullptr;
+	BitReader reader = { in, inSize, 0, 0, 0 };
+	size_t i = 0;
+	if (MULTI && multi != nullptr) {
+		/** Stop short of the end so a whole entry can always be stored */
+		while (i + MULTI_DECODE_SYMBOLS <= count) {
+			if (reader.bits < REFILL_BITS) {
+				refill<WORD, BMI2>(reader);
+			}
+			const MultiDecodeEntry& entry =
+				multi[shiftRight<BMI2>(reader.buf, 64 - MULTI_DECODE_BITS)];
+			if (entry.count != 0) {
+				memcpy(out + i, entry.symbols, MULTI_DECODE_SYMBOLS);
+				i += entry.count;
+				reader.buf = shiftLeft<BMI2>(reader.buf, entry.length);
+				reader.bits -= entry.length;
+				continue;
+			}
+			out[i++] = decodeOne<BMI2>(reader, table, root);
+		}
+	}
+	for (; i < count; i++) {
+		if (reader.bits < REFILL_BITS) {
+			refill<WORD, BMI2>(reader);
+		}
+		out[i] = decodeOne<BMI2>(reader, table, root);
+	}
+	/** Every bit consumed has to come from in, not the padding */
+	return reader.pos * BUFFER_SIZE - reader.bits <= inSize * BUFFER_SIZE;
+}
+
+/** Function Name: encodeScalar(const HCTree& tree, const byte* data,
+ *                              size_t size, byte* out)
+ *  Description: Portable encode variant, stores a byte at a time
+ *  Return Value: The number of code bits written
+ */
+static size_t encodeScalar(const HCTree& tree, const byte* data, size_t size,
+	byte* out) {
+	return encodeLoop<false, false>(tree, data, size, out);
+}
+
+/** Function Name: decodeScalar(const HCTree& tree, const byte* in,
+ *                              size_t inSize, byte* out, size_t count)
+ *  Description: Portable decode variant, refills a byte at a time
+ *  Return Value: False if the codes run past the end of in
+ */
+static bool decodeScalar(const HCTree& tree, const byte* in, size_t inSize,
+	byte* out, size_t count) {
+	return decodeLoop<false, false, false>(tree, in, inSize, out, count);
+}
+
+/** Function Name: decodeMultiScalar(const HCTree& tree, const byte* in,
+ *                                   size_t inSize, byte* out, size_t count)
+ *  Description: Portable multi-symbol decode variant
+ *  Return Value: False if the codes run past the end of in
+ */
+static bool decodeMultiScalar(const HCTree& tree, const byte* in,
+	size_t inSize, byte* out, size_t count) {
+	return decodeLoop<false, true, false>(tree, in, inSize, out, count);
+}
+
+/** Function Name: encodeWord(const HCTree& tree, const byte* data,
+ *                            size_t size, byte* out)
+ *  Description: Baseline encode variant, stores 32 bit words
+ *  Return Value: The number of code bits written
+ */
+static size_t encodeWord(const HCTree& tree, const byte* data, size_t size,
+	byte* out) {
+	return encodeLoop<true, false>(tree, data, size, out);
+}
+
+/** Function Name: decodeWord(const HCTree& tree, const byte* in,
+ *                            size_t inSize, byte* out, size_t count)
+ *  Description: Baseline decode variant, refills 64 bit words
+ *  Return Value: False if the codes run past the end of in
+ */
+static bool decodeWord(const HCTree& tree, const byte* in, size_t inSize,
+	byte* out, size_t count) {
+	return decodeLoop<true, false, false>(tree, in, inSize, out, count);
+}
+
+/** Function Name: decodeMultiWord(const HCTree& tree, const byte* in,
+ *                                 size_t inSize, byte* out, size_t count)
+ *  Description: Baseline multi-symbol decode variant
+ *  Return Value: False if the codes run past the end of in
+ */
+static bool decodeMultiWord(const HCTree& tree, const byte* in,
+	size_t inSize, byte* out, size_t count) {
+	return decodeLoop<true, true, false>(tree, in, inSize, out, count);
+}
+
+#if HC_X64
+/** Function Name: encodeBmi2(const HCTree& tree, const byte* data,
+ *                            size_t size, byte* out)
+ *  Description: Word encode variant compiled for BMI2
+ *  Return Value: The number of code bits written
+ */
+HC_TARGET("bmi2")
+static size_t encodeBmi2(const HCTree& tree, const byte* data, size_t size,
+	byte* out) {
+	return encodeLoop<true, true>(tree, data, size, out);
+}
+
+/** Function Name: decodeBmi2(const HCTree& tree, const byte* in,
+ *                            size_t inSize, byte* out, size_t count)
+ *  Description: Word decode variant compiled for BMI2
+ *  Return Value: False if the codes run past the end of in
+ */
+HC_TARGET("bmi2")
+static bool decodeBmi2(const HCTree& tree, const byte* in, size_t inSize,
+	byte* out, size_t count) {
+	return decodeLoop<true, false, true>(tree, in, inSize, out, count);
+}
+
+/** Function Name: decodeMultiBmi2(const HCTree& tree, const byte* in,
+ *                                 size_t inSize, byte* out, size_t count)
+ *  Description: Multi-symbol decode variant compiled for BMI2
+ *  Return Value: False if the codes run past the end of in
+ */
+HC_TARGET("bmi2")
+static bool decodeMultiBmi2(const HCTree& tree, const byte* in,
+	size_t inSize, byte* out, size_t count) {
+	return decodeLoop<true, true, true>(tree, in, inSize, out, count);
+}
+#endif
+
+#if HC_X64
+/** Struct Name: PairWriter
+ *  Description: Bit writer for the SIMD encoders. Pending bits sit at the
+ *               top of acc and leave it as a whole 64 bit store, so a pair
+ *               of codes of up to 56 bits goes in with one shift and one OR.
+ *               Runs are placed by the running accBits rather than by a
+ *               prefix sum of their lengths: the sum would still carry
+ *               from one step to the next, and runs that share a byte
+ *               would each need a load, OR and store into out.
+ */
+struct PairWriter {
+	byte* out; /** Where the next store lands */
+	unsigned long long acc; /** Pending bits, first bit in the top bit */
+	unsigned int accBits; /** Number of pending bits */
+};
+
+/** Function Name: storeBits(PairWriter& writer)
+ *  Description: Stores the pending bits, partial last byte included, and
+ *               moves past every whole byte of them
+ *  Return Value: None
+ */
+HC_INLINE void storeBits(PairWriter& writer) {
+	unsigned long long word = writer.acc;
+#if defined(_MSC_VER)
+	word = _byteswap_uint64(word);
+#else
+	word = __builtin_bswap64(word);
+#endif
+	memcpy(writer.out, &word, sizeof(word));
+	unsigned int whole = writer.accBits & ~7u;
+	writer.out += whole >> 3;
+	writer.acc <<= whole;
+	writer.accBits -= whole;
+}
+
+/** Function Name: putBits(PairWriter& writer, unsigned long long code,
+ *                         unsigned int length)
+ *  Description: Stores every whole pending byte, then appends the low
+ *               length bits of code
+ *  PRECONDITION: 0 < length <= 56, so the shift below stays under 64
+ *  Return Value: None
+ */
+HC_INLINE void putBits(PairWriter& writer, unsigned long long code,
+	unsigned int length) {
+	storeBits(writer);
+	writer.acc |= code << (64 - writer.accBits - length);
+	writer.accBits += length;
+}
+
+/** Function Name: finishPairs(PairWriter& writer, const unsigned int* codes,
+ *                             const unsigned int* lengths, const byte* data,
+ *                             size_t size)
+ *  Description: Scalar finish for the SIMD encoders. Appends the codes of
+ *               the last few symbols and stores what is still pending.
+ *  Return Value: None
+ */
+static void finishPairs(PairWriter& writer, const unsigned int* codes,
+	const unsigned int* lengths, const byte* data, size_t size) {
+	for (size_t i = 0; i < size; i++) {
+		putBits(writer, codes[data[i]], lengths[data[i]]);
+	}
+	storeBits(writer);
+}
+
+/** Function Name: encodeSse4(const HCTree& tree, const byte* data,
+ *                            size_t size, byte* out)
+ *  Description: Encodes 4 symbols per step. The codes, lengths and powers
+ *               of two of the lengths are loaded into vectors, and every
+ *               even code is multiplied up in front of the odd code after
+ *               it, so the bit writer only sees 2 codes per step.
+ *  Return Value: The number of code bits written
+ */
+HC_TARGET("sse4.1")
+static size_t encodeSse4(const HCTree& tree, const byte* data, size_t size,
+	byte* out) {
+	if (tree.getMaxCodeLength() > SIMD_MAX_CODE_LENGTH
+		|| size < SIMD_MIN_SYMBOLS) {
+		return encodeLoop<true, false>(tree, data, size, out);
+	}
+	unsigned int codes[ASCII_MAX];
+	unsigned int lengths[ASCII_MAX];
+	unsigned int scales[ASCII_MAX];
+	size_t totalBits = 0;
+	for (int s = 0; s < ASCII_MAX; s++) {
+		codes[s] = (unsigned int)tree.getCodeTable()[s];
+		lengths[s] = tree.getCodeLengthTable()[s];
+		scales[s] = 1u << lengths[s];
+	}
+	PairWriter writer = { out, 0, 0 };
+	const __m128i low32 = _mm_set1_epi64x(0xFFFFFFFFLL);
+	size_t i = 0;
+	for (; i + 4 <= size; i += 4) {
+		/** SSE has no gather, so the 4 table reads are inserted one by one */
+		__m128i code = _mm_cvtsi32_si128((int)codes[data[i]]);
+		code = _mm_insert_epi32(code, (int)codes[data[i + 1]], 1);
+		code = _mm_insert_epi32(code, (int)codes[data[i + 2]], 2);
+		code = _mm_insert_epi32(code, (int)codes[data[i + 3]], 3);
+		__m128i length = _mm_cvtsi32_si128((int)lengths[data[i]]);
+		length = _mm_insert_epi32(length, (int)lengths[data[i + 1]], 1);
+		length = _mm_insert_epi32(length, (int)lengths[data[i + 2]], 2);
+		length = _mm_insert_epi32(length, (int)lengths[data[i + 3]], 3);
+		__m128i oddScale = _mm_cvtsi32_si128((int)scales[data[i + 1]]);
+		oddScale = _mm_insert_epi32(oddScale, (int)scales[data[i + 3]], 2);
+		/** SSE has no per lane shift, multiplying by 2^length is one */
+		__m128i pairCode = _mm_or_si128(_mm_mul_epu32(code, oddScale),
+			_mm_srli_epi64(code, 32));
+		__m128i pairLength = _mm_add_epi64(_mm_and_si128(length, low32),
+			_mm_srli_epi64(length, 32));
+		unsigned int length0 = (unsigned int)_mm_cvtsi128_si32(pairLength);
+		unsigned int length1 = (unsigned int)_mm_extract_epi32(pairLength, 2);
+		putBits(writer, (unsigned long long)_mm_cvtsi128_si64(pairCode),
+			length0);
+		putBits(writer, (unsigned long long)_mm_extract_epi64(pairCode, 1),
+			length1);
+		totalBits += length0 + length1;
+	}
+	for (size_t j = i; j < size; j++) {
+		totalBits += lengths[data[j]];
+	}
+	finishPairs(writer, codes, lengths, data + i, size - i);
+	return totalBits;
+}
+
+/** Function Name: encodeAvx2(const HCTree& tree, const byte* data,
+ *                            size_t size, byte* out)
+ *  Description: Encodes 8 symbols per step. The codes and lengths are
+ *               loaded as 64 bit entries, every even code is shifted in front of
+ *               the odd code after it, and the 4 pairs of at most 56 bits
+ *               go to the bit writer. When every code is short enough the
+ *               pairs are merged again, so the writer sees 2 runs.
+ *  Return Value: The number of code bits written
+ */
+HC_TARGET("avx2,bmi2")
+static size_t encodeAvx2(const HCTree& tree, const byte* data, size_t size,
+	byte* out) {
+	if (tree.getMaxCodeLength() > SIMD_MAX_CODE_LENGTH
+		|| size < SIMD_MIN_SYMBOLS) {
+		return encodeLoop<true, true>(tree, data, size, out);
+	}
+	unsigned int codes[ASCII_MAX];
+	unsigned int lengths[ASCII_MAX];
+	/** Code in the low half, length in the high half, one load each */
+	long long entries[ASCII_MAX];
+	size_t totalBits = 0;
+	for (int s = 0; s < ASCII_MAX; s++) {
+		codes[s] = (unsigned int)tree.getCodeTable()[s];
+		lengths[s] = tree.getCodeLengthTable()[s];
+		entries[s] = (long long)codes[s] | ((long long)lengths[s] << 32);
+	}
+	PairWriter writer = { out, 0, 0 };
+	const __m256i low32 = _mm256_set1_epi64x(0xFFFFFFFFLL);
+	/** Four codes of up to 14 bits still fit in one putBits() */
+	bool quads = tree.getMaxCodeLength() * 4 <= SIMD_MAX_CODE_LENGTH * 2;
+	alignas(32) unsigned long long pairCodes[4];
+	alignas(32) unsigned long long pairLengths[4];
+	size_t i = 0;
+	for (; i + 8 <= size; i += 8) {
+		/** Even symbols in one vector, the odd ones after them in another.
+		 *  Plain loads beat the gather instruction on most cores.
+		 */
+		__m256i even = _mm256_setr_epi64x(entries[data[i]],
+			entries[data[i + 2]], entries[data[i + 4]], entries[data[i + 6]]);
+		__m256i odd = _mm256_setr_epi64x(entries[data[i + 1]],
+			entries[data[i + 3]], entries[data[i + 5]], entries[data[i + 7]]);
+		__m256i oddLength = _mm256_srli_epi64(odd, 32);
+		__m256i pairCode = _mm256_or_si256(
+			_mm256_sllv_epi64(_mm256_and_si256(even, low32), oddLength),
+			_mm256_and_si256(odd, low32));
+		__m256i pairLength = _mm256_add_epi64(_mm256_srli_epi64(even, 32),
+			oddLength);
+		if (quads) {
+			/** Short codes merge once more, into 2 runs of 4 codes */
+			__m256i nextCode = _mm256_shuffle_epi32(pairCode,
+				_MM_SHUFFLE(1, 0, 3, 2));
+			__m256i nextLength = _mm256_shuffle_epi32(pairLength,
+				_MM_SHUFFLE(1, 0, 3, 2));
+			__m256i quadCode = _mm256_or_si256(
+				_mm256_sllv_epi64(pairCode, nextLength), nextCode);
+			__m256i quadLength = _mm256_add_epi64(pairLength, nextLength);
+			unsigned int length0 =
+				(unsigned int)_mm256_extract_epi64(quadLength, 0);
+			unsigned int length1 =
+				(unsigned int)_mm256_extract_epi64(quadLength, 2);
+			putBits(writer,
+				(unsigned long long)_mm256_extract_epi64(quadCode, 0), length0);
+			putBits(writer,
+				(unsigned long long)_mm256_extract_epi64(quadCode, 2), length1);
+			totalBits += length0 + length1;
+			continue;
+		}
+		_mm256_store_si256((__m256i*)pairCodes, pairCode);
+		_mm256_store_si256((__m256i*)pairLengths, pairLength);
+		for (int k = 0; k < 4; k++) {
+			putBits(writer, pairCodes[k], (unsigned int)pairLengths[k]);
+			totalBits += pairLengths[k];
+		}
+	}
+	for (size_t j = i; j < size; j++) {
+		totalBits += lengths[data[j]];
+	}
+	finishPairs(writer, codes, lengths, data + i, size - i);
+	return totalBits;
+}
+#endif
+
+static const BitKernels scalarKernels = { "scalar", encodeScalar,
+	decodeScalar, decodeMultiScalar };
+static const BitKernels wordKernels = { "word64", encodeWord,
+	decodeWord, decodeMultiWord };
+#if HC_X64
+static const BitKernels bmi2Kernels = { "bmi2", encodeBmi2,
+	decodeBmi2, decodeMultiBmi2 };
+static const BitKernels sse4Kernels = { "sse4", encodeSse4,
+	decodeWord, decodeMultiWord };
+static const BitKernels avx2Kernels = { "avx2", encodeAvx2,
+	decodeBmi2, decodeMultiBmi2 };
+#endif
+
+/** Function Name: availableBitKernels()
+ *  Description: Every variant this host can run, slowest first
+ *  Return Value: Pointers to the runnable variants
+ */
+vector<const BitKernels*> availableBitKernels() {
+	vector<const BitKernels*> kernels;
+	kernels.push_back(&scalarKernels);
+	kernels.push_back(&wordKernels);
+#if HC_X64
+	if (cpuFeatures().sse41) {
+		kernels.push_back(&sse4Kernels);
+	}
+	if (cpuFeatures().bmi2) {
+		kernels.push_back(&bmi2Kernels);
+	}
+	if (cpuFeatures().avx2 && cpuFeatures().bmi2) {
+		kernels.push_back(&avx2Kernels);
+	}
+#endif
+	return kernels;
+}
+
+/** Function Name: bitKernels()
+ *  Description: The fastest variant this host supports, picked once
+ *  Return Value: The selected kernels
+ */
+const BitKernels& bitKernels() {
+	static const BitKernels* selected = availableBitKernels().back();
+	return *selected;
+}
+
+/** Function Name: encodeBound(const HCTree& tree, size_t size)
+ *  Description: Size of the output buffer encode needs for size symbols
+ *  Return Value: The number of bytes to reserve
+ */
+size_t encodeBound(const HCTree& tree, size_t size) {
+	/** The SIMD encoders store whole words, up to 8 bytes past the end */
+	return (size * tree.getMaxCodeLength() + 7) / 8 + SIMD_SLACK_BYTES;
+}
+
+/** Function Name: encodeContext(const HCTree* const* trees, const byte* data,
+ *                               size_t size, byte* out)
+ *  Description: Writes the codes of data to out, coding every byte with
+ *               trees[previous byte], encodeCodes() with the code and
+ *               length tables switched per byte
+ *  Return Value: The number of code bits written, without padding
+ */
+size_t encodeContext(const HCTree* const* trees, const byte* data,
+	size_t size, byte* out) {
+	/** Flatten the tables once so the loop does two loads per byte */
+	const unsigned long long* codes[ASCII_MAX];
+	const byte* lengths[ASCII_MAX];
+	static const byte noLengths[ASCII_MAX] = { 0 };
+	for (int c = 0; c < ASCII_MAX; c++) {
+		if (trees[c] == nullptr) {
+			codes[c] = nullptr;
+			lengths[c] = nullptr;
+			continue;
+		}
+		HCNode* root = trees[c]->getRoot();
+		bool lone = root != nullptr && root->c0 == nullptr;
+		codes[c] = trees[c]->getCodeTable().data();
+		lengths[c] = lone ? noLengths : trees[c]->getCodeLengthTable().data();
+	}
+	ContextLookup lookup = { data, codes, lengths, 0 };
+	return encodeCodes<true, false>(lookup, size, out);
+}
+
+/** Function Name: decodeContext(const HCTree* const* trees, const byte* in,
+ *                               size_t inSize, byte* out, size_t count)
+ *  Description: Decodes count symbols written by encodeContext(), looking
+ *               every code up in the table of the byte before it
+ *  Return Value: False if the codes run past the end of in, or a context
+ *                has no table
+ */
+bool decodeContext(const HCTree* const* trees, const byte* in, size_t inSize,
+	byte* out, size_t count) {
+	const DecodeEntry* tables[ASCII_MAX];
+	HCNode* roots[ASCII_MAX];
+	for (int c = 0; c < ASCII_MAX; c++) {
+		roots[c] = trees[c] != nullptr ? trees[c]->getRoot() : nullptr;
+		tables[c] = roots[c] != nullptr ?
+			trees[c]->getDecodeTable().data() : nullptr;
+	}
+	BitReader reader = { in, inSize, 0, 0, 0 };
+	byte prev = 0;
+	for (size_t i = 0; i < count; i++) {
+		HCNode* root = roots[prev];
+		if (root == nullptr) {
+			return false;
+		}
+		/** A lone leaf takes no bits */
+		if (root->c0 == nullptr) {
+			prev = out[i] = root->symbol;
+			continue;
+		}
+		if (reader.bits < REFILL_BITS) {
+			refill<true, false>(reader);
+		}
+		prev = out[i] = decodeOne<false>(reader, tables[prev], root);
+	}
+	/** Every bit consumed has to come from in, not the padding */
+	return reader.pos * BUFFER_SIZE - reader.bits <= inSize * BUFFER_SIZE;
+}
+
+/** Function Name: encodeSymbols(const HCTree& tree,
+ *                               const unsigned short* data, size_t size,
+ *                               byte* out)
+ *  Description: Writes the codes of data to out with encodeCodes() over
+ *               the tables of tree. A lone leaf is coded in 0 bits.
+ *  Return Value: The number of code bits written, without padding
+ */
+size_t encodeSymbols(const HCTree& tree, const unsigned short* data,
+	size_t size, byte* out) {
+	/** A lone leaf takes no bits */
+	HCNode* root = tree.getRoot();
+	if (root == nullptr || root->c0 == nullptr) {
+		return 0;
+	}
+	TableLookup<unsigned short> lookup = { data, tree.getCodeTable().data(),
+		tree.getCodeLengthTable().data() };
+	return encodeCodes<true, false>(lookup, size, out);
+}
+
+/** Function Name: decodeSymbols(const HCTree& tree, const byte* in,
+ *                               size_t inSize, unsigned short* out,
+ *                               size_t count)
+ *  Description: Decodes count symbols written by encodeSymbols()
+ *  Return Value: False if the codes run past the end of in
+ */
+bool decodeSymbols(const HCTree& tree, const byte* in, size_t inSize,
+	unsigned short* out, size_t count) {
+	HCNode* root = tree.getRoot();
+	if (root == nullptr) {
+		return count == 0;
+	}
+	/** A lone leaf takes no bits */
+	if (root->c0 == nullptr) {
+		for (size_t i = 0; i < count; i++) {
+			out[i] = root->symbol;
+		}
+		return true;
+	}
+	const DecodeEntry* table = tree.getDecodeTable().data();
+	BitReader reader = { in, inSize, 0, 0, 0 };
+	for (size_t i = 0; i < count; i++) {
+		if (reader.bits < REFILL_BITS) {
+			refill<true, false>(reader);
+		}
+		out[i] = decodeOne<false>(reader, table, root);
+	}
+	/** Every bit consumed has to come from in, not the padding */
+	return reader.pos * BUFFER_SIZE - reader.bits <= inSize * BUFFER_SIZE;
+}
@@ -0,0 +1,124 @@
+/** Filename: BitKernels.hpp
+ *  Name: Loc Chuong
+ *  Description: Bulk encode and decode loops for HCTree codes over byte
+ *               buffers. The loops carry their own bit writer and bit
+ *               reader and are compiled in several variants: a portable
+ *               scalar one that moves a byte at a time, one that moves
+ *               whole 64 bit words, and one that is additionally compiled
+ *               for BMI2 (bzhi, shlx, shrx). The best variant the host runs
+ *               is picked once, from CPUID, the first time it is needed.
+ *               On SSE4.1 and AVX2 hosts the encoder also comes in SIMD
+ *               variants that place many codes at once. Every variant
+ *               produces exactly the same bits.
+ *  Date: 10/18/2026
+ */
+
+#ifndef BITKERNELS_HPP
+#define BITKERNELS_HPP
+
+#include <cstddef>
+#include <vector>
+#include "HCNode.hpp"
+
+class HCTree;
+
+using namespace std;
+
+/** Struct Name: BitKernels
+ *  Description: One compiled variant of the bulk loops.
+ */
+struct BitKernels {
+	const char* name; /** Name shown in benchmark output */
+
+	/** Function Name: encode(const HCTree& tree, const byte* data,
+	 *                        size_t size, byte* out)
+	 *  Description: Writes the codes of data to out, first bit in the
+	 *               most significant bit of out[0], padded with 0 bits to
+	 *               a whole byte
+	 *  PRECONDITION: out holds at least encodeBound(tree, size) bytes
+	 *  Return Value: The number of code bits written, without padding
+	 */
+	size_t(*encode)(const HCTree& tree, const byte* data, size_t size,
+		byte* out);
+
+	/** Function Name: decode(const HCTree& tree, const byte* in,
+	 *                        size_t inSize, byte* out, size_t count)
+	 *  Description: Decodes count symbols from the inSize bytes at in
+	 *  Return Value: False if the codes run past the end of in
+	 */
+	bool(*decode)(const HCTree& tree, const byte* in, size_t inSize,
+		byte* out, size_t count);
+
+	/** Function Name: decodeMulti(const HCTree& tree, const byte* in,
+	 *                             size_t inSize, byte* out, size_t count)
+	 *  Description: Same as decode, but each lookup in the tree's
+	 *               multi-symbol table emits every whole code it holds.
+	 *               Falls back to decode when the tree has no such table.
+	 *  Return Value: False if the codes run past the end of in
+	 */
+	bool(*decodeMulti)(const HCTree& tree, const byte* in, size_t inSize,
+		byte* out, size_t count);
+};
+
+/** Function Name: bitKernels()
+ *  Description: The fastest variant this host supports, picked once
+ *  Return Value: The selected kernels
+ */
+const BitKernels& bitKernels();
+
+/** Function Name: availableBitKernels()
+ *  Description: Every variant this host can run, slowest first. Used by the
+ *               benchmark to compare them.
+ *  Return Value: Pointers to the runnable variants
+ */
+vector<const BitKernels*> availableBitKernels();
+
+/** Function Name: encodeBound(const HCTree& tree, size_t size)
+ *  Description: Size of the output buffer encode needs for size symbols
+ *  Return Value: The number of bytes to reserve
+ */
+size_t encodeBound(const HCTree& tree, size_t size);
+
+/** Function Name: encodeContext(const HCTree* const* trees, const byte* data,
+ *                               size_t size, byte* out)
+ *  Description: Writes the codes of data to out like BitKernels::encode,
+ *               but codes every byte with trees[previous byte], and the
+ *               first one with trees[0]. A tree with a lone leaf codes it
+ *               in 0 bits.
+ *  PRECONDITION: out holds at least (size * longest code + 7) / 8 bytes,
+ *                and trees[c] codes every byte that follows c in data
+ *  Return Value: The number of code bits written, without padding
+ */
+size_t encodeContext(const HCTree* const* trees, const byte* data,
+	size_t size, byte* out);
+
+/** Function Name: decodeContext(const HCTree* const* trees, const byte* in,
+ *                               size_t inSize, byte* out, size_t count)
+ *  Description: Decodes count symbols written by encodeContext()
+ *  Return Value: False if the codes run past the end of in
+ */
+bool decodeContext(const HCTree* const* trees, const byte* in, size_t inSize,
+	byte* out, size_t count);
+
+/** Function Name: encodeSymbols(const HCTree& tree,
+ *                               const unsigned short* data, size_t size,
+ *                               byte* out)
+ *  Description: Writes the codes of data to out like BitKernels::encode,
+ *               for trees whose alphabet is wider than a byte
+ *  PRECONDITION: out holds at least encodeBound(tree, size) bytes, and tree
+ *                codes every symbol of data
+ *  Return Value: The number of code bits written, without padding
+ */
+size_t encodeSymbols(const HCTree& tree, const unsigned short* data,
+	size_t size, byte* out);
+
+/** Function Name: decodeSymbols(const HCTree& tree, const byte* in,
+ *                               size_t inSize, unsigned short* out,
+ *                               size_t count)
+ *  Description: Decodes count symbols written by encodeSymbols()
+ *  Return Value: False if the codes run past the end of in
+ */
+bool decodeSymbols(const HCTree& tree, const byte* in, size_t inSize,
+	unsigned short* out, size_t count);
+
+#endif // BITKERNELS_HPP
@@ -20,10 +20,8 @@ BitOutputStream::BitOutputStream(std::ostream& os) :out(os), buf(0), nbits(0) {
  *  Return Value: None
  */
 void BitOutputStream::flush() {
-	/** Send buffer to the output */
+	/** Send buffer to the output, the ostream flushes itself on close */
 	out.put(buf);
-	/** Flush the ostream */
-	out.flush();
 	/** Clear the buffer */
 	buf = nbits = 0;
 }
@@ -117,6 +115,60 @@ void BitOutputStream::writeInt(int freq, int maxBitFreq) {
 	}
 }
 
+/** Function Name: writeBits(unsigned long long bits, int n)
+ *  Description: Write the low n bits of bits to buf, most significant bit
+ *               first, and flushes when buf is full.
+ *  Parameters: bits - Holds the bits to write in its low n bits
+ *              n - The number of bits to write
+ *  Return Value: None
+ */
+void BitOutputStream::writeBits(unsigned long long bits, int n) {
+	/** Move as many bits as fit in buf at once, most significant first */
+	while (n > 0) {
+		int take = BUFFER_SIZE - nbits;
+		if (take > n) {
+			take = n;
+		}
+		n -= take;
+		/** Unwritten bits of buf are always 0, so OR them in */
+		buf |= (char)(((bits >> n) & ((1u << take) - 1))
+			<< (BUFFER_SIZE - nbits - take));
+		nbits += take;
+		if (nbits == BUFFER_SIZE) {
+			flush();
+		}
+	}
+}
+
+/** Function Name: writeBitBuffer(const byte* data, size_t nbits)
+ *  Description: Write the first nbits bits of data, most significant bit of
+ *               data[0] first. Whole bytes go straight to the ostream when
+ *               buf is empty.
+ *  Parameters: data - Holds the bits to write
+ *              nbits - The number of bits to write
+ *  Return Value: None
+ */
+void BitOutputStream::writeBitBuffer(const byte* data, size_t nbits) {
+	size_t bytes = nbits / 8;
+	if (nbits == 0) {
+		return;
+	}
+	/** Byte aligned, so the whole bytes need no shifting */
+	if (this->nbits == 0) {
+		out.write((const char*)data, bytes);
+	}
+	else {
+		for (size_t i = 0; i < bytes; i++) {
+			writeBits(data[i], BUFFER_SIZE);
+		}
+	}
+	/** The bits of the last partial byte sit at its top */
+	int rest = (int)(nbits % 8);
+	if (rest != 0) {
+		writeBits(data[bytes] >> (BUFFER_SIZE - rest), rest);
+	}
+}
+
 /** Function Name: getnbits()
  *  Description: Getter method for nbits
  *  Return Value: The value of nbits
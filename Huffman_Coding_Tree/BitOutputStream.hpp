@@ -71,6 +71,26 @@ public:
 	 */
 	void writeInt(int freq, int maxBitFreq = BIT_INT);
 
+	/** Function Name: writeBits(unsigned long long bits, int n)
+	 *  Description: Write the low n bits of bits to buf, most significant
+	 *               bit first, and flushes when buf is full. This is the
+	 *               order HCTree codes are written in.
+	 *  Parameters: bits - Holds the bits to write in its low n bits
+	 *              n - The number of bits to write
+	 *  Return Value: None
+	 */
+	void writeBits(unsigned long long bits, int n);
+
+	/** Function Name: writeBitBuffer(const byte* data, size_t nbits)
+	 *  Description: Write the first nbits bits of data, most significant
+	 *               bit of data[0] first. Whole bytes go straight to the
+	 *               ostream when buf is empty.
+	 *  Parameters: data - Holds the bits to write
+	 *              nbits - The number of bits to write
+	 *  Return Value: None
+	 */
+	void writeBitBuffer(const byte* data, size_t nbits);
+
 	/** Function Name: getnbits()
 	 *  Description: Getter method for nbits
 	 *  Return Value: The value of nbits
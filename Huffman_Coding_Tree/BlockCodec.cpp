@@ -0,0 +1,513 @@
+/** Filename: BlockCodec.cpp
+ *  Name: Loc Chuong
+ *  Description: A block format for the Huffman Coding Tree. The input is cut
+ *               into blocks and every block picks the cheapest of a new
+ *               table, the previous block's table, or raw storage by
+ *               estimating its size from the block histogram.
+ *  Date: 10/18/2026
+ */
+
+#include "BlockCodec.hpp"
+#include "HCTableCache.hpp"
+#include "Crc32.hpp"
+#include "LittleEndian.hpp"
+#include "Trace.hpp"
+#include <cmath>
+#include <cstring>
+#include <sstream>
+#include <string>
+
+/** Function Name: padToByte(BitOutputStream& out)
+ *  Description: Writes 0 bits until out is at a byte boundary
+ *  Return Value: None
+ */
+static void padToByte(BitOutputStream& out) {
+	while (out.getnbits() != 0) {
+		out.writeBit(0);
+	}
+}
+
+/** Constructor
+ *  Description: Creates a BlockEncoder writing to os
+ */
+BlockEncoder::BlockEncoder(ostream& os, bool checksums) : out(os),
+	filteredCount(0), checksums(checksums) {
+	for (int i = 0; i < BLOCK_MODES; i++) {
+		modeCounts[i] = 0;
+	}
+}
+
+/** Function Name: estimateBits(const vector<int>& freqs, const HCTree& tree)
+ *  Description: Number of code bits tree would write for a block with
+ *               histogram freqs, from the code lengths alone
+ *  Parameters: freqs - Histogram of the block
+ *              tree - Candidate table
+ *  Return Value: The payload size in bits, or NO_ESTIMATE if freqs has a
+ *                byte tree has no code for
+ */
+unsigned long long BlockEncoder::estimateBits(const vector<int>& freqs,
+	const HCTree& tree) {
+	unsigned long long bits = 0;
+	for (int i = 0; i < ASCII_MAX; i++) {
+		if (freqs[i] == 0) {
+			continue;
+		}
+		int length = tree.getCodeLength((byte)i);
+		/** The table cannot code this byte */
+		if (length == 0) {
+			return NO_ESTIMATE;
+		}
+		bits += (unsigned long long)freqs[i] * length;
+	}
+	return bits;
+}
+
+/** Function Name: chooseMode(const byte* data, const vector<int>& freqs,
+ *                             size_t size,
+ *                             shared_ptr<const HCTree>& newTree)
+ *  Description: Picks the mode with the smallest estimated body. A new
+ *               table is only built when the entropy of the block says it
+ *               could beat reusing the previous table, the built-in English
+ *               table or storing it raw,
+ *               and the same goes for tANS and the context model against
+ *               the best mode so far. tANS wins on skewed blocks, where
+ *               Huffman rounds the cost of the common bytes up to 1 bit.
+ *               Text blocks also try a vocabulary of their own words.
+ *  Parameters: data - The bytes of the block
+ *              freqs - Histogram of the block
+ *              size - Number of bytes in the block
+ *              newTree - Set to the new table when BLOCK_NEW is picked
+ *  Return Value: The chosen mode
+ */
+int BlockEncoder::chooseMode(const byte* data, const vector<int>& freqs,
+	size_t size, shared_ptr<const HCTree>& newTree) {
+	/** Storing raw costs the block itself */
+	unsigned long long rawBytes = size;
+	/** Reusing costs the payload under the previous code lengths */
+	unsigned long long reuseBytes = NO_ESTIMATE;
+	if (prevTree) {
+		unsigned long long bits = estimateBits(freqs, *prevTree);
+		if (bits != NO_ESTIMATE) {
+			reuseBytes = (bits + 7) / 8;
+		}
+	}
+	int bestMode = BLOCK_RAW;
+	unsigned long long bestBytes = rawBytes;
+	if (reuseBytes < bestBytes) {
+		bestMode = BLOCK_REUSE;
+		bestBytes = reuseBytes;
+	}
+	/** The English table costs no header and no build either */
+	unsigned long long staticBits = StaticCodec<EnglishText>::estimateBits(freqs);
+	if (staticBits != STATIC_NO_ESTIMATE && (staticBits + 7) / 8 < bestBytes) {
+		bestMode = BLOCK_STATIC;
+		bestBytes = (staticBits + 7) / 8;
+	}
+
+	/** No Huffman code beats the entropy, so a new table costs at least
+	 *  the header plus the entropy of the block
+	 */
+	unsigned long long headerBytes = (HCTree::headerBits(freqs) + 7) / 8;
+	double entropyBits = 0;
+	for (int i = 0; i < ASCII_MAX; i++) {
+		if (freqs[i] != 0) {
+			entropyBits += freqs[i] * log2((double)size / freqs[i]);
+		}
+	}
+	unsigned long long newLowerBound =
+		headerBytes + (unsigned long long)(entropyBits / 8);
+	if (newLowerBound < bestBytes) {
+		/** A new table could win, build it and price it exactly */
+		shared_ptr<const HCTree> tree = HCTableCache::global().acquire(freqs);
+		unsigned long long newBytes =
+			headerBytes + (estimateBits(freqs, *tree) + 7) / 8;
+		if (newBytes < bestBytes) {
+			newTree = tree;
+			bestMode = BLOCK_NEW;
+			bestBytes = newBytes;
+		}
+	}
+
+	/** tANS codes close to the entropy, with the normalized histogram as
+	 *  its header. It decodes slower and leaves no table for later blocks
+	 *  to reuse, so it has to win by a margin.
+	 */
+	if (size == 0) {
+		return bestMode;
+	}
+	vector<int> normalized = AnsTable::normalize(freqs);
+	unsigned long long ansHeaderBytes = (HCTree::headerBits(normalized) + 7) / 8;
+	unsigned long long margin = size / ANS_MIN_GAIN;
+	if (ansHeaderBytes + (unsigned long long)(entropyBits / 8) + margin
+		< bestBytes) {
+		ansTable.build(normalized);
+		unsigned long long ansBytes = ansHeaderBytes
+			+ (unsigned long long)(ansTable.estimateBits(freqs) / 8) + 1;
+		if (ansBytes + margin < bestBytes) {
+			bestMode = BLOCK_ANS;
+			bestBytes = ansBytes;
+		}
+	}
+
+	/** The context model has to beat the best order-0 mode by more than
+	 *  its flags cost, judged by the order-1 entropy before building it
+	 */
+	if (size >= CONTEXT_MIN_BLOCK) {
+		contextModel.count(data, size);
+		if ((unsigned long long)(contextModel.lowerBoundBits() / 8)
+			+ (1 + ASCII_MAX) / 8 < bestBytes) {
+			contextModel.build();
+			unsigned long long contextBytes =
+				(contextModel.headerBits() + 7) / 8
+				+ (contextModel.payloadBits() + 7) / 8;
+			if (contextBytes < bestBytes) {
+				bestMode = BLOCK_CONTEXT;
+				bestBytes = contextBytes;
+			}
+		}
+	}
+
+	/** Words lose the context of the byte before, so they win when the
+	 *  bytes they absorb saved more than that, which only text does
+	 */
+	if (!TokenModel::looksLikeText(freqs, size)) {
+		return bestMode;
+	}
+	tokenModel.build(data, size);
+	unsigned long long tokenBytes = (tokenModel.headerBits() + 7) / 8
+		+ (tokenModel.payloadBits() + 7) / 8;
+	if (tokenBytes < bestBytes) {
+		return BLOCK_TOKEN;
+	}
+	return bestMode;
+}
+
+/** Function Name: writeBlock(const byte* data, size_t size)
+ *  Description: Writes data as one block in the cheapest mode, after the
+ *               filters that lower its entropy enough to pay for themselves
+ *  Parameters: data - The bytes of the block
+ *              size - Number of bytes in data
+ *  Return Value: The mode the block was written in
+ */
+int BlockEncoder::writeBlock(const byte* data, size_t size) {
+	unsigned int crc = checksums ? crc32(data, size) : 0;
+	/** From here on the block is the filtered bytes */
+	FilterChain chain = FilterChain::choose(data, size);
+	size_t unfilteredSize = size;
+	if (!chain.empty()) {
+		chain.encode(data, size, filtered);
+		data = filtered.data();
+		size = filtered.size();
+		filteredCount++;
+	}
+	/** Histogram of the block */
+	vector<int> freqs(ASCII_MAX, 0);
+	{
+		TRACE_SPAN("histogram");
+		for (size_t i = 0; i < size; i++) {
+			freqs[data[i]]++;
+		}
+	}
+	shared_ptr<const HCTree> newTree;
+	int mode = chooseMode(data, freqs, size, newTree);
+	modeCounts[mode]++;
+
+	int flags = checksums ? BLOCK_CHECKED : 0;
+	if (chain.empty()) {
+		out.put((char)(mode | flags));
+		if (checksums) {
+			writeU32(out, crc);
+		}
+	}
+	else {
+		out.put((char)(mode | flags | BLOCK_FILTERED));
+		if (checksums) {
+			writeU32(out, crc);
+		}
+		chain.write(out);
+		writeU32(out, (unsigned int)unfilteredSize);
+	}
+	writeU32(out, (unsigned int)size);
+	/** Raw blocks are copied straight through */
+	if (mode == BLOCK_RAW) {
+		writeU32(out, (unsigned int)size);
+		out.write((const char*)data, size);
+		return mode;
+	}
+
+	/** Code the block into a body buffer so its size is known */
+	vector<byte> body;
+	if (mode == BLOCK_STATIC) {
+		TRACE_SPAN("encode");
+		body.resize(StaticCodec<EnglishText>::encodeBound(size));
+		size_t bits = StaticCodec<EnglishText>::encode(data, size, body.data());
+		body.resize((bits + 7) / 8);
+		writeU32(out, (unsigned int)body.size());
+		out.write((const char*)body.data(), body.size());
+		return mode;
+	}
+	if (mode == BLOCK_ANS) {
+		ostringstream header;
+		BitOutputStream headerBOS(header);
+		HCTree::writeHeader(ansTable.getNormalized(), headerBOS);
+		padToByte(headerBOS);
+		string bytes = header.str();
+		body.assign(bytes.begin(), bytes.end());
+		ansTable.encode(data, size, body);
+		writeU32(out, (unsigned int)body.size());
+		out.write((const char*)body.data(), body.size());
+		return mode;
+	}
+	if (mode == BLOCK_CONTEXT) {
+		ostringstream header;
+		BitOutputStream headerBOS(header);
+		contextModel.writeHeader(headerBOS);
+		padToByte(headerBOS);
+		string bytes = header.str();
+		body.assign(bytes.begin(), bytes.end());
+		contextModel.encode(data, size, body);
+		writeU32(out, (unsigned int)body.size());
+		out.write((const char*)body.data(), body.size());
+		return mode;
+	}
+	if (mode == BLOCK_TOKEN) {
+		ostringstream header;
+		BitOutputStream headerBOS(header);
+		tokenModel.writeHeader(headerBOS);
+		padToByte(headerBOS);
+		string bytes = header.str();
+		body.assign(bytes.begin(), bytes.end());
+		tokenModel.encode(body);
+		writeU32(out, (unsigned int)body.size());
+		out.write((const char*)body.data(), body.size());
+		return mode;
+	}
+	if (mode == BLOCK_NEW) {
+		ostringstream header;
+		BitOutputStream headerBOS(header);
+		HCTree::writeHeader(freqs, headerBOS);
+		padToByte(headerBOS);
+		string bytes = header.str();
+		body.assign(bytes.begin(), bytes.end());
+		prevTree = newTree;
+	}
+	{
+		TRACE_SPAN("encode");
+		prevTree->encodeBytes(data, size, body);
+	}
+
+	writeU32(out, (unsigned int)body.size());
+	out.write((const char*)body.data(), body.size());
+	return mode;
+}
+
+/** Function Name: finish()
+ *  Description: Writes the BLOCK_END marker
+ *  Return Value: None
+ */
+void BlockEncoder::finish() {
+	out.put((char)BLOCK_END);
+	out.flush();
+}
+
+/** Function Name: getModeCount(int mode) const
+ *  Description: Getter for the number of blocks written in mode
+ *  Return Value: The number of blocks written in mode
+ */
+unsigned long long BlockEncoder::getModeCount(int mode) const {
+	return modeCounts[mode];
+}
+
+/** Function Name: getFilteredCount() const
+ *  Description: Getter for the number of blocks written filtered
+ *  Return Value: The value of filteredCount
+ */
+unsigned long long BlockEncoder::getFilteredCount() const {
+	return filteredCount;
+}
+
+/** Constructor
+ *  Description: Creates a BlockDecoder reading from is
+ */
+BlockDecoder::BlockDecoder(istream& is) : in(is), checkedCount(0) {
+}
+
+/** Function Name: readBlock(vector<byte>& data)
+ *  Description: Reads the next block and decodes it into data, undoing its
+ *               filters if it has any and checking its CRC-32 if it has one
+ *  Parameters: data - Set to the bytes of the block
+ *  Return Value: The mode of the block, BLOCK_END once the stream is done,
+ *                or BLOCK_ERROR if the block is malformed
+ */
+int BlockDecoder::readBlock(vector<byte>& data) {
+	data.clear();
+	int mode = in.get();
+	if (mode == EOF) {
+		return BLOCK_ERROR;
+	}
+	if (mode == BLOCK_END) {
+		return BLOCK_END;
+	}
+	bool checked = (mode & BLOCK_CHECKED) != 0;
+	unsigned int crc = 0;
+	if (checked && !readU32(in, crc)) {
+		return BLOCK_ERROR;
+	}
+	mode &= ~BLOCK_CHECKED;
+	if (!(mode & BLOCK_FILTERED)) {
+		mode = readBody(mode, BLOCK_SIZE, data);
+	}
+	else {
+		FilterChain chain;
+		unsigned int unfilteredSize = 0;
+		if (!chain.read(in) || !readU32(in, unfilteredSize)
+			|| unfilteredSize > BLOCK_SIZE) {
+			return BLOCK_ERROR;
+		}
+		mode = readBody(mode & ~BLOCK_FILTERED, BLOCK_FILTERED_SIZE, data);
+		if (mode == BLOCK_ERROR || !chain.decode(data, unfilteredSize)) {
+			return BLOCK_ERROR;
+		}
+	}
+	if (mode == BLOCK_ERROR || !checked) {
+		return mode;
+	}
+	/** The block was just written, so the CRC reads it from cache */
+	if (crc32(data.data(), data.size()) != crc) {
+		return BLOCK_ERROR;
+	}
+	checkedCount++;
+	return mode;
+}
+
+/** Function Name: getCheckedCount() const
+ *  Description: Getter for the number of blocks whose CRC-32 was checked
+ *  Return Value: The value of checkedCount
+ */
+unsigned long long BlockDecoder::getCheckedCount() const {
+	return checkedCount;
+}
+
+/** Function Name: readBody(int mode, size_t maxSize, vector<byte>& data)
+ *  Description: Reads the sizes and body of a block whose mode was read,
+ *               checks them before allocating anything, and decodes the
+ *               body into data
+ *  Return Value: mode, or BLOCK_ERROR if the block is malformed
+ */
+int BlockDecoder::readBody(int mode, size_t maxSize, vector<byte>& data) {
+	if (mode == BLOCK_END) {
+		return BLOCK_ERROR;
+	}
+	unsigned int rawSize = 0;
+	unsigned int bodySize = 0;
+	if (mode >= BLOCK_MODES || !readU32(in, rawSize)
+		|| !readU32(in, bodySize) || rawSize > maxSize
+		|| bodySize > rawSize + BLOCK_BODY_SLACK) {
+		return BLOCK_ERROR;
+	}
+	/** Raw blocks are copied straight through */
+	if (mode == BLOCK_RAW) {
+		if (bodySize != rawSize) {
+			return BLOCK_ERROR;
+		}
+		data.resize(rawSize);
+		if (!in.read((char*)data.data(), rawSize)) {
+			return BLOCK_ERROR;
+		}
+		return mode;
+	}
+
+	/** Pull the whole body in so the bit reader cannot run past it */
+	vector<byte> body(bodySize);
+	if (!in.read((char*)body.data(), bodySize)) {
+		return BLOCK_ERROR;
+	}
+	size_t headerBytes = 0;
+	if (mode == BLOCK_STATIC) {
+		data.resize(rawSize);
+		if (!StaticCodec<EnglishText>::decode(body.data(), bodySize,
+			data.data(), rawSize)) {
+			return BLOCK_ERROR;
+		}
+		return mode;
+	}
+	if (mode == BLOCK_ANS) {
+		istringstream header(string((const char*)body.data(), bodySize));
+		BitInputStream headerBIS(header);
+		vector<int> normalized;
+		if (HCTree::readHeader(headerBIS, normalized) != ANS_TABLE_SIZE
+			|| !ansTable.build(normalized)) {
+			return BLOCK_ERROR;
+		}
+		headerBytes = (HCTree::headerBits(normalized) + 7) / 8;
+		if (headerBytes > bodySize) {
+			return BLOCK_ERROR;
+		}
+		data.resize(rawSize);
+		if (!ansTable.decode(body.data() + headerBytes,
+			bodySize - headerBytes, data.data(), rawSize)) {
+			return BLOCK_ERROR;
+		}
+		return mode;
+	}
+	if (mode == BLOCK_CONTEXT) {
+		istringstream header(string((const char*)body.data(), bodySize));
+		BitInputStream headerBIS(header);
+		if (contextModel.readHeader(headerBIS) != (int)rawSize
+			|| rawSize == 0) {
+			return BLOCK_ERROR;
+		}
+		headerBytes = (contextModel.headerBits() + 7) / 8;
+		if (headerBytes > bodySize) {
+			return BLOCK_ERROR;
+		}
+		data.resize(rawSize);
+		if (!contextModel.decode(body.data() + headerBytes,
+			bodySize - headerBytes, data.data(), rawSize)) {
+			return BLOCK_ERROR;
+		}
+		return mode;
+	}
+	if (mode == BLOCK_TOKEN) {
+		istringstream header(string((const char*)body.data(), bodySize));
+		BitInputStream headerBIS(header);
+		int count = tokenModel.readHeader(headerBIS);
+		/** Every symbol is at least a byte */
+		if (count <= 0 || (unsigned int)count > rawSize) {
+			return BLOCK_ERROR;
+		}
+		headerBytes = (tokenModel.headerBits() + 7) / 8;
+		if (headerBytes > bodySize) {
+			return BLOCK_ERROR;
+		}
+		data.resize(rawSize);
+		if (!tokenModel.decode(body.data() + headerBytes,
+			bodySize - headerBytes, data.data(), rawSize, count)) {
+			return BLOCK_ERROR;
+		}
+		return mode;
+	}
+	if (mode == BLOCK_NEW) {
+		istringstream header(string((const char*)body.data(), bodySize));
+		BitInputStream headerBIS(header);
+		vector<int> freqs;
+		if (HCTree::readHeader(headerBIS, freqs) != (int)rawSize
+			|| rawSize == 0) {
+			return BLOCK_ERROR;
+		}
+		headerBytes = (HCTree::headerBits(freqs) + 7) / 8;
+		if (headerBytes > bodySize) {
+			return BLOCK_ERROR;
+		}
+		prevTree = HCTableCache::global().acquire(freqs);
+	}
+	if (!prevTree) {
+		return BLOCK_ERROR;
+	}
+	data.resize(rawSize);
+	if (!prevTree->decodeBytes(body.data() + headerBytes,
+		bodySize - headerBytes, data.data(), rawSize)) {
+		return BLOCK_ERROR;
+	}
+	return mode;
+}
@@ -0,0 +1,203 @@
+/** Filename: BlockCodec.hpp
+ *  Name: Loc Chuong
+ *  Description: A block format for the Huffman Coding Tree. The input is cut
+ *               into blocks of at most BLOCK_SIZE bytes and every block picks
+ *               the cheapest of seven modes by estimating its size from the
+ *               block histogram: code it with a new table, code it with the
+ *               previous block's table, code it with order-1 context tables,
+ *               code it with tANS, code it with the built-in English table,
+ *               code it as words of its own vocabulary, or store it raw.
+ *
+ *               Every block is laid out as
+ *                 mode (1 byte) | raw size (4 bytes) | body size (4 bytes) |
+ *                 body
+ *               where the body of a BLOCK_NEW block is the frequency header
+ *               padded to a byte followed by the padded code bits, the body
+ *               of a BLOCK_REUSE block is just the padded code bits, the body
+ *               of a BLOCK_CONTEXT block is the ContextModel header padded to
+ *               a byte followed by the padded code bits, the body of a
+ *               BLOCK_ANS block is the frequency header of the normalized
+ *               histogram padded to a byte followed by the tANS bytes, the
+ *               body of a BLOCK_STATIC block is just the padded code bits,
+ *               the body of a BLOCK_TOKEN block is the TokenModel header
+ *               padded to a byte followed by the padded code bits, and the
+ *               body of a BLOCK_RAW block is the bytes themselves.
+ *               The stream ends with a BLOCK_END block. Sizes are little
+ *               endian.
+ *
+ *               A block that went through a FilterChain first has
+ *               BLOCK_FILTERED set in its mode, and the mode is followed by
+ *                 the chain | size before filtering (4 bytes)
+ *               before the usual fields, which then describe the filtered
+ *               bytes.
+ *
+ *               A block with BLOCK_CHECKED set in its mode carries the
+ *               CRC-32 of its decoded bytes (4 bytes) right after the mode,
+ *               ahead of everything else. The decoder checks it as soon as
+ *               the block is decoded, while the block is still in cache.
+ *  Date: 10/18/2026
+ */
+
+#ifndef BLOCKCODEC_HPP
+#define BLOCKCODEC_HPP
+
+#include <iostream>
+#include <memory>
+#include <vector>
+#include "HCTree.hpp"
+#include "ContextModel.hpp"
+#include "AnsCoder.hpp"
+#include "FilterChain.hpp"
+#include "StaticCodec.hpp"
+#include "TokenModel.hpp"
+
+#define BLOCK_SIZE (1 << 16) /** Max number of input bytes in a block */
+#define BLOCK_MODES 8 /** Number of block modes */
+#define BLOCK_END 0 /** Marks the end of the block stream */
+#define BLOCK_NEW 1 /** Block carries its own frequency header */
+#define BLOCK_REUSE 2 /** Block is coded with the previous block's table */
+#define BLOCK_RAW 3 /** Block is stored as is */
+#define BLOCK_CONTEXT 4 /** Block carries order-1 context tables */
+#define BLOCK_ANS 5 /** Block is coded with tANS instead of Huffman */
+#define BLOCK_STATIC 6 /** Block is coded with the EnglishText table */
+#define BLOCK_TOKEN 7 /** Block is coded as words of its own vocabulary */
+#define BLOCK_FILTERED 0x80 /** Mode flag, the block was filtered first */
+#define BLOCK_CHECKED 0x40 /** Mode flag, a CRC-32 of the block follows */
+#define BLOCK_ERROR -1 /** Returned when a block cannot be read */
+/** Max bytes in a block after its filters, run lengths included */
+#define BLOCK_FILTERED_SIZE (BLOCK_SIZE + BLOCK_SIZE / RLE_MIN_RUN + 1)
+#define BLOCK_BODY_SLACK 1024 /** Most a coded body may exceed its raw size */
+#define ANS_MIN_GAIN 256 /** tANS has to save 1/ANS_MIN_GAIN of a block */
+#define NO_ESTIMATE ~0ULL /** Cost of a mode that cannot code the block */
+
+using namespace std;
+
+/** Class Name: BlockEncoder
+ *  Description: Writes blocks to an ostream, picking a mode for each one by
+ *               its estimated size.
+ */
+class BlockEncoder {
+private:
+	ostream& out; /** The stream blocks are written to */
+	shared_ptr<const HCTree> prevTree; /** Table of the last coded block */
+	ContextModel contextModel; /** Tables of the last BLOCK_CONTEXT block */
+	AnsTable ansTable; /** Tables of the last BLOCK_ANS block */
+	TokenModel tokenModel; /** Vocabulary of the last BLOCK_TOKEN block */
+	unsigned long long modeCounts[BLOCK_MODES]; /** Blocks written per mode */
+	unsigned long long filteredCount; /** Blocks written filtered */
+	vector<byte> filtered; /** The current block after its filters */
+	bool checksums; /** Whether blocks carry a CRC-32 */
+
+	/** Function Name: chooseMode(const byte* data,
+	 *                             const vector<int>& freqs, size_t size,
+	 *                             shared_ptr<const HCTree>& newTree)
+	 *  Description: Picks the mode with the smallest estimated body. A new
+	 *               table, a tANS table or a context model is only built
+	 *               when the entropy of the block says it could beat the
+	 *               cheaper modes.
+	 *  Parameters: data - The bytes of the block
+	 *              freqs - Histogram of the block
+	 *              size - Number of bytes in the block
+	 *              newTree - Set to the new table when BLOCK_NEW is picked
+	 *  Return Value: The chosen mode, contextModel is built for
+	 *                BLOCK_CONTEXT, ansTable for BLOCK_ANS and tokenModel
+	 *                for BLOCK_TOKEN
+	 */
+	int chooseMode(const byte* data, const vector<int>& freqs, size_t size,
+		shared_ptr<const HCTree>& newTree);
+
+public:
+	/** Constructor
+	 *  Description: Creates a BlockEncoder writing to os, giving every
+	 *               block a CRC-32 unless checksums is false
+	 */
+	explicit BlockEncoder(ostream& os, bool checksums = true);
+
+	/** Function Name: writeBlock(const byte* data, size_t size)
+	 *  Description: Writes data as one block in the cheapest mode, through
+	 *               the filters FilterChain::choose() picks for it
+	 *  PRECONDITION: 0 < size <= BLOCK_SIZE
+	 *  Parameters: data - The bytes of the block
+	 *              size - Number of bytes in data
+	 *  Return Value: The mode the block was written in
+	 */
+	int writeBlock(const byte* data, size_t size);
+
+	/** Function Name: finish()
+	 *  Description: Writes the BLOCK_END marker
+	 *  Return Value: None
+	 */
+	void finish();
+
+	/** Function Name: getModeCount(int mode) const
+	 *  Description: Getter for the number of blocks written in mode
+	 *  Return Value: The number of blocks written in mode
+	 */
+	unsigned long long getModeCount(int mode) const;
+
+	/** Function Name: getFilteredCount() const
+	 *  Description: Getter for the number of blocks written filtered
+	 *  Return Value: The value of filteredCount
+	 */
+	unsigned long long getFilteredCount() const;
+
+	/** Function Name: estimateBits(const vector<int>& freqs,
+	 *                              const HCTree& tree)
+	 *  Description: Number of code bits tree would write for a block with
+	 *               histogram freqs, from the code lengths alone
+	 *  Parameters: freqs - Histogram of the block
+	 *              tree - Candidate table
+	 *  Return Value: The payload size in bits, or NO_ESTIMATE if freqs has
+	 *                a byte tree has no code for
+	 */
+	static unsigned long long estimateBits(const vector<int>& freqs,
+		const HCTree& tree);
+};
+
+/** Class Name: BlockDecoder
+ *  Description: Reads blocks written by a BlockEncoder back from an istream
+ */
+class BlockDecoder {
+private:
+	istream& in; /** The stream blocks are read from */
+	shared_ptr<const HCTree> prevTree; /** Table of the last coded block */
+	ContextModel contextModel; /** Tables of the current BLOCK_CONTEXT block */
+	AnsTable ansTable; /** Tables of the current BLOCK_ANS block */
+	TokenModel tokenModel; /** Vocabulary of the current BLOCK_TOKEN block */
+	unsigned long long checkedCount; /** Blocks whose CRC-32 matched */
+
+	/** Function Name: readBody(int mode, size_t maxSize,
+	 *                          vector<byte>& data)
+	 *  Description: Reads the sizes and body of a block whose mode was read
+	 *               and decodes it into data
+	 *  Parameters: mode - The mode of the block, without its flags
+	 *              maxSize - Largest raw size the block may have
+	 *              data - Set to the bytes of the block
+	 *  Return Value: mode, or BLOCK_ERROR if the block is malformed
+	 */
+	int readBody(int mode, size_t maxSize, vector<byte>& data);
+
+public:
+	/** Constructor
+	 *  Description: Creates a BlockDecoder reading from is
+	 */
+	explicit BlockDecoder(istream& is);
+
+	/** Function Name: readBlock(vector<byte>& data)
+	 *  Description: Reads the next block and decodes it into data
+	 *  Parameters: data - Set to the bytes of the block
+	 *  Return Value: The mode of the block, BLOCK_END once the stream is
+	 *                done, or BLOCK_ERROR if the block is malformed or its
+	 *                CRC-32 does not match
+	 */
+	int readBlock(vector<byte>& data);
+
+	/** Function Name: getCheckedCount() const
+	 *  Description: Getter for the number of blocks read whose CRC-32 was
+	 *               checked
+	 *  Return Value: The value of checkedCount
+	 */
+	unsigned long long getCheckedCount() const;
+};
+
+#endif // BLOCKCODEC_HPP
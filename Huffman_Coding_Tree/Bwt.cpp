@@ -0,0 +1,403 @@
+/** Filename: Bwt.cpp
+ *  Name: Loc Chuong
+ *  Description: SA-IS suffix array, Burrows-Wheeler transform and its
+ *               inverse, and the move-to-front and zero-run coder of the
+ *               archive format.
+ *  Date: 10/18/2026
+ */
+
+#include "Bwt.hpp"
+#include "Trace.hpp"
+#include <cstring>
+
+#define BWT_LINK_SHIFT 8 /** A link holds its next row above the byte */
+
+/** Function Name: getBuckets(const int* text, int size, int alphabet,
+ *                            int* buckets, bool ends)
+ *  Description: Sets buckets[c] to where the suffixes starting with c
+ *               begin in the suffix array, or end if ends is set
+ *  Return Value: None
+ */
+static void getBuckets(const int* text, int size, int alphabet, int* buckets,
+	bool ends) {
+	for (int c = 0; c < alphabet; c++) {
+		buckets[c] = 0;
+	}
+	for (int i = 0; i < size; i++) {
+		buckets[text[i]]++;
+	}
+	int sum = 0;
+	for (int c = 0; c < alphabet; c++) {
+		sum += buckets[c];
+		buckets[c] = ends ? sum : sum - buckets[c];
+	}
+}
+
+/** Function Name: induceL(const vector<char>& sType, int* sa,
+ *                         const int* text, int size, int alphabet,
+ *                         int* buckets)
+ *  Description: Places the L-type suffixes from the sorted ones already in
+ *               sa, scanning left to right into the bucket fronts
+ *  Return Value: None
+ */
+static void induceL(const vector<char>& sType, int* sa, const int* text,
+	int size, int alphabet, int* buckets) {
+	getBuckets(text, size, alphabet, buckets, false);
+	for (int i = 0; i < size; i++) {
+		int j = sa[i] - 1;
+		if (sa[i] > 0 && !sType[j]) {
+			sa[buckets[text[j]]++] = j;
+		}
+	}
+}
+
+/** Function Name: induceS(const vector<char>& sType, int* sa,
+ *                         const int* text, int size, int alphabet,
+ *                         int* buckets)
+ *  Description: Places the S-type suffixes from the L-type ones, scanning
+ *               right to left into the bucket ends
+ *  Return Value: None
+ */
+static void induceS(const vector<char>& sType, int* sa, const int* text,
+	int size, int alphabet, int* buckets) {
+	getBuckets(text, size, alphabet, buckets, true);
+	for (int i = size - 1; i >= 0; i--) {
+		int j = sa[i] - 1;
+		if (sa[i] > 0 && sType[j]) {
+			sa[--buckets[text[j]]] = j;
+		}
+	}
+}
+
+/** Function Name: suffixArray(int* text, int* sa, int size, int alphabet)
+ *  Description: SA-IS. Sorts the LMS substrings by induction, names them,
+ *               sorts the string of names recursively when two share a
+ *               name, then induces every suffix from the sorted LMS ones.
+ *               The reduced string and its suffix array live in sa, so the
+ *               only extra memory is the type and bucket arrays.
+ *  PRECONDITION: text ends with a 0 found nowhere else, and every symbol
+ *                of text is below alphabet
+ *  Return Value: None
+ */
+static void suffixArray(int* text, int* sa, int size, int alphabet) {
+	/** sType[i] is set when the suffix at i sorts below the one after it */
+	vector<char> sType(size);
+	sType[size - 1] = 1;
+	if (size >= 2) {
+		sType[size - 2] = 0;
+	}
+	for (int i = size - 3; i >= 0; i--) {
+		sType[i] = text[i] < text[i + 1]
+			|| (text[i] == text[i + 1] && sType[i + 1]);
+	}
+	auto isLms = [&sType](int i) {
+		return i > 0 && sType[i] && !sType[i - 1];
+	};
+	vector<int> buckets(alphabet);
+
+	/** Sort the LMS substrings: drop them at their bucket ends, induce */
+	getBuckets(text, size, alphabet, buckets.data(), true);
+	for (int i = 0; i < size; i++) {
+		sa[i] = -1;
+	}
+	for (int i = 1; i < size; i++) {
+		if (isLms(i)) {
+			sa[--buckets[text[i]]] = i;
+		}
+	}
+	induceL(sType, sa, text, size, alphabet, buckets.data());
+	induceS(sType, sa, text, size, alphabet, buckets.data());
+
+	/** Pack the sorted LMS positions to the front */
+	int lmsCount = 0;
+	for (int i = 0; i < size; i++) {
+		if (isLms(sa[i])) {
+			sa[lmsCount++] = sa[i];
+		}
+	}
+	/** Name them, equal substrings sharing a name. LMS positions are at
+	 *  least two apart, so pos / 2 gives every one its own slot.
+	 */
+	for (int i = lmsCount; i < size; i++) {
+		sa[i] = -1;
+	}
+	int names = 0;
+	int prev = -1;
+	for (int i = 0; i < lmsCount; i++) {
+		int pos = sa[i];
+		bool differs = false;
+		for (int d = 0; d < size; d++) {
+			if (prev == -1 || text[pos + d] != text[prev + d]
+				|| sType[pos + d] != sType[prev + d]) {
+				differs = true;
+				break;
+			}
+			if (d > 0 && (isLms(pos + d) || isLms(prev + d))) {
+				break;
+			}
+		}
+		if (differs) {
+			names++;
+			prev = pos;
+		}
+		sa[lmsCount + pos / 2] = names - 1;
+	}
+	for (int i = size - 1, j = size - 1; i >= lmsCount; i--) {
+		if (sa[i] >= 0) {
+			sa[j--] = sa[i];
+		}
+	}
+
+	/** Sort the string of names, recursively unless they are all unique */
+	int* reduced = sa + size - lmsCount;
+	if (names < lmsCount) {
+		suffixArray(reduced, sa, lmsCount, names);
+	}
+	else {
+		for (int i = 0; i < lmsCount; i++) {
+			sa[reduced[i]] = i;
+		}
+	}
+
+	/** Map the sorted names back to positions and induce every suffix */
+	for (int i = 1, j = 0; i < size; i++) {
+		if (isLms(i)) {
+			reduced[j++] = i;
+		}
+	}
+	for (int i = 0; i < lmsCount; i++) {
+		sa[i] = reduced[sa[i]];
+	}
+	for (int i = lmsCount; i < size; i++) {
+		sa[i] = -1;
+	}
+	getBuckets(text, size, alphabet, buckets.data(), true);
+	for (int i = lmsCount - 1; i >= 0; i--) {
+		int j = sa[i];
+		sa[i] = -1;
+		sa[--buckets[text[j]]] = j;
+	}
+	induceL(sType, sa, text, size, alphabet, buckets.data());
+	induceS(sType, sa, text, size, alphabet, buckets.data());
+}
+
+/** Function Name: bwtEncode(const byte* data, size_t size, byte* out,
+ *                           unsigned int* starts)
+ *  Description: Sorts the suffixes of data plus a 0 marker, with every byte
+ *               shifted up by one to keep the marker the smallest, and
+ *               reads the byte before each one off the suffix array
+ *  Return Value: None
+ */
+void bwtEncode(const byte* data, size_t size, byte* out,
+	unsigned int* starts) {
+	TRACE_SPAN("bwt");
+	for (int q = 0; q < BWT_STREAMS; q++) {
+		starts[q] = 0;
+	}
+	if (size == 0) {
+		return;
+	}
+	int rows = (int)size + 1;
+	vector<int> text(rows);
+	vector<int> sa(rows);
+	for (size_t i = 0; i < size; i++) {
+		text[i] = data[i] + 1;
+	}
+	text[size] = 0;
+	suffixArray(text.data(), sa.data(), rows, ASCII_MAX + 1);
+
+	size_t streamStart[BWT_STREAMS];
+	for (int q = 0; q < BWT_STREAMS; q++) {
+		streamStart[q] = q * size / BWT_STREAMS;
+	}
+	size_t written = 0;
+	for (int row = 0; row < rows; row++) {
+		size_t pos = (size_t)sa[row];
+		for (int q = 0; q < BWT_STREAMS; q++) {
+			if (pos == streamStart[q]) {
+				starts[q] = (unsigned int)row;
+			}
+		}
+		/** The byte before the whole block is the marker, left out */
+		if (pos != 0) {
+			out[written++] = data[pos - 1];
+		}
+	}
+}
+
+/** Function Name: bwtDecode(const byte* in, size_t size,
+ *                           const unsigned int* starts, byte* out)
+ *  Description: Builds links[row] = (next row << 8) | first byte of row,
+ *               where next row is the rotation one byte further on, then
+ *               walks the links from every stream start at once
+ *  Return Value: False if a row in starts is out of range
+ */
+bool bwtDecode(const byte* in, size_t size, const unsigned int* starts,
+	byte* out) {
+	TRACE_SPAN("inverse bwt");
+	for (int q = 0; q < BWT_STREAMS; q++) {
+		if (starts[q] > size) {
+			return false;
+		}
+	}
+	if (size == 0) {
+		return true;
+	}
+	/** Row 0 holds the marker, the rows of byte c follow those below it */
+	size_t counts[ASCII_MAX] = { 0 };
+	for (size_t i = 0; i < size; i++) {
+		counts[in[i]]++;
+	}
+	size_t next[ASCII_MAX];
+	size_t sum = 1;
+	for (int c = 0; c < ASCII_MAX; c++) {
+		next[c] = sum;
+		sum += counts[c];
+	}
+	/** The k-th row ending in c is the one before the k-th starting with
+	 *  c, skipping the marker's row in the last column
+	 */
+	vector<unsigned int> links(size + 1);
+	links[0] = starts[0] << BWT_LINK_SHIFT;
+	for (size_t i = 0; i < size; i++) {
+		size_t row = i < starts[0] ? i : i + 1;
+		byte c = in[i];
+		links[next[c]++] = (unsigned int)(row << BWT_LINK_SHIFT) | c;
+	}
+
+	/** Each stream is one dependent chain of loads, follow them together */
+	const unsigned int* link = links.data();
+	byte* streamOut[BWT_STREAMS];
+	size_t streamSize[BWT_STREAMS];
+	unsigned int row[BWT_STREAMS];
+	size_t shortest = size;
+	for (int q = 0; q < BWT_STREAMS; q++) {
+		size_t begin = q * size / BWT_STREAMS;
+		streamOut[q] = out + begin;
+		streamSize[q] = (q + 1) * size / BWT_STREAMS - begin;
+		row[q] = starts[q];
+		if (streamSize[q] < shortest) {
+			shortest = streamSize[q];
+		}
+	}
+	for (size_t k = 0; k < shortest; k++) {
+		for (int q = 0; q < BWT_STREAMS; q++) {
+			unsigned int entry = link[row[q]];
+			streamOut[q][k] = (byte)entry;
+			row[q] = entry >> BWT_LINK_SHIFT;
+		}
+	}
+	for (int q = 0; q < BWT_STREAMS; q++) {
+		for (size_t k = shortest; k < streamSize[q]; k++) {
+			unsigned int entry = link[row[q]];
+			streamOut[q][k] = (byte)entry;
+			row[q] = entry >> BWT_LINK_SHIFT;
+		}
+	}
+	return true;
+}
+
+/** Function Name: writeRun(size_t run, vector<unsigned short>& symbols)
+ *  Description: Writes run in bijective base 2, RUNA for digit 1 and RUNB
+ *               for digit 2, least significant first
+ *  Return Value: None
+ */
+static void writeRun(size_t run, vector<unsigned short>& symbols) {
+	while (run > 0) {
+		if (run & 1) {
+			symbols.push_back(MTF_RUNA);
+			run = (run - 1) >> 1;
+		}
+		else {
+			symbols.push_back(MTF_RUNB);
+			run = (run - 2) >> 1;
+		}
+	}
+}
+
+/** Function Name: mtfEncode(const byte* data, size_t size,
+ *                           const vector<byte>& alphabet,
+ *                           vector<unsigned short>& symbols)
+ *  Description: Move-to-front codes data starting from alphabet in order,
+ *               collapsing the runs of index 0
+ *  Return Value: None
+ */
+void mtfEncode(const byte* data, size_t size, const vector<byte>& alphabet,
+	vector<unsigned short>& symbols) {
+	TRACE_SPAN("mtf");
+	symbols.clear();
+	if (size == 0) {
+		return;
+	}
+	byte order[ASCII_MAX];
+	memcpy(order, alphabet.data(), alphabet.size());
+	size_t run = 0;
+	for (size_t i = 0; i < size; i++) {
+		byte b = data[i];
+		if (order[0] == b) {
+			run++;
+			continue;
+		}
+		writeRun(run, symbols);
+		run = 0;
+		/** After a BWT the index is usually tiny, a scan beats a lookup */
+		int index = 1;
+		while (order[index] != b) {
+			index++;
+		}
+		memmove(order + 1, order, index);
+		order[0] = b;
+		symbols.push_back((unsigned short)(index + 1));
+	}
+	writeRun(run, symbols);
+}
+
+/** Function Name: mtfDecode(const unsigned short* symbols, size_t count,
+ *                           const vector<byte>& alphabet, byte* out,
+ *                           size_t size)
+ *  Description: Expands the zero runs and undoes move-to-front
+ *  Return Value: False if the symbols do not expand to exactly size bytes
+ *                over alphabet
+ */
+bool mtfDecode(const unsigned short* symbols, size_t count,
+	const vector<byte>& alphabet, byte* out, size_t size) {
+	TRACE_SPAN("inverse mtf");
+	if (alphabet.empty()) {
+		return count == 0 && size == 0;
+	}
+	byte order[ASCII_MAX];
+	memcpy(order, alphabet.data(), alphabet.size());
+	size_t written = 0;
+	size_t run = 0;
+	size_t weight = 1;
+	for (size_t i = 0; i < count; i++) {
+		unsigned short symbol = symbols[i];
+		if (symbol <= MTF_RUNB) {
+			/** A digit worth more than the block cannot be valid */
+			if (weight > size) {
+				return false;
+			}
+			run += (symbol + 1) * weight;
+			weight <<= 1;
+			if (run > size - written) {
+				return false;
+			}
+			continue;
+		}
+		memset(out + written, order[0], run);
+		written += run;
+		run = 0;
+		weight = 1;
+		size_t index = symbol - 1;
+		if (index >= alphabet.size() || written >= size) {
+			return false;
+		}
+		byte b = order[index];
+		memmove(order + 1, order, index);
+		order[0] = b;
+		out[written++] = b;
+	}
+	memset(out + written, order[0], run);
+	written += run;
+	return written == size;
+}
@@ -0,0 +1,78 @@
+/** Filename: Bwt.hpp
+ *  Name: Loc Chuong
+ *  Description: Burrows-Wheeler transform and move-to-front front end for the
+ *               archive format. The BWT groups bytes that share a following
+ *               context, move-to-front turns those groups into runs of small
+ *               indices, mostly 0, and the runs of 0 are written in
+ *               bijective base 2 with the two digits RUNA and RUNB. What is
+ *               left is an alphabet of ARCHIVE_ALPHABET symbols that Huffman
+ *               codes far below the order-0 size of the block.
+ *
+ *               The suffix array behind the BWT is built with SA-IS in
+ *               linear time. The inverse BWT follows one table of packed
+ *               (next row, byte) words, so every output byte costs a single
+ *               random load, and follows BWT_STREAMS chains at once so those
+ *               loads overlap instead of waiting on each other.
+ *  Date: 10/18/2026
+ */
+
+#ifndef BWT_HPP
+#define BWT_HPP
+
+#include <cstddef>
+#include <vector>
+#include "HCTree.hpp"
+
+#define BWT_STREAMS 4 /** Independent chains the inverse BWT follows */
+#define BWT_MAX_SIZE ((1 << 24) - 1) /** Rows must fit in 24 bits */
+#define MTF_RUNA 0 /** Zero-run digit worth 1 at its position */
+#define MTF_RUNB 1 /** Zero-run digit worth 2 at its position */
+#define ARCHIVE_ALPHABET 257 /** RUNA, RUNB and move-to-front indices 1-255 */
+
+using namespace std;
+
+/** Function Name: bwtEncode(const byte* data, size_t size, byte* out,
+ *                           unsigned int* starts)
+ *  Description: Writes the BWT of data, with an end of block marker sorting
+ *               below every byte, to out. The marker itself is left out;
+ *               starts[0] is the row it is in. starts[i] is the row of the
+ *               rotation starting at byte i * size / BWT_STREAMS, so the
+ *               inverse can rebuild the streams side by side.
+ *  PRECONDITION: size <= BWT_MAX_SIZE, out holds size bytes, starts holds
+ *                BWT_STREAMS rows
+ *  Return Value: None
+ */
+void bwtEncode(const byte* data, size_t size, byte* out, unsigned int* starts);
+
+/** Function Name: bwtDecode(const byte* in, size_t size,
+ *                           const unsigned int* starts, byte* out)
+ *  Description: Inverts bwtEncode()
+ *  PRECONDITION: size <= BWT_MAX_SIZE, out holds size bytes
+ *  Return Value: False if a row in starts is out of range
+ */
+bool bwtDecode(const byte* in, size_t size, const unsigned int* starts,
+	byte* out);
+
+/** Function Name: mtfEncode(const byte* data, size_t size,
+ *                           const vector<byte>& alphabet,
+ *                           vector<unsigned short>& symbols)
+ *  Description: Move-to-front codes data over alphabet, then writes every
+ *               run of index 0 as RUNA and RUNB digits, least significant
+ *               first, and every other index i as symbol i + 1
+ *  PRECONDITION: alphabet lists every byte of data, in increasing order
+ *  Return Value: None
+ */
+void mtfEncode(const byte* data, size_t size, const vector<byte>& alphabet,
+	vector<unsigned short>& symbols);
+
+/** Function Name: mtfDecode(const unsigned short* symbols, size_t count,
+ *                           const vector<byte>& alphabet, byte* out,
+ *                           size_t size)
+ *  Description: Inverts mtfEncode()
+ *  Return Value: False if the symbols do not expand to exactly size bytes
+ *                over alphabet
+ */
+bool mtfDecode(const unsigned short* symbols, size_t count,
+	const vector<byte>& alphabet, byte* out, size_t size);
+
+#endif // BWT_HPP
@@ -0,0 +1,438 @@
+/** Filename: ColumnCodec.cpp
+ *  Name: Loc Chuong
+ *  Description: A columnar format for delimited records, with a Huffman
+ *               table per column and the columns coded on several threads.
+ *  Date: 10/18/2026
+ */
+
+#include "ColumnCodec.hpp"
+#include "Crc32.hpp"
+#include "LittleEndian.hpp"
+#include "Trace.hpp"
+#include <sstream>
+#include <string>
+#include <thread>
+
+#define COLUMN_CANDIDATES 4 /** Number of delimiters detectDelimiter() tries */
+
+/** Delimiters detectDelimiter() tries, the first wins a tie */
+static const byte candidates[COLUMN_CANDIDATES] = { ',', '\t', '|', ';' };
+
+/** Function Name: encodeStream(const vector<byte>& data, vector<byte>& body)
+ *  Description: Codes one column stream with a table built for it alone
+ *  Return Value: None
+ */
+static void encodeStream(const vector<byte>& data, vector<byte>& body) {
+	TRACE_SPAN("column");
+	body.clear();
+	if (data.empty()) {
+		return;
+	}
+	vector<int> freqs(ASCII_MAX, 0);
+	for (size_t i = 0; i < data.size(); i++) {
+		freqs[data[i]]++;
+	}
+	HCTree tree;
+	tree.build(freqs);
+	ostringstream header;
+	BitOutputStream headerBOS(header);
+	HCTree::writeHeader(freqs, headerBOS);
+	while (headerBOS.getnbits() != 0) {
+		headerBOS.writeBit(0);
+	}
+	string bytes = header.str();
+	body.assign(bytes.begin(), bytes.end());
+	tree.encodeBytes(data.data(), data.size(), body);
+}
+
+/** Constructor
+ *  Description: Creates a ColumnEncoder coding up to threads streams at once
+ */
+ColumnEncoder::ColumnEncoder(int threads) :
+	threads(threads < 1 ? 1 : threads), delimiter(','), columnCount(0) {
+}
+
+/** Function Name: detectDelimiter(const byte* data, size_t size)
+ *  Description: Counts every candidate on each whole line of the first
+ *               COLUMN_SAMPLE_SIZE bytes, and scores it by the lines that
+ *               have as many as the first line, when that is not 0
+ *  Return Value: The delimiter, a comma if none of them fits
+ */
+byte ColumnEncoder::detectDelimiter(const byte* data, size_t size) {
+	size_t sample = size < COLUMN_SAMPLE_SIZE ? size : COLUMN_SAMPLE_SIZE;
+	byte best = candidates[0];
+	size_t bestScore = 0;
+	for (int d = 0; d < COLUMN_CANDIDATES; d++) {
+		size_t score = 0;
+		size_t firstCount = 0;
+		size_t lineCount = 0;
+		bool firstLine = true;
+		for (size_t i = 0; i < sample; i++) {
+			if (data[i] == candidates[d]) {
+				lineCount++;
+			}
+			else if (data[i] == '\n') {
+				if (firstLine) {
+					firstCount = lineCount;
+					firstLine = false;
+				}
+				if (firstCount != 0 && lineCount == firstCount) {
+					score++;
+				}
+				lineCount = 0;
+			}
+		}
+		if (score > bestScore) {
+			best = candidates[d];
+			bestScore = score;
+		}
+	}
+	return best;
+}
+
+/** Function Name: write(const byte* data, size_t size, ostream& out)
+ *  Description: Splits data into column streams, codes them a stream per
+ *               thread and writes the directory followed by the bodies
+ *  Return Value: None
+ */
+void ColumnEncoder::write(const byte* data, size_t size, ostream& out) {
+	TRACE_SPAN("columns");
+	delimiter = detectDelimiter(data, size);
+	byte flags = 0;
+	vector<vector<byte>> streams(1);
+	{
+		TRACE_SPAN("split");
+		int column = 0;
+		for (size_t i = 0; i < size; i++) {
+			byte c = data[i];
+			streams[column].push_back(c);
+			if (c == '\n') {
+				column = 0;
+			}
+			else if (c == delimiter && column < COLUMN_MAX - 1) {
+				column++;
+				if (column == (int)streams.size()) {
+					streams.push_back(vector<byte>());
+				}
+			}
+		}
+		/** Every record ends in a newline, one is added if the input lacks it */
+		if (size > 0 && data[size - 1] != '\n') {
+			streams[column].push_back('\n');
+			flags |= COLUMN_NO_NEWLINE;
+		}
+	}
+	columnCount = size == 0 ? 0 : (int)streams.size();
+
+	/** Worker t codes columns t, t + threads, t + 2 * threads and so on */
+	vector<vector<byte>> bodies(columnCount);
+	int workerCount = threads < columnCount ? threads : columnCount;
+	auto work = [this, &streams, &bodies](int first) {
+		for (int k = first; k < columnCount; k += threads) {
+			encodeStream(streams[k], bodies[k]);
+		}
+	};
+	vector<thread> workers;
+	for (int t = 1; t < workerCount; t++) {
+		workers.push_back(thread(work, t));
+	}
+	work(0);
+	for (size_t i = 0; i < workers.size(); i++) {
+		workers[i].join();
+	}
+
+	out.write(COLUMN_MAGIC, COLUMN_MAGIC_SIZE);
+	out.put((char)COLUMN_VERSION);
+	out.put((char)delimiter);
+	out.put((char)flags);
+	writeU32(out, (unsigned int)columnCount);
+	for (int k = 0; k < columnCount; k++) {
+		writeU32(out, (unsigned int)streams[k].size());
+		writeU32(out, (unsigned int)bodies[k].size());
+		writeU32(out, crc32(streams[k].data(), streams[k].size()));
+	}
+	for (int k = 0; k < columnCount; k++) {
+		out.write((const char*)bodies[k].data(), bodies[k].size());
+	}
+	out.flush();
+}
+
+/** Function Name: getDelimiter() const
+ *  Description: Getter for the delimiter of the last input written
+ *  Return Value: The value of delimiter
+ */
+byte ColumnEncoder::getDelimiter() const {
+	return delimiter;
+}
+
+/** Function Name: getColumnCount() const
+ *  Description: Getter for the number of streams of the last input written
+ *  Return Value: The value of columnCount
+ */
+int ColumnEncoder::getColumnCount() const {
+	return columnCount;
+}
+
+/** Constructor
+ *  Description: Creates a ColumnDecoder reading from is
+ */
+ColumnDecoder::ColumnDecoder(istream& is, int threads) : in(is),
+	threads(threads < 1 ? 1 : threads), delimiter(','), flags(0),
+	checkedCount(0), bodiesStart(0) {
+}
+
+/** Function Name: readDirectory()
+ *  Description: Reads the magic, delimiter, flags and stream sizes,
+ *               checking that the bodies fill the rest of the file exactly
+ *  Return Value: False if the file is not columnar or they are malformed
+ */
+bool ColumnDecoder::readDirectory() {
+	char header[COLUMN_MAGIC_SIZE + 1];
+	if (!in.read(header, COLUMN_MAGIC_SIZE + 1)
+		|| string(header, COLUMN_MAGIC_SIZE) != COLUMN_MAGIC
+		|| header[COLUMN_MAGIC_SIZE] != COLUMN_VERSION) {
+		return false;
+	}
+	int d = in.get();
+	int f = in.get();
+	unsigned int count = 0;
+	if (d == EOF || f == EOF || (f & ~COLUMN_NO_NEWLINE) != 0
+		|| !readU32(in, count) || count > COLUMN_MAX) {
+		return false;
+	}
+	delimiter = (byte)d;
+	flags = (byte)f;
+	rawSizes.assign(count, 0);
+	bodySizes.assign(count, 0);
+	crcs.assign(count, 0);
+	unsigned long long bodyTotal = 0;
+	for (unsigned int k = 0; k < count; k++) {
+		if (!readU32(in, rawSizes[k]) || !readU32(in, bodySizes[k])
+			|| !readU32(in, crcs[k])) {
+			return false;
+		}
+		/** Only an empty stream has an empty body */
+		if ((rawSizes[k] == 0) != (bodySizes[k] == 0)) {
+			return false;
+		}
+		bodyTotal += bodySizes[k];
+	}
+	/** Every record starts in the first column */
+	if (count > 0 && rawSizes[0] == 0) {
+		return false;
+	}
+	if (count == 0 && flags != 0) {
+		return false;
+	}
+	bodiesStart = in.tellg();
+	in.seekg(0, ios::end);
+	streamoff end = in.tellg();
+	in.seekg(bodiesStart);
+	return bodiesStart >= 0 && (unsigned long long)(end - bodiesStart)
+		== bodyTotal;
+}
+
+/** Function Name: decodeBody(const vector<byte>& body, size_t rawSize,
+ *                            unsigned int crc, vector<byte>& data)
+ *  Description: Reads the table of one stream, decodes its codes and
+ *               checks the CRC-32 of the stream while it is still in cache
+ *  Return Value: False if the body is malformed or the CRC-32 does not
+ *                match
+ */
+bool ColumnDecoder::decodeBody(const vector<byte>& body, size_t rawSize,
+	unsigned int crc, vector<byte>& data) {
+	TRACE_SPAN("column");
+	data.clear();
+	if (rawSize == 0) {
+		return body.empty() && crc == 0;
+	}
+	istringstream header(string((const char*)body.data(), body.size()));
+	BitInputStream headerBIS(header);
+	vector<int> freqs;
+	if (HCTree::readHeader(headerBIS, freqs) != (int)rawSize) {
+		return false;
+	}
+	size_t headerBytes = (HCTree::headerBits(freqs) + 7) / 8;
+	if (headerBytes > body.size()) {
+		return false;
+	}
+	HCTree tree;
+	tree.build(freqs);
+	data.resize(rawSize);
+	return tree.decodeBytes(body.data() + headerBytes,
+		body.size() - headerBytes, data.data(), rawSize)
+		&& crc32(data.data(), data.size()) == crc;
+}
+
+/** Function Name: decodeStreams(int count,
+ *                               vector<vector<byte>>& streams)
+ *  Description: Reads the bodies of the first count columns, which sit
+ *               one after the other at the start of the bodies, and
+ *               decodes them a stream per thread
+ *  Return Value: False if a stream is malformed
+ */
+bool ColumnDecoder::decodeStreams(int count, vector<vector<byte>>& streams) {
+	vector<vector<byte>> bodies(count);
+	in.clear();
+	in.seekg(bodiesStart);
+	for (int k = 0; k < count; k++) {
+		bodies[k].resize(bodySizes[k]);
+		if (!in.read((char*)bodies[k].data(), bodySizes[k])) {
+			return false;
+		}
+	}
+	streams.assign(count, vector<byte>());
+	vector<char> valid(count, 0);
+	int workerCount = threads < count ? threads : count;
+	auto work = [this, count, &bodies, &streams, &valid](int first) {
+		for (int k = first; k < count; k += threads) {
+			valid[k] = decodeBody(bodies[k], rawSizes[k], crcs[k],
+				streams[k]);
+		}
+	};
+	vector<thread> workers;
+	for (int t = 1; t < workerCount; t++) {
+		workers.push_back(thread(work, t));
+	}
+	if (count > 0) {
+		work(0);
+	}
+	for (size_t i = 0; i < workers.size(); i++) {
+		workers[i].join();
+	}
+	for (int k = 0; k < count; k++) {
+		if (!valid[k]) {
+			return false;
+		}
+	}
+	checkedCount += count;
+	return true;
+}
+
+/** Function Name: decodeAll(vector<byte>& data)
+ *  Description: Decodes every stream, then walks the streams record by
+ *               record, taking a field from each until the one that ends
+ *               in a newline
+ *  Return Value: False if the file is malformed
+ */
+bool ColumnDecoder::decodeAll(vector<byte>& data) {
+	TRACE_SPAN("columns");
+	data.clear();
+	int count = (int)rawSizes.size();
+	vector<vector<byte>> streams;
+	if (!decodeStreams(count, streams)) {
+		return false;
+	}
+	size_t total = 0;
+	for (int k = 0; k < count; k++) {
+		total += streams[k].size();
+	}
+
+	TRACE_SPAN("stitch");
+	data.resize(total);
+	byte* out = data.data();
+	vector<size_t> next(count, 0);
+	while (count > 0 && next[0] < streams[0].size()) {
+		int column = 0;
+		while (1) {
+			const vector<byte>& stream = streams[column];
+			size_t i = next[column];
+			/** The last stream holds every field past it, delimiters and all */
+			bool last = column == COLUMN_MAX - 1;
+			while (i < stream.size() && stream[i] != '\n'
+				&& (last || stream[i] != delimiter)) {
+				*out++ = stream[i++];
+			}
+			if (i == stream.size()) {
+				return false;
+			}
+			*out++ = stream[i];
+			next[column] = i + 1;
+			if (stream[i] == '\n') {
+				break;
+			}
+			if (++column == count) {
+				return false;
+			}
+		}
+	}
+	for (int k = 0; k < count; k++) {
+		if (next[k] != streams[k].size()) {
+			return false;
+		}
+	}
+	if (flags & COLUMN_NO_NEWLINE) {
+		data.pop_back();
+	}
+	return true;
+}
+
+/** Function Name: decodeColumn(int column, vector<byte>& data)
+ *  Description: Decodes the streams up to column and walks them record by
+ *               record like decodeAll(). A record whose field before
+ *               column ends in a newline has no value in column and gets
+ *               an empty line; the others get the field of column.
+ *  Return Value: False if column does not exist or is malformed
+ */
+bool ColumnDecoder::decodeColumn(int column, vector<byte>& data) {
+	TRACE_SPAN("columns");
+	data.clear();
+	if (column < 0 || column >= (int)rawSizes.size()) {
+		return false;
+	}
+	vector<vector<byte>> streams;
+	if (!decodeStreams(column + 1, streams)) {
+		return false;
+	}
+
+	TRACE_SPAN("stitch");
+	vector<size_t> next(column + 1, 0);
+	while (next[0] < streams[0].size()) {
+		for (int k = 0; k <= column; k++) {
+			const vector<byte>& stream = streams[k];
+			size_t i = next[k];
+			/** The last stream holds every field past it, delimiters and all */
+			bool last = k == COLUMN_MAX - 1;
+			size_t start = i;
+			while (i < stream.size() && stream[i] != '\n'
+				&& (last || stream[i] != delimiter)) {
+				i++;
+			}
+			if (i == stream.size()) {
+				return false;
+			}
+			next[k] = i + 1;
+			if (k == column) {
+				data.insert(data.end(), stream.begin() + start,
+					stream.begin() + i);
+			}
+			else if (stream[i] != '\n') {
+				continue;
+			}
+			data.push_back('\n');
+			break;
+		}
+	}
+	for (int k = 0; k <= column; k++) {
+		if (next[k] != streams[k].size()) {
+			return false;
+		}
+	}
+	return true;
+}
+
+/** Function Name: getColumnCount() const
+ *  Description: Getter for the number of streams
+ *  Return Value: The number of streams
+ */
+int ColumnDecoder::getColumnCount() const {
+	return (int)rawSizes.size();
+}
+
+/** Function Name: getCheckedCount() const
+ *  Description: Getter for the number of streams whose CRC-32 was checked
+ *  Return Value: The value of checkedCount
+ */
+unsigned long long ColumnDecoder::getCheckedCount() const {
+	return checkedCount;
+}
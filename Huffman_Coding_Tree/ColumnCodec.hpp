@@ -0,0 +1,169 @@
+/** Filename: ColumnCodec.hpp
+ *  Name: Loc Chuong
+ *  Description: A columnar format for delimited records such as CSV and TSV.
+ *               Every record is split on the delimiter and field k goes to
+ *               stream k, followed by the byte that ended it: the delimiter,
+ *               or a newline for the last field of the record. Timestamps,
+ *               enums and free text then each get a table of their own
+ *               instead of one table blending them. The ending bytes make
+ *               the split exactly reversible whatever the records hold, and
+ *               let one column be decoded on its own.
+ *
+ *               The file is laid out as
+ *                 COLUMN_MAGIC | version (1 byte) |
+ *                 delimiter (1 byte) | flags (1 byte) |
+ *                 column count (4 bytes) |
+ *                 per column: raw size (4 bytes) | body size (4 bytes) |
+ *                             CRC-32 of the stream (4 bytes) |
+ *                 the bodies, in column order
+ *               where a body is the frequency header padded to a byte
+ *               followed by the padded code bits, and is empty for an empty
+ *               stream. Sizes are little endian.
+ *  Date: 10/18/2026
+ */
+
+#ifndef COLUMNCODEC_HPP
+#define COLUMNCODEC_HPP
+
+#include <iostream>
+#include <vector>
+#include "HCTree.hpp"
+
+#define COLUMN_MAX 64 /** Fields past this go to the last stream */
+#define COLUMN_SAMPLE_SIZE (1 << 16) /** Bytes looked at to pick a delimiter */
+#define COLUMN_NO_NEWLINE 1 /** Flag: the input did not end with a newline */
+#define COLUMN_ALL -1 /** Column index asking for every column */
+#define COLUMN_MAGIC "HCCL" /** First bytes of every columnar file */
+#define COLUMN_MAGIC_SIZE 4 /** Number of bytes in COLUMN_MAGIC */
+#define COLUMN_VERSION 1 /** Format version written after the magic */
+
+using namespace std;
+
+/** Class Name: ColumnEncoder
+ *  Description: Splits delimited records into column streams and codes
+ *               every stream with its own table, several at once.
+ */
+class ColumnEncoder {
+private:
+	int threads; /** Number of streams coded at once */
+	byte delimiter; /** Delimiter of the last input written */
+	int columnCount; /** Number of streams of the last input written */
+
+public:
+	/** Constructor
+	 *  Description: Creates a ColumnEncoder coding up to threads streams at
+	 *               once
+	 */
+	explicit ColumnEncoder(int threads);
+
+	/** Function Name: write(const byte* data, size_t size, ostream& out)
+	 *  Description: Writes data to out in the columnar format
+	 *  Parameters: data - The records
+	 *              size - Number of bytes in data
+	 *              out - The stream to write to
+	 *  Return Value: None
+	 */
+	void write(const byte* data, size_t size, ostream& out);
+
+	/** Function Name: detectDelimiter(const byte* data, size_t size)
+	 *  Description: Picks the delimiter among comma, tab, '|' and ';' that
+	 *               splits the most sampled lines into the same number of
+	 *               fields
+	 *  Return Value: The delimiter, a comma if none of them fits
+	 */
+	static byte detectDelimiter(const byte* data, size_t size);
+
+	/** Function Name: getDelimiter() const
+	 *  Description: Getter for the delimiter of the last input written
+	 *  Return Value: The value of delimiter
+	 */
+	byte getDelimiter() const;
+
+	/** Function Name: getColumnCount() const
+	 *  Description: Getter for the number of streams of the last input
+	 *  Return Value: The value of columnCount
+	 */
+	int getColumnCount() const;
+};
+
+/** Class Name: ColumnDecoder
+ *  Description: Reads a file written by a ColumnEncoder, either whole or
+ *               one column at a time
+ */
+class ColumnDecoder {
+private:
+	istream& in; /** The stream the file is read from */
+	int threads; /** Number of streams decoded at once */
+	byte delimiter; /** Delimiter of the records */
+	byte flags; /** COLUMN_NO_NEWLINE or 0 */
+	vector<unsigned int> rawSizes; /** Decoded size of every stream */
+	vector<unsigned int> bodySizes; /** Coded size of every stream */
+	vector<unsigned int> crcs; /** CRC-32 of every decoded stream */
+	unsigned long long checkedCount; /** Streams whose CRC-32 matched */
+	streamoff bodiesStart; /** Where the first body starts in the file */
+
+	/** Function Name: decodeStreams(int count,
+	 *                               vector<vector<byte>>& streams)
+	 *  Description: Reads and decodes the streams of the first count
+	 *               columns
+	 *  Return Value: False if a stream is malformed or its CRC-32 does not
+	 *                match
+	 */
+	bool decodeStreams(int count, vector<vector<byte>>& streams);
+
+	/** Function Name: decodeBody(const vector<byte>& body, size_t rawSize,
+	 *                            unsigned int crc, vector<byte>& data)
+	 *  Description: Decodes one stream from its body and checks its CRC-32
+	 *  Return Value: False if the body is malformed or the CRC-32 does not
+	 *                match
+	 */
+	static bool decodeBody(const vector<byte>& body, size_t rawSize,
+		unsigned int crc, vector<byte>& data);
+
+public:
+	/** Constructor
+	 *  Description: Creates a ColumnDecoder reading from is, decoding up
+	 *               to threads streams at once
+	 */
+	ColumnDecoder(istream& is, int threads);
+
+	/** Function Name: readDirectory()
+	 *  Description: Reads the magic, delimiter, flags and stream sizes
+	 *  Return Value: False if the file is not columnar or they are
+	 *                malformed
+	 */
+	bool readDirectory();
+
+	/** Function Name: decodeAll(vector<byte>& data)
+	 *  Description: Decodes every stream and stitches the records back
+	 *               together
+	 *  PRECONDITION: readDirectory() succeeded
+	 *  Return Value: False if the file is malformed
+	 */
+	bool decodeAll(vector<byte>& data);
+
+	/** Function Name: decodeColumn(int column, vector<byte>& data)
+	 *  Description: Decodes column alone, one value per line, so line n
+	 *               is the value of record n. Records too short to have the
+	 *               column get an empty line, and the last stream keeps the
+	 *               delimiters of any fields past COLUMN_MAX.
+	 *  PRECONDITION: readDirectory() succeeded
+	 *  Return Value: False if column does not exist or is malformed
+	 */
+	bool decodeColumn(int column, vector<byte>& data);
+
+	/** Function Name: getColumnCount() const
+	 *  Description: Getter for the number of streams
+	 *  Return Value: The number of streams
+	 */
+	int getColumnCount() const;
+
+	/** Function Name: getCheckedCount() const
+	 *  Description: Getter for the number of streams decoded whose CRC-32
+	 *               was checked
+	 *  Return Value: The value of checkedCount
+	 */
+	unsigned long long getCheckedCount() const;
+};
+
+#endif // COLUMNCODEC_HPP
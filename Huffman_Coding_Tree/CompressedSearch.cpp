@@ -0,0 +1,254 @@
+/** Filename: CompressedSearch.cpp
+ *  Name: Loc Chuong
+ *  Description: Substring search over the payload of the single stream
+ *               format, comparing the pattern's codes at every symbol
+ *               boundary and decoding only the lines that match.
+ *  Date: 10/18/2026
+ */
+
+#include "CompressedSearch.hpp"
+#include "Trace.hpp"
+#include <cstring>
+#if defined(_MSC_VER)
+#include <stdlib.h>
+#endif
+
+#define PEEK_BITS 57 /** Bits peekWord() guarantees at any offset */
+
+/** Function Name: peekWord(const byte* in, size_t pos)
+ *  Description: Loads the 64 bits starting at bit pos of in, first bit in
+ *               the top bit. Only the top PEEK_BITS bits are guaranteed to
+ *               come from in, the rest are 0.
+ *  Return Value: The bits at pos
+ */
+static inline unsigned long long peekWord(const byte* in, size_t pos) {
+	/** One unaligned load and a byte swap, this runs once per lookup */
+	unsigned long long word;
+	memcpy(&word, in + (pos >> 3), sizeof(word));
+#if defined(_MSC_VER)
+	word = _byteswap_uint64(word);
+#else
+	word = __builtin_bswap64(word);
+#endif
+	return word << (pos & 7);
+}
+
+/** Constructor
+ *  Description: Creates a search over the count symbols coded from bit
+ *               startBit of in
+ */
+CompressedSearch::CompressedSearch(const HCTree& tree, const byte* in,
+	size_t startBit, size_t count) : tree(tree), in(in), startBit(startBit),
+	count(count) {
+}
+
+/** Function Name: decodeSymbol(size_t& pos) const
+ *  Description: Decodes the symbol whose code starts at bit pos. A lone
+ *               leaf takes no bits.
+ *  Parameters: pos - Advanced past the code
+ *  Return Value: The decoded symbol
+ */
+byte CompressedSearch::decodeSymbol(size_t& pos) const {
+	HCNode* currNode = tree.getRoot();
+	if (currNode->c0 == nullptr) {
+		return (byte)currNode->symbol;
+	}
+	unsigned long long word = peekWord(in, pos);
+	const DecodeEntry& entry =
+		tree.getDecodeTable()[word >> (64 - DECODE_TABLE_BITS)];
+	if (entry.length != 0) {
+		pos += entry.length;
+		return (byte)entry.symbol;
+	}
+	/** Code is longer than the table, walk the tree bit by bit */
+	int used = 0;
+	while (currNode->c0 != nullptr) {
+		if (used == PEEK_BITS) {
+			pos += used;
+			used = 0;
+			word = peekWord(in, pos);
+		}
+		currNode = ((word >> (63 - used)) & 1) ? currNode->c1 : currNode->c0;
+		used++;
+	}
+	pos += used;
+	return (byte)currNode->symbol;
+}
+
+/** Function Name: codePattern(const string& pattern)
+ *  Description: Concatenates the codes of pattern and cuts them into
+ *               pieces of SEARCH_WORD_BITS bits, each compared with one load
+ *  Return Value: False if pattern has a byte the table cannot code
+ */
+bool CompressedSearch::codePattern(const string& pattern) {
+	patternWords.clear();
+	patternWordBits.clear();
+	HCNode* root = tree.getRoot();
+	bool lone = root->c0 == nullptr;
+	unsigned long long word = 0;
+	int wordBits = 0;
+	for (size_t i = 0; i < pattern.size(); i++) {
+		byte symbol = (byte)pattern[i];
+		int length = tree.getCodeLength(symbol);
+		if (length == 0) {
+			return false;
+		}
+		/** The lone leaf of a one-byte file is coded in 0 bits */
+		if (lone) {
+			continue;
+		}
+		unsigned long long code = tree.getCode(symbol);
+		/** Feed the code in bit by bit so pieces can split it anywhere */
+		for (int b = length - 1; b >= 0; b--) {
+			word = (word << 1) | ((code >> b) & 1);
+			wordBits++;
+			if (wordBits == SEARCH_WORD_BITS) {
+				patternWords.push_back(word);
+				patternWordBits.push_back(wordBits);
+				word = 0;
+				wordBits = 0;
+			}
+		}
+	}
+	if (wordBits > 0) {
+		patternWords.push_back(word);
+		patternWordBits.push_back(wordBits);
+	}
+	return true;
+}
+
+/** Function Name: matchesAt(size_t pos) const
+ *  Description: Compares the bits at pos with the pattern codes, one piece
+ *               per load, stopping at the first piece that differs
+ *  Return Value: True if every piece matches
+ */
+bool CompressedSearch::matchesAt(size_t pos) const {
+	for (size_t j = 0; j < patternWords.size(); j++) {
+		int bits = patternWordBits[j];
+		if ((peekWord(in, pos) >> (64 - bits)) != patternWords[j]) {
+			return false;
+		}
+		pos += bits;
+	}
+	return true;
+}
+
+/** Function Name: search(const string& pattern, ostream& out)
+ *  Description: Steps from boundary to boundary, remembering where the
+ *               current line starts. At a match it decodes from there to
+ *               the end of the line, writes it, and carries on after it, so
+ *               a line is written once however often it matches.
+ *  Return Value: The number of matches written
+ */
+unsigned long long CompressedSearch::search(const string& pattern,
+	ostream& out) {
+	TRACE_SPAN("search");
+	if (count == 0 || !codePattern(pattern)) {
+		return 0;
+	}
+	size_t length = pattern.size();
+	unsigned long long matches = 0;
+	unsigned long long lineNumber = 1;
+	size_t pos = startBit;
+	size_t index = 0;
+	size_t lineStart = pos;
+	size_t lineIndex = 0;
+	/** Cheap first check on the head piece before matchesAt() */
+	unsigned long long head = patternWords.empty() ? 0 : patternWords[0];
+	int headShift = patternWords.empty() ? 64 : 64 - patternWordBits[0];
+	const DecodeEntry* table = tree.getDecodeTable().data();
+	const byte* codeLengths = tree.getCodeLengthTable().data();
+	/** Where the tree has a multi-symbol table, windows holding neither the
+	 *  pattern's first byte nor a newline are skipped whole. stops[w] marks
+	 *  the symbols of window w that need a look, all of them when the
+	 *  window holds no whole code.
+	 */
+	const MultiDecodeEntry* multi = length > 0 ?
+		tree.getMultiDecodeTable() : nullptr;
+	vector<byte> stops;
+	if (multi != nullptr) {
+		stops.resize(1 << MULTI_DECODE_BITS);
+		for (int w = 0; w < (1 << MULTI_DECODE_BITS); w++) {
+			const MultiDecodeEntry& entry = multi[w];
+			byte mask = entry.count == 0 ? 0xFF : 0;
+			for (int k = 0; k < entry.count; k++) {
+				if (entry.symbols[k] == (byte)pattern[0]
+					|| entry.symbols[k] == '\n') {
+					mask |= (byte)(1 << k);
+				}
+			}
+			stops[w] = mask;
+		}
+	}
+	while (index < count) {
+		/** One load serves the skip, the head check and the table lookup */
+		unsigned long long word = peekWord(in, pos);
+		if (multi != nullptr && index + MULTI_DECODE_SYMBOLS <= count) {
+			int window = (int)(word >> (64 - MULTI_DECODE_BITS));
+			byte mask = stops[window];
+			if (mask == 0) {
+				pos += multi[window].length;
+				index += multi[window].count;
+				continue;
+			}
+			if (mask != 1) {
+				/** Step over the symbols before the first one to look at */
+				const MultiDecodeEntry& entry = multi[window];
+				int skip = 0;
+				while (skip < entry.count && !(mask & (1 << skip))) {
+					skip++;
+				}
+				if (skip > 0) {
+					for (int k = 0; k < skip; k++) {
+						pos += codeLengths[entry.symbols[k]];
+					}
+					index += skip;
+					continue;
+				}
+			}
+		}
+		bool headMatches = headShift == 64 || (word >> headShift) == head;
+		if (headMatches && index + length <= count && matchesAt(pos)) {
+			/** Decode the line, and any the match runs into */
+			TRACE_SPAN("decode line");
+			string line;
+			size_t matchEnd = index + length;
+			size_t p = lineStart;
+			size_t k = lineIndex;
+			unsigned long long newlines = 0;
+			while (k < count) {
+				byte symbol = decodeSymbol(p);
+				k++;
+				if (symbol == '\n') {
+					newlines++;
+					if (k >= matchEnd) {
+						break;
+					}
+				}
+				line += (char)symbol;
+			}
+			out << lineNumber << ":" << line << "\n";
+			matches++;
+			lineNumber += newlines;
+			pos = lineStart = p;
+			index = lineIndex = k;
+			continue;
+		}
+		const DecodeEntry& entry = table[word >> (64 - DECODE_TABLE_BITS)];
+		byte symbol;
+		if (entry.length != 0) {
+			pos += entry.length;
+			symbol = (byte)entry.symbol;
+		}
+		else {
+			symbol = decodeSymbol(pos);
+		}
+		if (symbol == '\n') {
+			lineStart = pos;
+			lineIndex = index + 1;
+			lineNumber++;
+		}
+		index++;
+	}
+	return matches;
+}
@@ -0,0 +1,81 @@
+/** Filename: CompressedSearch.hpp
+ *  Name: Loc Chuong
+ *  Description: Substring search over the payload of the single stream
+ *               format without decompressing it. The pattern is coded with
+ *               the file's own table, and because Huffman codes are prefix
+ *               free, the bits at a symbol boundary start with the codes of
+ *               the pattern exactly when the symbols there spell it out. So
+ *               the search only has to step from boundary to boundary with
+ *               the decode table and compare bits; no byte is written out
+ *               until a line matches, and only that line is decoded.
+ *  Date: 10/18/2026
+ */
+
+#ifndef COMPRESSEDSEARCH_HPP
+#define COMPRESSEDSEARCH_HPP
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include "HCTree.hpp"
+
+#define SEARCH_WORD_BITS 56 /** Pattern bits compared per load */
+#define SEARCH_PADDING_BYTES 8 /** Readable bytes needed past the input */
+
+using namespace std;
+
+/** Class Name: CompressedSearch
+ *  Description: Finds the lines of a coded payload that hold a pattern and
+ *               decodes only those lines.
+ */
+class CompressedSearch {
+private:
+	const HCTree& tree; /** Table the payload was coded with */
+	const byte* in; /** The coded bytes */
+	size_t startBit; /** Bit where the payload starts */
+	size_t count; /** Number of symbols in the payload */
+	vector<unsigned long long> patternWords; /** Pattern codes, in pieces */
+	vector<int> patternWordBits; /** Bits in each piece, at most 56 */
+
+	/** Function Name: decodeSymbol(size_t& pos) const
+	 *  Description: Decodes the symbol whose code starts at bit pos
+	 *  Parameters: pos - Advanced past the code
+	 *  Return Value: The decoded symbol
+	 */
+	byte decodeSymbol(size_t& pos) const;
+
+	/** Function Name: codePattern(const string& pattern)
+	 *  Description: Fills patternWords with the codes of pattern
+	 *  Return Value: False if pattern has a byte the table cannot code, in
+	 *                which case nothing can match
+	 */
+	bool codePattern(const string& pattern);
+
+	/** Function Name: matchesAt(size_t pos) const
+	 *  Description: Whether the bits at pos start with the pattern codes
+	 *  Return Value: True if they do
+	 */
+	bool matchesAt(size_t pos) const;
+
+public:
+	/** Constructor
+	 *  Description: Creates a search over the count symbols coded from bit
+	 *               startBit of in
+	 *  PRECONDITION: in stays valid and holds SEARCH_PADDING_BYTES readable
+	 *                bytes past the payload
+	 */
+	CompressedSearch(const HCTree& tree, const byte* in, size_t startBit,
+		size_t count);
+
+	/** Function Name: search(const string& pattern, ostream& out)
+	 *  Description: Writes every line holding pattern to out, prefixed with
+	 *               its line number like grep -n. A match running over a
+	 *               newline writes every line it touches as one.
+	 *  Parameters: pattern - The bytes to look for
+	 *              out - Receives the matching lines
+	 *  Return Value: The number of matches written
+	 */
+	unsigned long long search(const string& pattern, ostream& out);
+};
+
+#endif // COMPRESSEDSEARCH_HPP
@@ -0,0 +1,271 @@
+/** Filename: ContextModel.cpp
+ *  Name: Loc Chuong
+ *  Description: Order-1 context model for the block format, with rare
+ *               contexts merged into a shared fallback table.
+ *  Date: 10/18/2026
+ */
+
+#include "ContextModel.hpp"
+#include "BitKernels.hpp"
+#include "Trace.hpp"
+#include <climits>
+#include <cmath>
+
+/** Constructor
+ *  Description: Creates an empty model
+ */
+ContextModel::ContextModel() : countedSize(0), freqs(ASCII_MAX + 1),
+	trees(ASCII_MAX + 1) {
+	for (int c = 0; c < ASCII_MAX; c++) {
+		tableOf[c] = CONTEXT_NONE;
+		treeOf[c] = nullptr;
+	}
+}
+
+/** Function Name: buildTrees()
+ *  Description: Builds the trees for freqs and fills treeOf. Context tables
+ *               rarely repeat, so they skip HCTableCache rather than evict
+ *               the order-0 tables it holds.
+ *  Return Value: None
+ */
+void ContextModel::buildTrees() {
+	for (int t = 0; t <= ASCII_MAX; t++) {
+		trees[t].reset();
+		if (!freqs[t].empty()) {
+			shared_ptr<HCTree> tree = make_shared<HCTree>();
+			tree->build(freqs[t]);
+			trees[t] = tree;
+		}
+	}
+	for (int c = 0; c < ASCII_MAX; c++) {
+		treeOf[c] = tableOf[c] == CONTEXT_NONE ? nullptr
+			: trees[tableOf[c]].get();
+	}
+}
+
+/** Function Name: count(const byte* data, size_t size)
+ *  Description: Counts the order-1 histogram of data. The first byte is
+ *               counted after byte 0.
+ *  Return Value: None
+ */
+void ContextModel::count(const byte* data, size_t size) {
+	counts.assign(ASCII_MAX * ASCII_MAX, 0);
+	contextTotals.assign(ASCII_MAX, 0);
+	countedSize = size;
+	byte prev = 0;
+	for (size_t i = 0; i < size; i++) {
+		counts[prev * ASCII_MAX + data[i]]++;
+		contextTotals[prev]++;
+		prev = data[i];
+	}
+}
+
+/** Function Name: lowerBoundBits() const
+ *  Description: Order-1 entropy of the counted bytes, which no context
+ *               model beats
+ *  Return Value: The bound in bits
+ */
+double ContextModel::lowerBoundBits() const {
+	double bits = 0;
+	for (int c = 0; c < ASCII_MAX; c++) {
+		if (contextTotals[c] == 0) {
+			continue;
+		}
+		for (int s = 0; s < ASCII_MAX; s++) {
+			int count = counts[c * ASCII_MAX + s];
+			if (count != 0) {
+				bits += count * log2((double)contextTotals[c] / count);
+			}
+		}
+	}
+	return bits;
+}
+
+/** Function Name: build()
+ *  Description: Builds the tables of the counted bytes. A context gets its
+ *               own table when its header plus its entropy is smaller than
+ *               coding it with the order-0 histogram of the block, which
+ *               stands in for the fallback.
+ *  Return Value: None
+ */
+void ContextModel::build() {
+	TRACE_SPAN("context model");
+	vector<int> order0(ASCII_MAX, 0);
+	for (int c = 0; c < ASCII_MAX; c++) {
+		for (int s = 0; s < ASCII_MAX; s++) {
+			order0[s] += counts[c * ASCII_MAX + s];
+		}
+	}
+	for (int t = 0; t <= ASCII_MAX; t++) {
+		freqs[t].clear();
+	}
+	vector<int> fallback(ASCII_MAX, 0);
+	bool anyFallback = false;
+	for (int c = 0; c < ASCII_MAX; c++) {
+		const int* row = &counts[c * ASCII_MAX];
+		int total = contextTotals[c];
+		if (total == 0) {
+			tableOf[c] = CONTEXT_NONE;
+			continue;
+		}
+		double ownBits = 0;
+		double sharedBits = 0;
+		for (int s = 0; s < ASCII_MAX; s++) {
+			if (row[s] != 0) {
+				ownBits += row[s] * log2((double)total / row[s]);
+				sharedBits += row[s] * log2((double)countedSize / order0[s]);
+			}
+		}
+		vector<int> own(row, row + ASCII_MAX);
+		if (ownBits + HCTree::headerBits(own) < sharedBits) {
+			tableOf[c] = c;
+			freqs[c].swap(own);
+			continue;
+		}
+		tableOf[c] = CONTEXT_FALLBACK;
+		for (int s = 0; s < ASCII_MAX; s++) {
+			fallback[s] += row[s];
+		}
+		anyFallback = true;
+	}
+	if (anyFallback) {
+		freqs[CONTEXT_FALLBACK].swap(fallback);
+	}
+	buildTrees();
+}
+
+/** Function Name: headerBits() const
+ *  Description: Size of the header writeHeader() writes: a fallback flag,
+ *               one flag per context, then the frequency headers
+ *  Return Value: The header size in bits
+ */
+int ContextModel::headerBits() const {
+	int bits = 1 + ASCII_MAX;
+	for (int t = 0; t <= ASCII_MAX; t++) {
+		if (!freqs[t].empty()) {
+			bits += HCTree::headerBits(freqs[t]);
+		}
+	}
+	return bits;
+}
+
+/** Function Name: payloadBits() const
+ *  Description: Number of code bits encode() writes for the block the
+ *               model was built from
+ *  Return Value: The payload size in bits
+ */
+unsigned long long ContextModel::payloadBits() const {
+	unsigned long long bits = 0;
+	for (int t = 0; t <= ASCII_MAX; t++) {
+		if (freqs[t].empty()) {
+			continue;
+		}
+		/** A lone leaf costs nothing, see encodeContext() */
+		HCNode* root = trees[t]->getRoot();
+		if (root->c0 == nullptr) {
+			continue;
+		}
+		for (int s = 0; s < ASCII_MAX; s++) {
+			bits += (unsigned long long)freqs[t][s]
+				* trees[t]->getCodeLength((byte)s);
+		}
+	}
+	return bits;
+}
+
+/** Function Name: writeHeader(BitOutputStream& out) const
+ *  Description: Writes the header readHeader() rebuilds the model from
+ *  Return Value: None
+ */
+void ContextModel::writeHeader(BitOutputStream& out) const {
+	out.writeBit(freqs[CONTEXT_FALLBACK].empty() ? 0 : 1);
+	for (int c = 0; c < ASCII_MAX; c++) {
+		out.writeBit(tableOf[c] == c ? 1 : 0);
+	}
+	/** Fallback first, then the own tables in context order */
+	if (!freqs[CONTEXT_FALLBACK].empty()) {
+		HCTree::writeHeader(freqs[CONTEXT_FALLBACK], out);
+	}
+	for (int c = 0; c < ASCII_MAX; c++) {
+		if (tableOf[c] == c) {
+			HCTree::writeHeader(freqs[c], out);
+		}
+	}
+}
+
+/** Function Name: readHeader(BitInputStream& in)
+ *  Description: Rebuilds a model from a header written by writeHeader()
+ *  Return Value: The number of bytes the tables code, -1 if malformed
+ */
+int ContextModel::readHeader(BitInputStream& in) {
+	bool hasFallback = in.readBits() != 0;
+	for (int c = 0; c < ASCII_MAX; c++) {
+		tableOf[c] = in.readBits() != 0 ? c
+			: (hasFallback ? CONTEXT_FALLBACK : CONTEXT_NONE);
+	}
+	for (int t = 0; t <= ASCII_MAX; t++) {
+		freqs[t].clear();
+	}
+	long long total = 0;
+	for (int t = -1; t < ASCII_MAX; t++) {
+		/** Fallback first, then the own tables in context order */
+		int table = t < 0 ? CONTEXT_FALLBACK : t;
+		if (t < 0 ? !hasFallback : tableOf[t] != t) {
+			continue;
+		}
+		int tableTotal = HCTree::readHeader(in, freqs[table]);
+		/** An empty table cannot be built */
+		if (tableTotal <= 0 || total + tableTotal > INT_MAX) {
+			return -1;
+		}
+		total += tableTotal;
+	}
+	buildTrees();
+	return (int)total;
+}
+
+/** Function Name: encode(const byte* data, size_t size,
+ *                        vector<byte>& out) const
+ *  Description: Appends the codes of data to out, padded to a byte
+ *  Return Value: The number of code bits appended, without padding
+ */
+size_t ContextModel::encode(const byte* data, size_t size,
+	vector<byte>& out) const {
+	TRACE_SPAN("encode");
+	int maxLength = 0;
+	for (int t = 0; t <= ASCII_MAX; t++) {
+		if (trees[t] && trees[t]->getMaxCodeLength() > maxLength) {
+			maxLength = trees[t]->getMaxCodeLength();
+		}
+	}
+	size_t start = out.size();
+	out.resize(start + (size * maxLength + 7) / 8);
+	size_t bits = encodeContext(treeOf, data, size, out.data() + start);
+	out.resize(start + (bits + 7) / 8);
+	return bits;
+}
+
+/** Function Name: decode(const byte* in, size_t inSize, byte* out,
+ *                        size_t count) const
+ *  Description: Decodes count bytes written by encode()
+ *  Return Value: False if the codes run past the end of in
+ */
+bool ContextModel::decode(const byte* in, size_t inSize, byte* out,
+	size_t count) const {
+	TRACE_SPAN("decode");
+	return decodeContext(treeOf, in, inSize, out, count);
+}
+
+/** Function Name: getTableCount() const
+ *  Description: Getter for the number of tables, fallback included
+ *  Return Value: The number of tables in the model
+ */
+int ContextModel::getTableCount() const {
+	int count = 0;
+	for (int t = 0; t <= ASCII_MAX; t++) {
+		if (!freqs[t].empty()) {
+			count++;
+		}
+	}
+	return count;
+}
@@ -0,0 +1,121 @@
+/** Filename: ContextModel.hpp
+ *  Name: Loc Chuong
+ *  Description: Order-1 context model for the block format. Every byte is
+ *               coded with a Huffman table picked by the byte before it, so
+ *               text, where the next byte depends strongly on the last one,
+ *               codes well below its order-0 size. Contexts too rare to pay
+ *               for their own header share one fallback table.
+ *  Date: 10/18/2026
+ */
+
+#ifndef CONTEXTMODEL_HPP
+#define CONTEXTMODEL_HPP
+
+#include <memory>
+#include <vector>
+#include "HCTree.hpp"
+
+#define CONTEXT_MIN_BLOCK 4096 /** Smaller blocks are not worth modeling */
+#define CONTEXT_NONE -1 /** Context index of a context that never occurs */
+#define CONTEXT_FALLBACK 256 /** Context index of the shared fallback table */
+
+using namespace std;
+
+/** Class Name: ContextModel
+ *  Description: The order-1 tables of one block: one per context that pays
+ *               for its own header, plus the fallback shared by the rest.
+ *               The header lists which contexts have their own table, then
+ *               the fallback's frequency header and every own table's.
+ */
+class ContextModel {
+private:
+	vector<int> counts; /** Order-1 histogram, counts[prev * 256 + byte] */
+	vector<int> contextTotals; /** Bytes seen after each byte */
+	size_t countedSize; /** Number of bytes counted */
+	vector<vector<int>> freqs; /** Histogram per table, by context index */
+	int tableOf[ASCII_MAX]; /** Table used after each byte */
+	vector<shared_ptr<const HCTree>> trees; /** Tree per context index */
+	const HCTree* treeOf[ASCII_MAX]; /** trees, looked up by previous byte */
+
+	/** Function Name: buildTrees()
+	 *  Description: Builds the trees for freqs and fills treeOf
+	 *  Return Value: None
+	 */
+	void buildTrees();
+
+public:
+	/** Constructor
+	 *  Description: Creates an empty model
+	 */
+	ContextModel();
+
+	/** Function Name: count(const byte* data, size_t size)
+	 *  Description: Counts the order-1 histogram of data
+	 *  Return Value: None
+	 */
+	void count(const byte* data, size_t size);
+
+	/** Function Name: lowerBoundBits() const
+	 *  Description: Order-1 entropy of the counted bytes. No context model
+	 *               codes them in fewer bits, so the caller can skip build()
+	 *               when this already loses.
+	 *  Return Value: The bound in bits
+	 */
+	double lowerBoundBits() const;
+
+	/** Function Name: build()
+	 *  Description: Builds the tables of the counted bytes, merging the
+	 *               contexts that would cost more with their own header
+	 *               than coded by the order-0 histogram
+	 *  Return Value: None
+	 */
+	void build();
+
+	/** Function Name: headerBits() const
+	 *  Description: Size of the header writeHeader() writes
+	 *  Return Value: The header size in bits
+	 */
+	int headerBits() const;
+
+	/** Function Name: payloadBits() const
+	 *  Description: Number of code bits encode() writes for the block the
+	 *               model was built from
+	 *  Return Value: The payload size in bits
+	 */
+	unsigned long long payloadBits() const;
+
+	/** Function Name: writeHeader(BitOutputStream& out) const
+	 *  Description: Writes the header readHeader() rebuilds the model from
+	 *  Return Value: None
+	 */
+	void writeHeader(BitOutputStream& out) const;
+
+	/** Function Name: readHeader(BitInputStream& in)
+	 *  Description: Rebuilds a model from a header written by writeHeader()
+	 *  Return Value: The number of bytes the tables code, -1 if malformed
+	 */
+	int readHeader(BitInputStream& in);
+
+	/** Function Name: encode(const byte* data, size_t size,
+	 *                        vector<byte>& out) const
+	 *  Description: Appends the codes of data to out, padded to a byte
+	 *  PRECONDITION: The model was counted from data and built
+	 *  Return Value: The number of code bits appended, without padding
+	 */
+	size_t encode(const byte* data, size_t size, vector<byte>& out) const;
+
+	/** Function Name: decode(const byte* in, size_t inSize, byte* out,
+	 *                        size_t count) const
+	 *  Description: Decodes count bytes written by encode()
+	 *  Return Value: False if the codes run past the end of in
+	 */
+	bool decode(const byte* in, size_t inSize, byte* out, size_t count) const;
+
+	/** Function Name: getTableCount() const
+	 *  Description: Getter for the number of tables, fallback included
+	 *  Return Value: The number of tables in the model
+	 */
+	int getTableCount() const;
+};
+
+#endif // CONTEXTMODEL_HPP
@@ -0,0 +1,85 @@
+/** Filename: CpuFeatures.cpp
+ *  Name: Loc Chuong
+ *  Description: Detects, once per process, which optional x86 instruction
+ *               set extensions the host supports.
+ *  Date: 10/18/2026
+ */
+
+#include "CpuFeatures.hpp"
+
+#if HC_X64
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+#if HC_X64
+/** Function Name: cpuid(int leaf, int subleaf, unsigned int regs[4])
+ *  Description: Runs CPUID, filling regs with eax, ebx, ecx and edx
+ *  Return Value: None
+ */
+static void cpuid(int leaf, int subleaf, unsigned int regs[4]) {
+#if defined(_MSC_VER)
+	__cpuidex((int*)regs, leaf, subleaf);
+#else
+	__cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+}
+
+/** Function Name: xcr0()
+ *  Description: Reads the XCR0 register, which says which register states
+ *               the OS saves on a context switch
+ *  Return Value: The low 32 bits of XCR0
+ */
+static unsigned int xcr0() {
+#if defined(_MSC_VER)
+	return (unsigned int)_xgetbv(0);
+#else
+	unsigned int eax, edx;
+	__asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+	return eax;
+#endif
+}
+#endif
+
+/** Function Name: detect()
+ *  Description: Queries CPUID for the features we dispatch on
+ *  Return Value: The features of the host
+ */
+static CpuFeatures detect() {
+	CpuFeatures features = { false, false, false, false, false };
+#if HC_X64
+	unsigned int regs[4];
+	cpuid(0, 0, regs);
+	unsigned int maxLeaf = regs[0];
+	cpuid(1, 0, regs);
+	features.sse41 = (regs[2] & (1u << 19)) != 0;
+	features.pclmul = (regs[2] & (1u << 1)) != 0;
+	bool osxsave = (regs[2] & (1u << 27)) != 0;
+	bool avx = (regs[2] & (1u << 28)) != 0;
+	/** The OS has to save xmm and ymm state for AVX2 to be usable */
+	bool ymmSaved = osxsave && (xcr0() & 6) == 6;
+	if (maxLeaf >= 7) {
+		cpuid(7, 0, regs);
+		features.bmi2 = (regs[1] & (1u << 8)) != 0;
+		features.avx2 = avx && ymmSaved && (regs[1] & (1u << 5)) != 0;
+	}
+	cpuid(0x80000000, 0, regs);
+	if (regs[0] >= 0x80000001) {
+		cpuid(0x80000001, 0, regs);
+		features.lzcnt = (regs[2] & (1u << 5)) != 0;
+	}
+#endif
+	return features;
+}
+
+/** Function Name: cpuFeatures()
+ *  Description: Runs CPUID the first time it is called and caches the result
+ *  Return Value: The features of the host
+ */
+const CpuFeatures& cpuFeatures() {
+	static const CpuFeatures features = detect();
+	return features;
+}
@@ -0,0 +1,46 @@
+/** Filename: CpuFeatures.hpp
+ *  Name: Loc Chuong
+ *  Description: Detects, once per process, which optional x86 instruction
+ *               set extensions the host supports so the hot loops can pick
+ *               the best compiled variant at runtime.
+ *  Date: 10/18/2026
+ */
+
+#ifndef CPUFEATURES_HPP
+#define CPUFEATURES_HPP
+
+/** HC_X64 is set when the x86-64 only kernels can be compiled */
+#if defined(_M_X64) || defined(__x86_64__)
+#define HC_X64 1
+#else
+#define HC_X64 0
+#endif
+
+/** HC_TARGET(isa) lets GCC and Clang compile one function for isa without
+ *  raising the baseline of the whole build. MSVC needs nothing for this.
+ */
+#if defined(__GNUC__) || defined(__clang__)
+#define HC_TARGET(isa) __attribute__((target(isa)))
+#else
+#define HC_TARGET(isa)
+#endif
+
+/** Struct Name: CpuFeatures
+ *  Description: The extensions the host supports. Every flag is false on
+ *               hosts that are not x86-64.
+ */
+struct CpuFeatures {
+	bool bmi2; /** bzhi, pdep, pext, shlx, shrx */
+	bool lzcnt; /** lzcnt */
+	bool sse41; /** SSE4.1 */
+	bool avx2; /** AVX2, including OS support for the ymm registers */
+	bool pclmul; /** pclmulqdq */
+};
+
+/** Function Name: cpuFeatures()
+ *  Description: Runs CPUID the first time it is called and caches the result
+ *  Return Value: The features of the host
+ */
+const CpuFeatures& cpuFeatures();
+
+#endif // CPUFEATURES_HPP
@@ -0,0 +1,242 @@
+/** Filename: Crc32.cpp
+ *  Name: Loc Chuong
+ *  Description: CRC-32 a byte at a time, sliced by 8, and folded with
+ *               PCLMULQDQ, with the variant picked once from CPUID.
+ *  Date: 10/18/2026
+ */
+
+#include "Crc32.hpp"
+#include "CpuFeatures.hpp"
+
+#if HC_X64
+#include <immintrin.h>
+#endif
+
+#define CRC32_FOLD_BYTES 64 /** Bytes the PCLMULQDQ loop folds at a time */
+#define CRC32_LANE_BYTES 16 /** Bytes in one folded lane */
+
+/** Struct Name: Crc32Tables
+ *  Description: table[0][b] is the CRC-32 step of byte b on its own, and
+ *               table[k][b] that of b followed by k zero bytes
+ */
+struct Crc32Tables {
+	unsigned int table[CRC32_SLICES][256];
+};
+
+/** Function Name: buildCrc32Tables()
+ *  Description: Builds the slice tables at compile time
+ *  Return Value: The tables
+ */
+static constexpr Crc32Tables buildCrc32Tables() {
+	Crc32Tables tables = {};
+	for (unsigned int i = 0; i < 256; i++) {
+		unsigned int crc = i;
+		for (int bit = 0; bit < 8; bit++) {
+			crc = (crc >> 1) ^ ((crc & 1) ? CRC32_POLYNOMIAL : 0);
+		}
+		tables.table[0][i] = crc;
+	}
+	for (int k = 1; k < CRC32_SLICES; k++) {
+		for (int i = 0; i < 256; i++) {
+			unsigned int prev = tables.table[k - 1][i];
+			tables.table[k][i] = (prev >> 8) ^ tables.table[0][prev & 0xFF];
+		}
+	}
+	return tables;
+}
+
+static constexpr Crc32Tables crcTables = buildCrc32Tables();
+
+/** Function Name: bytewiseState(const byte* data, size_t size,
+ *                               unsigned int state)
+ *  Description: Runs the inverted CRC state over data a byte at a time
+ *  Return Value: The new state
+ */
+static inline unsigned int bytewiseState(const byte* data, size_t size,
+	unsigned int state) {
+	for (size_t i = 0; i < size; i++) {
+		state = crcTables.table[0][(state ^ data[i]) & 0xFF] ^ (state >> 8);
+	}
+	return state;
+}
+
+/** Function Name: sliceState(const byte* data, size_t size,
+ *                            unsigned int state)
+ *  Description: Runs the inverted CRC state over data eight bytes at a
+ *               time, one lookup per byte in eight independent tables
+ *  Return Value: The new state
+ */
+static inline unsigned int sliceState(const byte* data, size_t size,
+	unsigned int state) {
+	const unsigned int (*t)[256] = crcTables.table;
+	for (; size >= 8; data += 8, size -= 8) {
+		unsigned int one = state ^ (data[0] | (data[1] << 8)
+			| (data[2] << 16) | ((unsigned int)data[3] << 24));
+		unsigned int two = data[4] | (data[5] << 8) | (data[6] << 16)
+			| ((unsigned int)data[7] << 24);
+		state = t[7][one & 0xFF] ^ t[6][(one >> 8) & 0xFF]
+			^ t[5][(one >> 16) & 0xFF] ^ t[4][one >> 24]
+			^ t[3][two & 0xFF] ^ t[2][(two >> 8) & 0xFF]
+			^ t[1][(two >> 16) & 0xFF] ^ t[0][two >> 24];
+	}
+	return bytewiseState(data, size, state);
+}
+
+/** Function Name: crc32Bytewise(const byte* data, size_t size,
+ *                               unsigned int crc)
+ *  Description: Continues crc a byte at a time
+ *  Return Value: The CRC-32 of everything so far
+ */
+static unsigned int crc32Bytewise(const byte* data, size_t size,
+	unsigned int crc) {
+	return ~bytewiseState(data, size, ~crc);
+}
+
+/** Function Name: crc32Slice8(const byte* data, size_t size,
+ *                             unsigned int crc)
+ *  Description: Continues crc eight bytes at a time
+ *  Return Value: The CRC-32 of everything so far
+ */
+static unsigned int crc32Slice8(const byte* data, size_t size,
+	unsigned int crc) {
+	return ~sliceState(data, size, ~crc);
+}
+
+#if HC_X64
+/** Function Name: foldState(const byte* data, size_t size,
+ *                           unsigned int state)
+ *  Description: Runs the inverted CRC state over data with carry-less
+ *               multiplies: four lanes of 16 bytes are folded forward 64
+ *               bytes at a time, then into one lane, then the rest of the
+ *               lanes are folded in one by one and the 128 bit remainder is
+ *               Barrett reduced to 32 bits. The constants are the powers of
+ *               x modulo the polynomial from the Intel paper "Fast CRC
+ *               Computation for Generic Polynomials Using PCLMULQDQ".
+ *  PRECONDITION: size >= CRC32_FOLD_BYTES and a multiple of
+ *                CRC32_LANE_BYTES
+ *  Return Value: The new state
+ */
+HC_TARGET("pclmul,sse4.1")
+static unsigned int foldState(const byte* data, size_t size,
+	unsigned int state) {
+	const __m128i k1k2 = _mm_set_epi64x(0x01c6e41596LL, 0x0154442bd4LL);
+	const __m128i k3k4 = _mm_set_epi64x(0x00ccaa009eLL, 0x01751997d0LL);
+	const __m128i k5k0 = _mm_set_epi64x(0, 0x0163cd6124LL);
+	const __m128i poly = _mm_set_epi64x(0x01f7011641LL, 0x01db710641LL);
+	const __m128i mask32 = _mm_setr_epi32(~0, 0, ~0, 0);
+
+	__m128i x1 = _mm_loadu_si128((const __m128i*)(data + 0x00));
+	__m128i x2 = _mm_loadu_si128((const __m128i*)(data + 0x10));
+	__m128i x3 = _mm_loadu_si128((const __m128i*)(data + 0x20));
+	__m128i x4 = _mm_loadu_si128((const __m128i*)(data + 0x30));
+	x1 = _mm_xor_si128(x1, _mm_cvtsi32_si128((int)state));
+	data += CRC32_FOLD_BYTES;
+	size -= CRC32_FOLD_BYTES;
+
+	/** Fold the four lanes forward over the next 64 bytes */
+	for (; size >= CRC32_FOLD_BYTES; data += CRC32_FOLD_BYTES,
+		size -= CRC32_FOLD_BYTES) {
+		__m128i x5 = _mm_clmulepi64_si128(x1, k1k2, 0x00);
+		__m128i x6 = _mm_clmulepi64_si128(x2, k1k2, 0x00);
+		__m128i x7 = _mm_clmulepi64_si128(x3, k1k2, 0x00);
+		__m128i x8 = _mm_clmulepi64_si128(x4, k1k2, 0x00);
+		x1 = _mm_clmulepi64_si128(x1, k1k2, 0x11);
+		x2 = _mm_clmulepi64_si128(x2, k1k2, 0x11);
+		x3 = _mm_clmulepi64_si128(x3, k1k2, 0x11);
+		x4 = _mm_clmulepi64_si128(x4, k1k2, 0x11);
+		x1 = _mm_xor_si128(_mm_xor_si128(x1, x5),
+			_mm_loadu_si128((const __m128i*)(data + 0x00)));
+		x2 = _mm_xor_si128(_mm_xor_si128(x2, x6),
+			_mm_loadu_si128((const __m128i*)(data + 0x10)));
+		x3 = _mm_xor_si128(_mm_xor_si128(x3, x7),
+			_mm_loadu_si128((const __m128i*)(data + 0x20)));
+		x4 = _mm_xor_si128(_mm_xor_si128(x4, x8),
+			_mm_loadu_si128((const __m128i*)(data + 0x30)));
+	}
+
+	/** Fold the four lanes into one, then the remaining lanes into it */
+	__m128i lanes[3] = { x2, x3, x4 };
+	for (int i = 0; i < 3; i++) {
+		__m128i x5 = _mm_clmulepi64_si128(x1, k3k4, 0x00);
+		x1 = _mm_clmulepi64_si128(x1, k3k4, 0x11);
+		x1 = _mm_xor_si128(_mm_xor_si128(x1, lanes[i]), x5);
+	}
+	for (; size >= CRC32_LANE_BYTES; data += CRC32_LANE_BYTES,
+		size -= CRC32_LANE_BYTES) {
+		__m128i x5 = _mm_clmulepi64_si128(x1, k3k4, 0x00);
+		x1 = _mm_clmulepi64_si128(x1, k3k4, 0x11);
+		x1 = _mm_xor_si128(_mm_xor_si128(x1,
+			_mm_loadu_si128((const __m128i*)data)), x5);
+	}
+
+	/** Fold 128 bits down to 64 */
+	__m128i x2f = _mm_clmulepi64_si128(x1, k3k4, 0x10);
+	x1 = _mm_xor_si128(_mm_srli_si128(x1, 8), x2f);
+	x2f = _mm_srli_si128(x1, 4);
+	x1 = _mm_clmulepi64_si128(_mm_and_si128(x1, mask32), k5k0, 0x00);
+	x1 = _mm_xor_si128(x1, x2f);
+
+	/** Barrett reduce to 32 bits */
+	x2f = _mm_clmulepi64_si128(_mm_and_si128(x1, mask32), poly, 0x10);
+	x2f = _mm_clmulepi64_si128(_mm_and_si128(x2f, mask32), poly, 0x00);
+	x1 = _mm_xor_si128(x1, x2f);
+	return (unsigned int)_mm_extract_epi32(x1, 1);
+}
+
+/** Function Name: crc32Pclmul(const byte* data, size_t size,
+ *                             unsigned int crc)
+ *  Description: Continues crc by folding the whole 16 byte lanes with
+ *               PCLMULQDQ and slicing the bytes left over
+ *  Return Value: The CRC-32 of everything so far
+ */
+static unsigned int crc32Pclmul(const byte* data, size_t size,
+	unsigned int crc) {
+	unsigned int state = ~crc;
+	if (size >= CRC32_FOLD_BYTES) {
+		size_t folded = size & ~(size_t)(CRC32_LANE_BYTES - 1);
+		state = foldState(data, folded, state);
+		data += folded;
+		size -= folded;
+	}
+	return ~sliceState(data, size, state);
+}
+#endif
+
+static const Crc32Kernel bytewiseKernel = { "bytewise", crc32Bytewise };
+static const Crc32Kernel slice8Kernel = { "slice8", crc32Slice8 };
+#if HC_X64
+static const Crc32Kernel pclmulKernel = { "pclmul", crc32Pclmul };
+#endif
+
+/** Function Name: availableCrc32Kernels()
+ *  Description: Every variant this host can run, slowest first
+ *  Return Value: Pointers to the runnable variants
+ */
+vector<const Crc32Kernel*> availableCrc32Kernels() {
+	vector<const Crc32Kernel*> kernels;
+	kernels.push_back(&bytewiseKernel);
+	kernels.push_back(&slice8Kernel);
+#if HC_X64
+	if (cpuFeatures().pclmul && cpuFeatures().sse41) {
+		kernels.push_back(&pclmulKernel);
+	}
+#endif
+	return kernels;
+}
+
+/** Function Name: crc32Kernel()
+ *  Description: The fastest variant this host supports, picked once
+ *  Return Value: The selected kernel
+ */
+const Crc32Kernel& crc32Kernel() {
+	static const Crc32Kernel* selected = availableCrc32Kernels().back();
+	return *selected;
+}
+
+/** Function Name: crc32(const byte* data, size_t size, unsigned int crc)
+ *  Description: Continues the CRC-32 of some bytes over size more
+ *  Return Value: The CRC-32 of everything so far
+ */
+unsigned int crc32(const byte* data, size_t size, unsigned int crc) {
+	return crc32Kernel().update(data, size, crc);
+}
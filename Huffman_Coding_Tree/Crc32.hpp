@@ -0,0 +1,61 @@
+/** Filename: Crc32.hpp
+ *  Name: Loc Chuong
+ *  Description: The CRC-32 of zlib and PNG, reflected polynomial 0xEDB88320,
+ *               used to check decoded blocks and the members of a packed
+ *               archive. It comes in three variants producing the same
+ *               value: a byte at a time from one table, eight bytes at a
+ *               time from eight tables, and 64 bytes at a time folded with
+ *               carry-less multiplies (PCLMULQDQ). The fastest one the host
+ *               runs is picked once, from CPUID.
+ *  Date: 10/18/2026
+ */
+
+#ifndef CRC32_HPP
+#define CRC32_HPP
+
+#include <cstddef>
+#include <vector>
+#include "HCNode.hpp"
+
+#define CRC32_POLYNOMIAL 0xEDB88320u /** Reflected CRC-32 polynomial */
+#define CRC32_SLICES 8 /** Tables of the slice-by-8 variant */
+
+using namespace std;
+
+/** Struct Name: Crc32Kernel
+ *  Description: One compiled variant of the CRC-32 loop
+ */
+struct Crc32Kernel {
+	const char* name; /** Name shown in benchmark output */
+
+	/** Function Name: update(const byte* data, size_t size, unsigned int crc)
+	 *  Description: Continues the CRC-32 crc over size more bytes
+	 *  Return Value: The CRC-32 of everything so far
+	 */
+	unsigned int(*update)(const byte* data, size_t size, unsigned int crc);
+};
+
+/** Function Name: crc32Kernel()
+ *  Description: The fastest variant this host supports, picked once
+ *  Return Value: The selected kernel
+ */
+const Crc32Kernel& crc32Kernel();
+
+/** Function Name: availableCrc32Kernels()
+ *  Description: Every variant this host can run, slowest first. Used by the
+ *               benchmark to compare them.
+ *  Return Value: Pointers to the runnable variants
+ */
+vector<const Crc32Kernel*> availableCrc32Kernels();
+
+/** Function Name: crc32(const byte* data, size_t size, unsigned int crc)
+ *  Description: Continues the CRC-32 of some bytes over size more, with
+ *               the variant picked by crc32Kernel()
+ *  Parameters: data - The bytes to add
+ *              size - Number of bytes in data
+ *              crc - CRC-32 of the bytes before data, 0 to start
+ *  Return Value: The CRC-32 of everything so far
+ */
+unsigned int crc32(const byte* data, size_t size, unsigned int crc = 0);
+
+#endif // CRC32_HPP
@@ -6,13 +6,35 @@
  */
 
 #include "HCTree.hpp"
+#include "HCTableCache.hpp"
+#include "BlockCodec.hpp"
+#include "ArchiveCodec.hpp"
+#include "AppendCodec.hpp"
+#include "ColumnCodec.hpp"
+#include "PackArchive.hpp"
+#include "CompressedSearch.hpp"
+#include "SizeEstimator.hpp"
+#include "Benchmark.hpp"
+#include "ParallelDecoder.hpp"
+#include "Pipeline.hpp"
+#include "BatchIO.hpp"
+#include "RunStats.hpp"
+#include "Trace.hpp"
+#include <algorithm>
+#include <cstdlib>
 #include <fstream>
 #include <sstream>
 #include <string>
 #include <iostream>
+#include <thread>
 #include "math.h"
 
-#define DECODE_EOF -1 /** End of file reached for decoded as non-ASCII value */
+#if defined(_WIN32)
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
 #define ACTION_ARG 1 /** Argument number to denote command */
 #define INFILE_ARG 2 /** Argument number for the inFile */
 #define OUTFILE_ARG 3 /** Argument number for the outFile */
@@ -21,14 +43,32 @@
 
 using namespace std;
 
-/** Function Name: uncompress(string inputFile, string outputFile)
+/** Struct Name: RunOptions
+ *  Description: Switches given on the command line after the file names
+ */
+struct RunOptions {
+	bool pipeline; /** --pipeline, overlap reading, coding and writing */
+	bool uring; /** Cleared by --no-uring, keeps batches off io_uring */
+	bool stats; /** --stats, print run statistics as JSON afterwards */
+	string trace; /** --trace=<file>, write Chrome trace JSON to the file */
+	int column; /** --column=<n>, cuncompress writes only column n */
+	int samplePercent; /** --sample=<percent>, compress from a sample */
+	bool shareTables; /** Cleared by --no-share, one table per member */
+	string member; /** --member=<name>, unpack extracts only that member */
+	bool verify; /** --verify, bcompress decodes every block as it goes */
+};
+
+/** Function Name: uncompress(string inputFile, string outputFile,
+ *                            RunStats* stats)
  *  Description: The function that will drive the Huffman Coding Tree program's
  *               uncompress functionality.
  *  Parameters: inputFile - Name of file that will be uncompressed
  *              outputFIle - Desired name of file to uncompress to
+ *              stats - Filled in with the phase timings if not nullptr
  *  Return Value: The success of the program as an int
  */
-int uncompress(string inputFile, string outputFile) {
+int uncompress(string inputFile, string outputFile,
+	RunStats* stats = nullptr) {
 	/** Open the input file for reading */
 	ifstream inFile(inputFile, ios::binary);
 	/** Create BitInputStream to read at the bit level */
@@ -42,75 +82,170 @@ int uncompress(string inputFile, string outputFile) {
 
 	/** Seek to end of file */
 	inFile.seekg(0, ios::end);
+	/** Size of the compressed file in bytes */
+	streamoff fileSize = inFile.tellg();
 
 	/** Check for empty file */
-	if (inFile.tellg() == 0) {
+	if (fileSize == 0) {
 		return 0;
 	}
 	/** Seek back to beginning of file */
 	inFile.clear();
 	inFile.seekg(0, ios::beg);
 
-	/** Create HCTree to hold ASCII values and their frequency */
-	HCTree* HCT = new HCTree();
-	/** Read in the max frequency number of bits */
-	int uniqASCII = inBIS.readInt(BIT_SIZE_UNIQ_ASCII);
-	/** Read in the number of bits needed to store frequency of ASCII */
-	int bitFreqs = inBIS.readInt(BIT_SIZE_BIT_FREQS);
-	/** Holds the total number of ASCII in the uncompressed message */
-	int totalFreq = 0;
-	/** Read in the correct number of uniq ASCII */
-	for (int i = 0; i < uniqASCII; i++) {
-		/** Read the ASCII char itself */
-		byte ASCII = inBIS.readByte();
-		/** Read the frequency of the ASCII char */
-		int freq = inBIS.readInt(bitFreqs);
-		/** Increment the total frequency of all ASCII */
-		totalFreq += freq;
-		/** Set the frequency of the ASCII char in the freqs vector */
-		freqs[(int)ASCII] = freq;
-	}
-	/** Build the Huffman coding tree using freqs vector */
-	HCT->build(freqs);
+	/** Read the frequency header, which also gives the message length */
+	int totalFreq;
+	{
+		PhaseTimer timer(stats, PHASE_HEADER);
+		TRACE_SPAN("header");
+		totalFreq = HCTree::readHeader(inBIS, freqs);
+	}
+	/** A header with no symbols in a file that is not empty is corrupt */
+	if (totalFreq <= 0) {
+		cout << "Corrupt header in " << inputFile << endl;
+		return -1;
+	}
+	/** Fetch the Huffman coding tree for freqs, built once per header */
+	shared_ptr<const HCTree> HCT;
+	{
+		PhaseTimer timer(stats, PHASE_BUILD);
+		TRACE_SPAN("acquire tree");
+		HCT = HCTableCache::global().acquire(freqs);
+	}
 
+	/** The payload is decoded in memory */
+	vector<byte> coded((size_t)fileSize + PARALLEL_PADDING_BYTES, 0);
+	{
+		PhaseTimer timer(stats, PHASE_IO);
+		TRACE_SPAN("io");
+		ifstream codedFile(inputFile, ios::binary);
+		codedFile.read((char*)coded.data(), fileSize);
+	}
 	/** Create string as buffer for uncompressed message */
-	string lastLine = string();
-	/** Decode for a total of all the ASCII characters in the message */
-	for (int i = 0; i < totalFreq; i++) {
-		/** Holds the next ASCII character decoded */
-		int nextChar;
-		/** Error checking and decodes binary to ASCII */
-		if ((nextChar = HCT->decode(inBIS)) != DECODE_EOF) {
-			/** Append to the output string */
-			lastLine += (unsigned char)nextChar;
+	string lastLine = string(totalFreq, '\0');
+	size_t startBit = HCTree::headerBits(freqs);
+	bool decoded = false;
+	{
+		PhaseTimer timer(stats, PHASE_DECODE);
+		TRACE_SPAN("decode");
+		/** Large payloads are decoded on every core when there is more
+		 *  than one */
+		int threads = (int)thread::hardware_concurrency();
+		if (threads > 1 && fileSize * 8 >= 2 * PARALLEL_MIN_CHUNK_BITS) {
+			ParallelDecoder decoder(*HCT, coded.data(), (size_t)fileSize);
+			decoded = decoder.decode(startBit, totalFreq,
+				(byte*)&lastLine[0], threads);
+		}
+		/** Otherwise with the bulk loop picked for this CPU */
+		if (!decoded) {
+			decoded = HCT->decodeBits(coded.data(), (size_t)fileSize,
+				startBit, (byte*)&lastLine[0], totalFreq);
 		}
 	}
+	if (!decoded) {
+		cout << "Corrupt payload in " << inputFile << endl;
+		return -1;
+	}
 	/** Output uncompressed message to outFile */
-	outFile << lastLine;
-
-	/** Close output file */
-	outFile.close();
-	/** Close input file */
-	inFile.close();
-	/** Deallocate HCTree */
-	delete HCT;
+	{
+		PhaseTimer timer(stats, PHASE_IO);
+		TRACE_SPAN("io");
+		outFile << lastLine;
+		/** Close output file */
+		outFile.close();
+		/** Close input file */
+		inFile.close();
+	}
+	if (stats != nullptr) {
+		stats->headerBytes = (HCTree::headerBits(freqs) + 7) / 8;
+		stats->setCode(freqs, *HCT);
+	}
 	/** Return successful program */
 	return 0;
 }
 
-/** Function Name: compress(string inputFile, string outputFile)
+/** Function Name: sampleFrequencies(ifstream& inFile, streamoff fileSize,
+ *                                   int samplePercent, vector<int>& freqs)
+ *  Description: Counts one chunk out of every 100 / samplePercent, spread
+ *               evenly over inFile, and scales the counts to the whole file
+ *               with scaleSample()
+ *  Parameters: inFile - The file to sample, left at an unspecified place
+ *              fileSize - Size of inFile in bytes
+ *              samplePercent - Share of the file to read, in percent
+ *              freqs - Set to the scaled histogram
+ *  Return Value: False if the file is too small to sample, in which case
+ *                it should be counted whole
+ */
+static bool sampleFrequencies(ifstream& inFile, streamoff fileSize,
+	int samplePercent, vector<int>& freqs) {
+	TRACE_SPAN("sample");
+	streamoff stride = (streamoff)BLOCK_SIZE * 100 / samplePercent;
+	/** A single chunk would read as much as counting the whole file */
+	if (fileSize <= stride) {
+		return false;
+	}
+	vector<byte> chunk(BLOCK_SIZE);
+	unsigned long long sampleBytes = 0;
+	for (streamoff pos = 0; pos < fileSize; pos += stride) {
+		inFile.clear();
+		inFile.seekg(pos, ios::beg);
+		inFile.read((char*)chunk.data(), BLOCK_SIZE);
+		streamsize size = inFile.gcount();
+		for (streamsize i = 0; i < size; i++) {
+			freqs[chunk[i]]++;
+		}
+		sampleBytes += size;
+	}
+	return scaleSample(freqs, sampleBytes, fileSize);
+}
+
+/** Function Name: printSampleCost(const vector<int>& freqs,
+ *                                 const vector<int>& exactFreqs,
+ *                                 const HCTree& tree)
+ *  Description: Prints what the table built from a sample spent against
+ *               what a table built from the exact counts would
+ *  Parameters: freqs - The sampled frequencies tree was built from
+ *              exactFreqs - The exact frequencies of the file
+ *              tree - The tree the file was coded with
+ *  Return Value: None
+ */
+static void printSampleCost(const vector<int>& freqs,
+	const vector<int>& exactFreqs, const HCTree& tree) {
+	unsigned long long sampledBits = HCTree::headerBits(freqs);
+	for (int i = 0; i < ASCII_MAX; i++) {
+		sampledBits += (unsigned long long)exactFreqs[i]
+			* tree.getCodeLength(i);
+	}
+	SizeEstimate exact = estimateSize(exactFreqs);
+	unsigned long long sampledBytes = (sampledBits + 7) / 8;
+	cout << "Sampled table: " << sampledBytes << " bytes, exact table: "
+		<< exact.compressedBytes << " bytes ("
+		<< 100.0 * ((double)sampledBytes - exact.compressedBytes)
+			/ exact.compressedBytes
+		<< "% more)" << endl;
+}
+
+/** Function Name: compress(string inputFile, string outputFile,
+ *                          RunStats* stats)
  *  Description: The function that will drive the Huffman Coding Tree program's
  *               compress functionality. The driver will take in two arguments,
  *               an inputFile and an outputFile. inputFile will consist of either
  *               an empty file or a series of ASCII characters to compress.
  *               outputFile will be the compressed version of the inputFile
  *               using the Huffman Coding Tree.
+ *               With samplePercent set, the table is built from that share
+ *               of the file instead of a full first pass, and what that
+ *               cost against the exact table is printed at the end.
  *  Parameters: inputFile - the filename to the file to be compressed
  *              outputFile - the filename to the compressed ver. of inputFile
  *                           using a Huffman Coding Tree
+ *              stats - Filled in with the phase timings if not nullptr
+ *              samplePercent - Share of the file to build the table from,
+ *                              in percent, or 0 to count all of it
  *  Return Value: The success of the program as an int
  */
-int compress(string inputFile, string outputFile) {
+int compress(string inputFile, string outputFile, RunStats* stats = nullptr,
+	int samplePercent = 0) {
 
 	/** Open the input file for reading */
 	ifstream inFile(inputFile, ios::in);
@@ -118,8 +253,6 @@ int compress(string inputFile, string outputFile) {
 	ofstream outFile(outputFile, ios::binary);
 	/** Create BitOutputStream to write at the bit level */
 	BitOutputStream outBOS = BitOutputStream(outFile);
-	/** Read bytes from the file and count occurences of each byte value */
-	unsigned char nextChar;
 	/** Create int vector to hold ASCII frequency */
 	vector<int> freqs(ASCII_MAX);
 
@@ -133,49 +266,53 @@ int compress(string inputFile, string outputFile) {
 	inFile.clear();
 	inFile.seekg(0, ios::beg);
 
-	/** Max frequency in vector of ASCII vals */
-	double maxFreq = 0;
-	/** Number of unique ASCII characters in our HCTree */
-	unsigned int uniqASCII = 0;
-	/** Populate freqs vector with characters from file */
-	while (1) {
-		nextChar = (unsigned char)inFile.get();
-		if (inFile.eof()) break;
-		/** Increment frequency of ASCII value */
-		freqs[nextChar]++;
-		/** Find the largest frequency of all the ASCII values */
-		if (freqs[nextChar] > maxFreq) {
-			/** Reassign max value of frequency to larger value */
-			maxFreq = freqs[nextChar];
-		}
-	}
-	/** Construct the Huffman coding tree using freqs vector */
-	HCTree* HCT = new HCTree();
-	/** Build Huffman coding tree */
-	HCT->build(freqs);
-	/** Find the number of unique ASCII values */
-	for (int i = 0; i < freqs.size(); i++) {
-		if (freqs[i] != 0) {
-			uniqASCII++;
-		}
-	}
-	/** Write the number of unique ASCII values */
-	outBOS.writeInt(uniqASCII, BIT_SIZE_UNIQ_ASCII);
-
-	/** Convert number of bits needed to store max frequency to byte */
-	byte bitFreqs = (byte)(floor(log2(maxFreq)) + 1);
-
-	/** Write the number of bits needed to represent the max frequency */
-	outBOS.writeInt(bitFreqs, BIT_SIZE_BIT_FREQS);
-	/** Open the output file for writing */
-	for (int i = 0; i < freqs.size(); i++) {
-		/** Only write ASCII values that have frequency over 0 */
-		if (freqs[i] != 0) {
-			/** Write ASCII char as byte to output file */
-			outBOS.writeByte((byte)i);
-			/** Write frequency of ASCII char as byte to output file */
-			outBOS.writeInt(freqs[i], (int)bitFreqs);
+	/** Populate freqs vector with characters from file, a chunk at a time */
+	vector<byte> chunk(BLOCK_SIZE);
+	/** Exact counts, taken during the encode pass when sampling */
+	vector<int> exactFreqs;
+	bool sampled = false;
+	if (samplePercent > 0 && samplePercent < 100) {
+		PhaseTimer timer(stats, PHASE_HISTOGRAM);
+		inFile.seekg(0, ios::end);
+		streamoff fileSize = inFile.tellg();
+		sampled = sampleFrequencies(inFile, fileSize, samplePercent, freqs);
+		if (sampled) {
+			exactFreqs.assign(ASCII_MAX, 0);
 		}
+		else {
+			freqs.assign(ASCII_MAX, 0);
+		}
+		inFile.clear();
+		inFile.seekg(0, ios::beg);
+	}
+	while (!sampled) {
+		streamsize size;
+		{
+			PhaseTimer timer(stats, PHASE_IO);
+			TRACE_SPAN("io");
+			inFile.read((char*)chunk.data(), BLOCK_SIZE);
+			size = inFile.gcount();
+		}
+		if (size == 0) break;
+		PhaseTimer timer(stats, PHASE_HISTOGRAM);
+		TRACE_SPAN("histogram");
+		/** Increment frequency of each ASCII value */
+		for (streamsize i = 0; i < size; i++) {
+			freqs[chunk[i]]++;
+		}
+	}
+	/** Fetch the Huffman coding tree for freqs, built once per header */
+	shared_ptr<const HCTree> HCT;
+	{
+		PhaseTimer timer(stats, PHASE_BUILD);
+		TRACE_SPAN("acquire tree");
+		HCT = HCTableCache::global().acquire(freqs);
+	}
+	/** Write the frequency header the tree is rebuilt from */
+	{
+		PhaseTimer timer(stats, PHASE_HEADER);
+		TRACE_SPAN("header");
+		HCTree::writeHeader(freqs, outBOS);
 	}
 	/** Print out header size */
 	cout << "Header size is: " << (int)outFile.tellp() << " bytes" << endl;
@@ -183,13 +320,22 @@ int compress(string inputFile, string outputFile) {
 	/** Move file iterator to beginning of file */
 	inFile.clear();
 	inFile.seekg(0, ios::beg);
-	/** Encode the ASCII characters from inFile */
+	/** Encode the ASCII characters from inFile a chunk at a time */
 	while (1) {
-		/** Holds the next ASCII char from the input stream */
-		nextChar = (unsigned char)inFile.get();
-		/** Error checking */
-		if (inFile.eof()) break;
-		HCT->encode(nextChar, outBOS);
+		streamsize size;
+		{
+			PhaseTimer timer(stats, PHASE_IO);
+			TRACE_SPAN("io");
+			inFile.read((char*)chunk.data(), BLOCK_SIZE);
+			size = inFile.gcount();
+		}
+		if (size == 0) break;
+		PhaseTimer timer(stats, PHASE_ENCODE);
+		TRACE_SPAN("encode");
+		HCT->encodeBlock(chunk.data(), (size_t)size, outBOS);
+		for (streamsize i = 0; sampled && i < size; i++) {
+			exactFreqs[chunk[i]]++;
+		}
 	}
 	/** Add padding bits to end if a full byte was not written */
 	while (outBOS.getnbits() != 0) {
@@ -197,48 +343,1314 @@ int compress(string inputFile, string outputFile) {
 		outBOS.writeBit(0);
 	}
 
+	{
+		PhaseTimer timer(stats, PHASE_IO);
+		TRACE_SPAN("io");
+		/** Close the output file */
+		outFile.close();
+		/** Close the input file */
+		inFile.close();
+	}
+	if (sampled) {
+		printSampleCost(freqs, exactFreqs, *HCT);
+	}
+	if (stats != nullptr) {
+		stats->headerBytes = (HCTree::headerBits(freqs) + 7) / 8;
+		stats->setCode(sampled ? exactFreqs : freqs, *HCT);
+	}
+
+	/** Uncompress the message */
+	return 0;
+}
+
+/** Function Name: compressPipelined(string inputFile, string outputFile,
+ *                                   RunStats* stats, int samplePercent)
+ *  Description: Same as compress(), but a reader thread reads ahead and a
+ *               writer thread writes behind while this thread counts and
+ *               encodes, so disk waits overlap with coding. The output is
+ *               identical to compress() with the same samplePercent. The
+ *               reads and writes happen on the stage threads, so only the
+ *               coding phases are timed.
+ *  Parameters: inputFile - the filename to the file to be compressed
+ *              outputFile - the filename to the compressed ver. of inputFile
+ *                           using a Huffman Coding Tree
+ *              stats - Filled in with the phase timings if not nullptr
+ *              samplePercent - Share of the file to build the table from,
+ *                              in percent, or 0 to count all of it
+ *  Return Value: The success of the program as an int
+ */
+int compressPipelined(string inputFile, string outputFile,
+	RunStats* stats = nullptr, int samplePercent = 0) {
+	/** Open the input file for reading */
+	ifstream inFile(inputFile, ios::in);
+	/** Open the output file for writing */
+	ofstream outFile(outputFile, ios::binary);
+	/** Create int vector to hold ASCII frequency */
+	vector<int> freqs(ASCII_MAX);
+	/** Holds the buffer being worked on */
+	PipelineBuffer* buffer;
+
+	/** Seek to end of file */
+	inFile.seekg(0, ios::end);
+	streamoff fileSize = inFile.tellg();
+	/** Check for empty file */
+	if (fileSize == 0) {
+		return 0;
+	}
+	/** Exact counts, taken during the encode pass when sampling */
+	vector<int> exactFreqs;
+	bool sampled = false;
+	if (samplePercent > 0 && samplePercent < 100) {
+		PhaseTimer timer(stats, PHASE_HISTOGRAM);
+		sampled = sampleFrequencies(inFile, fileSize, samplePercent, freqs);
+		if (sampled) {
+			exactFreqs.assign(ASCII_MAX, 0);
+		}
+		else {
+			freqs.assign(ASCII_MAX, 0);
+		}
+	}
+	inFile.clear();
+	inFile.seekg(0, ios::beg);
+
+	/** First pass, count occurences of each byte value */
+	if (!sampled) {
+		ReadStage reader(inFile);
+		while ((buffer = reader.next()) != nullptr) {
+			PhaseTimer timer(stats, PHASE_HISTOGRAM);
+			TRACE_SPAN("histogram");
+			for (size_t i = 0; i < buffer->size; i++) {
+				freqs[buffer->data[i]]++;
+			}
+			reader.recycle(buffer);
+		}
+	}
+	/** Fetch the Huffman coding tree for freqs, built once per header */
+	shared_ptr<const HCTree> HCT;
+	{
+		PhaseTimer timer(stats, PHASE_BUILD);
+		TRACE_SPAN("acquire tree");
+		HCT = HCTableCache::global().acquire(freqs);
+	}
+
+	/** Second pass, encode while the next buffer is read and the last one
+	 *  is written
+	 */
+	inFile.clear();
+	inFile.seekg(0, ios::beg);
+	{
+		ReadStage reader(inFile);
+		WriteStage writer(outFile);
+		{
+			WriteStageBuf writeBuf(writer);
+			ostream coded(&writeBuf);
+			BitOutputStream outBOS = BitOutputStream(coded);
+			/** Write the frequency header the tree is rebuilt from */
+			{
+				PhaseTimer timer(stats, PHASE_HEADER);
+				HCTree::writeHeader(freqs, outBOS);
+			}
+			/** Print out header size, in the whole bytes it fills */
+			cout << "Header size is: " << HCTree::headerBits(freqs) / 8
+				<< " bytes" << endl;
+			while ((buffer = reader.next()) != nullptr) {
+				PhaseTimer timer(stats, PHASE_ENCODE);
+				TRACE_SPAN("encode");
+				HCT->encodeBlock(buffer->data.data(), buffer->size, outBOS);
+				for (size_t i = 0; sampled && i < buffer->size; i++) {
+					exactFreqs[buffer->data[i]]++;
+				}
+				reader.recycle(buffer);
+			}
+			/** Append padding bits to end if the full byte was not written */
+			while (outBOS.getnbits() != 0) {
+				outBOS.writeBit(0);
+			}
+		}
+		writer.finish();
+	}
+
 	/** Close the output file */
 	outFile.close();
 	/** Close the input file */
 	inFile.close();
-	/** Deallocate HCTree */
-	delete HCT;
+	if (sampled) {
+		printSampleCost(freqs, exactFreqs, *HCT);
+	}
+	if (stats != nullptr) {
+		stats->headerBytes = (HCTree::headerBits(freqs) + 7) / 8;
+		stats->setCode(sampled ? exactFreqs : freqs, *HCT);
+	}
+	return 0;
+}
 
-	/** Uncompress the message */
+/** Function Name: uncompressPipelined(string inputFile, string outputFile,
+ *                                     RunStats* stats)
+ *  Description: Same as uncompress(), but a reader thread reads ahead and a
+ *               writer thread writes behind while this thread decodes a
+ *               buffer of symbols at a time with the bulk loop picked for
+ *               this CPU. Only the coding phases are timed.
+ *  Parameters: inputFile - Name of file that will be uncompressed
+ *              outputFile - Desired name of file to uncompress to
+ *              stats - Filled in with the phase timings if not nullptr
+ *  Return Value: The success of the program as an int
+ */
+int uncompressPipelined(string inputFile, string outputFile,
+	RunStats* stats = nullptr) {
+	/** Open the input file for reading */
+	ifstream inFile(inputFile, ios::binary);
+	/** Open the output file for writing */
+	ofstream outFile;
+	outFile.open(outputFile);
+	bool valid = true;
+	{
+		ReadStage reader(inFile);
+		WriteStage writer(outFile);
+		{
+			ReadStageBuf readBuf(reader);
+			istream coded(&readBuf);
+			WriteStageBuf writeBuf(writer);
+			ostream decoded(&writeBuf);
+			/** Check for empty file */
+			if (coded.peek() == EOF) {
+				return 0;
+			}
+			/** Coded bytes read so far and not yet decoded. Two buffers
+			 *  hold any header, and keep one buffer of symbols from ever
+			 *  running short unless its codes average over 16 bits.
+			 */
+			vector<byte> pending;
+			auto readMore = [&coded, &pending]() {
+				size_t size = pending.size();
+				pending.resize(size + PIPELINE_BUFFER_SIZE);
+				coded.read((char*)pending.data() + size, PIPELINE_BUFFER_SIZE);
+				pending.resize(size + (size_t)coded.gcount());
+				return coded.gcount() > 0;
+			};
+			readMore();
+			readMore();
+			/** Read the frequency header, which also gives the length */
+			vector<int> freqs(ASCII_MAX);
+			int totalFreq;
+			{
+				PhaseTimer timer(stats, PHASE_HEADER);
+				istringstream header(string(pending.begin(), pending.end()));
+				BitInputStream inBIS = BitInputStream(header);
+				totalFreq = HCTree::readHeader(inBIS, freqs);
+			}
+			size_t bit = HCTree::headerBits(freqs);
+			valid = totalFreq > 0 && bit <= pending.size() * BUFFER_SIZE;
+			/** Fetch the Huffman coding tree for freqs */
+			shared_ptr<const HCTree> HCT;
+			if (valid) {
+				PhaseTimer timer(stats, PHASE_BUILD);
+				HCT = HCTableCache::global().acquire(freqs);
+			}
+			/** Decoded bytes are handed on a buffer at a time */
+			vector<byte> chunk(PIPELINE_BUFFER_SIZE);
+			TRACE_SPAN("decode");
+			size_t left = valid ? (size_t)totalFreq : 0;
+			while (left > 0) {
+				/** Drop the bytes decoded, keep two buffers ahead */
+				size_t used = bit / BUFFER_SIZE;
+				pending.erase(pending.begin(), pending.begin() + used);
+				bit -= used * BUFFER_SIZE;
+				while (pending.size() < 2 * PIPELINE_BUFFER_SIZE) {
+					if (!readMore()) break;
+				}
+				size_t count = min(left, (size_t)PIPELINE_BUFFER_SIZE);
+				size_t endBit = 0;
+				bool decodedChunk;
+				{
+					PhaseTimer timer(stats, PHASE_DECODE);
+					decodedChunk = HCT->decodeBits(pending.data(),
+						pending.size(), bit, chunk.data(), count, &endBit);
+				}
+				if (!decodedChunk) {
+					/** Codes ran past what was read, try again with more */
+					if (readMore()) {
+						continue;
+					}
+					valid = false;
+					break;
+				}
+				decoded.write((const char*)chunk.data(), count);
+				left -= count;
+				bit = endBit;
+			}
+			if (valid && stats != nullptr) {
+				stats->headerBytes = (HCTree::headerBits(freqs) + 7) / 8;
+				stats->setCode(freqs, *HCT);
+			}
+		}
+		writer.finish();
+	}
+	if (!valid) {
+		cout << "Corrupt payload in " << inputFile << endl;
+		return -1;
+	}
+
+	/** Close output file */
+	outFile.close();
+	/** Close input file */
+	inFile.close();
 	return 0;
 }
 
+/** Function Name: writeBlocks(istream& in, ostream& out,
+ *                             BlockEncoder& encoder, ostringstream& coded,
+ *                             VerifyStage* verifier)
+ *  Description: Codes in a block at a time. Without a verifier encoder
+ *               writes to out itself. With one, encoder writes to coded,
+ *               and every block is copied from there to out and handed to
+ *               the verifier along with its input.
+ *  Return Value: None
+ */
+static void writeBlocks(istream& in, ostream& out, BlockEncoder& encoder,
+	ostringstream& coded, VerifyStage* verifier) {
+	/** Holds one block of input */
+	vector<byte> block(BLOCK_SIZE);
+	while (1) {
+		in.read((char*)block.data(), BLOCK_SIZE);
+		streamsize size = in.gcount();
+		if (size == 0) break;
+		if (verifier == nullptr) {
+			encoder.writeBlock(block.data(), (size_t)size);
+			continue;
+		}
+		/** The verifier keeps the block and hands back a buffer to read
+		 *  the next one into */
+		VerifyBuffer* buffer = verifier->acquire();
+		block.resize((size_t)size);
+		buffer->input.swap(block);
+		block.resize(BLOCK_SIZE);
+		encoder.writeBlock(buffer->input.data(), (size_t)size);
+		buffer->coded = coded.str();
+		coded.str("");
+		out.write(buffer->coded.data(), buffer->coded.size());
+		verifier->submit(buffer);
+	}
+	encoder.finish();
+	if (verifier != nullptr) {
+		string end = coded.str();
+		out.write(end.data(), end.size());
+	}
+}
+
+/** Function Name: compressBlocks(string inputFile, string outputFile,
+ *                                bool verify)
+ *  Description: Compresses inputFile into the block format, where every
+ *               block is coded with a new table, the previous block's table,
+ *               or stored raw, whichever is estimated to be smallest, after
+ *               the filters that pay for themselves on it. With verify, every
+ *               block is also decoded on a background thread while the next
+ *               ones are coded, and compared with the input still in memory.
+ *  Parameters: inputFile - the filename to the file to be compressed
+ *              outputFile - the filename to write the blocks to
+ *              verify - Whether to verify every block
+ *  Return Value: The success of the program as an int, -1 if a block did
+ *                not verify
+ */
+int compressBlocks(string inputFile, string outputFile, bool verify) {
+	/** Open the input file for reading */
+	ifstream inFile(inputFile, ios::binary);
+	/** Open the output file for writing */
+	ofstream outFile(outputFile, ios::binary);
+	/** When verifying, blocks are coded into memory so their bytes can go
+	 *  to both the file and the verifier */
+	ostringstream coded;
+	BlockEncoder encoder(verify ? (ostream&)coded : (ostream&)outFile);
+	bool verified = true;
+	unsigned long long verifiedBlocks = 0;
+	unsigned long long verifiedBytes = 0;
+	if (verify) {
+		VerifyStage verifier;
+		writeBlocks(inFile, outFile, encoder, coded, &verifier);
+		verified = verifier.finish();
+		verifiedBlocks = verifier.getVerifiedBlocks();
+		verifiedBytes = verifier.getVerifiedBytes();
+	}
+	else {
+		writeBlocks(inFile, outFile, encoder, coded, nullptr);
+	}
+	/** Print out how the blocks were written */
+	cout << "Blocks: " << encoder.getModeCount(BLOCK_NEW) << " new, "
+		<< encoder.getModeCount(BLOCK_REUSE) << " reused, "
+		<< encoder.getModeCount(BLOCK_RAW) << " raw, "
+		<< encoder.getModeCount(BLOCK_CONTEXT) << " context, "
+		<< encoder.getModeCount(BLOCK_ANS) << " tANS, "
+		<< encoder.getModeCount(BLOCK_STATIC) << " static, "
+		<< encoder.getModeCount(BLOCK_TOKEN) << " token, "
+		<< encoder.getFilteredCount() << " filtered" << endl;
+	if (!verified) {
+		cout << "Verify failed after " << verifiedBlocks << " blocks" << endl;
+		return -1;
+	}
+	if (verify) {
+		cout << "Verified: " << verifiedBlocks << " blocks, " << verifiedBytes
+			<< " bytes" << endl;
+	}
+
+	/** Close the output file */
+	outFile.close();
+	/** Close the input file */
+	inFile.close();
+	return 0;
+}
+
+/** Function Name: uncompressBlocks(string inputFile, string outputFile)
+ *  Description: Uncompresses a file written by compressBlocks()
+ *  Parameters: inputFile - Name of file that will be uncompressed
+ *              outputFile - Desired name of file to uncompress to
+ *  Return Value: The success of the program as an int
+ */
+int uncompressBlocks(string inputFile, string outputFile) {
+	/** Open the input file for reading */
+	ifstream inFile(inputFile, ios::binary);
+	/** Open the output file for writing */
+	ofstream outFile(outputFile, ios::binary);
+	BlockDecoder decoder(inFile);
+	/** Holds one decoded block */
+	vector<byte> block;
+	int mode;
+	while ((mode = decoder.readBlock(block)) != BLOCK_END) {
+		if (mode == BLOCK_ERROR) {
+			cout << "Corrupt block in " << inputFile << endl;
+			return -1;
+		}
+		outFile.write((const char*)block.data(), block.size());
+	}
+
+	/** Close output file */
+	outFile.close();
+	/** Close input file */
+	inFile.close();
+	return 0;
+}
+
+/** Function Name: appendLog(string inputFile, string outputFile)
+ *  Description: Appends inputFile to the log outputFile as one new segment
+ *               of blocks, creating the log if it does not exist. Only the
+ *               last footer of the log is read and nothing already in it
+ *               is rewritten.
+ *  Parameters: inputFile - the filename to the file to be appended
+ *              outputFile - the filename of the log
+ *  Return Value: The success of the program as an int
+ */
+int appendLog(string inputFile, string outputFile) {
+	/** Open the input file for reading */
+	ifstream inFile(inputFile, ios::binary);
+	if (!inFile) {
+		cout << "Could not open " << inputFile << endl;
+		return -1;
+	}
+	/** Create the log if needed, then open it for reading and writing */
+	ofstream(outputFile, ios::binary | ios::app).close();
+	fstream logFile(outputFile, ios::in | ios::out | ios::binary);
+	AppendEncoder encoder(logFile);
+	if (!encoder.open()) {
+		cout << "Corrupt log " << outputFile << endl;
+		return -1;
+	}
+	/** Holds one block of input */
+	vector<byte> block(BLOCK_SIZE);
+	while (1) {
+		inFile.read((char*)block.data(), BLOCK_SIZE);
+		streamsize size = inFile.gcount();
+		if (size == 0) break;
+		encoder.writeBlock(block.data(), (size_t)size);
+	}
+	encoder.finish();
+	/** Print out what the log holds now */
+	cout << "Log: " << encoder.getSegmentCount() << " segments, "
+		<< encoder.getTotalSize() << " bytes" << endl;
+
+	/** Close the log */
+	logFile.close();
+	/** Close the input file */
+	inFile.close();
+	return 0;
+}
+
+/** Function Name: uncompressLog(string inputFile, string outputFile)
+ *  Description: Uncompresses every segment of a log written by appendLog()
+ *               into one file, in the order they were appended
+ *  Parameters: inputFile - Name of the log
+ *              outputFile - Desired name of file to uncompress to
+ *  Return Value: The success of the program as an int
+ */
+int uncompressLog(string inputFile, string outputFile) {
+	/** Open the input file for reading */
+	ifstream inFile(inputFile, ios::binary);
+	AppendDecoder decoder(inFile);
+	if (!decoder.readIndex()) {
+		cout << "Corrupt log " << inputFile << endl;
+		return -1;
+	}
+	/** Open the output file for writing */
+	ofstream outFile(outputFile, ios::binary);
+	for (size_t i = 0; i < decoder.getSegments().size(); i++) {
+		if (!decoder.decodeSegment(i, &outFile)) {
+			cout << "Corrupt segment " << i << " in " << inputFile << endl;
+			return -1;
+		}
+	}
+
+	/** Close output file */
+	outFile.close();
+	/** Close input file */
+	inFile.close();
+	return 0;
+}
+
+/** Function Name: testFile(string inputFile)
+ *  Description: Decodes a block stream, BWT archive, columnar file, packed
+ *               archive or log in memory and checks every CRC-32 it
+ *               carries, without writing anything. The formats are told
+ *               apart by their magic; anything else is read as a block
+ *               stream.
+ *  Parameters: inputFile - Name of file to check
+ *  Return Value: 0 if the file decodes and every checksum matches
+ */
+int testFile(string inputFile) {
+	/** Open the input file for reading */
+	ifstream inFile(inputFile, ios::binary);
+	if (!inFile) {
+		cout << "Could not open " << inputFile << endl;
+		return -1;
+	}
+	char magic[PACK_MAGIC_SIZE];
+	inFile.read(magic, PACK_MAGIC_SIZE);
+	string kind(magic, (size_t)inFile.gcount());
+	inFile.clear();
+	inFile.seekg(0);
+	/** Number of decoded bytes and of checksums that matched */
+	unsigned long long bytes = 0;
+	unsigned long long checks = 0;
+	bool valid = true;
+	if (kind.compare(PACK_MAGIC) == 0) {
+		PackReader reader(inFile);
+		valid = reader.readDirectory();
+		vector<byte> data;
+		for (size_t i = 0; valid && i < reader.getEntries().size(); i++) {
+			valid = reader.extract(i, data);
+			bytes += data.size();
+			checks++;
+		}
+	}
+	else if (kind.compare(APPEND_MAGIC) == 0) {
+		AppendDecoder decoder(inFile);
+		valid = decoder.readIndex();
+		for (size_t i = 0; valid && i < decoder.getSegments().size(); i++) {
+			valid = decoder.decodeSegment(i, nullptr);
+			bytes += decoder.getSegments()[i].rawSize;
+			checks++;
+		}
+	}
+	else if (kind.compare(ARCHIVE_MAGIC) == 0) {
+		ArchiveDecoder decoder(inFile, (int)thread::hardware_concurrency());
+		vector<byte> block;
+		int mode;
+		while ((mode = decoder.readBlock(block)) != ARCHIVE_END) {
+			if (mode == ARCHIVE_ERROR) {
+				valid = false;
+				break;
+			}
+			bytes += block.size();
+		}
+		checks = decoder.getCheckedCount();
+	}
+	else if (kind.compare(COLUMN_MAGIC) == 0) {
+		ColumnDecoder decoder(inFile, (int)thread::hardware_concurrency());
+		vector<byte> data;
+		valid = decoder.readDirectory() && decoder.decodeAll(data);
+		bytes = data.size();
+		checks = decoder.getCheckedCount();
+	}
+	else {
+		BlockDecoder decoder(inFile);
+		vector<byte> block;
+		int mode;
+		while ((mode = decoder.readBlock(block)) != BLOCK_END) {
+			if (mode == BLOCK_ERROR) {
+				valid = false;
+				break;
+			}
+			bytes += block.size();
+		}
+		checks = decoder.getCheckedCount();
+	}
+	if (!valid) {
+		cout << "Corrupt: " << inputFile << endl;
+		return -1;
+	}
+	/** Print out what was checked */
+	cout << "OK: " << bytes << " bytes, " << checks << " checksums matched"
+		<< endl;
+
+	/** Close input file */
+	inFile.close();
+	return 0;
+}
+
+/** Function Name: compressArchive(string inputFile, string outputFile)
+ *  Description: Compresses inputFile into the archive format, where every
+ *               block goes through the BWT front end before it is Huffman
+ *               coded, with a block per core coded at once.
+ *  Parameters: inputFile - the filename to the file to be compressed
+ *              outputFile - the filename to write the blocks to
+ *  Return Value: The success of the program as an int
+ */
+int compressArchive(string inputFile, string outputFile) {
+	/** Open the input file for reading */
+	ifstream inFile(inputFile, ios::binary);
+	/** Open the output file for writing */
+	ofstream outFile(outputFile, ios::binary);
+	ArchiveEncoder encoder(outFile, (int)thread::hardware_concurrency());
+	/** Holds one block of input */
+	vector<byte> block(ARCHIVE_BLOCK_SIZE);
+	while (1) {
+		inFile.read((char*)block.data(), ARCHIVE_BLOCK_SIZE);
+		streamsize size = inFile.gcount();
+		if (size == 0) break;
+		encoder.writeBlock(block.data(), (size_t)size);
+	}
+	encoder.finish();
+	/** Print out how the blocks were written */
+	cout << "Blocks: " << encoder.getModeCount(ARCHIVE_BWT) << " bwt, "
+		<< encoder.getModeCount(ARCHIVE_RAW) << " raw" << endl;
+
+	/** Close the output file */
+	outFile.close();
+	/** Close the input file */
+	inFile.close();
+	return 0;
+}
+
+/** Function Name: uncompressArchive(string inputFile, string outputFile)
+ *  Description: Uncompresses a file written by compressArchive()
+ *  Parameters: inputFile - Name of file that will be uncompressed
+ *              outputFile - Desired name of file to uncompress to
+ *  Return Value: The success of the program as an int
+ */
+int uncompressArchive(string inputFile, string outputFile) {
+	/** Open the input file for reading */
+	ifstream inFile(inputFile, ios::binary);
+	/** Open the output file for writing */
+	ofstream outFile(outputFile, ios::binary);
+	ArchiveDecoder decoder(inFile, (int)thread::hardware_concurrency());
+	/** Holds one decoded block */
+	vector<byte> block;
+	int mode;
+	while ((mode = decoder.readBlock(block)) != ARCHIVE_END) {
+		if (mode == ARCHIVE_ERROR) {
+			cout << "Corrupt block in " << inputFile << endl;
+			return -1;
+		}
+		outFile.write((const char*)block.data(), block.size());
+	}
+
+	/** Close output file */
+	outFile.close();
+	/** Close input file */
+	inFile.close();
+	return 0;
+}
+
+/** Function Name: compressColumns(string inputFile, string outputFile)
+ *  Description: Compresses the delimited records of inputFile into the
+ *               columnar format, with a table per column and the columns
+ *               coded on every core.
+ *  Parameters: inputFile - the filename to the file to be compressed
+ *              outputFile - the filename to write the columns to
+ *  Return Value: The success of the program as an int
+ */
+int compressColumns(string inputFile, string outputFile) {
+	/** Open the input file for reading */
+	ifstream inFile(inputFile, ios::binary);
+	if (!inFile) {
+		cout << "Could not open " << inputFile << endl;
+		return -1;
+	}
+	/** The records are split into columns in memory */
+	vector<byte> data((istreambuf_iterator<char>(inFile)),
+		istreambuf_iterator<char>());
+	/** Open the output file for writing */
+	ofstream outFile(outputFile, ios::binary);
+	ColumnEncoder encoder((int)thread::hardware_concurrency());
+	encoder.write(data.data(), data.size(), outFile);
+	/** Print out how the records were split */
+	byte delimiter = encoder.getDelimiter();
+	cout << "Columns: " << encoder.getColumnCount() << ", delimiter "
+		<< (delimiter == '\t' ? string("tab") : string(1, (char)delimiter))
+		<< endl;
+
+	/** Close the output file */
+	outFile.close();
+	/** Close the input file */
+	inFile.close();
+	return 0;
+}
+
+/** Function Name: uncompressColumns(string inputFile, string outputFile,
+ *                                   int column)
+ *  Description: Uncompresses a file written by compressColumns(), or only
+ *               one of its columns, one value per line
+ *  Parameters: inputFile - Name of file that will be uncompressed
+ *              outputFile - Desired name of file to uncompress to
+ *              column - The column to write, COLUMN_ALL for the records
+ *  Return Value: The success of the program as an int
+ */
+int uncompressColumns(string inputFile, string outputFile, int column) {
+	/** Open the input file for reading */
+	ifstream inFile(inputFile, ios::binary);
+	ColumnDecoder decoder(inFile, (int)thread::hardware_concurrency());
+	/** Holds the decoded records or column */
+	vector<byte> data;
+	if (!decoder.readDirectory()) {
+		cout << "Corrupt columns in " << inputFile << endl;
+		return -1;
+	}
+	if (column != COLUMN_ALL && column >= decoder.getColumnCount()) {
+		cout << "No column " << column << " in " << inputFile << endl;
+		return -1;
+	}
+	bool valid = column == COLUMN_ALL ? decoder.decodeAll(data)
+		: decoder.decodeColumn(column, data);
+	if (!valid) {
+		cout << "Corrupt columns in " << inputFile << endl;
+		return -1;
+	}
+	/** Open the output file for writing */
+	ofstream outFile(outputFile, ios::binary);
+	outFile.write((const char*)data.data(), data.size());
+
+	/** Close output file */
+	outFile.close();
+	/** Close input file */
+	inFile.close();
+	return 0;
+}
+
+/** Function Name: estimateCompressed(string inputFile)
+ *  Description: Prints the size compress() would write for inputFile and
+ *               the sizes of the other ways to store it, from its
+ *               histogram alone. Files over ESTIMATE_SAMPLE_THRESHOLD are
+ *               sampled.
+ *  Parameters: inputFile - Name of the file to size
+ *  Return Value: The success of the program as an int
+ */
+int estimateCompressed(string inputFile) {
+	/** Open the input file for reading */
+	ifstream inFile(inputFile, ios::binary);
+	if (!inFile) {
+		cout << "Could not open " << inputFile << endl;
+		return -1;
+	}
+	vector<byte> data((istreambuf_iterator<char>(inFile)),
+		istreambuf_iterator<char>());
+	SizeEstimate estimate = estimateSize(data.data(), data.size());
+	cout << (estimate.sampled ? "Estimated" : "Exact") << " compressed size: "
+		<< estimate.compressedBytes << " bytes (header "
+		<< estimate.headerBits << " bits, payload " << estimate.payloadBits
+		<< " bits)" << endl;
+	cout << "Static English table: " << estimate.staticBytes << " bytes, raw: "
+		<< estimate.inputBytes << " bytes" << endl;
+
+	/** Close the input file */
+	inFile.close();
+	return 0;
+}
+
+/** Function Name: searchCompressed(string inputFile, string pattern)
+ *  Description: Prints the lines of a file written by compress() that hold
+ *               pattern, searching the coded bits directly and decoding
+ *               only the lines that match.
+ *  Parameters: inputFile - Name of the compressed file to search
+ *              pattern - The text to look for
+ *  Return Value: The success of the program as an int
+ */
+int searchCompressed(string inputFile, string pattern) {
+	/** Open the input file for reading */
+	ifstream inFile(inputFile, ios::binary);
+	if (!inFile) {
+		cout << "Could not open " << inputFile << endl;
+		return -1;
+	}
+	/** Size of the compressed file in bytes */
+	inFile.seekg(0, ios::end);
+	streamoff fileSize = inFile.tellg();
+	inFile.seekg(0, ios::beg);
+	unsigned long long matches = 0;
+	/** An empty file holds no lines */
+	if (fileSize > 0) {
+		BitInputStream inBIS = BitInputStream(inFile);
+		vector<int> freqs;
+		int totalFreq = HCTree::readHeader(inBIS, freqs);
+		shared_ptr<const HCTree> HCT = HCTableCache::global().acquire(freqs);
+		/** The search works on the whole file in memory */
+		vector<byte> coded((size_t)fileSize + SEARCH_PADDING_BYTES, 0);
+		inFile.clear();
+		inFile.seekg(0, ios::beg);
+		inFile.read((char*)coded.data(), fileSize);
+		CompressedSearch search(*HCT, coded.data(), HCTree::headerBits(freqs),
+			totalFreq);
+		matches = search.search(pattern, cout);
+	}
+	cout << "Matching lines: " << matches << endl;
+	/** Close the input file */
+	inFile.close();
+	return 0;
+}
+
+/** Function Name: compressBuffer(const vector<byte>& in, vector<byte>& out)
+ *  Description: Compresses in into out in the same format as compress()
+ *  Parameters: in - The bytes to compress
+ *              out - Set to the compressed bytes, empty if in is
+ *  Return Value: None
+ */
+static void compressBuffer(const vector<byte>& in, vector<byte>& out) {
+	out.clear();
+	if (in.empty()) {
+		return;
+	}
+	vector<int> freqs(ASCII_MAX);
+	for (size_t i = 0; i < in.size(); i++) {
+		freqs[in[i]]++;
+	}
+	shared_ptr<const HCTree> HCT = HCTableCache::global().acquire(freqs);
+	ostringstream coded;
+	BitOutputStream outBOS = BitOutputStream(coded);
+	HCTree::writeHeader(freqs, outBOS);
+	HCT->encodeBlock(in.data(), in.size(), outBOS);
+	while (outBOS.getnbits() != 0) {
+		outBOS.writeBit(0);
+	}
+	string bytes = coded.str();
+	out.assign(bytes.begin(), bytes.end());
+}
+
+/** Function Name: uncompressBuffer(const vector<byte>& in, vector<byte>& out)
+ *  Description: Uncompresses in, written by compress(), into out with the
+ *               bulk loop picked for this CPU
+ *  Parameters: in - The compressed bytes
+ *              out - Set to the uncompressed bytes
+ *  Return Value: False if in is corrupt
+ */
+static bool uncompressBuffer(const vector<byte>& in, vector<byte>& out) {
+	out.clear();
+	if (in.empty()) {
+		return true;
+	}
+	istringstream coded(string(in.begin(), in.end()));
+	BitInputStream inBIS = BitInputStream(coded);
+	vector<int> freqs(ASCII_MAX);
+	int totalFreq = HCTree::readHeader(inBIS, freqs);
+	if (totalFreq <= 0) {
+		return false;
+	}
+	shared_ptr<const HCTree> HCT = HCTableCache::global().acquire(freqs);
+	out.resize(totalFreq);
+	return HCT->decodeBits(in.data(), in.size(), HCTree::headerBits(freqs),
+		out.data(), totalFreq);
+}
+
+/** Function Name: runBatch(string listFile, string suffix, bool decompress,
+ *                          const RunOptions& options)
+ *  Description: Compresses or uncompresses every file named in listFile,
+ *               one name per line, into the same name plus suffix. Files
+ *               are read and written BATCH_FILES at a time through
+ *               BatchIO, so small files do not pay a syscall each.
+ *  Parameters: listFile - File holding the names of the files to code
+ *              suffix - Appended to every name to get its output file
+ *              decompress - Whether to uncompress instead of compress
+ *              options - Switches from the command line
+ *  Return Value: 0 if every file was coded, -1 otherwise
+ */
+int runBatch(string listFile, string suffix, bool decompress,
+	const RunOptions& options) {
+	ifstream list(listFile);
+	if (!list) {
+		cout << "Cannot open " << listFile << endl;
+		return -1;
+	}
+	vector<string> names;
+	string name;
+	while (getline(list, name)) {
+		if (!name.empty()) {
+			names.push_back(name);
+		}
+	}
+	BatchIO io(options.uring);
+	size_t failed = 0;
+	for (size_t start = 0; start < names.size(); start += BATCH_FILES) {
+		size_t count = min((size_t)BATCH_FILES, names.size() - start);
+		vector<BatchFile> files(count);
+		for (size_t i = 0; i < count; i++) {
+			files[i].inputPath = names[start + i];
+			files[i].outputPath = names[start + i] + suffix;
+			files[i].ok = true;
+		}
+		io.readFiles(files);
+		for (size_t i = 0; i < count; i++) {
+			if (!files[i].ok) continue;
+			if (decompress) {
+				files[i].ok = uncompressBuffer(files[i].input, files[i].output);
+			}
+			else {
+				compressBuffer(files[i].input, files[i].output);
+			}
+		}
+		io.writeFiles(files);
+		for (size_t i = 0; i < count; i++) {
+			if (!files[i].ok) {
+				cout << "Failed: " << files[i].inputPath << endl;
+				failed++;
+			}
+		}
+	}
+	/** Print out how the batch went */
+	cout << "Batch: " << names.size() << " files, " << failed << " failed, "
+		<< io.getBackendName() << " backend" << endl;
+	return failed == 0 ? 0 : -1;
+}
+
+/** Function Name: packFiles(string listFile, string archiveFile,
+ *                           const RunOptions& options)
+ *  Description: Packs every file named in listFile, one name per line,
+ *               into one archive, counting and coding them on every core.
+ *               Members are named by their paths made relative.
+ *  Parameters: listFile - File holding the names of the files to pack
+ *              archiveFile - The archive to write
+ *              options - Switches from the command line
+ *  Return Value: The success of the program as an int
+ */
+int packFiles(string listFile, string archiveFile, const RunOptions& options) {
+	ifstream list(listFile);
+	if (!list) {
+		cout << "Cannot open " << listFile << endl;
+		return -1;
+	}
+	vector<string> names;
+	string name;
+	while (getline(list, name)) {
+		if (!name.empty()) {
+			names.push_back(name);
+		}
+	}
+	/** Open the output file for writing */
+	ofstream outFile(archiveFile, ios::binary);
+	PackWriter writer((int)thread::hardware_concurrency(),
+		options.shareTables);
+	if (!writer.write(names, outFile)) {
+		cout << "Failed: " << writer.getFailedPath() << endl;
+		return -1;
+	}
+	/** Print out how the members were coded */
+	cout << "Packed: " << names.size() << " files, "
+		<< writer.getTableCount() << " tables, " << writer.getSharedCount()
+		<< " sharing, " << writer.getRawCount() << " raw" << endl;
+
+	/** Close the output file */
+	outFile.close();
+	return 0;
+}
+
+/** Function Name: makeParents(const string& path)
+ *  Description: Creates the directories path lies in, as a packed member
+ *               name keeps the relative directories of its file
+ *  Return Value: None, a directory that cannot be made fails the open
+ *                after it
+ */
+void makeParents(const string& path) {
+	for (size_t end = path.find('/'); end != string::npos;
+		end = path.find('/', end + 1)) {
+		string directory = path.substr(0, end);
+#if defined(_WIN32)
+		_mkdir(directory.c_str());
+#else
+		mkdir(directory.c_str(), 0777);
+#endif
+	}
+}
+
+/** Function Name: unpackFiles(string archiveFile, string suffix,
+ *                             const RunOptions& options)
+ *  Description: Extracts every member of an archive written by packFiles()
+ *               into its name plus suffix, below the working directory, a
+ *               member per thread, or only options.member, found through
+ *               the directory without touching the other members
+ *  Parameters: archiveFile - The archive to read
+ *              suffix - Appended to every name to get its output file
+ *              options - Switches from the command line
+ *  Return Value: 0 if every member was extracted, -1 otherwise
+ */
+int unpackFiles(string archiveFile, string suffix,
+	const RunOptions& options) {
+	/** Open the input file for reading */
+	ifstream inFile(archiveFile, ios::binary);
+	PackReader reader(inFile);
+	if (!reader.readDirectory()) {
+		cout << "Corrupt archive " << archiveFile << endl;
+		return -1;
+	}
+	const vector<PackEntry>& entries = reader.getEntries();
+	vector<size_t> members;
+	if (options.member.empty()) {
+		for (size_t i = 0; i < entries.size(); i++) {
+			members.push_back(i);
+		}
+	}
+	else {
+		long long index = reader.find(PackWriter::memberName(options.member));
+		if (index < 0) {
+			cout << "No member " << options.member << " in " << archiveFile
+				<< endl;
+			return -1;
+		}
+		members.push_back((size_t)index);
+	}
+	/** Every worker reads through a stream of its own */
+	vector<char> ok(members.size(), 0);
+	int threads = max(1, (int)thread::hardware_concurrency());
+	int workerCount = min(threads, (int)members.size());
+	auto work = [&](int first) {
+		ifstream archive(archiveFile, ios::binary);
+		vector<byte> data;
+		for (size_t k = first; k < members.size(); k += threads) {
+			if (!reader.extract(members[k], archive, data)) continue;
+			makeParents(entries[members[k]].name);
+			ofstream outFile(entries[members[k]].name + suffix, ios::binary);
+			outFile.write((const char*)data.data(), data.size());
+			ok[k] = (bool)outFile;
+		}
+	};
+	vector<thread> workers;
+	for (int t = 0; t < workerCount; t++) {
+		workers.push_back(thread(work, t));
+	}
+	for (size_t t = 0; t < workers.size(); t++) {
+		workers[t].join();
+	}
+	size_t failed = 0;
+	for (size_t k = 0; k < members.size(); k++) {
+		if (!ok[k]) {
+			cout << "Failed: " << entries[members[k]].name << endl;
+			failed++;
+		}
+	}
+	/** Print out how the extraction went */
+	cout << "Unpacked: " << members.size() << " files, " << failed
+		<< " failed" << endl;
+
+	/** Close input file */
+	inFile.close();
+	return failed == 0 ? 0 : -1;
+}
+
+/** Function Name: listArchive(string archiveFile)
+ *  Description: Prints the directory of an archive written by packFiles()
+ *  Parameters: archiveFile - The archive to read
+ *  Return Value: The success of the program as an int
+ */
+int listArchive(string archiveFile) {
+	/** Open the input file for reading */
+	ifstream inFile(archiveFile, ios::binary);
+	PackReader reader(inFile);
+	if (!reader.readDirectory()) {
+		cout << "Corrupt archive " << archiveFile << endl;
+		return -1;
+	}
+	const vector<PackEntry>& entries = reader.getEntries();
+	for (size_t i = 0; i < entries.size(); i++) {
+		cout << entries[i].rawSize << " " << entries[i].storedSize << " ";
+		if (entries[i].tableId == PACK_RAW_TABLE) {
+			cout << "raw";
+		}
+		else {
+			cout << "table " << entries[i].tableId;
+		}
+		cout << " " << entries[i].name << endl;
+	}
+	cout << "Members: " << entries.size() << ", tables "
+		<< reader.getTableCount() << endl;
+
+	/** Close input file */
+	inFile.close();
+	return 0;
+}
+
+/** Function Name: fileBytes(string path)
+ *  Description: Size of a file for the run statistics
+ *  Parameters: path - The file to measure
+ *  Return Value: The size in bytes, 0 if it cannot be opened
+ */
+static unsigned long long fileBytes(string path) {
+	ifstream file(path, ios::binary | ios::ate);
+	if (!file) {
+		return 0;
+	}
+	return (unsigned long long)file.tellg();
+}
+
+/** Function Name: runCommand(string command, string inputFile,
+ *                            string outputFile, const RunOptions& options,
+ *                            RunStats* stats)
+ *  Description: Runs a single command on inputFile and outputFile
+ *  Parameters: command - One of compress, uncompress, bcompress,
+ *                        buncompress, acompress, auncompress, ccompress,
+ *                        cuncompress, lcompress, luncompress, test, search,
+ *                        estimate, batchcompress, batchuncompress, pack,
+ *                        unpack, list or benchmark
+ *              inputFile - The file to read, the list of files to code
+ *                          for the batch commands and pack
+ *              outputFile - The file to write, the suffix of the files
+ *                           to write for the batch commands and unpack,
+ *                           the pattern for search, unused by estimate,
+ *                           list, test and benchmark
+ *              options - Switches from the command line
+ *              stats - Given to the commands that fill in phase timings
+ *  Return Value: The success of the command, -1 if command is unknown
+ */
+static int runCommand(string command, string inputFile, string outputFile,
+	const RunOptions& options, RunStats* stats) {
+	if (command.compare("compress") == 0) {
+		if (options.pipeline) {
+			return compressPipelined(inputFile, outputFile, stats,
+				options.samplePercent);
+		}
+		return compress(inputFile, outputFile, stats, options.samplePercent);
+	}
+	if (command.compare("uncompress") == 0) {
+		if (options.pipeline) {
+			return uncompressPipelined(inputFile, outputFile, stats);
+		}
+		return uncompress(inputFile, outputFile, stats);
+	}
+	if (command.compare("bcompress") == 0) {
+		return compressBlocks(inputFile, outputFile, options.verify);
+	}
+	if (command.compare("buncompress") == 0) {
+		return uncompressBlocks(inputFile, outputFile);
+	}
+	if (command.compare("acompress") == 0) {
+		return compressArchive(inputFile, outputFile);
+	}
+	if (command.compare("auncompress") == 0) {
+		return uncompressArchive(inputFile, outputFile);
+	}
+	if (command.compare("ccompress") == 0) {
+		return compressColumns(inputFile, outputFile);
+	}
+	if (command.compare("cuncompress") == 0) {
+		return uncompressColumns(inputFile, outputFile, options.column);
+	}
+	if (command.compare("lcompress") == 0) {
+		return appendLog(inputFile, outputFile);
+	}
+	if (command.compare("luncompress") == 0) {
+		return uncompressLog(inputFile, outputFile);
+	}
+	if (command.compare("test") == 0) {
+		return testFile(inputFile);
+	}
+	if (command.compare("search") == 0) {
+		return searchCompressed(inputFile, outputFile);
+	}
+	if (command.compare("estimate") == 0) {
+		return estimateCompressed(inputFile);
+	}
+	if (command.compare("batchcompress") == 0) {
+		return runBatch(inputFile, outputFile, false, options);
+	}
+	if (command.compare("batchuncompress") == 0) {
+		return runBatch(inputFile, outputFile, true, options);
+	}
+	if (command.compare("pack") == 0) {
+		return packFiles(inputFile, outputFile, options);
+	}
+	if (command.compare("unpack") == 0) {
+		return unpackFiles(inputFile, outputFile, options);
+	}
+	if (command.compare("list") == 0) {
+		return listArchive(inputFile);
+	}
+	if (command.compare("benchmark") == 0) {
+		return benchmark(inputFile);
+	}
+	return -1;
+}
+
+/** Function Name: run(string command, string inputFile, string outputFile,
+ *                     const RunOptions& options)
+ *  Description: Runs a single command on inputFile and outputFile, then
+ *               prints its statistics as JSON if options asks for them.
+ *               Only compress and uncompress time their phases; every
+ *               command gets the total time and peak memory. The JSON is
+ *               all that goes to stdout then, the messages of the command
+ *               go to stderr. Traces the command into options.trace if it
+ *               is set.
+ *  Parameters: command - The command, as for runCommand()
+ *              inputFile - The file to read
+ *              outputFile - The file to write
+ *              options - Switches from the command line
+ *  Return Value: The success of the command, -1 if command is unknown
+ */
+int run(string command, string inputFile, string outputFile,
+	const RunOptions& options) {
+	if (!options.trace.empty()) {
+		Trace::start();
+	}
+	RunStats stats;
+	stats.command = command;
+	stats.decompress = command.find("uncompress") != string::npos;
+	/** With --stats stdout carries the JSON alone, messages go to stderr */
+	streambuf* stdoutBuf = cout.rdbuf();
+	if (options.stats) {
+		cout.rdbuf(cerr.rdbuf());
+	}
+	int result;
+	{
+		PhaseTimer timer(options.stats ? &stats : nullptr);
+		TRACE_SPAN("run");
+		result = runCommand(command, inputFile, outputFile, options,
+			options.stats ? &stats : nullptr);
+	}
+	cout.rdbuf(stdoutBuf);
+	if (!options.trace.empty() && !Trace::dump(options.trace)) {
+		cout << "Could not write trace to " << options.trace << endl;
+	}
+	if (!options.stats) {
+		return result;
+	}
+	/** Batch commands name a list and a suffix rather than two files */
+	if (command.compare(0, 5, "batch") != 0 &&
+		command.compare("pack") != 0 && command.compare("unpack") != 0 &&
+		command.compare("benchmark") != 0) {
+		stats.inputBytes = fileBytes(inputFile);
+		/** search names a pattern, estimate, list and test write nothing */
+		if (command.compare("search") != 0
+			&& command.compare("estimate") != 0
+			&& command.compare("list") != 0
+			&& command.compare("test") != 0) {
+			stats.outputBytes = fileBytes(outputFile);
+		}
+	}
+	stats.peakRssBytes = peakRssBytes();
+	stats.cacheHits = HCTableCache::global().getHits();
+	stats.cacheMisses = HCTableCache::global().getMisses();
+	cout << stats.toJson() << endl;
+	return result;
+}
+
 /** Function Name: main(int argc, char** argv)
  *  Description: The main driver function for the Huffman Coding Program.
- *               Note: Command Line arguments not used.
+ *               With no arguments it asks for commands interactively,
+ *               otherwise it runs <command> <infile> [outfile] [--pipeline]
+ *               [--no-uring] [--stats] [--trace=<file>] [--column=<n>]
+ *               [--sample=<percent>] [--no-share] [--member=<name>]
+ *               [--verify] once.
  *  Parameters: argc - Number of command line arguments
  *              argv - Array consisting of the command line arguments.
  *  Return Value: The success of the program as an int
  */
 int main(int argc, char** argv) {
-	/** Initialize user input strings, char, and flag */
+	RunOptions options = { false, true, false, "", COLUMN_ALL, 0, true,
+		"", false };
+	/** Run a single command given on the command line */
+	if (argc > INFILE_ARG) {
+		/** Switches start with --, everything else is positional */
+		vector<string> args;
+		for (int i = ACTION_ARG; i < argc; i++) {
+			string arg = argv[i];
+			if (arg.compare("--pipeline") == 0) {
+				options.pipeline = true;
+			}
+			else if (arg.compare("--no-uring") == 0) {
+				options.uring = false;
+			}
+			else if (arg.compare("--stats") == 0) {
+				options.stats = true;
+			}
+			else if (arg.compare("--verify") == 0) {
+				options.verify = true;
+			}
+			else if (arg.compare("--no-share") == 0) {
+				options.shareTables = false;
+			}
+			else if (arg.compare(0, 9, "--member=") == 0) {
+				options.member = arg.substr(9);
+			}
+			else if (arg.compare(0, 8, "--trace=") == 0) {
+				options.trace = arg.substr(8);
+			}
+			else if (arg.compare(0, 9, "--sample=") == 0) {
+				options.samplePercent = atoi(arg.substr(9).c_str());
+				if (options.samplePercent < 1 || options.samplePercent > 100) {
+					cout << "Bad sample percent " << arg.substr(9) << endl;
+					return -1;
+				}
+			}
+			else if (arg.compare(0, 9, "--column=") == 0) {
+				options.column = atoi(arg.substr(9).c_str());
+				if (options.column < 0) {
+					cout << "Bad column " << arg.substr(9) << endl;
+					return -1;
+				}
+			}
+			else if (arg.compare(0, 2, "--") == 0) {
+				cout << "Unknown option " << arg << endl;
+				return -1;
+			}
+			else {
+				args.push_back(arg);
+			}
+		}
+		if (args.size() < INFILE_ARG) {
+			cout << "Usage: " << argv[0]
+				<< " <command> <infile> [outfile] [--pipeline] [--no-uring]"
+				<< " [--stats] [--trace=<file>] [--column=<n>]"
+				<< " [--sample=<percent>] [--no-share] [--member=<name>]"
+				<< " [--verify]"
+				<< endl;
+			return -1;
+		}
+		return run(args[ACTION_ARG - 1], args[INFILE_ARG - 1],
+			args.size() > INFILE_ARG ? args[OUTFILE_ARG - 1] : "", options);
+	}
+	/** Initialize user input strings */
 	string inputFile{};
 	string outputFile{};
 	string cont{};
 	string command{};
-	int flag = -1;
 	cout << "Huffman Coding Tree" << endl;
 	/** Loop until user exits */
 	while (1) {
 		/** Loop until user inputs a valid command */
 		while (1) {
 			cout << "Type in 'compress' or 'uncompress' to compress/uncompress a file." << endl;
+			cout << "Type in 'bcompress' or 'buncompress' to use the block format." << endl;
+			cout << "Type in 'acompress' or 'auncompress' to use the archive format." << endl;
+			cout << "Type in 'ccompress' or 'cuncompress' to use the columnar format." << endl;
+			cout << "Type in 'lcompress' to append to a log or 'luncompress' to read one." << endl;
 			cin >> command;
-			if (command.compare("compress") == 0) { flag = 0; break; }
-			if (command.compare("uncompress") == 0) { flag = 1;  break; }
+			if (command.compare("compress") == 0) break;
+			if (command.compare("uncompress") == 0) break;
+			if (command.compare("bcompress") == 0) break;
+			if (command.compare("buncompress") == 0) break;
+			if (command.compare("acompress") == 0) break;
+			if (command.compare("auncompress") == 0) break;
+			if (command.compare("ccompress") == 0) break;
+			if (command.compare("cuncompress") == 0) break;
+			if (command.compare("lcompress") == 0) break;
+			if (command.compare("luncompress") == 0) break;
 		}
 		cout << "Type in the name of the input file (Include extension i.e. '.txt')" << endl;
 		cin >> inputFile;
 		cout << "Type in the desire name of the output file (Include extension i.e. '.txt')" << endl;
 		cin >> outputFile;
 		/** Perform compression or decompression */
-		if (flag == 0) compress(inputFile, outputFile);
-		if (flag == 1) uncompress(inputFile, outputFile);
+		run(command, inputFile, outputFile, options);
 		/** Ask user if they want to loop through program */
 		while (1) {
 			cout << "Do you want to continue? (y/n)" << endl;
@@ -255,4 +1667,4 @@ int main(int argc, char** argv) {
 		}
 	}
 	return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,361 @@
+/** Filename: FilterChain.cpp
+ *  Name: Loc Chuong
+ *  Description: Reversible filters run over a block before it is coded. The
+ *               word filters go through memcpy loads in straight loops with
+ *               no branches so the compiler can vectorize them.
+ *  Date: 10/18/2026
+ */
+
+#include "FilterChain.hpp"
+#include "Trace.hpp"
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#define FILTER_CANDIDATES 13 /** Number of chains choose() tries */
+
+/** Chains choose() tries, 0xFF ends a chain shorter than the maximum */
+static const byte candidates[FILTER_CANDIDATES][FILTER_MAX_STAGES] = {
+	{ FILTER_RLE, 0xFF, 0xFF },
+	{ FILTER_DELTA, 0xFF, 0xFF },
+	{ FILTER_DELTA, FILTER_RLE, 0xFF },
+	{ FILTER_SPLIT4, 0xFF, 0xFF },
+	{ FILTER_SPLIT4, FILTER_RLE, 0xFF },
+	{ FILTER_SPLIT8, 0xFF, 0xFF },
+	{ FILTER_SPLIT8, FILTER_RLE, 0xFF },
+	{ FILTER_DELTA32, FILTER_SPLIT4, 0xFF },
+	{ FILTER_ZIGZAG32, FILTER_SPLIT4, 0xFF },
+	{ FILTER_ZIGZAG32, FILTER_SPLIT4, FILTER_RLE },
+	{ FILTER_ZIGZAG64, FILTER_SPLIT8, 0xFF },
+	{ FILTER_ZIGZAG64, FILTER_SPLIT8, FILTER_RLE },
+	{ FILTER_DELTA32, FILTER_SPLIT4, FILTER_RLE },
+};
+
+/** Function Name: deltaBytes(byte* data, size_t size, bool inverse)
+ *  Description: Replaces every byte by its difference from the one before,
+ *               or sums the differences back up
+ *  Return Value: None
+ */
+static void deltaBytes(byte* data, size_t size, bool inverse) {
+	byte prev = 0;
+	for (size_t i = 0; i < size; i++) {
+		byte value = data[i];
+		data[i] = inverse ? (byte)(value + prev) : (byte)(value - prev);
+		prev = inverse ? data[i] : value;
+	}
+}
+
+/** Function Name: deltaWords(byte* data, size_t size, bool zigzag,
+ *                            bool inverse)
+ *  Description: Replaces every little endian word of type T by its
+ *               difference from the word before, zigzagged if asked so the
+ *               sign moves to the low bit, or undoes it. Bytes past the
+ *               last whole word are left alone.
+ *  Return Value: None
+ */
+template <typename T>
+static void deltaWords(byte* data, size_t size, bool zigzag, bool inverse) {
+	size_t count = size / sizeof(T);
+	const int topBit = 8 * sizeof(T) - 1;
+	if (inverse) {
+		/** Each word needs the one before it, this part stays serial */
+		T prev = 0;
+		for (size_t i = 0; i < count; i++) {
+			T word;
+			memcpy(&word, data + i * sizeof(T), sizeof(T));
+			if (zigzag) {
+				word = (T)((word >> 1) ^ (T)(0 - (word & 1)));
+			}
+			prev = (T)(prev + word);
+			memcpy(data + i * sizeof(T), &prev, sizeof(T));
+		}
+		return;
+	}
+	/** prev is the word as loaded, so no step waits on the one before */
+	T prev = 0;
+	for (size_t i = 0; i < count; i++) {
+		T word;
+		memcpy(&word, data + i * sizeof(T), sizeof(T));
+		T diff = (T)(word - prev);
+		prev = word;
+		if (zigzag) {
+			diff = (T)((diff << 1) ^ (T)(0 - (diff >> topBit)));
+		}
+		memcpy(data + i * sizeof(T), &diff, sizeof(T));
+	}
+}
+
+/** Function Name: splitPlanes(const byte* data, size_t size, int width,
+ *                             byte* out, bool inverse)
+ *  Description: Writes byte k of every width-byte word to plane k, the
+ *               planes one after another, or joins the planes back into
+ *               words. Bytes past the last whole word are copied after.
+ *  Return Value: None
+ */
+static void splitPlanes(const byte* data, size_t size, int width, byte* out,
+	bool inverse) {
+	size_t count = size / width;
+	for (int k = 0; k < width; k++) {
+		const byte* src = inverse ? data + k * count : data + k;
+		byte* dst = inverse ? out + k : out + k * count;
+		if (inverse) {
+			for (size_t i = 0; i < count; i++) {
+				dst[i * width] = src[i];
+			}
+		}
+		else {
+			for (size_t i = 0; i < count; i++) {
+				dst[i] = src[i * width];
+			}
+		}
+	}
+	memcpy(out + count * width, data + count * width, size - count * width);
+}
+
+/** Function Name: rleEncode(const byte* data, size_t size, vector<byte>& out)
+ *  Description: Copies data, and after every RLE_MIN_RUN equal bytes writes
+ *               how many more of them follow, up to RLE_MAX_EXTRA
+ *  Return Value: None
+ */
+static void rleEncode(const byte* data, size_t size, vector<byte>& out) {
+	out.clear();
+	out.reserve(size + size / RLE_MIN_RUN + 1);
+	size_t i = 0;
+	while (i < size) {
+		byte value = data[i];
+		size_t run = 1;
+		while (i + run < size && data[i + run] == value
+			&& run < RLE_MIN_RUN + RLE_MAX_EXTRA) {
+			run++;
+		}
+		if (run < RLE_MIN_RUN) {
+			out.insert(out.end(), run, value);
+		}
+		else {
+			out.insert(out.end(), RLE_MIN_RUN, value);
+			out.push_back((byte)(run - RLE_MIN_RUN));
+		}
+		i += run;
+	}
+}
+
+/** Function Name: rleDecode(const vector<byte>& data, size_t size,
+ *                           vector<byte>& out)
+ *  Description: Undoes rleEncode(), stopping at size bytes
+ *  Return Value: False if data does not decode to exactly size bytes
+ */
+static bool rleDecode(const vector<byte>& data, size_t size,
+	vector<byte>& out) {
+	out.clear();
+	out.reserve(size);
+	size_t run = 0;
+	for (size_t i = 0; i < data.size(); i++) {
+		if (out.size() == size) {
+			return false;
+		}
+		byte value = data[i];
+		run = (!out.empty() && out.back() == value) ? run + 1 : 1;
+		out.push_back(value);
+		if (run == RLE_MIN_RUN) {
+			/** The run length byte must be there */
+			if (++i == data.size() || out.size() + data[i] > size) {
+				return false;
+			}
+			out.insert(out.end(), data[i], value);
+			run = 0;
+		}
+	}
+	return out.size() == size;
+}
+
+/** Function Name: applyStage(int filter, vector<byte>& data,
+ *                            vector<byte>& scratch, size_t size,
+ *                            bool inverse)
+ *  Description: Runs one filter, or its inverse, over data. Filters that
+ *               cannot work in place go through scratch.
+ *  Parameters: size - Bytes before filtering, for the inverse of FILTER_RLE
+ *  Return Value: False if the inverse finds data malformed
+ */
+static bool applyStage(int filter, vector<byte>& data, vector<byte>& scratch,
+	size_t size, bool inverse) {
+	switch (filter) {
+	case FILTER_RLE:
+		if (inverse) {
+			if (!rleDecode(data, size, scratch)) {
+				return false;
+			}
+		}
+		else {
+			rleEncode(data.data(), data.size(), scratch);
+		}
+		data.swap(scratch);
+		return true;
+	case FILTER_DELTA:
+		deltaBytes(data.data(), data.size(), inverse);
+		return true;
+	case FILTER_ZIGZAG32:
+		deltaWords<uint32_t>(data.data(), data.size(), true, inverse);
+		return true;
+	case FILTER_DELTA32:
+		deltaWords<uint32_t>(data.data(), data.size(), false, inverse);
+		return true;
+	case FILTER_ZIGZAG64:
+		deltaWords<uint64_t>(data.data(), data.size(), true, inverse);
+		return true;
+	case FILTER_SPLIT4:
+	case FILTER_SPLIT8:
+		scratch.resize(data.size());
+		splitPlanes(data.data(), data.size(),
+			filter == FILTER_SPLIT4 ? 4 : 8, scratch.data(), inverse);
+		data.swap(scratch);
+		return true;
+	}
+	return false;
+}
+
+/** Constructor
+ *  Description: Creates an empty chain
+ */
+FilterChain::FilterChain() {
+}
+
+/** Constructor
+ *  Description: Creates a chain running stages in order
+ */
+FilterChain::FilterChain(const vector<byte>& stages) : stages(stages) {
+}
+
+/** Function Name: empty() const
+ *  Description: Whether the chain has no stages
+ *  Return Value: True if it has none
+ */
+bool FilterChain::empty() const {
+	return stages.empty();
+}
+
+/** Function Name: encode(const byte* data, size_t size,
+ *                        vector<byte>& out) const
+ *  Description: Runs every stage over data, in order
+ *  Return Value: None
+ */
+void FilterChain::encode(const byte* data, size_t size,
+	vector<byte>& out) const {
+	TRACE_SPAN("filter");
+	out.assign(data, data + size);
+	vector<byte> scratch;
+	for (size_t s = 0; s < stages.size(); s++) {
+		applyStage(stages[s], out, scratch, size, false);
+	}
+}
+
+/** Function Name: decode(vector<byte>& data, size_t size) const
+ *  Description: Undoes every stage, last one first. Only FILTER_RLE changes
+ *               the size and read() allows one of it, so every stage before
+ *               it sees size bytes.
+ *  Return Value: False if data is not the output of this chain
+ */
+bool FilterChain::decode(vector<byte>& data, size_t size) const {
+	TRACE_SPAN("unfilter");
+	vector<byte> scratch;
+	for (size_t s = stages.size(); s-- > 0;) {
+		if (!applyStage(stages[s], data, scratch, size, true)) {
+			return false;
+		}
+	}
+	return data.size() == size;
+}
+
+/** Function Name: write(ostream& out) const
+ *  Description: Writes the stage count and the stages
+ *  Return Value: None
+ */
+void FilterChain::write(ostream& out) const {
+	out.put((char)stages.size());
+	for (size_t s = 0; s < stages.size(); s++) {
+		out.put((char)stages[s]);
+	}
+}
+
+/** Function Name: read(istream& in)
+ *  Description: Reads a chain written by write()
+ *  Return Value: False if the chain is malformed
+ */
+bool FilterChain::read(istream& in) {
+	stages.clear();
+	int count = in.get();
+	if (count == EOF || count == 0 || count > FILTER_MAX_STAGES) {
+		return false;
+	}
+	int rleStages = 0;
+	for (int s = 0; s < count; s++) {
+		int filter = in.get();
+		if (filter == EOF || filter >= FILTER_KINDS) {
+			return false;
+		}
+		if (filter == FILTER_RLE) {
+			rleStages++;
+		}
+		stages.push_back((byte)filter);
+	}
+	return rleStages <= 1;
+}
+
+/** Function Name: getWrittenSize() const
+ *  Description: Number of bytes write() writes
+ *  Return Value: The number of bytes
+ */
+size_t FilterChain::getWrittenSize() const {
+	return 1 + stages.size();
+}
+
+/** Function Name: entropyBits(const byte* data, size_t size)
+ *  Description: Order-0 entropy of data
+ *  Return Value: The entropy in bits
+ */
+double FilterChain::entropyBits(const byte* data, size_t size) {
+	int freqs[ASCII_MAX] = { 0 };
+	for (size_t i = 0; i < size; i++) {
+		freqs[data[i]]++;
+	}
+	double bits = 0;
+	for (int i = 0; i < ASCII_MAX; i++) {
+		if (freqs[i] != 0) {
+			bits += freqs[i] * log2((double)size / freqs[i]);
+		}
+	}
+	return bits;
+}
+
+/** Function Name: choose(const byte* data, size_t size)
+ *  Description: Prices every candidate by the entropy of its output on the
+ *               first FILTER_SAMPLE_SIZE bytes, plus their share of the
+ *               bytes recording it, and keeps the cheapest if it beats
+ *               leaving data as it is by 1/FILTER_MIN_GAIN of the sample
+ *  Return Value: The chain to use, empty if none is worth it
+ */
+FilterChain FilterChain::choose(const byte* data, size_t size) {
+	TRACE_SPAN("choose filter");
+	size_t sample = size < FILTER_SAMPLE_SIZE ? size : FILTER_SAMPLE_SIZE;
+	double share = size == 0 ? 0 : (double)sample / size;
+	double plainBytes = entropyBits(data, sample) / 8;
+	double bestBytes = plainBytes - (double)sample / FILTER_MIN_GAIN;
+	FilterChain best;
+	vector<byte> filtered;
+	for (int c = 0; c < FILTER_CANDIDATES; c++) {
+		vector<byte> chainStages;
+		for (int s = 0; s < FILTER_MAX_STAGES && candidates[c][s] != 0xFF;
+			s++) {
+			chainStages.push_back(candidates[c][s]);
+		}
+		FilterChain chain(chainStages);
+		chain.encode(data, sample, filtered);
+		/** The chain and the size before filtering are stored too */
+		double bytes = entropyBits(filtered.data(), filtered.size()) / 8
+			+ (chain.getWrittenSize() + 4) * share;
+		if (bytes < bestBytes) {
+			best = chain;
+			bestBytes = bytes;
+		}
+	}
+	return best;
+}
@@ -0,0 +1,119 @@
+/** Filename: FilterChain.hpp
+ *  Name: Loc Chuong
+ *  Description: Reversible filters run over a block before it is coded.
+ *               Arrays of little endian integers have a nearly flat byte
+ *               histogram, so Huffman gains little on them as they are.
+ *               Taking the difference of neighboring words, zigzagging it so
+ *               small negative steps stay small, and splitting the words
+ *               into byte planes leaves planes of mostly zero bytes, and
+ *               run-length coding shortens the long runs that are left.
+ *
+ *               A chain is written as
+ *                 stage count (1 byte) | one filter id per stage (1 byte)
+ *               and the stages run in order when encoding and backwards
+ *               when decoding.
+ *  Date: 10/18/2026
+ */
+
+#ifndef FILTERCHAIN_HPP
+#define FILTERCHAIN_HPP
+
+#include <iostream>
+#include <vector>
+#include "HCTree.hpp"
+
+#define FILTER_MAX_STAGES 3 /** Most filters in one chain */
+#define FILTER_KINDS 7 /** Number of filter ids */
+#define FILTER_RLE 0 /** Run-length codes runs of the same byte */
+#define FILTER_DELTA 1 /** Difference of every byte and the one before */
+#define FILTER_DELTA32 2 /** Difference of 4-byte words */
+#define FILTER_ZIGZAG32 3 /** Zigzagged difference of 4-byte words */
+#define FILTER_ZIGZAG64 4 /** Zigzagged difference of 8-byte words */
+#define FILTER_SPLIT4 5 /** Splits 4-byte words into 4 byte planes */
+#define FILTER_SPLIT8 6 /** Splits 8-byte words into 8 byte planes */
+#define RLE_MIN_RUN 4 /** Equal bytes in a row before a run length */
+#define RLE_MAX_EXTRA 255 /** Most repeats one run length byte holds */
+#define FILTER_MIN_GAIN 64 /** A chain has to save 1/FILTER_MIN_GAIN */
+#define FILTER_SAMPLE_SIZE (1 << 14) /** Bytes choose() prices chains on */
+
+using namespace std;
+
+/** Class Name: FilterChain
+ *  Description: A sequence of reversible filters, picked for a block by
+ *               the entropy of what each candidate chain leaves.
+ */
+class FilterChain {
+private:
+	vector<byte> stages; /** Filter ids, in the order they encode */
+
+public:
+	/** Constructor
+	 *  Description: Creates an empty chain, which leaves blocks as they are
+	 */
+	FilterChain();
+
+	/** Constructor
+	 *  Description: Creates a chain running stages in order
+	 */
+	explicit FilterChain(const vector<byte>& stages);
+
+	/** Function Name: empty() const
+	 *  Description: Whether the chain has no stages
+	 *  Return Value: True if it has none
+	 */
+	bool empty() const;
+
+	/** Function Name: encode(const byte* data, size_t size,
+	 *                        vector<byte>& out) const
+	 *  Description: Runs every stage over data
+	 *  Parameters: data - The bytes to filter
+	 *              size - Number of bytes in data
+	 *              out - Set to the filtered bytes
+	 *  Return Value: None
+	 */
+	void encode(const byte* data, size_t size, vector<byte>& out) const;
+
+	/** Function Name: decode(vector<byte>& data, size_t size) const
+	 *  Description: Undoes every stage, last one first
+	 *  Parameters: data - The filtered bytes, set to the original ones
+	 *              size - Number of bytes before filtering
+	 *  Return Value: False if data is not the output of this chain
+	 */
+	bool decode(vector<byte>& data, size_t size) const;
+
+	/** Function Name: write(ostream& out) const
+	 *  Description: Writes the stage count and the stages
+	 *  Return Value: None
+	 */
+	void write(ostream& out) const;
+
+	/** Function Name: read(istream& in)
+	 *  Description: Reads a chain written by write()
+	 *  Return Value: False if the chain is malformed
+	 */
+	bool read(istream& in);
+
+	/** Function Name: getWrittenSize() const
+	 *  Description: Number of bytes write() writes
+	 *  Return Value: The number of bytes
+	 */
+	size_t getWrittenSize() const;
+
+	/** Function Name: choose(const byte* data, size_t size)
+	 *  Description: Runs every candidate chain over the start of data and
+	 *               keeps the one leaving the lowest order-0 entropy, if it
+	 *               beats leaving data as it is by more than
+	 *               1/FILTER_MIN_GAIN
+	 *  Return Value: The chain to use, empty if none is worth it
+	 */
+	static FilterChain choose(const byte* data, size_t size);
+
+	/** Function Name: entropyBits(const byte* data, size_t size)
+	 *  Description: Order-0 entropy of data, the fewest bits an order-0
+	 *               coder could spend on it
+	 *  Return Value: The entropy in bits
+	 */
+	static double entropyBits(const byte* data, size_t size);
+};
+
+#endif // FILTERCHAIN_HPP
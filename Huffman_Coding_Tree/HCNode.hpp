@@ -29,7 +29,7 @@ class HCNode {
 
 public:
 	int count; /** Denotes the frequency of the symbol in the HCTree */
-	byte symbol; /** byte in the file we're keeping track of */
+	unsigned short symbol; /** byte, or wider symbol, we're keeping track of */
 	HCNode* c0;  /** pointer to '0' child */
 	HCNode* c1;  /** pointer to '1' child */
 	HCNode* p;   /** pointer to parent */
@@ -39,13 +39,13 @@ public:
 	 *               variables. c0, c1, and p will be set to 0 if not
 	 *               specified.
 	 *  Parameters: count - Frequency of the symbol in the HCTree
-	 *              symbol - Byte in the file we're keeping track of
+	 *              symbol - Byte, or wider symbol, we're keeping track of
 	 *              c0 - pointer to '0' child
 	 *              c1 - pointer to '1' child
 	 *              p - pointer to parent
 	 */
 	HCNode(int count,
-		byte symbol,
+		unsigned short symbol,
 		HCNode* c0 = 0,
 		HCNode* c1 = 0,
 		HCNode* p = 0)
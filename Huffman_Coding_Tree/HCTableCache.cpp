@@ -0,0 +1,166 @@
+/** Filename: HCTableCache.cpp
+ *  Name: Loc Chuong
+ *  Description: A least recently used cache of built HCTrees, keyed by a
+ *               hash of the frequency header they were built from. Repeated
+ *               headers hand back the same tree, with its encode and decode
+ *               tables, instead of running HCTree::build() again.
+ *  Date: 10/18/2026
+ */
+
+#include "HCTableCache.hpp"
+
+#define FNV_OFFSET 14695981039346656037ULL /** FNV-1a 64 bit offset basis */
+#define FNV_PRIME 1099511628211ULL /** FNV-1a 64 bit prime */
+
+/** Constructor
+ *  Description: Creates an empty cache holding up to capacity trees
+ */
+HCTableCache::HCTableCache(size_t capacity)
+	: capacity(capacity), hits(0), misses(0) {
+}
+
+/** Function Name: hashHeader(const vector<int>& freqs)
+ *  Description: FNV-1a hash of the header fields written for freqs, in the
+ *               order they are serialized.
+ *  Parameters: freqs - freqs[i] is the frequency of byte i
+ *  Return Value: The 64 bit hash
+ */
+unsigned long long HCTableCache::hashHeader(const vector<int>& freqs) {
+	unsigned long long hash = FNV_OFFSET;
+	/** Count the unique bytes first, it leads the header */
+	unsigned int uniqASCII = 0;
+	for (size_t i = 0; i < freqs.size(); i++) {
+		if (freqs[i] != 0) {
+			uniqASCII++;
+		}
+	}
+	for (int b = 0; b < 4; b++) {
+		hash = (hash ^ ((uniqASCII >> (8 * b)) & 0xFF)) * FNV_PRIME;
+	}
+	/** Then every byte present followed by its frequency */
+	for (size_t i = 0; i < freqs.size(); i++) {
+		if (freqs[i] != 0) {
+			hash = (hash ^ (unsigned int)i) * FNV_PRIME;
+			for (int b = 0; b < 4; b++) {
+				hash = (hash ^ (((unsigned int)freqs[i] >> (8 * b)) & 0xFF))
+					* FNV_PRIME;
+			}
+		}
+	}
+	return hash;
+}
+
+/** Function Name: find(unsigned long long key, const vector<int>& freqs)
+ *  Description: Looks up freqs and moves it to the front of lru. lock must
+ *               be held.
+ *  Return Value: The cached tree, or an empty pointer
+ */
+shared_ptr<const HCTree> HCTableCache::find(unsigned long long key,
+	const vector<int>& freqs) {
+	auto range = index.equal_range(key);
+	for (auto it = range.first; it != range.second; ++it) {
+		/** Same hash, make sure it is the same header */
+		if (it->second->freqs == freqs) {
+			/** Mark as most recently used */
+			lru.splice(lru.begin(), lru, it->second);
+			return it->second->tree;
+		}
+	}
+	return shared_ptr<const HCTree>();
+}
+
+/** Function Name: acquire(const vector<int>& freqs)
+ *  Description: Returns the tree built from freqs, building and caching it
+ *               on a miss.
+ *  Parameters: freqs - freqs[i] is the frequency of byte i
+ *  Return Value: A shared, read-only tree built from freqs
+ */
+shared_ptr<const HCTree> HCTableCache::acquire(const vector<int>& freqs) {
+	unsigned long long key = hashHeader(freqs);
+	{
+		lock_guard<mutex> guard(lock);
+		shared_ptr<const HCTree> tree = find(key, freqs);
+		if (tree) {
+			hits++;
+			return tree;
+		}
+	}
+	misses++;
+	/** Build outside the lock so other threads can keep hitting */
+	shared_ptr<HCTree> built = make_shared<HCTree>();
+	built->build(freqs);
+
+	lock_guard<mutex> guard(lock);
+	/** Another thread may have built the same header meanwhile */
+	shared_ptr<const HCTree> tree = find(key, freqs);
+	if (tree) {
+		return tree;
+	}
+	if (capacity == 0) {
+		return built;
+	}
+	/** Evict the least recently used tree when full */
+	if (lru.size() >= capacity) {
+		auto range = index.equal_range(lru.back().key);
+		for (auto it = range.first; it != range.second; ++it) {
+			if (it->second == prev(lru.end())) {
+				index.erase(it);
+				break;
+			}
+		}
+		lru.pop_back();
+	}
+	Entry entry;
+	entry.key = key;
+	entry.freqs = freqs;
+	entry.tree = built;
+	lru.push_front(entry);
+	index.insert(make_pair(key, lru.begin()));
+	return built;
+}
+
+/** Function Name: clear()
+ *  Description: Drops every entry and resets the counters
+ *  Return Value: None
+ */
+void HCTableCache::clear() {
+	lock_guard<mutex> guard(lock);
+	index.clear();
+	lru.clear();
+	hits = 0;
+	misses = 0;
+}
+
+/** Function Name: size() const
+ *  Description: Getter for the number of cached trees
+ *  Return Value: The number of entries in the cache
+ */
+size_t HCTableCache::size() const {
+	lock_guard<mutex> guard(lock);
+	return lru.size();
+}
+
+/** Function Name: getHits() const
+ *  Description: Getter for the number of lookups served from the cache
+ *  Return Value: The value of hits
+ */
+unsigned long long HCTableCache::getHits() const {
+	return hits;
+}
+
+/** Function Name: getMisses() const
+ *  Description: Getter for the number of lookups that had to build
+ *  Return Value: The value of misses
+ */
+unsigned long long HCTableCache::getMisses() const {
+	return misses;
+}
+
+/** Function Name: global()
+ *  Description: The process wide cache used by compress and uncompress
+ *  Return Value: A reference to the shared cache
+ */
+HCTableCache& HCTableCache::global() {
+	static HCTableCache cache;
+	return cache;
+}
@@ -0,0 +1,115 @@
+/** Filename: HCTableCache.hpp
+ *  Name: Loc Chuong
+ *  Description: A least recently used cache of built HCTrees, keyed by a
+ *               hash of the frequency header they were built from. Repeated
+ *               headers hand back the same tree, with its encode and decode
+ *               tables, instead of running HCTree::build() again. Cached
+ *               trees are read-only and can be shared across threads.
+ *  Date: 10/18/2026
+ */
+
+#ifndef HCTABLECACHE_HPP
+#define HCTABLECACHE_HPP
+
+#include <list>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <unordered_map>
+#include "HCTree.hpp"
+
+#define TABLE_CACHE_CAPACITY 64 /** Default number of trees kept around */
+
+using namespace std;
+
+/** Class Name: HCTableCache
+ *  Description: A thread safe LRU cache mapping frequency headers to built
+ *               HCTrees. Hits and misses are counted so the capacity can be
+ *               sized against a real workload.
+ */
+class HCTableCache {
+private:
+	/** Struct Name: Entry
+	 *  Description: One cached tree and the header it was built from.
+	 *               The freqs are kept to tell hash collisions apart.
+	 */
+	struct Entry {
+		unsigned long long key; /** hashHeader() of freqs */
+		vector<int> freqs; /** Frequencies the tree was built from */
+		shared_ptr<const HCTree> tree; /** The built tree */
+	};
+
+	size_t capacity; /** Max number of entries before evicting */
+	list<Entry> lru; /** Entries, most recently used first */
+	/** Index into lru by key. Colliding keys share a bucket list */
+	unordered_multimap<unsigned long long, list<Entry>::iterator> index;
+	mutable mutex lock; /** Guards lru and index */
+	atomic<unsigned long long> hits; /** Number of lookups served */
+	atomic<unsigned long long> misses; /** Number of lookups that built */
+
+	/** Function Name: find(unsigned long long key, const vector<int>& freqs)
+	 *  Description: Looks up freqs and moves it to the front of lru.
+	 *               lock must be held.
+	 *  Return Value: The cached tree, or an empty pointer
+	 */
+	shared_ptr<const HCTree> find(unsigned long long key,
+		const vector<int>& freqs);
+
+public:
+	/** Constructor
+	 *  Description: Creates an empty cache holding up to capacity trees
+	 */
+	explicit HCTableCache(size_t capacity = TABLE_CACHE_CAPACITY);
+
+	/** Function Name: acquire(const vector<int>& freqs)
+	 *  Description: Returns the tree built from freqs, building and
+	 *               caching it on a miss. The least recently used tree is
+	 *               evicted when the cache is full; callers still holding
+	 *               it keep it alive.
+	 *  PRECONDITION: freqs has at least one non zero entry.
+	 *  Parameters: freqs - freqs[i] is the frequency of byte i
+	 *  Return Value: A shared, read-only tree built from freqs
+	 */
+	shared_ptr<const HCTree> acquire(const vector<int>& freqs);
+
+	/** Function Name: hashHeader(const vector<int>& freqs)
+	 *  Description: FNV-1a hash of the header fields written for freqs,
+	 *               in the order they are serialized: the number of unique
+	 *               bytes, then each byte and its frequency.
+	 *  Parameters: freqs - freqs[i] is the frequency of byte i
+	 *  Return Value: The 64 bit hash
+	 */
+	static unsigned long long hashHeader(const vector<int>& freqs);
+
+	/** Function Name: clear()
+	 *  Description: Drops every entry and resets the counters
+	 *  Return Value: None
+	 */
+	void clear();
+
+	/** Function Name: size() const
+	 *  Description: Getter for the number of cached trees
+	 *  Return Value: The number of entries in the cache
+	 */
+	size_t size() const;
+
+	/** Function Name: getHits() const
+	 *  Description: Getter for the number of lookups served from the cache
+	 *  Return Value: The value of hits
+	 */
+	unsigned long long getHits() const;
+
+	/** Function Name: getMisses() const
+	 *  Description: Getter for the number of lookups that had to build
+	 *  Return Value: The value of misses
+	 */
+	unsigned long long getMisses() const;
+
+	/** Function Name: global()
+	 *  Description: The process wide cache used by compress and uncompress
+	 *  Return Value: A reference to the shared cache
+	 */
+	static HCTableCache& global();
+};
+
+#endif // HCTABLECACHE_HPP
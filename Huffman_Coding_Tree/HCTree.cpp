@@ -6,6 +6,10 @@
  */
 
 #include "HCTree.hpp"
+#include "BitKernels.hpp"
+#include "Trace.hpp"
+#include <climits>
+#include <cmath>
 
  /** Function Name: build(const vector<int>& freqs)
   *  Description: Uses the Huffman algorithmn to build a Huffman coding trie
@@ -18,8 +22,13 @@
   *  Return Value: None
   */
 void HCTree::build(const vector<int>& freqs) {
+	TRACE_SPAN("build tree");
 	/** Create priority queue to sort HCNode and use Huffman's algorithm */
 	priority_queue<HCNode*, vector<HCNode*>, HCNodePtrComp> pq;
+	/** Alphabets wider than a byte need more leaves */
+	if (freqs.size() > this->leaves.size()) {
+		this->leaves.resize(freqs.size(), nullptr);
+	}
 	/** Set vector of leaves in calling HCTree */
 	for (int i = 0; i < freqs.size(); i++) {
 		if (freqs[i] != 0) {
@@ -64,6 +73,111 @@ void HCTree::build(const vector<int>& freqs) {
 	this->root = pq.top();
 	/** Pop last element from priority queue */
 	pq.pop();
+	/** Precompute the codes so encode and decode skip the tree walk */
+	buildTables();
+}
+
+/** Function Name: buildTables()
+ *  Description: Walks the trie once to fill codes, codeLengths and
+ *               decodeTable so encode() and decode() do not have to walk it
+ *               per symbol.
+ *  Return Value: None
+ */
+void HCTree::buildTables() {
+	codes = vector<unsigned long long>(leaves.size(), 0);
+	codeLengths = vector<byte>(leaves.size(), 0);
+	decodeTable = vector<DecodeEntry>(1 << DECODE_TABLE_BITS);
+	maxCodeLength = 0;
+	multiWorthwhile = false;
+	if (root == nullptr) {
+		return;
+	}
+	/** A lone leaf is written as a single 0 bit, see encode() */
+	if (root->c0 == nullptr && root->c1 == nullptr) {
+		codeLengths[root->symbol] = 1;
+		maxCodeLength = 1;
+		return;
+	}
+	/** Depth first walk carrying the code of the path taken so far. With
+	 *  int counts no path is longer than 64, so a code fits in 64 bits.
+	 */
+	stack<pair<HCNode*, pair<unsigned long long, int>>> todo;
+	todo.push(make_pair(root, make_pair(0ULL, 0)));
+	while (!todo.empty()) {
+		HCNode* currNode = todo.top().first;
+		unsigned long long code = todo.top().second.first;
+		int length = todo.top().second.second;
+		todo.pop();
+		/** Leaf reached, record its code */
+		if (currNode->c0 == nullptr && currNode->c1 == nullptr) {
+			codes[currNode->symbol] = code;
+			codeLengths[currNode->symbol] = (byte)length;
+			if (length > maxCodeLength) {
+				maxCodeLength = length;
+			}
+			/** Short codes own every table slot they are a prefix of */
+			if (length <= DECODE_TABLE_BITS) {
+				int shift = DECODE_TABLE_BITS - length;
+				int first = (int)(code << shift);
+				for (int i = 0; i < (1 << shift); i++) {
+					decodeTable[first + i].symbol = currNode->symbol;
+					decodeTable[first + i].length = (byte)length;
+				}
+			}
+			continue;
+		}
+		todo.push(make_pair(currNode->c0, make_pair(code << 1, length + 1)));
+		todo.push(make_pair(currNode->c1,
+			make_pair((code << 1) | 1, length + 1)));
+	}
+	/** The multi-symbol table holds bytes, wider alphabets go without */
+	if (leaves.size() > ASCII_MAX) {
+		return;
+	}
+	/** Batching pays off when a lookup usually holds two or more codes */
+	unsigned long long totalBits = 0;
+	for (int i = 0; i < ASCII_MAX; i++) {
+		if (leaves[i] != nullptr) {
+			totalBits += (unsigned long long)leaves[i]->count * codeLengths[i];
+		}
+	}
+	multiWorthwhile = totalBits * 2 <= (unsigned long long)root->count
+		* MULTI_DECODE_BITS;
+}
+
+/** Function Name: getMultiDecodeTable() const
+ *  Description: Getter for the multi-symbol decode table, built the first
+ *               time it is asked for
+ *  Return Value: The table, or nullptr if it would not pay off
+ */
+const MultiDecodeEntry* HCTree::getMultiDecodeTable() const {
+	if (!multiWorthwhile) {
+		return nullptr;
+	}
+	call_once(multiOnce, [this]() {
+		multiDecodeTable = vector<MultiDecodeEntry>(1 << MULTI_DECODE_BITS);
+		for (int window = 0; window < (1 << MULTI_DECODE_BITS); window++) {
+			MultiDecodeEntry& entry = multiDecodeTable[window];
+			entry.count = 0;
+			entry.length = 0;
+			/** Peel whole codes off the front of the window */
+			while (entry.count < MULTI_DECODE_SYMBOLS) {
+				int left = MULTI_DECODE_BITS - entry.length;
+				/** Bits past the window read as 0 in the lookup */
+				int peek = (int)(((unsigned int)window << entry.length)
+					& ((1 << MULTI_DECODE_BITS) - 1))
+					>> (MULTI_DECODE_BITS - DECODE_TABLE_BITS);
+				const DecodeEntry& single = decodeTable[peek];
+				/** Stop once the next code is not wholly in the window */
+				if (single.length == 0 || single.length > left) {
+					break;
+				}
+				entry.symbols[entry.count++] = (byte)single.symbol;
+				entry.length += single.length;
+			}
+		}
+	});
+	return multiDecodeTable.data();
 }
 
 /** Function Name: encode(byte symbol, BitOutputStream& out) const
@@ -76,39 +190,9 @@ void HCTree::build(const vector<int>& freqs) {
  *  Return Value: None
  */
 void HCTree::encode(byte symbol, BitOutputStream& out) const {
-	/** Create pointer to leaf node */
-	HCNode* currNode = this->leaves[symbol];
-	/** Write 0s if HCTree only has one node */
-	if (currNode != nullptr && currNode->p == nullptr
-		&& currNode->c0 == nullptr && currNode->c1 == nullptr) {
-		out.writeBit(0);
-	}
-	/** Holds num of times node traverses */
-	int traverseNum = 0;
-	/** Holds the encoded symbol */
-	int encoded = 0;
-	/** Traverse to parent if possible */
-	if (currNode) {
-		while (currNode->p != nullptr) {
-			/** Checks if the currNode's parent's c0 child is this node */
-			if (currNode->p->c0 != nullptr && currNode->p->c0 == currNode) {
-				/** Set 0 at the appropriate index in encode */
-				encoded &= ~(1 << traverseNum);
-			}
-			/** Checks if the currNode's parent's c1 child is this node */
-			if (currNode->p->c1 != nullptr && currNode->p->c1 == currNode) {
-				/** Set 0 at the appropriate index in encode */
-				encoded |= (1 << traverseNum);
-			}
-			/** Increment number of traversals */
-			traverseNum++;
-			/** Traverse to parent node */
-			currNode = currNode->p;
-		}
-	}
-	/** Write the appropriate bit to the stream */
-	for (int i = 0; i < traverseNum; i++) {
-		out.writeBit(encoded >> (traverseNum - i - 1));
+	/** Symbols that are not in the tree have a length of 0 */
+	if (codeLengths[symbol] != 0) {
+		out.writeBits(codes[symbol], codeLengths[symbol]);
 	}
 }
 
@@ -163,34 +247,28 @@ void HCTree::encode(byte symbol, ofstream& out) const {
  */
 
 int HCTree::decode(BitInputStream& in) const {
-	/** Holds next bit read from BitInputStream */
-	int nextBit = 0;
 	/** Create pointer to root node */
 	HCNode* currNode = root;
+	if (currNode == nullptr) {
+		return -1;
+	}
 	/** Handles HCTree with only one node */
-	if (currNode->p == nullptr && currNode->c0 == nullptr
-		&& currNode->c1 == nullptr && currNode != nullptr) {
+	if (currNode->c0 == nullptr && currNode->c1 == nullptr) {
 		return currNode->symbol;
 	}
-	/** Checks if currNode still has children to traverse */
-	if (currNode) {
-		while (currNode->c0 != nullptr && currNode->c1 != nullptr) {
-			/** Read the next bit from the stream */
-			nextBit = in.readBits();
-			/** Check if the c0 child exists and the next bit read is 0 */
-			if (currNode->c0 != nullptr && nextBit == 0) {
-				/** Traverse to c0 child */
-				currNode = currNode->c0;
-			}
-			/** Check if the c1 child exists and the next bit read is 1 */
-			else if (currNode->c1 != nullptr && nextBit == 1) {
-				/** Traverse to c1 child */
-				currNode = currNode->c1;
-			}
-			/** Current node has no children */
-			if (currNode->c0 == nullptr && currNode->c1 == nullptr) {
-				return currNode->symbol;
-			}
+	/** Look the next bits up in the decode table */
+	const DecodeEntry& entry = decodeTable[in.peekBits(DECODE_TABLE_BITS)];
+	if (entry.length != 0) {
+		in.skipBits(entry.length);
+		return entry.symbol;
+	}
+	/** Code is longer than the table, walk the tree bit by bit */
+	while (currNode->c0 != nullptr && currNode->c1 != nullptr) {
+		/** Traverse to the child picked by the next bit */
+		currNode = (in.readBits() == 0) ? currNode->c0 : currNode->c1;
+		/** Current node has no children */
+		if (currNode->c0 == nullptr && currNode->c1 == nullptr) {
+			return currNode->symbol;
 		}
 	}
 	return -1;
@@ -231,6 +309,272 @@ int HCTree::decode(ifstream& in) const {
 	return -1;
 }
 
+/** Function Name: encodeBytes(const byte* data, size_t size,
+ *                             vector<byte>& out) const
+ *  Description: Appends the codes of size bytes to out in one go, padded
+ *               with 0 bits to a whole byte
+ *  Parameters: data - The bytes to encode
+ *              size - Number of bytes in data
+ *              out - Buffer the codes are appended to
+ *  Return Value: The number of code bits written, without padding
+ */
+size_t HCTree::encodeBytes(const byte* data, size_t size,
+	vector<byte>& out) const {
+	size_t start = out.size();
+	out.resize(start + encodeBound(*this, size));
+	size_t bits = bitKernels().encode(*this, data, size, out.data() + start);
+	/** Trim the reserve down to the bytes actually written */
+	out.resize(start + (bits + 7) / 8);
+	return bits;
+}
+
+/** Function Name: encodeBlock(const byte* data, size_t size,
+ *                             BitOutputStream& out) const
+ *  Description: Writes the codes of size bytes to out, continuing from
+ *               whatever bits out already holds
+ *  Parameters: data - The bytes to encode
+ *              size - Number of bytes in data
+ *              out - The stream the codes are written to
+ *  Return Value: None
+ */
+void HCTree::encodeBlock(const byte* data, size_t size,
+	BitOutputStream& out) const {
+	/** Scratch space for the codes, kept between calls on each thread */
+	static thread_local vector<byte> codeBuffer;
+	codeBuffer.clear();
+	size_t bits = encodeBytes(data, size, codeBuffer);
+	out.writeBitBuffer(codeBuffer.data(), bits);
+}
+
+/** Function Name: decodeBytes(const byte* in, size_t inSize, byte* out,
+ *                             size_t count) const
+ *  Description: Decodes count symbols from a buffer written by encodeBytes()
+ *  Parameters: in - The coded bytes
+ *              inSize - Number of bytes in in
+ *              out - Receives count decoded bytes
+ *              count - Number of symbols to decode
+ *  Return Value: False if the codes run past the end of in
+ */
+bool HCTree::decodeBytes(const byte* in, size_t inSize, byte* out,
+	size_t count) const {
+	/** Long runs of short codes go through the multi-symbol table */
+	if (count >= MULTI_DECODE_MIN_COUNT && getMultiDecodeTable() != nullptr) {
+		return bitKernels().decodeMulti(*this, in, inSize, out, count);
+	}
+	return bitKernels().decode(*this, in, inSize, out, count);
+}
+
+/** Function Name: decodeBits(const byte* in, size_t inSize, size_t startBit,
+ *                            byte* out, size_t count, size_t* endBit) const
+ *  Description: Shifts the codes onto a byte boundary when they do not
+ *               start on one, so the bulk loops can read them, and adds up
+ *               the code lengths of the symbols decoded to find where they
+ *               end
+ *  Return Value: False if the codes run past the end of in
+ */
+bool HCTree::decodeBits(const byte* in, size_t inSize, size_t startBit,
+	byte* out, size_t count, size_t* endBit) const {
+	size_t startByte = startBit / BUFFER_SIZE;
+	int shift = (int)(startBit % BUFFER_SIZE);
+	if (startByte > inSize || (startByte == inSize && shift != 0)) {
+		return false;
+	}
+	const byte* codes = in + startByte;
+	size_t codesSize = inSize - startByte;
+	vector<byte> aligned;
+	if (shift != 0) {
+		aligned.resize(codesSize);
+		for (size_t i = 0; i + 1 < codesSize; i++) {
+			aligned[i] = (byte)((codes[i] << shift)
+				| (codes[i + 1] >> (BUFFER_SIZE - shift)));
+		}
+		aligned[codesSize - 1] = (byte)(codes[codesSize - 1] << shift);
+		codes = aligned.data();
+	}
+	if (!decodeBytes(codes, codesSize, out, count)) {
+		return false;
+	}
+	if (endBit == nullptr && shift == 0) {
+		return true;
+	}
+	/** The shifted buffer ends in shift bits that were never in in */
+	size_t bits = 0;
+	for (size_t i = 0; i < count; i++) {
+		bits += codeLengths[out[i]];
+	}
+	if (endBit != nullptr) {
+		*endBit = startBit + bits;
+	}
+	return startBit + bits <= inSize * BUFFER_SIZE;
+}
+
+/** Function Name: headerBits(const vector<int>& freqs, int symbolBits)
+ *  Description: Size of the header writeHeader() writes for freqs
+ *  Parameters: freqs - freqs[i] is the frequency of symbol i
+ *              symbolBits - Number of bits per symbol
+ *  Return Value: The header size in bits
+ */
+int HCTree::headerBits(const vector<int>& freqs, int symbolBits) {
+	/** Number of unique ASCII characters and the largest frequency */
+	int uniqASCII = 0;
+	int maxFreq = 0;
+	for (size_t i = 0; i < freqs.size(); i++) {
+		if (freqs[i] != 0) {
+			uniqASCII++;
+		}
+		if (freqs[i] > maxFreq) {
+			maxFreq = freqs[i];
+		}
+	}
+	/** The unique count takes one bit more than a symbol, so a full
+	 *  alphabet fits: BIT_SIZE_UNIQ_ASCII for bytes
+	 */
+	if (maxFreq == 0) {
+		return symbolBits + 1 + BIT_SIZE_BIT_FREQS;
+	}
+	/** Number of bits needed to store the max frequency */
+	int bitFreqs = (int)(floor(log2((double)maxFreq)) + 1);
+	return symbolBits + 1 + BIT_SIZE_BIT_FREQS
+		+ uniqASCII * (symbolBits + bitFreqs);
+}
+
+/** Function Name: writeHeader(const vector<int>& freqs,
+ *                              BitOutputStream& out, int symbolBits)
+ *  Description: Writes the frequency header a tree is rebuilt from: the
+ *               number of unique symbols, the number of bits per frequency,
+ *               then each symbol present and its frequency.
+ *  Parameters: freqs - freqs[i] is the frequency of symbol i
+ *              out - Stream to write to
+ *              symbolBits - Number of bits per symbol
+ *  Return Value: None
+ */
+void HCTree::writeHeader(const vector<int>& freqs, BitOutputStream& out,
+	int symbolBits) {
+	/** Max frequency in vector of ASCII vals */
+	double maxFreq = 0;
+	/** Number of unique ASCII characters in our HCTree */
+	unsigned int uniqASCII = 0;
+	for (size_t i = 0; i < freqs.size(); i++) {
+		if (freqs[i] != 0) {
+			uniqASCII++;
+		}
+		if (freqs[i] > maxFreq) {
+			maxFreq = freqs[i];
+		}
+	}
+	/** Write the number of unique ASCII values */
+	out.writeInt(uniqASCII, symbolBits + 1);
+	/** Convert number of bits needed to store max frequency to byte */
+	byte bitFreqs = (byte)(floor(log2(maxFreq)) + 1);
+	/** Write the number of bits needed to represent the max frequency */
+	out.writeInt(bitFreqs, BIT_SIZE_BIT_FREQS);
+	for (size_t i = 0; i < freqs.size(); i++) {
+		/** Only write ASCII values that have frequency over 0 */
+		if (freqs[i] != 0) {
+			/** Write ASCII char to output file, LSB first like writeByte */
+			out.writeInt((int)i, symbolBits);
+			/** Write frequency of ASCII char as byte to output file */
+			out.writeInt(freqs[i], (int)bitFreqs);
+		}
+	}
+}
+
+/** Function Name: readHeader(BitInputStream& in, vector<int>& freqs,
+ *                             int symbolBits)
+ *  Description: Reads a header written by writeHeader() into freqs
+ *  Parameters: in - Stream to read from
+ *              freqs - Set to 1 << symbolBits frequencies read from in
+ *              symbolBits - Number of bits per symbol
+ *  Return Value: The sum of the frequencies read, -1 if one is negative
+ *                or they add up to more than an int holds
+ */
+int HCTree::readHeader(BitInputStream& in, vector<int>& freqs,
+	int symbolBits) {
+	freqs = vector<int>(1 << symbolBits, 0);
+	/** Read in the number of unique ASCII values */
+	int uniqASCII = in.readInt(symbolBits + 1);
+	/** Read in the number of bits needed to store frequency of ASCII */
+	int bitFreqs = in.readInt(BIT_SIZE_BIT_FREQS);
+	/** Holds the total number of ASCII in the uncompressed message */
+	long long totalFreq = 0;
+	bool valid = true;
+	/** Read in the correct number of uniq ASCII */
+	for (int i = 0; i < uniqASCII; i++) {
+		/** Read the ASCII char itself */
+		int ASCII = in.readInt(symbolBits);
+		/** Read the frequency of the ASCII char */
+		int freq = in.readInt(bitFreqs);
+		/** A frequency read from a corrupt header can be negative */
+		if (freq < 0) {
+			valid = false;
+		}
+		/** Increment the total frequency of all ASCII */
+		totalFreq += freq;
+		/** Set the frequency of the ASCII char in the freqs vector */
+		freqs[(int)ASCII] = freq;
+	}
+	if (!valid || totalFreq > INT_MAX) {
+		return -1;
+	}
+	return (int)totalFreq;
+}
+
+/** Function Name: getCode(int symbol) const
+ *  Description: Getter for the code of symbol
+ *  Return Value: The code of symbol
+ */
+unsigned long long HCTree::getCode(int symbol) const {
+	return codes[symbol];
+}
+
+/** Function Name: getCodeLength(int symbol) const
+ *  Description: Getter for the number of bits encode() writes for symbol
+ *  Return Value: The code length, 0 if symbol is not in the tree
+ */
+int HCTree::getCodeLength(int symbol) const {
+	return codeLengths[symbol];
+}
+
+/** Function Name: getCodeTable() const
+ *  Description: Getter for the codes of all ASCII_MAX bytes
+ *  Return Value: A reference to codes
+ */
+const vector<unsigned long long>& HCTree::getCodeTable() const {
+	return codes;
+}
+
+/** Function Name: getCodeLengthTable() const
+ *  Description: Getter for the code lengths of all ASCII_MAX bytes
+ *  Return Value: A reference to codeLengths
+ */
+const vector<byte>& HCTree::getCodeLengthTable() const {
+	return codeLengths;
+}
+
+/** Function Name: getRoot() const
+ *  Description: Getter for the root of the trie
+ *  Return Value: The value of root
+ */
+HCNode* HCTree::getRoot() const {
+	return root;
+}
+
+/** Function Name: getMaxCodeLength() const
+ *  Description: Getter for the length of the longest code
+ *  Return Value: The value of maxCodeLength
+ */
+int HCTree::getMaxCodeLength() const {
+	return maxCodeLength;
+}
+
+/** Function Name: getDecodeTable() const
+ *  Description: Getter for the decode table
+ *  Return Value: A reference to decodeTable
+ */
+const vector<DecodeEntry>& HCTree::getDecodeTable() const {
+	return decodeTable;
+}
+
 /** Function Name: deleteNodes(HCNode * currNode)
  *  Description: Deletes the HCTree from the root node by recursion
  *  Parameters: currNode - Pointer to the root node
@@ -12,6 +12,7 @@
 #include <vector>
 #include <stack>
 #include <fstream>
+#include <mutex>
 #include "HCNode.hpp"
 #include "BitInputStream.hpp"
 #include "BitOutputStream.hpp"
@@ -19,6 +20,34 @@
 #define ASCII_MAX 256 /** Max number of ASCII values */
 #define BIT_SIZE_UNIQ_ASCII 9 /** Num of bits to store all unique ASCII val */
 #define BIT_SIZE_BIT_FREQS 5 /** Num of bits to store bits storing freq */
+#define DECODE_TABLE_BITS 11 /** Num of bits decode() looks up at once */
+#define MULTI_DECODE_BITS 12 /** Num of bits a multi-symbol lookup covers */
+#define MULTI_DECODE_SYMBOLS 4 /** Max symbols one multi-symbol lookup emits */
+#define MULTI_DECODE_MIN_COUNT 4096 /** Fewer symbols do not pay for it */
+
+/** Struct Name: DecodeEntry
+ *  Description: One slot of the decode table. Every DECODE_TABLE_BITS bit
+ *               pattern that starts with a code no longer than
+ *               DECODE_TABLE_BITS maps to that code's symbol and length.
+ *               length is 0 when the pattern starts a longer code.
+ */
+struct DecodeEntry {
+	unsigned short symbol; /** Symbol coded by the leading bits */
+	byte length; /** Length of that code, 0 if it is longer than the table */
+};
+
+/** Struct Name: MultiDecodeEntry
+ *  Description: One slot of the multi-symbol decode table. Every
+ *               MULTI_DECODE_BITS bit pattern maps to as many whole codes
+ *               as it starts with, up to MULTI_DECODE_SYMBOLS of them.
+ *               count is 0 when the pattern does not hold a whole code.
+ */
+struct MultiDecodeEntry {
+	byte symbols[MULTI_DECODE_SYMBOLS]; /** The decoded symbols, in order */
+	byte count; /** How many of symbols are valid */
+	byte length; /** Total length of those codes in bits */
+	byte unused[2]; /** Pads the entry to 8 bytes */
+};
 
 using namespace std;
 
@@ -47,6 +76,22 @@ public:
 class HCTree {
 private:
 	HCNode* root; /** Pointer to the root HCNode in the HCTree */
+	vector<unsigned long long> codes; /** codes[i] holds the code of byte i */
+	vector<byte> codeLengths; /** Length of codes[i], 0 if i is not coded */
+	vector<DecodeEntry> decodeTable; /** Lookup table used by decode() */
+	int maxCodeLength; /** Length of the longest code in the tree */
+	bool multiWorthwhile; /** Whether codes are short enough to batch */
+	mutable once_flag multiOnce; /** Builds multiDecodeTable once */
+	/** Lookup table emitting several symbols at once, built on demand */
+	mutable vector<MultiDecodeEntry> multiDecodeTable;
+
+	/** Function Name: buildTables()
+	 *  Description: Walks the trie once to fill codes, codeLengths and
+	 *               decodeTable so encode() and decode() do not have to
+	 *               walk it per symbol.
+	 *  Return Value: None
+	 */
+	void buildTables();
 
 public:
 	vector<HCNode*> leaves; /** Vector of pointers to leaves of HCTree */
@@ -54,7 +99,7 @@ public:
 	 *  Description: Creates a HCTree with no root and a set leaves vector
 	 *               of size 256(MAX ASCII Chars)
 	 */
-	explicit HCTree() : root(0) {
+	explicit HCTree() : root(0), maxCodeLength(0), multiWorthwhile(false) {
 		leaves = vector<HCNode*>(256, (HCNode*)0);
 	}
 
@@ -72,11 +117,14 @@ public:
 
 	/** Function Name: build(const vector<int>& freqs)
 	 *  Description: Uses the Huffman algorithmn to build a Huffman coding
-	 *               trie
+	 *               trie. freqs may be longer than ASCII_MAX for alphabets
+	 *               wider than a byte; such trees code with encodeSymbols()
+	 *               and decodeSymbols() and have no multi-symbol table.
 	 *  PRECONDITION: freqs is a vector of ints, such that freqs[i] is the
 	 *                frequency of occurence of byte i in the message.
 	 *  POSTCONDITION: root points to the root of the trie, and leaves[i]
-	 *                 points to the leaf node containing byte i.
+	 *                 points to the leaf node containing byte i. The
+	 *                 encode and decode tables are built.
 	 *  Parameters: freqs - A vector of ints s.t. freqs[i] is the frequency
 	 *                      of occurence of byte i in the message
 	 *  Return Value: None
@@ -127,6 +175,160 @@ public:
 	 *                the ifstream
 	 */
 	int decode(ifstream& in) const;
+
+	/** Function Name: encodeBytes(const byte* data, size_t size,
+	 *                             vector<byte>& out) const
+	 *  Description: Appends the codes of size bytes to out in one go,
+	 *               padded with 0 bits to a whole byte, using the bulk
+	 *               loop picked for this CPU. Writes the same bits as
+	 *               calling encode() on every byte.
+	 *  PRECONDITION: build() has been called.
+	 *  Parameters: data - The bytes to encode
+	 *              size - Number of bytes in data
+	 *              out - Buffer the codes are appended to
+	 *  Return Value: The number of code bits written, without padding
+	 */
+	size_t encodeBytes(const byte* data, size_t size, vector<byte>& out) const;
+
+	/** Function Name: encodeBlock(const byte* data, size_t size,
+	 *                             BitOutputStream& out) const
+	 *  Description: Writes the codes of size bytes to out, continuing from
+	 *               whatever bits out already holds. The codes are placed by
+	 *               the bulk loop picked for this CPU, then handed to out in
+	 *               one piece. Writes the same bits as calling encode() on
+	 *               every byte.
+	 *  PRECONDITION: build() has been called.
+	 *  Parameters: data - The bytes to encode
+	 *              size - Number of bytes in data
+	 *              out - The stream the codes are written to
+	 *  Return Value: None
+	 */
+	void encodeBlock(const byte* data, size_t size, BitOutputStream& out) const;
+
+	/** Function Name: decodeBytes(const byte* in, size_t inSize, byte* out,
+	 *                             size_t count) const
+	 *  Description: Decodes count symbols from a buffer written by
+	 *               encodeBytes(), using the bulk loop picked for this CPU
+	 *  PRECONDITION: build() has been called.
+	 *  Parameters: in - The coded bytes
+	 *              inSize - Number of bytes in in
+	 *              out - Receives count decoded bytes
+	 *              count - Number of symbols to decode
+	 *  Return Value: False if the codes run past the end of in
+	 */
+	bool decodeBytes(const byte* in, size_t inSize, byte* out,
+		size_t count) const;
+
+	/** Function Name: decodeBits(const byte* in, size_t inSize,
+	 *                            size_t startBit, byte* out, size_t count,
+	 *                            size_t* endBit) const
+	 *  Description: Decodes count symbols whose codes start at bit startBit
+	 *               of in, such as the payload after a header that does not
+	 *               end on a byte, through decodeBytes()
+	 *  PRECONDITION: build() has been called.
+	 *  Parameters: in - The coded bytes
+	 *              inSize - Number of bytes in in
+	 *              startBit - Bit offset of the first code in in
+	 *              out - Receives count decoded bytes
+	 *              count - Number of symbols to decode
+	 *              endBit - Set to the bit offset after the last code, if
+	 *                       not nullptr
+	 *  Return Value: False if the codes run past the end of in
+	 */
+	bool decodeBits(const byte* in, size_t inSize, size_t startBit,
+		byte* out, size_t count, size_t* endBit = nullptr) const;
+
+	/** Function Name: writeHeader(const vector<int>& freqs,
+	 *                              BitOutputStream& out, int symbolBits)
+	 *  Description: Writes the frequency header a tree is rebuilt from:
+	 *               the number of unique symbols, the number of bits per
+	 *               frequency, then each symbol present and its frequency.
+	 *  Parameters: freqs - freqs[i] is the frequency of symbol i
+	 *              out - Stream to write to
+	 *              symbolBits - Number of bits per symbol, a byte unless
+	 *                           the alphabet is wider
+	 *  Return Value: None
+	 */
+	static void writeHeader(const vector<int>& freqs, BitOutputStream& out,
+		int symbolBits = BUFFER_SIZE);
+
+	/** Function Name: readHeader(BitInputStream& in, vector<int>& freqs,
+	 *                             int symbolBits)
+	 *  Description: Reads a header written by writeHeader() into freqs
+	 *  Parameters: in - Stream to read from
+	 *              freqs - Set to 1 << symbolBits frequencies read from in
+	 *              symbolBits - Number of bits per symbol
+	 *  Return Value: The sum of the frequencies read, -1 if one is negative
+	 *                or they add up to more than an int holds
+	 */
+	static int readHeader(BitInputStream& in, vector<int>& freqs,
+		int symbolBits = BUFFER_SIZE);
+
+	/** Function Name: headerBits(const vector<int>& freqs, int symbolBits)
+	 *  Description: Size of the header writeHeader() writes for freqs
+	 *  Parameters: freqs - freqs[i] is the frequency of symbol i
+	 *              symbolBits - Number of bits per symbol
+	 *  Return Value: The header size in bits
+	 */
+	static int headerBits(const vector<int>& freqs,
+		int symbolBits = BUFFER_SIZE);
+
+	/** Function Name: getCode(int symbol) const
+	 *  Description: Getter for the code of symbol, stored in the low
+	 *               getCodeLength(symbol) bits with the first bit written
+	 *               as the most significant one.
+	 *  Return Value: The code of symbol
+	 */
+	unsigned long long getCode(int symbol) const;
+
+	/** Function Name: getCodeLength(int symbol) const
+	 *  Description: Getter for the number of bits encode() writes for
+	 *               symbol
+	 *  Return Value: The code length, 0 if symbol is not in the tree
+	 */
+	int getCodeLength(int symbol) const;
+
+	/** Function Name: getMultiDecodeTable() const
+	 *  Description: Getter for the multi-symbol decode table, which has
+	 *               1 << MULTI_DECODE_BITS entries. The table is built the
+	 *               first time it is asked for, and only if the average
+	 *               code is at most half of MULTI_DECODE_BITS long, so most
+	 *               lookups emit two or more symbols. Safe to call from
+	 *               several threads.
+	 *  Return Value: The table, or nullptr if it would not pay off
+	 */
+	const MultiDecodeEntry* getMultiDecodeTable() const;
+
+	/** Function Name: getCodeTable() const
+	 *  Description: Getter for the codes of all ASCII_MAX bytes
+	 *  Return Value: A reference to codes
+	 */
+	const vector<unsigned long long>& getCodeTable() const;
+
+	/** Function Name: getCodeLengthTable() const
+	 *  Description: Getter for the code lengths of all ASCII_MAX bytes
+	 *  Return Value: A reference to codeLengths
+	 */
+	const vector<byte>& getCodeLengthTable() const;
+
+	/** Function Name: getRoot() const
+	 *  Description: Getter for the root of the trie
+	 *  Return Value: The value of root
+	 */
+	HCNode* getRoot() const;
+
+	/** Function Name: getMaxCodeLength() const
+	 *  Description: Getter for the length of the longest code
+	 *  Return Value: The value of maxCodeLength
+	 */
+	int getMaxCodeLength() const;
+
+	/** Function Name: getDecodeTable() const
+	 *  Description: Getter for the decode table, which has
+	 *               1 << DECODE_TABLE_BITS entries
+	 *  Return Value: A reference to decodeTable
+	 */
+	const vector<DecodeEntry>& getDecodeTable() const;
 };
 
 #endif // HCTREE_H
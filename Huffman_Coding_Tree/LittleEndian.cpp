@@ -0,0 +1,69 @@
+/** Filename: LittleEndian.cpp
+ *  Name: Loc Chuong
+ *  Description: Little endian numbers in byte buffers and streams.
+ *  Date: 10/19/2026
+ */
+
+#include "LittleEndian.hpp"
+
+/** Function Name: putNumber(vector<byte>& out, unsigned long long value,
+ *                           int bytes)
+ *  Description: Appends the low bytes of value to out, little endian
+ *  Return Value: None
+ */
+void putNumber(vector<byte>& out, unsigned long long value, int bytes) {
+	for (int i = 0; i < bytes; i++) {
+		out.push_back((byte)(value >> (8 * i)));
+	}
+}
+
+/** Function Name: loadNumber(const byte* in, int bytes)
+ *  Description: Reads a little endian number of bytes bytes
+ *  Return Value: The number
+ */
+unsigned long long loadNumber(const byte* in, int bytes) {
+	unsigned long long value = 0;
+	for (int i = 0; i < bytes; i++) {
+		value |= (unsigned long long)in[i] << (8 * i);
+	}
+	return value;
+}
+
+/** Function Name: getNumber(const vector<byte>& in, size_t& pos, int bytes,
+ *                           unsigned long long& value)
+ *  Description: Reads a little endian number of bytes bytes at pos and
+ *               moves pos past it
+ *  Return Value: False if in ends first
+ */
+bool getNumber(const vector<byte>& in, size_t& pos, int bytes,
+	unsigned long long& value) {
+	if (in.size() - pos < (size_t)bytes) {
+		return false;
+	}
+	value = loadNumber(in.data() + pos, bytes);
+	pos += bytes;
+	return true;
+}
+
+/** Function Name: writeU32(ostream& out, unsigned int value)
+ *  Description: Writes value as 4 little endian bytes
+ *  Return Value: None
+ */
+void writeU32(ostream& out, unsigned int value) {
+	for (int i = 0; i < 4; i++) {
+		out.put((char)((value >> (8 * i)) & 0xFF));
+	}
+}
+
+/** Function Name: readU32(istream& in, unsigned int& value)
+ *  Description: Reads 4 little endian bytes into value
+ *  Return Value: False if the stream ran out
+ */
+bool readU32(istream& in, unsigned int& value) {
+	byte bytes[4];
+	if (!in.read((char*)bytes, 4)) {
+		return false;
+	}
+	value = (unsigned int)loadNumber(bytes, 4);
+	return true;
+}
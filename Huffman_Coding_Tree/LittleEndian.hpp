@@ -0,0 +1,58 @@
+/** Filename: LittleEndian.hpp
+ *  Name: Loc Chuong
+ *  Description: Reads and writes the little endian numbers every container
+ *               format of the Huffman Coding Tree is built from: the block,
+ *               archive, column, log and pack formats all store their sizes,
+ *               offsets and checksums this way.
+ *  Date: 10/19/2026
+ */
+
+#ifndef LITTLEENDIAN_HPP
+#define LITTLEENDIAN_HPP
+
+#include <cstddef>
+#include <iostream>
+#include <vector>
+#include "HCNode.hpp"
+
+using namespace std;
+
+/** Function Name: putNumber(vector<byte>& out, unsigned long long value,
+ *                           int bytes)
+ *  Description: Appends the low bytes of value to out, little endian
+ *  Parameters: out - Receives the bytes
+ *              value - The number
+ *              bytes - How many bytes of it to write, at most 8
+ *  Return Value: None
+ */
+void putNumber(vector<byte>& out, unsigned long long value, int bytes);
+
+/** Function Name: loadNumber(const byte* in, int bytes)
+ *  Description: Reads a little endian number of bytes bytes
+ *  PRECONDITION: in holds bytes bytes
+ *  Return Value: The number
+ */
+unsigned long long loadNumber(const byte* in, int bytes);
+
+/** Function Name: getNumber(const vector<byte>& in, size_t& pos, int bytes,
+ *                           unsigned long long& value)
+ *  Description: Reads a little endian number of bytes bytes at pos and
+ *               moves pos past it
+ *  Return Value: False if in ends first
+ */
+bool getNumber(const vector<byte>& in, size_t& pos, int bytes,
+	unsigned long long& value);
+
+/** Function Name: writeU32(ostream& out, unsigned int value)
+ *  Description: Writes value as 4 little endian bytes
+ *  Return Value: None
+ */
+void writeU32(ostream& out, unsigned int value);
+
+/** Function Name: readU32(istream& in, unsigned int& value)
+ *  Description: Reads 4 little endian bytes into value
+ *  Return Value: False if the stream ran out
+ */
+bool readU32(istream& in, unsigned int& value);
+
+#endif // LITTLEENDIAN_HPP
@@ -0,0 +1,259 @@
+/** Filename: MessageCodec.cpp
+ *  Name: Loc Chuong
+ *  Description: Codes small messages with a reusable table, from and into
+ *               caller buffers, without allocating.
+ *  Date: 10/19/2026
+ */
+
+#include "MessageCodec.hpp"
+#include <cstdint>
+#include <cstring>
+
+#define MESSAGE_GROUP_SIZE (1 << MESSAGE_GROUP_BITS) /** Symbols per group */
+
+/** Function Name: putMask(byte* out, unsigned int mask)
+ *  Description: Writes a 2 byte mask, little endian
+ *  Return Value: None
+ */
+static inline void putMask(byte* out, unsigned int mask) {
+	out[0] = (byte)mask;
+	out[1] = (byte)(mask >> 8);
+}
+
+/** Function Name: getMask(const byte* in)
+ *  Description: Reads a 2 byte mask, little endian
+ *  Return Value: The mask
+ */
+static inline unsigned int getMask(const byte* in) {
+	return in[0] | ((unsigned int)in[1] << 8);
+}
+
+/** Constructor
+ *  Description: Creates a context with a workspace of its own
+ */
+MessageCodec::MessageCodec() : storage(arenaBytes()),
+	work(place(storage.data())) {
+}
+
+/** Constructor
+ *  Description: Creates a context whose workspace lives in arena, or an
+ *               invalid one if arena cannot hold it
+ */
+MessageCodec::MessageCodec(void* arena, size_t arenaSize)
+	: work(arena != nullptr && arenaSize >= arenaBytes() ? place(arena)
+		: nullptr) {
+}
+
+/** Function Name: isValid() const
+ *  Description: Whether the context has a workspace to code with
+ *  Return Value: False if it was given an arena that is too small
+ */
+bool MessageCodec::isValid() const {
+	return work != nullptr;
+}
+
+/** Function Name: place(void* arena)
+ *  Description: Rounds the start of arena up to the workspace alignment
+ *  Return Value: The workspace
+ */
+MessageWorkspace* MessageCodec::place(void* arena) {
+	uintptr_t start = (uintptr_t)arena;
+	uintptr_t align = alignof(MessageWorkspace);
+	return (MessageWorkspace*)((start + align - 1) & ~(align - 1));
+}
+
+/** Function Name: arenaBytes()
+ *  Description: Size of the arena a context needs, alignment included
+ *  Return Value: The size in bytes
+ */
+size_t MessageCodec::arenaBytes() {
+	return sizeof(MessageWorkspace) + alignof(MessageWorkspace) - 1;
+}
+
+/** Function Name: encodeBound(size_t size)
+ *  Description: Bytes encode() may write for a message of size bytes
+ *  Return Value: The bound in bytes
+ */
+size_t MessageCodec::encodeBound(size_t size) {
+	/** A message that does not shrink is stored */
+	return MESSAGE_SIZE_BYTES + 2 + size;
+}
+
+/** Function Name: encode(const byte* data, size_t size, byte* out)
+ *  Description: Counts the message, builds its length-limited code
+ *               lengths, and writes them and the codes, or the message as
+ *               it is if the header and codes would not be smaller
+ *  Return Value: Number of bytes written to out, 0 if the context is not
+ *                valid
+ */
+size_t MessageCodec::encode(const byte* data, size_t size, byte* out) {
+	if (work == nullptr) {
+		return 0;
+	}
+	size_t pos = 0;
+	size_t left = size;
+	while (left >= 0x80) {
+		out[pos++] = (byte)(left | 0x80);
+		left >>= 7;
+	}
+	out[pos++] = (byte)left;
+	if (size == 0) {
+		return pos;
+	}
+
+	int* freqs = work->freqs;
+	StaticTable& table = work->table;
+	memset(freqs, 0, sizeof(work->freqs));
+	for (size_t i = 0; i < size; i++) {
+		freqs[data[i]]++;
+	}
+	memset(table.lengths, 0, sizeof(table.lengths));
+	staticCodeLengths(work->freqs, table);
+	staticLimitLengths(work->freqs, table);
+
+	/** Cost of coding it, to compare with storing it */
+	unsigned int groups = 0;
+	unsigned int symbolMasks[MESSAGE_GROUPS] = {};
+	int coded = 0;
+	unsigned long long bits = 0;
+	for (int s = 0; s < ASCII_MAX; s++) {
+		if (table.lengths[s] != 0) {
+			groups |= 1u << (s >> MESSAGE_GROUP_BITS);
+			symbolMasks[s >> MESSAGE_GROUP_BITS] |=
+				1u << (s & (MESSAGE_GROUP_SIZE - 1));
+			coded++;
+			bits += (unsigned long long)freqs[s] * table.lengths[s];
+		}
+	}
+	size_t headerBytes = 2 + (coded + 1) / 2;
+	for (int g = 0; g < MESSAGE_GROUPS; g++) {
+		if (groups & (1u << g)) {
+			headerBytes += 2;
+		}
+	}
+	if (headerBytes + (bits + 7) / 8 >= 2 + size) {
+		putMask(out + pos, MESSAGE_STORED);
+		memcpy(out + pos + 2, data, size);
+		return pos + 2 + size;
+	}
+
+	putMask(out + pos, groups);
+	pos += 2;
+	for (int g = 0; g < MESSAGE_GROUPS; g++) {
+		if (groups & (1u << g)) {
+			putMask(out + pos, symbolMasks[g]);
+			pos += 2;
+		}
+	}
+	/** Two lengths to a byte, the first in the high nibble */
+	int nibble = 0;
+	for (int s = 0; s < ASCII_MAX; s++) {
+		if (table.lengths[s] == 0) {
+			continue;
+		}
+		if (nibble == 0) {
+			out[pos] = (byte)(table.lengths[s] << 4);
+		}
+		else {
+			out[pos++] |= table.lengths[s];
+		}
+		nibble ^= 1;
+	}
+	pos += nibble;
+	staticAssignCodes(table);
+	return pos + (staticEncode(table, data, size, out + pos) + 7) / 8;
+}
+
+/** Function Name: decode(const byte* in, size_t inSize, byte* out,
+ *                        size_t capacity, size_t& size)
+ *  Description: Reads the header, checks the lengths make a prefix code
+ *               of at most STATIC_MAX_BITS bits, rebuilds its decode table
+ *               and decodes the codes
+ *  Return Value: False if the message is malformed or longer than
+ *                capacity, or the context is not valid
+ */
+bool MessageCodec::decode(const byte* in, size_t inSize, byte* out,
+	size_t capacity, size_t& size) {
+	size_t pos = 0;
+	size = 0;
+	if (work == nullptr) {
+		return false;
+	}
+	for (int shift = 0; ; shift += 7) {
+		if (pos == inSize || pos == MESSAGE_SIZE_BYTES) {
+			return false;
+		}
+		size |= (size_t)(in[pos] & 0x7F) << shift;
+		if ((in[pos++] & 0x80) == 0) {
+			break;
+		}
+	}
+	if (size > MESSAGE_MAX_SIZE || size > capacity) {
+		return false;
+	}
+	if (size == 0) {
+		return pos == inSize;
+	}
+	if (inSize - pos < 2) {
+		return false;
+	}
+	unsigned int groups = getMask(in + pos);
+	pos += 2;
+	if (groups == MESSAGE_STORED) {
+		if (inSize - pos != size) {
+			return false;
+		}
+		memcpy(out, in + pos, size);
+		return true;
+	}
+
+	/** Which symbols have a code */
+	StaticTable& table = work->table;
+	memset(table.lengths, 0, sizeof(table.lengths));
+	int coded = 0;
+	for (int g = 0; g < MESSAGE_GROUPS; g++) {
+		if ((groups & (1u << g)) == 0) {
+			continue;
+		}
+		if (inSize - pos < 2) {
+			return false;
+		}
+		unsigned int mask = getMask(in + pos);
+		pos += 2;
+		if (mask == 0) {
+			return false;
+		}
+		for (int i = 0; i < MESSAGE_GROUP_SIZE; i++) {
+			if (mask & (1u << i)) {
+				/** Marked for now, the real length is read below */
+				table.lengths[(g << MESSAGE_GROUP_BITS) + i] = 1;
+				coded++;
+			}
+		}
+	}
+	if (inSize - pos < (size_t)(coded + 1) / 2) {
+		return false;
+	}
+	/** Read the lengths and add up the code space they take */
+	long long space = 0;
+	int nibble = 0;
+	for (int s = 0; s < ASCII_MAX; s++) {
+		if (table.lengths[s] == 0) {
+			continue;
+		}
+		int length = nibble == 0 ? in[pos] >> 4 : in[pos++] & 0x0F;
+		nibble ^= 1;
+		if (length == 0 || length > STATIC_MAX_BITS) {
+			return false;
+		}
+		table.lengths[s] = (byte)length;
+		space += 1LL << (STATIC_MAX_BITS - length);
+	}
+	pos += nibble;
+	if (space > STATIC_TABLE_SIZE) {
+		return false;
+	}
+	staticAssignCodes(table);
+	staticFillDecode(table);
+	return staticDecode(table, in + pos, inSize - pos, out, size);
+}
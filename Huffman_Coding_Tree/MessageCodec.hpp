@@ -0,0 +1,136 @@
+/** Filename: MessageCodec.hpp
+ *  Name: Loc Chuong
+ *  Description: A reusable codec context for small messages. compress()
+ *               spends most of a 1 KB message on setup: a tree of new'd
+ *               nodes, streams and strings for the header. A MessageCodec
+ *               keeps one table and histogram, allocated once or placed in
+ *               memory the caller hands it, and codes every message from
+ *               and into caller buffers with the length-limited canonical
+ *               codes of StaticCodec.hpp, so steady state coding never
+ *               touches the heap. Nothing carries over from one message to
+ *               the next, so there is nothing to reset between them.
+ *
+ *               A message is laid out as
+ *                 raw size (1 to MESSAGE_SIZE_BYTES bytes, 7 bits each,
+ *                   low first, top bit set on all but the last)
+ *               and unless the raw size is 0
+ *                 group mask (2 bytes), bit g set if any of the symbols
+ *                   16g to 16g + 15 has a code
+ *                 per group set: symbol mask (2 bytes), bit i set if
+ *                   symbol 16g + i has a code
+ *                 per symbol with a code, in order: its length (4 bits,
+ *                   high nibble first), padded to a byte
+ *                 the codes, first bit in the top bit of each byte
+ *               with the masks little endian. A group mask of 0 means the
+ *               raw bytes follow as they are, for messages that would not
+ *               get smaller.
+ *  Date: 10/19/2026
+ */
+
+#ifndef MESSAGECODEC_HPP
+#define MESSAGECODEC_HPP
+
+#include <vector>
+#include "StaticCodec.hpp"
+
+#define MESSAGE_MAX_SIZE 0x7FFFFFFF /** Largest message, fits an int count */
+#define MESSAGE_SIZE_BYTES 5 /** Longest raw size field */
+#define MESSAGE_GROUP_BITS 4 /** Symbols per group are 1 << this */
+#define MESSAGE_GROUPS (ASCII_MAX >> MESSAGE_GROUP_BITS) /** Symbol groups */
+#define MESSAGE_STORED 0 /** Group mask of a message stored as it is */
+
+using namespace std;
+
+/** Struct Name: MessageWorkspace
+ *  Description: The scratch memory of a MessageCodec
+ */
+struct MessageWorkspace {
+	StaticTable table; /** Code table of the message being coded */
+	int freqs[ASCII_MAX]; /** Histogram of the message being encoded */
+};
+
+/** Class Name: MessageCodec
+ *  Description: Encodes and decodes one message at a time with a table of
+ *               its own. A context is not safe to share between threads;
+ *               give every thread its own.
+ */
+class MessageCodec {
+private:
+	vector<byte> storage; /** Workspace memory, unless the caller gave some */
+	MessageWorkspace* work; /** The workspace, nullptr if the arena was
+	                         *  too small */
+
+	/** Function Name: place(void* arena)
+	 *  Description: Finds the aligned workspace inside arena
+	 *  PRECONDITION: arena holds arenaBytes() bytes
+	 *  Return Value: The workspace
+	 */
+	static MessageWorkspace* place(void* arena);
+
+public:
+	/** Constructor
+	 *  Description: Creates a context with a workspace of its own, the
+	 *               only allocation it ever makes
+	 */
+	MessageCodec();
+
+	/** Constructor
+	 *  Description: Creates a context whose workspace lives in arena. The
+	 *               context never allocates; arena has to outlive it. An
+	 *               arena smaller than arenaBytes() leaves the context
+	 *               invalid, see isValid().
+	 */
+	MessageCodec(void* arena, size_t arenaSize);
+
+	/** The workspace pointer must not be shared by two contexts */
+	MessageCodec(const MessageCodec&) = delete;
+	MessageCodec& operator=(const MessageCodec&) = delete;
+
+	/** Function Name: isValid() const
+	 *  Description: Whether the context has a workspace to code with
+	 *  Return Value: False if it was given an arena that is too small
+	 */
+	bool isValid() const;
+
+	/** Function Name: arenaBytes()
+	 *  Description: Size of the arena a context needs, alignment included
+	 *  Return Value: The size in bytes
+	 */
+	static size_t arenaBytes();
+
+	/** Function Name: encodeBound(size_t size)
+	 *  Description: Bytes encode() may write for a message of size bytes
+	 *  Return Value: The bound in bytes
+	 */
+	static size_t encodeBound(size_t size);
+
+	/** Function Name: encode(const byte* data, size_t size, byte* out)
+	 *  Description: Writes the message in data to out, coded with a table
+	 *               built from its own histogram, or stored if that does
+	 *               not make it smaller
+	 *  PRECONDITION: size <= MESSAGE_MAX_SIZE and out holds
+	 *                encodeBound(size) bytes
+	 *  Parameters: data - The message
+	 *              size - Number of bytes in data
+	 *              out - Receives the coded message
+	 *  Return Value: Number of bytes written to out, 0 if the context is
+	 *                not valid
+	 */
+	size_t encode(const byte* data, size_t size, byte* out);
+
+	/** Function Name: decode(const byte* in, size_t inSize, byte* out,
+	 *                        size_t capacity, size_t& size)
+	 *  Description: Decodes a message written by encode()
+	 *  Parameters: in - The coded message
+	 *              inSize - Number of bytes in in
+	 *              out - Receives the message
+	 *              capacity - Number of bytes out holds
+	 *              size - Set to the size of the message
+	 *  Return Value: False if the message is malformed or longer than
+	 *                capacity, or the context is not valid
+	 */
+	bool decode(const byte* in, size_t inSize, byte* out, size_t capacity,
+		size_t& size);
+};
+
+#endif // MESSAGECODEC_HPP
@@ -0,0 +1,638 @@
+/** Filename: PackArchive.cpp
+ *  Name: Loc Chuong
+ *  Description: Packs many files into one archive with a central directory,
+ *               and extracts any or all of its members.
+ *  Date: 10/18/2026
+ */
+
+#include "PackArchive.hpp"
+#include "HCTableCache.hpp"
+#include "SizeEstimator.hpp"
+#include "Crc32.hpp"
+#include "LittleEndian.hpp"
+#include "Trace.hpp"
+#include <climits>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+#define PACK_READ_SIZE (1 << 16) /** Bytes counted per read of a file */
+
+/** Struct Name: PackPlan
+ *  Description: What the first pass learned about one file
+ */
+struct PackPlan {
+	vector<int> freqs; /** Histogram of the file */
+	unsigned long long size; /** Size of the file */
+	unsigned long long ownBytes; /** Its table and body with its own table */
+	unsigned int tableId; /** Table picked for it */
+	bool ok; /** Whether the file could be read */
+};
+
+/** Struct Name: PackBody
+ *  Description: One coded member, waiting to be written
+ */
+struct PackBody {
+	vector<byte> table; /** Its own table, empty if it has none */
+	vector<byte> body; /** The coded or raw bytes */
+	unsigned int crc; /** CRC-32 of the file */
+	bool ok; /** Whether the file read back as first counted */
+};
+
+/** Function Name: tableBytes(const vector<int>& freqs)
+ *  Description: The frequency header of freqs, padded to a whole byte
+ *  Return Value: The header bytes
+ */
+static vector<byte> tableBytes(const vector<int>& freqs) {
+	ostringstream header;
+	BitOutputStream headerBOS(header);
+	HCTree::writeHeader(freqs, headerBOS);
+	while (headerBOS.getnbits() != 0) {
+		headerBOS.writeBit(0);
+	}
+	string bytes = header.str();
+	return vector<byte>(bytes.begin(), bytes.end());
+}
+
+/** Function Name: readFile(const string& path, vector<byte>& data)
+ *  Description: Reads the whole file at path into data
+ *  Return Value: False if it could not be read
+ */
+static bool readFile(const string& path, vector<byte>& data) {
+	ifstream file(path, ios::binary);
+	if (!file) {
+		return false;
+	}
+	data.assign(istreambuf_iterator<char>(file), istreambuf_iterator<char>());
+	return !file.bad();
+}
+
+/** Function Name: countFile(const string& path, PackPlan& plan)
+ *  Description: Reads the file at path a piece at a time into its
+ *               histogram and sizes it coded with a table of its own
+ *  Return Value: None
+ */
+static void countFile(const string& path, PackPlan& plan) {
+	TRACE_SPAN("count");
+	plan.freqs.assign(ASCII_MAX, 0);
+	plan.size = 0;
+	ifstream file(path, ios::binary);
+	plan.ok = (bool)file;
+	vector<char> buffer(PACK_READ_SIZE);
+	while (plan.ok) {
+		file.read(buffer.data(), buffer.size());
+		streamsize got = file.gcount();
+		for (streamsize i = 0; i < got; i++) {
+			plan.freqs[(byte)buffer[i]]++;
+		}
+		plan.size += got;
+		if (plan.size > INT_MAX) {
+			/** Frequencies are ints */
+			plan.ok = false;
+		}
+		if (got < (streamsize)buffer.size()) {
+			plan.ok = plan.ok && !file.bad();
+			break;
+		}
+	}
+	plan.ownBytes = plan.size == 0 ? 0
+		: (HCTree::headerBits(plan.freqs) + 7) / 8
+		+ (huffmanPayloadBits(plan.freqs) + 7) / 8;
+}
+
+/** Function Name: isSafeName(const string& name)
+ *  Description: Whether name is a relative path with no root, drive or ".."
+ *               component, which cannot be unpacked outside the directory
+ *               it is unpacked in
+ *  Return Value: True if name is safe to unpack
+ */
+static bool isSafeName(const string& name) {
+	if (name.empty() || name[0] == '/' || name[0] == '\\'
+		|| (name.size() >= 2 && name[1] == ':')
+		|| name.find('\0') != string::npos) {
+		return false;
+	}
+	size_t start = 0;
+	while (start <= name.size()) {
+		size_t end = name.find_first_of("/\\", start);
+		if (end == string::npos) {
+			end = name.size();
+		}
+		if (name.compare(start, end - start, "..") == 0) {
+			return false;
+		}
+		start = end + 1;
+	}
+	return true;
+}
+
+/** Constructor
+ *  Description: Creates a PackWriter using up to threads threads
+ */
+PackWriter::PackWriter(int threads, bool shareTables) :
+	threads(threads < 1 ? 1 : threads), shareTables(shareTables),
+	tableCount(0), sharedCount(0), rawCount(0) {
+}
+
+/** Function Name: memberName(const string& path)
+ *  Description: Splits path on slashes and backslashes and rebuilds it from
+ *               its components, skipping empty and "." ones, letting ".."
+ *               drop the component before it and nothing more, and leaving
+ *               out a drive
+ *  Return Value: The relative name, empty if nothing of path is left
+ */
+string PackWriter::memberName(const string& path) {
+	vector<string> parts;
+	size_t start = 0;
+	/** A drive such as C: is a root as much as a leading slash is */
+	if (path.size() >= 2 && path[1] == ':') {
+		start = 2;
+	}
+	while (start <= path.size()) {
+		size_t end = path.find_first_of("/\\", start);
+		if (end == string::npos) {
+			end = path.size();
+		}
+		string part = path.substr(start, end - start);
+		if (part == "..") {
+			if (!parts.empty()) {
+				parts.pop_back();
+			}
+		}
+		else if (!part.empty() && part != ".") {
+			parts.push_back(part);
+		}
+		start = end + 1;
+	}
+	string name;
+	for (size_t i = 0; i < parts.size(); i++) {
+		name += (i == 0 ? "" : "/") + parts[i];
+	}
+	return name;
+}
+
+/** Function Name: write(const vector<string>& paths, ostream& out)
+ *  Description: Counts every file in parallel, picks a table for each,
+ *               then codes them a batch at a time and writes the bodies,
+ *               the directory and the trailer
+ *  Return Value: False if a file could not be read or has no usable name
+ */
+bool PackWriter::write(const vector<string>& paths, ostream& out) {
+	TRACE_SPAN("pack");
+	tableCount = 0;
+	sharedCount = 0;
+	rawCount = 0;
+	failedPath.clear();
+	size_t count = paths.size();
+	vector<string> names(count);
+	for (size_t i = 0; i < count; i++) {
+		names[i] = memberName(paths[i]);
+		if (names[i].empty() || names[i].size() > PACK_NAME_MAX
+			|| !isSafeName(names[i])) {
+			failedPath = paths[i];
+			return false;
+		}
+	}
+	/** Worker t counts files t, t + threads, t + 2 * threads and so on */
+	vector<PackPlan> plans(count);
+	{
+		int workerCount = (size_t)threads < count ? threads : (int)count;
+		auto work = [&](int first) {
+			for (size_t k = first; k < count; k += threads) {
+				countFile(paths[k], plans[k]);
+			}
+		};
+		vector<thread> workers;
+		for (int t = 0; t < workerCount; t++) {
+			workers.push_back(thread(work, t));
+		}
+		for (size_t t = 0; t < workers.size(); t++) {
+			workers[t].join();
+		}
+	}
+	for (size_t i = 0; i < count; i++) {
+		if (!plans[i].ok) {
+			failedPath = paths[i];
+			return false;
+		}
+	}
+
+	/** The shared table is summed over every small file */
+	vector<int> sharedFreqs(ASCII_MAX, 0);
+	vector<bool> candidate(count, false);
+	long long sharedTotal = 0;
+	for (size_t i = 0; shareTables && i < count; i++) {
+		if (plans[i].size == 0 || plans[i].size > PACK_SHARE_LIMIT
+			|| sharedTotal + (long long)plans[i].size > INT_MAX) {
+			continue;
+		}
+		candidate[i] = true;
+		sharedTotal += plans[i].size;
+		for (int c = 0; c < ASCII_MAX; c++) {
+			sharedFreqs[c] += plans[i].freqs[c];
+		}
+	}
+	HCTree sharedTree;
+	vector<byte> sharedTable;
+	vector<unsigned long long> sharedBytes(count, 0);
+	if (sharedTotal > 0) {
+		sharedTree.build(sharedFreqs);
+		sharedTable = tableBytes(sharedFreqs);
+		/** Sharing has to win back the shared table itself */
+		unsigned long long saved = 0;
+		for (size_t i = 0; i < count; i++) {
+			if (!candidate[i]) continue;
+			unsigned long long bits = 0;
+			for (int c = 0; c < ASCII_MAX; c++) {
+				bits += (unsigned long long)plans[i].freqs[c]
+					* sharedTree.getCodeLength(c);
+			}
+			sharedBytes[i] = (bits + 7) / 8;
+			unsigned long long best = min(plans[i].ownBytes, plans[i].size);
+			if (sharedBytes[i] < best) {
+				saved += best - sharedBytes[i];
+			}
+			else {
+				candidate[i] = false;
+			}
+		}
+		if (saved <= sharedTable.size()) {
+			candidate.assign(count, false);
+			sharedTable.clear();
+		}
+	}
+	/** Table 0 is the shared one, the rest are numbered in member order */
+	unsigned int nextTable = sharedTable.empty() ? 0 : 1;
+	for (size_t i = 0; i < count; i++) {
+		if (candidate[i]) {
+			plans[i].tableId = 0;
+			sharedCount++;
+		}
+		else if (plans[i].size == 0 || plans[i].ownBytes >= plans[i].size) {
+			plans[i].tableId = PACK_RAW_TABLE;
+			rawCount++;
+		}
+		else {
+			plans[i].tableId = nextTable++;
+		}
+	}
+	tableCount = nextTable;
+
+	vector<unsigned long long> tableOffsets;
+	vector<unsigned int> tableSizes;
+	vector<PackEntry> entries(count);
+	out.write(PACK_MAGIC, PACK_MAGIC_SIZE);
+	out.put((char)PACK_VERSION);
+	unsigned long long position = PACK_HEADER_SIZE;
+	if (!sharedTable.empty()) {
+		tableOffsets.push_back(position);
+		tableSizes.push_back((unsigned int)sharedTable.size());
+		out.write((const char*)sharedTable.data(), sharedTable.size());
+		position += sharedTable.size();
+	}
+
+	/** Files are coded threads at a time, so only a batch is in memory */
+	for (size_t start = 0; start < count; start += threads) {
+		size_t batch = min((size_t)threads, count - start);
+		vector<PackBody> bodies(batch);
+		auto work = [&](size_t k) {
+			TRACE_SPAN("member");
+			const PackPlan& plan = plans[start + k];
+			PackBody& body = bodies[k];
+			vector<byte> data;
+			body.ok = readFile(paths[start + k], data)
+				&& data.size() == plan.size;
+			if (!body.ok) {
+				return;
+			}
+			vector<int> freqs(ASCII_MAX, 0);
+			for (size_t j = 0; j < data.size(); j++) {
+				freqs[data[j]]++;
+			}
+			/** The file has to be the one that was counted */
+			body.ok = freqs == plan.freqs;
+			body.crc = crc32(data.data(), data.size());
+			if (!body.ok) {
+				return;
+			}
+			if (plan.tableId == PACK_RAW_TABLE) {
+				body.body.swap(data);
+			}
+			else if (candidate[start + k]) {
+				sharedTree.encodeBytes(data.data(), data.size(), body.body);
+			}
+			else {
+				HCTree tree;
+				tree.build(freqs);
+				body.table = tableBytes(freqs);
+				tree.encodeBytes(data.data(), data.size(), body.body);
+			}
+		};
+		vector<thread> workers;
+		for (size_t k = 0; k < batch; k++) {
+			workers.push_back(thread(work, k));
+		}
+		for (size_t k = 0; k < batch; k++) {
+			workers[k].join();
+		}
+		for (size_t k = 0; k < batch; k++) {
+			if (!bodies[k].ok) {
+				failedPath = paths[start + k];
+				return false;
+			}
+			if (!bodies[k].table.empty()) {
+				tableOffsets.push_back(position);
+				tableSizes.push_back((unsigned int)bodies[k].table.size());
+				out.write((const char*)bodies[k].table.data(),
+					bodies[k].table.size());
+				position += bodies[k].table.size();
+			}
+			PackEntry& entry = entries[start + k];
+			entry.name = names[start + k];
+			entry.offset = position;
+			entry.rawSize = plans[start + k].size;
+			entry.storedSize = bodies[k].body.size();
+			entry.tableId = plans[start + k].tableId;
+			entry.crc = bodies[k].crc;
+			out.write((const char*)bodies[k].body.data(),
+				bodies[k].body.size());
+			position += bodies[k].body.size();
+		}
+	}
+
+	vector<byte> directory;
+	putNumber(directory, tableOffsets.size(), 4);
+	for (size_t t = 0; t < tableOffsets.size(); t++) {
+		putNumber(directory, tableOffsets[t], 8);
+		putNumber(directory, tableSizes[t], 4);
+	}
+	putNumber(directory, count, 4);
+	for (size_t i = 0; i < count; i++) {
+		const PackEntry& entry = entries[i];
+		putNumber(directory, entry.name.size(), 2);
+		directory.insert(directory.end(), entry.name.begin(),
+			entry.name.end());
+		putNumber(directory, entry.offset, 8);
+		putNumber(directory, entry.rawSize, 8);
+		putNumber(directory, entry.storedSize, 8);
+		putNumber(directory, entry.tableId, 4);
+		putNumber(directory, entry.crc, 4);
+	}
+	vector<byte> trailer;
+	putNumber(trailer, position, 8);
+	putNumber(trailer, directory.size(), 4);
+	putNumber(trailer, crc32(directory.data(), directory.size()), 4);
+	trailer.insert(trailer.end(), PACK_MAGIC, PACK_MAGIC + PACK_MAGIC_SIZE);
+	out.write((const char*)directory.data(), directory.size());
+	out.write((const char*)trailer.data(), trailer.size());
+	return true;
+}
+
+/** Function Name: getTableCount() const
+ *  Description: Getter for the number of tables in the last archive
+ *  Return Value: The number of tables
+ */
+size_t PackWriter::getTableCount() const {
+	return tableCount;
+}
+
+/** Function Name: getSharedCount() const
+ *  Description: Getter for the number of members sharing a table
+ *  Return Value: The number of members
+ */
+size_t PackWriter::getSharedCount() const {
+	return sharedCount;
+}
+
+/** Function Name: getRawCount() const
+ *  Description: Getter for the number of members stored raw
+ *  Return Value: The number of members
+ */
+size_t PackWriter::getRawCount() const {
+	return rawCount;
+}
+
+/** Function Name: getFailedPath() const
+ *  Description: Getter for the file write() could not read
+ *  Return Value: The path, empty if every file was read
+ */
+const string& PackWriter::getFailedPath() const {
+	return failedPath;
+}
+
+/** Constructor
+ *  Description: Creates a PackReader on the archive is
+ */
+PackReader::PackReader(istream& is) : in(is) {
+}
+
+/** Function Name: readDirectory()
+ *  Description: Checks the header and trailer, then reads and checks the
+ *               directory and every table it lists
+ *  Return Value: False if the archive is malformed
+ */
+bool PackReader::readDirectory() {
+	TRACE_SPAN("directory");
+	entries.clear();
+	tables.clear();
+	in.clear();
+	in.seekg(0, ios::end);
+	streamoff end = in.tellg();
+	if (end < PACK_HEADER_SIZE + PACK_TRAILER_SIZE) {
+		return false;
+	}
+	char header[PACK_HEADER_SIZE];
+	in.seekg(0);
+	if (!in.read(header, PACK_HEADER_SIZE)
+		|| string(header, PACK_MAGIC_SIZE) != PACK_MAGIC
+		|| header[PACK_MAGIC_SIZE] != PACK_VERSION) {
+		return false;
+	}
+	vector<byte> trailer(PACK_TRAILER_SIZE);
+	in.seekg(end - PACK_TRAILER_SIZE);
+	if (!in.read((char*)trailer.data(), PACK_TRAILER_SIZE)
+		|| string((const char*)trailer.data() + 16, PACK_MAGIC_SIZE)
+		!= PACK_MAGIC) {
+		return false;
+	}
+	size_t pos = 0;
+	unsigned long long directoryOffset, directorySize, directoryCrc;
+	getNumber(trailer, pos, 8, directoryOffset);
+	getNumber(trailer, pos, 4, directorySize);
+	getNumber(trailer, pos, 4, directoryCrc);
+	unsigned long long bodiesEnd = (unsigned long long)end - PACK_TRAILER_SIZE;
+	if (directoryOffset < PACK_HEADER_SIZE || directoryOffset > bodiesEnd
+		|| bodiesEnd - directoryOffset != directorySize) {
+		return false;
+	}
+	vector<byte> directory(directorySize);
+	in.seekg(directoryOffset);
+	if (!in.read((char*)directory.data(), directory.size())
+		|| crc32(directory.data(), directory.size()) != directoryCrc) {
+		return false;
+	}
+
+	pos = 0;
+	unsigned long long tableCount, entryCount, value;
+	if (!getNumber(directory, pos, 4, tableCount)) {
+		return false;
+	}
+	vector<unsigned long long> tableOffsets;
+	vector<unsigned int> tableSizes;
+	for (unsigned long long t = 0; t < tableCount; t++) {
+		unsigned long long offset;
+		if (!getNumber(directory, pos, 8, offset)
+			|| !getNumber(directory, pos, 4, value)) {
+			return false;
+		}
+		tableOffsets.push_back(offset);
+		tableSizes.push_back((unsigned int)value);
+	}
+	if (!getNumber(directory, pos, 4, entryCount)) {
+		return false;
+	}
+	for (unsigned long long i = 0; i < entryCount; i++) {
+		PackEntry entry;
+		if (!getNumber(directory, pos, 2, value)
+			|| directory.size() - pos < value) {
+			return false;
+		}
+		entry.name.assign((const char*)directory.data() + pos, value);
+		pos += value;
+		/** The name becomes a path when the member is unpacked */
+		if (!isSafeName(entry.name)) {
+			return false;
+		}
+		if (!getNumber(directory, pos, 8, entry.offset)
+			|| !getNumber(directory, pos, 8, entry.rawSize)
+			|| !getNumber(directory, pos, 8, entry.storedSize)) {
+			return false;
+		}
+		if (!getNumber(directory, pos, 4, value)) {
+			return false;
+		}
+		entry.tableId = (unsigned int)value;
+		if (!getNumber(directory, pos, 4, value)) {
+			return false;
+		}
+		entry.crc = (unsigned int)value;
+		/** The body lies between the header and the directory */
+		if (entry.offset < PACK_HEADER_SIZE || entry.offset > directoryOffset
+			|| directoryOffset - entry.offset < entry.storedSize) {
+			return false;
+		}
+		/** A raw body is the member, a coded one spends a bit per byte or
+		 *  more */
+		if (entry.tableId == PACK_RAW_TABLE
+			? entry.storedSize != entry.rawSize
+			: entry.tableId >= tableCount
+			|| entry.rawSize / 8 > entry.storedSize) {
+			return false;
+		}
+		entries.push_back(entry);
+	}
+	if (pos != directory.size()) {
+		return false;
+	}
+	return readTables(tableOffsets, tableSizes, directoryOffset);
+}
+
+/** Function Name: readTables(const vector<unsigned long long>& offsets,
+ *                             const vector<unsigned int>& sizes,
+ *                             unsigned long long bodiesEnd)
+ *  Description: Reads every table and checks it fills its record exactly
+ *  Return Value: False if a table is malformed
+ */
+bool PackReader::readTables(const vector<unsigned long long>& offsets,
+	const vector<unsigned int>& sizes, unsigned long long bodiesEnd) {
+	for (size_t t = 0; t < offsets.size(); t++) {
+		if (offsets[t] < PACK_HEADER_SIZE || offsets[t] > bodiesEnd
+			|| bodiesEnd - offsets[t] < sizes[t] || sizes[t] == 0) {
+			return false;
+		}
+		string bytes(sizes[t], '\0');
+		in.clear();
+		in.seekg(offsets[t]);
+		if (!in.read(&bytes[0], bytes.size())) {
+			return false;
+		}
+		istringstream header(bytes);
+		BitInputStream headerBIS(header);
+		vector<int> freqs;
+		if (HCTree::readHeader(headerBIS, freqs) <= 0
+			|| (size_t)(HCTree::headerBits(freqs) + 7) / 8 != bytes.size()) {
+			return false;
+		}
+		tables.push_back(freqs);
+	}
+	return true;
+}
+
+/** Function Name: getEntries() const
+ *  Description: Getter for the members read by readDirectory()
+ *  Return Value: The members
+ */
+const vector<PackEntry>& PackReader::getEntries() const {
+	return entries;
+}
+
+/** Function Name: getTableCount() const
+ *  Description: Getter for the number of tables in the archive
+ *  Return Value: The number of tables
+ */
+size_t PackReader::getTableCount() const {
+	return tables.size();
+}
+
+/** Function Name: find(const string& name) const
+ *  Description: Looks a member up by name
+ *  Return Value: Index of the first member named name, or -1
+ */
+long long PackReader::find(const string& name) const {
+	for (size_t i = 0; i < entries.size(); i++) {
+		if (entries[i].name == name) {
+			return (long long)i;
+		}
+	}
+	return -1;
+}
+
+/** Function Name: extract(size_t index, vector<byte>& data) const
+ *  Description: Decodes member index through the stream the reader was
+ *               made on
+ *  Return Value: False if the member is corrupt
+ */
+bool PackReader::extract(size_t index, vector<byte>& data) const {
+	return extract(index, in, data);
+}
+
+/** Function Name: extract(size_t index, istream& from,
+ *                         vector<byte>& data) const
+ *  Description: Reads the body of member index whole, decodes it with the
+ *               cached tree of its table and checks its CRC-32
+ *  Return Value: False if the member is corrupt
+ */
+bool PackReader::extract(size_t index, istream& from,
+	vector<byte>& data) const {
+	TRACE_SPAN("member");
+	const PackEntry& entry = entries[index];
+	vector<byte> body(entry.storedSize);
+	from.clear();
+	from.seekg(entry.offset);
+	if (!body.empty() && !from.read((char*)body.data(), body.size())) {
+		return false;
+	}
+	if (entry.tableId == PACK_RAW_TABLE) {
+		data.swap(body);
+	}
+	else {
+		shared_ptr<const HCTree> tree =
+			HCTableCache::global().acquire(tables[entry.tableId]);
+		data.resize(entry.rawSize);
+		if (!tree->decodeBytes(body.data(), body.size(), data.data(),
+			data.size())) {
+			return false;
+		}
+	}
+	return crc32(data.data(), data.size()) == entry.crc;
+}
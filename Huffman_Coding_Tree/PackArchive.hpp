@@ -0,0 +1,204 @@
+/** Filename: PackArchive.hpp
+ *  Name: Loc Chuong
+ *  Description: A container packing many files into one, each coded on its
+ *               own, with a central directory at the end so any member can
+ *               be found and decoded without reading the others. Small
+ *               files can share one table instead of paying for a header
+ *               each.
+ *
+ *               An archive is laid out as
+ *                 "HCAR" | version (1 byte)
+ *                 tables and member bodies, in any order
+ *                 directory
+ *                 directory offset (8 bytes) | directory size (4 bytes) |
+ *                 directory CRC-32 (4 bytes) | "HCAR"
+ *               and the directory as
+ *                 table count (4 bytes)
+ *                 per table: offset (8 bytes) | size (4 bytes)
+ *                 member count (4 bytes)
+ *                 per member: name size (2 bytes) | name | offset (8 bytes) |
+ *                             raw size (8 bytes) | stored size (8 bytes) |
+ *                             table id (4 bytes) | CRC-32 (4 bytes)
+ *               with every number little endian. A table is the frequency
+ *               header of HCTree padded to a whole byte, and a member body
+ *               is the codes of encodeBytes(), or the raw bytes when its
+ *               table id is PACK_RAW_TABLE.
+ *  Date: 10/18/2026
+ */
+
+#ifndef PACKARCHIVE_HPP
+#define PACKARCHIVE_HPP
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include "HCTree.hpp"
+
+#define PACK_MAGIC "HCAR" /** First and last bytes of every archive */
+#define PACK_MAGIC_SIZE 4 /** Number of bytes in PACK_MAGIC */
+#define PACK_VERSION 1 /** Format version written after the magic */
+#define PACK_HEADER_SIZE 5 /** Magic and version */
+#define PACK_TRAILER_SIZE 20 /** Directory offset, size, CRC and magic */
+#define PACK_RAW_TABLE 0xFFFFFFFFu /** Table id of a member stored raw */
+#define PACK_SHARE_LIMIT (64 << 10) /** Largest file that may share a table */
+#define PACK_NAME_MAX 0xFFFF /** Longest member name */
+
+using namespace std;
+
+/** Struct Name: PackEntry
+ *  Description: One member of an archive, as its directory records it
+ */
+struct PackEntry {
+	string name; /** Relative path the member was packed from */
+	unsigned long long offset; /** Archive offset of the body */
+	unsigned long long rawSize; /** Size of the member itself */
+	unsigned long long storedSize; /** Size of the body */
+	unsigned int tableId; /** Table the body is coded with */
+	unsigned int crc; /** CRC-32 of the member itself */
+};
+
+/** Class Name: PackWriter
+ *  Description: Packs files into an archive. The files are counted on
+ *               several threads, then every small file that codes smaller
+ *               with a table summed over all of them than with its own
+ *               takes that shared table. The rest get a table each, or are
+ *               stored raw when coding would not shrink them. Bodies are
+ *               coded a batch at a time on several threads and written in
+ *               the order the files were given.
+ */
+class PackWriter {
+private:
+	int threads; /** Most files coded at once */
+	bool shareTables; /** Whether small files may share a table */
+	size_t tableCount; /** Tables in the last archive */
+	size_t sharedCount; /** Members of the last archive sharing a table */
+	size_t rawCount; /** Members of the last archive stored raw */
+	string failedPath; /** File that could not be read, if any */
+
+public:
+	/** Constructor
+	 *  Description: Creates a PackWriter using up to threads threads
+	 */
+	PackWriter(int threads, bool shareTables = true);
+
+	/** Function Name: write(const vector<string>& paths, ostream& out)
+	 *  Description: Packs the files at paths into out, each named by
+	 *               memberName() of its path
+	 *  Parameters: paths - The files to pack
+	 *              out - Stream the archive is written to
+	 *  Return Value: False if a file could not be read or has no usable
+	 *                name, leaving out incomplete
+	 */
+	bool write(const vector<string>& paths, ostream& out);
+
+	/** Function Name: memberName(const string& path)
+	 *  Description: The name a file is packed under: path with backslashes
+	 *               turned into slashes, any root or drive dropped, and
+	 *               "." and ".." components resolved without ever climbing
+	 *               above the top, so it always extracts below the
+	 *               directory it is unpacked in
+	 *  Return Value: The relative name, empty if nothing of path is left
+	 */
+	static string memberName(const string& path);
+
+	/** Function Name: getTableCount() const
+	 *  Description: Getter for the number of tables in the last archive
+	 *  Return Value: The number of tables
+	 */
+	size_t getTableCount() const;
+
+	/** Function Name: getSharedCount() const
+	 *  Description: Getter for the number of members of the last archive
+	 *               coded with the shared table
+	 *  Return Value: The number of members
+	 */
+	size_t getSharedCount() const;
+
+	/** Function Name: getRawCount() const
+	 *  Description: Getter for the number of members of the last archive
+	 *               stored raw
+	 *  Return Value: The number of members
+	 */
+	size_t getRawCount() const;
+
+	/** Function Name: getFailedPath() const
+	 *  Description: Getter for the file write() could not read
+	 *  Return Value: The path, empty if every file was read
+	 */
+	const string& getFailedPath() const;
+};
+
+/** Class Name: PackReader
+ *  Description: Reads the directory of an archive from its end and
+ *               extracts members by index. Members are independent, so
+ *               several threads may extract at once, each through its own
+ *               stream on the archive.
+ */
+class PackReader {
+private:
+	istream& in; /** The archive */
+	vector<PackEntry> entries; /** Members, in directory order */
+	vector<vector<int>> tables; /** Frequencies of every table */
+
+	/** Function Name: readTables(const vector<unsigned long long>& offsets,
+	 *                             const vector<unsigned int>& sizes,
+	 *                             unsigned long long bodiesEnd)
+	 *  Description: Reads every table listed in the directory
+	 *  Return Value: False if a table is malformed
+	 */
+	bool readTables(const vector<unsigned long long>& offsets,
+		const vector<unsigned int>& sizes, unsigned long long bodiesEnd);
+
+public:
+	/** Constructor
+	 *  Description: Creates a PackReader on the archive is
+	 */
+	explicit PackReader(istream& is);
+
+	/** Function Name: readDirectory()
+	 *  Description: Checks the magic and version, then reads the directory
+	 *               and the tables it lists
+	 *  Return Value: False if the archive is malformed, or a member name
+	 *                is not a relative path staying below where it is
+	 *                unpacked
+	 */
+	bool readDirectory();
+
+	/** Function Name: getEntries() const
+	 *  Description: Getter for the members read by readDirectory()
+	 *  Return Value: The members
+	 */
+	const vector<PackEntry>& getEntries() const;
+
+	/** Function Name: getTableCount() const
+	 *  Description: Getter for the number of tables in the archive
+	 *  Return Value: The number of tables
+	 */
+	size_t getTableCount() const;
+
+	/** Function Name: find(const string& name) const
+	 *  Description: Looks a member up by name
+	 *  Return Value: Index of the first member named name, or -1
+	 */
+	long long find(const string& name) const;
+
+	/** Function Name: extract(size_t index, vector<byte>& data) const
+	 *  Description: Decodes member index through the stream the reader
+	 *               was made on
+	 *  Return Value: False if the member is corrupt
+	 */
+	bool extract(size_t index, vector<byte>& data) const;
+
+	/** Function Name: extract(size_t index, istream& from,
+	 *                         vector<byte>& data) const
+	 *  Description: Seeks to the body of member index, decodes it and
+	 *               checks its CRC-32
+	 *  Parameters: index - The member, below getEntries().size()
+	 *              from - A stream on the same archive
+	 *              data - Set to the member
+	 *  Return Value: False if the member is corrupt
+	 */
+	bool extract(size_t index, istream& from, vector<byte>& data) const;
+};
+
+#endif // PACKARCHIVE_HPP
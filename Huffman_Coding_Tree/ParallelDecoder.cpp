@@ -0,0 +1,206 @@
+/** Filename: ParallelDecoder.cpp
+ *  Name: Loc Chuong
+ *  Description: Decodes one continuous payload of the single stream format
+ *               on several threads by letting every thread start at an
+ *               arbitrary bit offset and stitching the chunks together
+ *               where their symbol boundaries line up.
+ *  Date: 10/18/2026
+ */
+
+#include "ParallelDecoder.hpp"
+#include "Trace.hpp"
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <thread>
+
+#define PEEK_BITS 57 /** Bits peekWord() guarantees at any offset */
+
+/** Function Name: peekWord(const byte* in, size_t pos)
+ *  Description: Loads the 64 bits starting at bit pos of in, first bit in
+ *               the top bit. Only the top PEEK_BITS bits are guaranteed to
+ *               come from in, the rest are 0.
+ *  Return Value: The bits at pos
+ */
+static inline unsigned long long peekWord(const byte* in, size_t pos) {
+	const byte* bytes = in + (pos >> 3);
+	unsigned long long word = 0;
+	for (int i = 0; i < 8; i++) {
+		word = (word << 8) | bytes[i];
+	}
+	return word << (pos & 7);
+}
+
+/** Constructor
+ *  Description: Creates a ParallelDecoder for inSize coded bytes
+ */
+ParallelDecoder::ParallelDecoder(const HCTree& tree, const byte* in,
+	size_t inSize) : tree(tree), in(in), inBits(inSize * 8),
+	syncedChunks(0), serialChunks(0) {
+}
+
+/** Function Name: decodeSymbol(size_t& pos) const
+ *  Description: Decodes the symbol whose code starts at bit pos
+ *  Parameters: pos - Advanced past the code
+ *  Return Value: The decoded symbol
+ */
+byte ParallelDecoder::decodeSymbol(size_t& pos) const {
+	unsigned long long word = peekWord(in, pos);
+	const DecodeEntry& entry =
+		tree.getDecodeTable()[word >> (64 - DECODE_TABLE_BITS)];
+	if (entry.length != 0) {
+		pos += entry.length;
+		return (byte)entry.symbol;
+	}
+	/** Code is longer than the table, walk the tree bit by bit */
+	HCNode* currNode = tree.getRoot();
+	int used = 0;
+	while (currNode->c0 != nullptr) {
+		if (used == PEEK_BITS) {
+			pos += used;
+			used = 0;
+			word = peekWord(in, pos);
+		}
+		currNode = ((word >> (63 - used)) & 1) ? currNode->c1 : currNode->c0;
+		used++;
+	}
+	pos += used;
+	return currNode->symbol;
+}
+
+/** Function Name: decodeChunk(Chunk& chunk) const
+ *  Description: Decodes from chunk.startBit to chunk.endBit, then keeps
+ *               going for another SYNC_WINDOW_BITS past chunk.endBit
+ *  Parameters: chunk - Holds the range to decode, receives the symbols
+ *  Return Value: None
+ */
+void ParallelDecoder::decodeChunk(Chunk& chunk) const {
+	TRACE_SPAN("decode chunk");
+	chunk.symbols.clear();
+	chunk.headPositions.clear();
+	chunk.tail.clear();
+	chunk.tailPositions.clear();
+	size_t pos = chunk.startBit;
+	/** Boundaries the chunk before can line up with */
+	size_t headEnd = chunk.startBit + SYNC_WINDOW_BITS;
+	while (pos < chunk.endBit) {
+		if (pos < headEnd) {
+			chunk.headPositions.push_back(pos);
+		}
+		chunk.symbols.push_back(decodeSymbol(pos));
+	}
+	/** Run on into the next chunk's window so it can line up with us */
+	size_t tailEnd = min(chunk.endBit + SYNC_WINDOW_BITS, inBits);
+	while (pos < tailEnd) {
+		chunk.tailPositions.push_back(pos);
+		chunk.tail.push_back(decodeSymbol(pos));
+	}
+	chunk.tailEndBit = pos;
+}
+
+/** Function Name: decode(size_t startBit, size_t count, byte* out,
+ *                        int threads)
+ *  Description: Decodes count symbols starting at bit startBit of in
+ *  Parameters: startBit - Bit offset of the first code in in
+ *              count - Number of symbols to decode
+ *              out - Receives count decoded bytes
+ *              threads - Largest number of threads to use
+ *  Return Value: False if the payload holds fewer than count symbols
+ */
+bool ParallelDecoder::decode(size_t startBit, size_t count, byte* out,
+	int threads) {
+	syncedChunks = serialChunks = 0;
+	HCNode* root = tree.getRoot();
+	if (root == nullptr || startBit > inBits) {
+		return count == 0;
+	}
+	/** A lone symbol takes no bits to decode */
+	if (root->c0 == nullptr) {
+		memset(out, root->symbol, count);
+		return true;
+	}
+
+	/** Give every thread at least PARALLEL_MIN_CHUNK_BITS */
+	size_t payloadBits = inBits - startBit;
+	size_t chunkCount = min((size_t)max(threads, 1),
+		max(payloadBits / PARALLEL_MIN_CHUNK_BITS, (size_t)1));
+	vector<Chunk> chunks(chunkCount);
+	for (size_t k = 0; k < chunkCount; k++) {
+		chunks[k].startBit = startBit + payloadBits * k / chunkCount;
+		chunks[k].endBit = startBit + payloadBits * (k + 1) / chunkCount;
+	}
+	vector<thread> workers;
+	for (size_t k = 1; k < chunkCount; k++) {
+		workers.push_back(thread(&ParallelDecoder::decodeChunk, this,
+			ref(chunks[k])));
+	}
+	decodeChunk(chunks[0]);
+	{
+		TRACE_SPAN("join decoders");
+		for (size_t k = 0; k < workers.size(); k++) {
+			workers[k].join();
+		}
+	}
+	TRACE_SPAN("stitch chunks");
+
+	/** The first chunk starts on a true boundary, and every chunk after
+	 *  it is stitched on at the first boundary it shares with the tail of
+	 *  the chunk before, which is on true boundaries by then
+	 */
+	size_t written = 0;
+	auto emit = [&](const byte* data, size_t size) {
+		size = min(size, count - written);
+		memcpy(out + written, data, size);
+		written += size;
+	};
+	emit(chunks[0].symbols.data(), chunks[0].symbols.size());
+	for (size_t k = 1; k < chunkCount; k++) {
+		Chunk& prev = chunks[k - 1];
+		Chunk& curr = chunks[k];
+		/** Both position lists are sorted, walk them together */
+		size_t t = 0;
+		size_t h = 0;
+		bool synced = false;
+		while (t < prev.tailPositions.size() && h < curr.headPositions.size()) {
+			if (prev.tailPositions[t] == curr.headPositions[h]) {
+				synced = true;
+				break;
+			}
+			if (prev.tailPositions[t] < curr.headPositions[h]) {
+				t++;
+			}
+			else {
+				h++;
+			}
+		}
+		if (synced) {
+			emit(prev.tail.data(), t);
+			emit(curr.symbols.data() + h, curr.symbols.size() - h);
+			syncedChunks++;
+			continue;
+		}
+		/** Never lined up, decode the chunk again from the true boundary */
+		emit(prev.tail.data(), prev.tail.size());
+		curr.startBit = prev.tailEndBit;
+		decodeChunk(curr);
+		emit(curr.symbols.data(), curr.symbols.size());
+		serialChunks++;
+	}
+	return written == count;
+}
+
+/** Function Name: getSyncedChunks() const
+ *  Description: Getter for the number of chunks that lined up
+ *  Return Value: Chunks stitched at a shared boundary in the last decode
+ */
+int ParallelDecoder::getSyncedChunks() const {
+	return syncedChunks;
+}
+
+/** Function Name: getSerialChunks() const
+ *  Description: Getter for the number of chunks that never lined up
+ *  Return Value: Chunks decoded again serially in the last decode
+ */
+int ParallelDecoder::getSerialChunks() const {
+	return serialChunks;
+}
@@ -0,0 +1,106 @@
+/** Filename: ParallelDecoder.hpp
+ *  Name: Loc Chuong
+ *  Description: Decodes one continuous payload of the single stream format
+ *               on several threads. Every thread starts at an arbitrary bit
+ *               offset and notes where its symbols begin. Huffman codes
+ *               resynchronize quickly, so once a thread's symbol boundaries
+ *               line up with the true boundaries found by the thread before
+ *               it, everything it decoded from there on is correct. A chunk
+ *               whose boundaries never line up is decoded again serially
+ *               from the true boundary, so the output is always bit-exact.
+ *  Date: 10/18/2026
+ */
+
+#ifndef PARALLELDECODER_HPP
+#define PARALLELDECODER_HPP
+
+#include <vector>
+#include "HCTree.hpp"
+
+#define SYNC_WINDOW_BITS 4096 /** How far past its start a chunk may sync */
+#define PARALLEL_MIN_CHUNK_BITS (1 << 20) /** Smallest chunk worth a thread */
+#define PARALLEL_PADDING_BYTES 8 /** Readable bytes needed past the input */
+
+using namespace std;
+
+/** Class Name: ParallelDecoder
+ *  Description: Splits a payload into one chunk per thread, decodes the
+ *               chunks speculatively and stitches them together where
+ *               their symbol boundaries meet.
+ */
+class ParallelDecoder {
+private:
+	/** Struct Name: Chunk
+	 *  Description: What one thread decoded from its bit range
+	 */
+	struct Chunk {
+		size_t startBit; /** Where the thread started decoding */
+		size_t endBit; /** Where the next chunk starts */
+		size_t tailEndBit; /** Where decoding stopped past endBit */
+		vector<byte> symbols; /** Symbols starting in [startBit, endBit) */
+		vector<size_t> headPositions; /** Where the first symbols start */
+		vector<byte> tail; /** Symbols decoded past endBit */
+		vector<size_t> tailPositions; /** Where each tail symbol starts */
+	};
+
+	const HCTree& tree; /** Table the payload was coded with */
+	const byte* in; /** The coded bytes */
+	size_t inBits; /** Number of bits in in */
+	int syncedChunks; /** Chunks that lined up with the chunk before */
+	int serialChunks; /** Chunks decoded again from the true boundary */
+
+	/** Function Name: decodeSymbol(size_t& pos) const
+	 *  Description: Decodes the symbol whose code starts at bit pos
+	 *  Parameters: pos - Advanced past the code
+	 *  Return Value: The decoded symbol
+	 */
+	byte decodeSymbol(size_t& pos) const;
+
+	/** Function Name: decodeChunk(Chunk& chunk) const
+	 *  Description: Decodes from chunk.startBit to chunk.endBit, recording
+	 *               the boundaries in the first SYNC_WINDOW_BITS, then keeps
+	 *               going for another SYNC_WINDOW_BITS past chunk.endBit so
+	 *               the next chunk can be lined up against its tail
+	 *  Parameters: chunk - Holds the range to decode, receives the symbols
+	 *  Return Value: None
+	 */
+	void decodeChunk(Chunk& chunk) const;
+
+public:
+	/** Constructor
+	 *  Description: Creates a ParallelDecoder for inSize coded bytes
+	 *  PRECONDITION: PARALLEL_PADDING_BYTES bytes past in + inSize can be
+	 *                read
+	 *  Parameters: tree - Table the payload was coded with
+	 *              in - The coded bytes
+	 *              inSize - Number of bytes in in
+	 */
+	ParallelDecoder(const HCTree& tree, const byte* in, size_t inSize);
+
+	/** Function Name: decode(size_t startBit, size_t count, byte* out,
+	 *                        int threads)
+	 *  Description: Decodes count symbols starting at bit startBit of in.
+	 *               Uses up to threads threads, fewer if the payload is too
+	 *               small to give each one PARALLEL_MIN_CHUNK_BITS.
+	 *  Parameters: startBit - Bit offset of the first code in in
+	 *              count - Number of symbols to decode
+	 *              out - Receives count decoded bytes
+	 *              threads - Largest number of threads to use
+	 *  Return Value: False if the payload holds fewer than count symbols
+	 */
+	bool decode(size_t startBit, size_t count, byte* out, int threads);
+
+	/** Function Name: getSyncedChunks() const
+	 *  Description: Getter for the number of chunks that lined up
+	 *  Return Value: Chunks stitched at a shared boundary in the last decode
+	 */
+	int getSyncedChunks() const;
+
+	/** Function Name: getSerialChunks() const
+	 *  Description: Getter for the number of chunks that never lined up
+	 *  Return Value: Chunks decoded again serially in the last decode
+	 */
+	int getSerialChunks() const;
+};
+
+#endif // PARALLELDECODER_HPP
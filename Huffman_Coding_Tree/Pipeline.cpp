@@ -0,0 +1,350 @@
+/** Filename: Pipeline.cpp
+ *  Name: Loc Chuong
+ *  Description: Reader and writer stages of the pipelined compress and
+ *               uncompress, the streambufs that let the bit streams read
+ *               from and write to them, and the verify stage of the block
+ *               format.
+ *  Date: 10/18/2026
+ */
+
+#include "Pipeline.hpp"
+#include "BlockCodec.hpp"
+#include <cstring>
+#include <sstream>
+
+/** Constructor
+ *  Description: Starts the reader thread on in
+ */
+ReadStage::ReadStage(istream& in) : in(in), finished(false) {
+	for (int i = 0; i < PIPELINE_DEPTH; i++) {
+		buffers[i].data.resize(PIPELINE_BUFFER_SIZE);
+		buffers[i].size = 0;
+		freeBuffers.push(&buffers[i]);
+	}
+	reader = thread(&ReadStage::readLoop, this);
+}
+
+/** Destructor
+ *  Description: Drains whatever is left and joins the reader thread
+ */
+ReadStage::~ReadStage() {
+	/** The reader cannot stop before its end marker has been taken */
+	PipelineBuffer* buffer;
+	while ((buffer = next()) != nullptr) {
+		recycle(buffer);
+	}
+	reader.join();
+}
+
+/** Function Name: readLoop()
+ *  Description: Body of the reader thread. Fills free buffers until the
+ *               stream runs out, then queues the end marker.
+ *  Return Value: None
+ */
+void ReadStage::readLoop() {
+	while (1) {
+		PipelineBuffer* buffer = freeBuffers.pop();
+		{
+			TRACE_SPAN("read");
+			in.read((char*)buffer->data.data(), PIPELINE_BUFFER_SIZE);
+			buffer->size = (size_t)in.gcount();
+		}
+		if (buffer->size == 0) break;
+		fullBuffers.push(buffer);
+	}
+	fullBuffers.push(nullptr);
+}
+
+/** Function Name: next()
+ *  Description: Takes the next filled buffer, waiting for the reader
+ *  Return Value: The buffer, or nullptr once the stream is done
+ */
+PipelineBuffer* ReadStage::next() {
+	if (finished) {
+		return nullptr;
+	}
+	PipelineBuffer* buffer = fullBuffers.pop();
+	if (buffer == nullptr) {
+		finished = true;
+	}
+	return buffer;
+}
+
+/** Function Name: recycle(PipelineBuffer* buffer)
+ *  Description: Hands a buffer returned by next() back to the reader
+ *  Return Value: None
+ */
+void ReadStage::recycle(PipelineBuffer* buffer) {
+	freeBuffers.push(buffer);
+}
+
+/** Constructor
+ *  Description: Starts the writer thread on out
+ */
+WriteStage::WriteStage(ostream& out) : out(out), finished(false) {
+	for (int i = 0; i < PIPELINE_DEPTH; i++) {
+		buffers[i].data.resize(PIPELINE_BUFFER_SIZE);
+		buffers[i].size = 0;
+		freeBuffers.push(&buffers[i]);
+	}
+	writer = thread(&WriteStage::writeLoop, this);
+}
+
+/** Destructor
+ *  Description: Calls finish()
+ */
+WriteStage::~WriteStage() {
+	finish();
+}
+
+/** Function Name: writeLoop()
+ *  Description: Body of the writer thread. Writes submitted buffers until
+ *               it takes the end marker.
+ *  Return Value: None
+ */
+void WriteStage::writeLoop() {
+	while (1) {
+		PipelineBuffer* buffer = fullBuffers.pop();
+		if (buffer == nullptr) break;
+		{
+			TRACE_SPAN("write");
+			out.write((const char*)buffer->data.data(), buffer->size);
+		}
+		buffer->size = 0;
+		freeBuffers.push(buffer);
+	}
+	TRACE_SPAN("flush");
+	out.flush();
+}
+
+/** Function Name: acquire()
+ *  Description: Takes an empty buffer to fill, waiting for the writer
+ *  Return Value: The buffer, with size 0
+ */
+PipelineBuffer* WriteStage::acquire() {
+	return freeBuffers.pop();
+}
+
+/** Function Name: submit(PipelineBuffer* buffer)
+ *  Description: Queues a buffer returned by acquire() for writing
+ *  Return Value: None
+ */
+void WriteStage::submit(PipelineBuffer* buffer) {
+	fullBuffers.push(buffer);
+}
+
+/** Function Name: finish()
+ *  Description: Writes everything submitted and joins the writer thread
+ *  Return Value: None
+ */
+void WriteStage::finish() {
+	if (finished) {
+		return;
+	}
+	finished = true;
+	fullBuffers.push(nullptr);
+	writer.join();
+}
+
+/** Constructor
+ *  Description: Starts the verifier thread
+ */
+VerifyStage::VerifyStage() : verifiedBlocks(0), verifiedBytes(0),
+	failed(false), finished(false) {
+	for (int i = 0; i < PIPELINE_DEPTH; i++) {
+		freeBuffers.push(&buffers[i]);
+	}
+	verifier = thread(&VerifyStage::verifyLoop, this);
+}
+
+/** Destructor
+ *  Description: Calls finish()
+ */
+VerifyStage::~VerifyStage() {
+	finish();
+}
+
+/** Function Name: verifyLoop()
+ *  Description: Body of the verifier thread. Feeds every submitted block
+ *               to one BlockDecoder until it takes the end marker. Once a
+ *               block fails the rest are only recycled.
+ *  Return Value: None
+ */
+void VerifyStage::verifyLoop() {
+	stringstream coded;
+	BlockDecoder decoder(coded);
+	vector<byte> decoded;
+	while (1) {
+		VerifyBuffer* buffer = fullBuffers.pop();
+		if (buffer == nullptr) break;
+		if (!failed) {
+			TRACE_SPAN("verify");
+			coded.clear();
+			coded.str(buffer->coded);
+			int mode = decoder.readBlock(decoded);
+			/** The block has to use up exactly the bytes written for it */
+			failed = mode == BLOCK_ERROR || mode == BLOCK_END
+				|| decoded != buffer->input
+				|| coded.tellg() != (streamoff)buffer->coded.size();
+			if (!failed) {
+				verifiedBlocks++;
+				verifiedBytes += decoded.size();
+			}
+		}
+		freeBuffers.push(buffer);
+	}
+}
+
+/** Function Name: acquire()
+ *  Description: Takes a buffer to read a block into
+ *  Return Value: The buffer
+ */
+VerifyBuffer* VerifyStage::acquire() {
+	return freeBuffers.pop();
+}
+
+/** Function Name: submit(VerifyBuffer* buffer)
+ *  Description: Queues a buffer returned by acquire() for verifying
+ *  Return Value: None
+ */
+void VerifyStage::submit(VerifyBuffer* buffer) {
+	fullBuffers.push(buffer);
+}
+
+/** Function Name: finish()
+ *  Description: Verifies everything submitted and joins the verifier
+ *               thread
+ *  Return Value: True if every block decoded to its input
+ */
+bool VerifyStage::finish() {
+	if (!finished) {
+		finished = true;
+		fullBuffers.push(nullptr);
+		verifier.join();
+	}
+	return !failed;
+}
+
+/** Function Name: getVerifiedBlocks() const
+ *  Description: Getter for the number of blocks verified
+ *  Return Value: The value of verifiedBlocks
+ */
+unsigned long long VerifyStage::getVerifiedBlocks() const {
+	return verifiedBlocks;
+}
+
+/** Function Name: getVerifiedBytes() const
+ *  Description: Getter for the number of input bytes verified
+ *  Return Value: The value of verifiedBytes
+ */
+unsigned long long VerifyStage::getVerifiedBytes() const {
+	return verifiedBytes;
+}
+
+/** Constructor
+ *  Description: Creates a streambuf over stage
+ */
+ReadStageBuf::ReadStageBuf(ReadStage& stage) : stage(stage), current(nullptr) {
+}
+
+/** Destructor
+ *  Description: Recycles the buffer being read
+ */
+ReadStageBuf::~ReadStageBuf() {
+	if (current != nullptr) {
+		stage.recycle(current);
+	}
+}
+
+/** Function Name: underflow()
+ *  Description: Recycles the buffer just read and moves to the next one
+ *  Return Value: The next character, or EOF once the stream is done
+ */
+ReadStageBuf::int_type ReadStageBuf::underflow() {
+	if (current != nullptr) {
+		stage.recycle(current);
+	}
+	current = stage.next();
+	if (current == nullptr) {
+		return traits_type::eof();
+	}
+	char* begin = (char*)current->data.data();
+	setg(begin, begin, begin + current->size);
+	return traits_type::to_int_type(*begin);
+}
+
+/** Constructor
+ *  Description: Creates a streambuf over stage
+ */
+WriteStageBuf::WriteStageBuf(WriteStage& stage) : stage(stage) {
+	current = stage.acquire();
+	char* begin = (char*)current->data.data();
+	setp(begin, begin + PIPELINE_BUFFER_SIZE);
+}
+
+/** Destructor
+ *  Description: Submits what has been written so far along with the
+ *               buffer being filled
+ */
+WriteStageBuf::~WriteStageBuf() {
+	current->size = pptr() - pbase();
+	stage.submit(current);
+}
+
+/** Function Name: submitCurrent()
+ *  Description: Submits the buffer being filled and takes a new one
+ *  Return Value: None
+ */
+void WriteStageBuf::submitCurrent() {
+	current->size = pptr() - pbase();
+	if (current->size == 0) {
+		return;
+	}
+	stage.submit(current);
+	current = stage.acquire();
+	char* begin = (char*)current->data.data();
+	setp(begin, begin + PIPELINE_BUFFER_SIZE);
+}
+
+/** Function Name: overflow(int_type c)
+ *  Description: Submits the full buffer and stores c in a new one
+ *  Return Value: c, or anything but EOF if c is EOF
+ */
+WriteStageBuf::int_type WriteStageBuf::overflow(int_type c) {
+	submitCurrent();
+	if (traits_type::eq_int_type(c, traits_type::eof())) {
+		return traits_type::not_eof(c);
+	}
+	*pptr() = traits_type::to_char_type(c);
+	pbump(1);
+	return c;
+}
+
+/** Function Name: xsputn(const char* s, streamsize n)
+ *  Description: Copies n characters in, a buffer at a time
+ *  Return Value: n
+ */
+streamsize WriteStageBuf::xsputn(const char* s, streamsize n) {
+	streamsize left = n;
+	while (left > 0) {
+		if (pptr() == epptr()) {
+			submitCurrent();
+		}
+		streamsize room = epptr() - pptr();
+		streamsize take = left < room ? left : room;
+		memcpy(pptr(), s, (size_t)take);
+		pbump((int)take);
+		s += take;
+		left -= take;
+	}
+	return n;
+}
+
+/** Function Name: sync()
+ *  Description: Submits what has been written so far
+ *  Return Value: 0
+ */
+int WriteStageBuf::sync() {
+	submitCurrent();
+	return 0;
+}
@@ -0,0 +1,367 @@
+/** Filename: Pipeline.hpp
+ *  Name: Loc Chuong
+ *  Description: Pieces of the pipelined compress and uncompress. A reader
+ *               thread fills buffers from an istream, the coding thread
+ *               works on them, and a writer thread drains the coded buffers
+ *               to an ostream, so disk waits overlap with coding. The stages
+ *               pass a fixed set of buffers around through lock-free single
+ *               producer, single consumer queues, and both ends can be
+ *               wrapped in a streambuf so BitInputStream and BitOutputStream
+ *               work on them unchanged. A verify stage decodes coded blocks
+ *               on a thread of its own while later blocks are coded.
+ *  Date: 10/18/2026
+ */
+
+#ifndef PIPELINE_HPP
+#define PIPELINE_HPP
+
+#include <atomic>
+#include <iostream>
+#include <streambuf>
+#include <string>
+#include <thread>
+#include <vector>
+#include "HCNode.hpp"
+#include "Trace.hpp"
+
+#define PIPELINE_BUFFER_SIZE (1 << 16) /** Bytes in one pipeline buffer */
+#define PIPELINE_DEPTH 4 /** Buffers each stage has in flight */
+#define CACHE_LINE_SIZE 64 /** Keeps the two queue ends on their own lines */
+
+using namespace std;
+
+/** Struct Name: PipelineBuffer
+ *  Description: One buffer handed between stages. The stages queue a
+ *               nullptr after their last buffer to mark the end.
+ */
+struct PipelineBuffer {
+	vector<byte> data; /** PIPELINE_BUFFER_SIZE bytes of storage */
+	size_t size; /** Number of bytes of data in use */
+};
+
+/** Class Name: SpscQueue<T, N>
+ *  Description: Bounded lock-free queue for exactly one producer thread and
+ *               one consumer thread. The producer only writes tail and the
+ *               consumer only writes head, so no locks are needed.
+ */
+template <typename T, size_t N>
+class SpscQueue {
+private:
+	T slots[N]; /** Ring of queued items */
+	alignas(CACHE_LINE_SIZE) atomic<size_t> head; /** Next slot to pop */
+	alignas(CACHE_LINE_SIZE) atomic<size_t> tail; /** Next slot to push */
+
+public:
+	/** Constructor
+	 *  Description: Creates an empty queue
+	 */
+	SpscQueue() : head(0), tail(0) {
+	}
+
+	/** Function Name: tryPush(T item)
+	 *  Description: Queues item unless the queue is full
+	 *  Return Value: False if the queue was full
+	 */
+	bool tryPush(T item) {
+		size_t t = tail.load(memory_order_relaxed);
+		if (t - head.load(memory_order_acquire) == N) {
+			return false;
+		}
+		slots[t % N] = item;
+		tail.store(t + 1, memory_order_release);
+		return true;
+	}
+
+	/** Function Name: tryPop(T& item)
+	 *  Description: Takes the oldest item unless the queue is empty
+	 *  Return Value: False if the queue was empty
+	 */
+	bool tryPop(T& item) {
+		size_t h = head.load(memory_order_relaxed);
+		if (h == tail.load(memory_order_acquire)) {
+			return false;
+		}
+		item = slots[h % N];
+		head.store(h + 1, memory_order_release);
+		return true;
+	}
+
+	/** Function Name: push(T item)
+	 *  Description: Queues item, yielding while the queue is full
+	 *  Return Value: None
+	 */
+	void push(T item) {
+		if (tryPush(item)) {
+			return;
+		}
+		TRACE_SPAN("wait for space");
+		while (!tryPush(item)) {
+			this_thread::yield();
+		}
+	}
+
+	/** Function Name: pop()
+	 *  Description: Takes the oldest item, yielding while the queue is empty
+	 *  Return Value: The item
+	 */
+	T pop() {
+		T item;
+		if (tryPop(item)) {
+			return item;
+		}
+		TRACE_SPAN("wait for item");
+		while (!tryPop(item)) {
+			this_thread::yield();
+		}
+		return item;
+	}
+};
+
+/** Class Name: ReadStage
+ *  Description: Reader thread that fills buffers from an istream ahead of
+ *               the coding thread.
+ */
+class ReadStage {
+private:
+	istream& in; /** Stream the reader thread reads */
+	PipelineBuffer buffers[PIPELINE_DEPTH]; /** Every buffer of the stage */
+	SpscQueue<PipelineBuffer*, PIPELINE_DEPTH> freeBuffers; /** To fill */
+	SpscQueue<PipelineBuffer*, PIPELINE_DEPTH> fullBuffers; /** To code */
+	bool finished; /** The coding thread has seen the end marker */
+	thread reader; /** Runs readLoop() */
+
+	/** Function Name: readLoop()
+	 *  Description: Body of the reader thread
+	 *  Return Value: None
+	 */
+	void readLoop();
+
+public:
+	/** Constructor
+	 *  Description: Starts the reader thread on in
+	 */
+	ReadStage(istream& in);
+
+	/** Destructor
+	 *  Description: Drains whatever is left and joins the reader thread
+	 */
+	~ReadStage();
+
+	/** Function Name: next()
+	 *  Description: Takes the next filled buffer, waiting for the reader
+	 *  Return Value: The buffer, or nullptr once the stream is done
+	 */
+	PipelineBuffer* next();
+
+	/** Function Name: recycle(PipelineBuffer* buffer)
+	 *  Description: Hands a buffer returned by next() back to the reader
+	 *  Return Value: None
+	 */
+	void recycle(PipelineBuffer* buffer);
+};
+
+/** Class Name: WriteStage
+ *  Description: Writer thread that drains coded buffers to an ostream
+ *               behind the coding thread.
+ */
+class WriteStage {
+private:
+	ostream& out; /** Stream the writer thread writes */
+	PipelineBuffer buffers[PIPELINE_DEPTH]; /** Every buffer of the stage */
+	SpscQueue<PipelineBuffer*, PIPELINE_DEPTH> freeBuffers; /** To fill */
+	SpscQueue<PipelineBuffer*, PIPELINE_DEPTH> fullBuffers; /** To write */
+	bool finished; /** The end marker has been submitted */
+	thread writer; /** Runs writeLoop() */
+
+	/** Function Name: writeLoop()
+	 *  Description: Body of the writer thread
+	 *  Return Value: None
+	 */
+	void writeLoop();
+
+public:
+	/** Constructor
+	 *  Description: Starts the writer thread on out
+	 */
+	WriteStage(ostream& out);
+
+	/** Destructor
+	 *  Description: Calls finish()
+	 */
+	~WriteStage();
+
+	/** Function Name: acquire()
+	 *  Description: Takes an empty buffer to fill, waiting for the writer
+	 *  Return Value: The buffer, with size 0
+	 */
+	PipelineBuffer* acquire();
+
+	/** Function Name: submit(PipelineBuffer* buffer)
+	 *  Description: Queues a buffer returned by acquire() for writing. The
+	 *               writer hands it back once it has been written.
+	 *  Return Value: None
+	 */
+	void submit(PipelineBuffer* buffer);
+
+	/** Function Name: finish()
+	 *  Description: Writes everything submitted and joins the writer thread
+	 *  Return Value: None
+	 */
+	void finish();
+};
+
+/** Struct Name: VerifyBuffer
+ *  Description: One block handed to a VerifyStage, as it was read and as
+ *               it was written
+ */
+struct VerifyBuffer {
+	vector<byte> input; /** The block as read */
+	string coded; /** The block as BlockEncoder wrote it */
+};
+
+/** Class Name: VerifyStage
+ *  Description: Verifier thread that decodes every block a BlockEncoder
+ *               wrote with a BlockDecoder of its own, so tables carried
+ *               from block to block are checked too, and compares the
+ *               result with the input the block was coded from. The input
+ *               stays in its buffer until then, so nothing is read twice.
+ */
+class VerifyStage {
+private:
+	VerifyBuffer buffers[PIPELINE_DEPTH]; /** Every buffer of the stage */
+	SpscQueue<VerifyBuffer*, PIPELINE_DEPTH> freeBuffers; /** To fill */
+	SpscQueue<VerifyBuffer*, PIPELINE_DEPTH> fullBuffers; /** To verify */
+	unsigned long long verifiedBlocks; /** Blocks that decoded to input */
+	unsigned long long verifiedBytes; /** Bytes in those blocks */
+	bool failed; /** A block did not decode to its input */
+	bool finished; /** The end marker has been submitted */
+	thread verifier; /** Runs verifyLoop() */
+
+	/** Function Name: verifyLoop()
+	 *  Description: Body of the verifier thread
+	 *  Return Value: None
+	 */
+	void verifyLoop();
+
+public:
+	/** Constructor
+	 *  Description: Starts the verifier thread
+	 */
+	VerifyStage();
+
+	/** Destructor
+	 *  Description: Calls finish()
+	 */
+	~VerifyStage();
+
+	/** Function Name: acquire()
+	 *  Description: Takes a buffer to read a block into, waiting for the
+	 *               verifier
+	 *  Return Value: The buffer
+	 */
+	VerifyBuffer* acquire();
+
+	/** Function Name: submit(VerifyBuffer* buffer)
+	 *  Description: Queues a buffer returned by acquire(), holding a block
+	 *               and its coded bytes, for verifying. Blocks have to be
+	 *               submitted in the order they were coded.
+	 *  Return Value: None
+	 */
+	void submit(VerifyBuffer* buffer);
+
+	/** Function Name: finish()
+	 *  Description: Verifies everything submitted and joins the verifier
+	 *               thread
+	 *  Return Value: True if every block decoded to its input
+	 */
+	bool finish();
+
+	/** Function Name: getVerifiedBlocks() const
+	 *  Description: Getter for the number of blocks verified, valid after
+	 *               finish()
+	 *  Return Value: The value of verifiedBlocks
+	 */
+	unsigned long long getVerifiedBlocks() const;
+
+	/** Function Name: getVerifiedBytes() const
+	 *  Description: Getter for the number of input bytes verified, valid
+	 *               after finish()
+	 *  Return Value: The value of verifiedBytes
+	 */
+	unsigned long long getVerifiedBytes() const;
+};
+
+/** Class Name: ReadStageBuf
+ *  Description: streambuf that reads the buffers of a ReadStage
+ */
+class ReadStageBuf : public streambuf {
+private:
+	ReadStage& stage; /** Stage the buffers come from */
+	PipelineBuffer* current; /** Buffer being read, or nullptr */
+
+protected:
+	/** Function Name: underflow()
+	 *  Description: Recycles the buffer just read and moves to the next one
+	 *  Return Value: The next character, or EOF once the stream is done
+	 */
+	int_type underflow();
+
+public:
+	/** Constructor
+	 *  Description: Creates a streambuf over stage
+	 */
+	ReadStageBuf(ReadStage& stage);
+
+	/** Destructor
+	 *  Description: Recycles the buffer being read
+	 */
+	~ReadStageBuf();
+};
+
+/** Class Name: WriteStageBuf
+ *  Description: streambuf that fills the buffers of a WriteStage
+ */
+class WriteStageBuf : public streambuf {
+private:
+	WriteStage& stage; /** Stage the buffers go to */
+	PipelineBuffer* current; /** Buffer being filled */
+
+	/** Function Name: submitCurrent()
+	 *  Description: Submits the buffer being filled and takes a new one
+	 *  Return Value: None
+	 */
+	void submitCurrent();
+
+protected:
+	/** Function Name: overflow(int_type c)
+	 *  Description: Submits the full buffer and stores c in a new one
+	 *  Return Value: c, or anything but EOF if c is EOF
+	 */
+	int_type overflow(int_type c);
+
+	/** Function Name: xsputn(const char* s, streamsize n)
+	 *  Description: Copies n characters in, a buffer at a time
+	 *  Return Value: n
+	 */
+	streamsize xsputn(const char* s, streamsize n);
+
+	/** Function Name: sync()
+	 *  Description: Submits what has been written so far
+	 *  Return Value: 0
+	 */
+	int sync();
+
+public:
+	/** Constructor
+	 *  Description: Creates a streambuf over stage
+	 */
+	WriteStageBuf(WriteStage& stage);
+
+	/** Destructor
+	 *  Description: Submits what has been written so far along with the
+	 *               buffer being filled
+	 */
+	~WriteStageBuf();
+};
+
+#endif // PIPELINE_HPP
@@ -0,0 +1,190 @@
+/** Filename: RunStats.cpp
+ *  Name: Loc Chuong
+ *  Description: Opt-in statistics of one compress or uncompress run and the
+ *               timers that fill them in.
+ *  Date: 10/18/2026
+ */
+
+#include "RunStats.hpp"
+#include "HCTree.hpp"
+#include <cmath>
+#include <ctime>
+#include <sstream>
+
+#if defined(_WIN32)
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#pragma comment(lib, "psapi.lib")
+#else
+#include <sys/resource.h>
+#endif
+
+/** Names of the phases in the JSON output, by phase number */
+static const char* PHASE_NAMES[PHASE_COUNT] = { "histogram", "build",
+	"header", "encode", "decode", "io" };
+
+/** Constructor
+ *  Description: Creates empty statistics
+ */
+RunStats::RunStats() : decompress(false), inputBytes(0), outputBytes(0),
+	headerBytes(0), entropyBits(0), averageCodeLength(0), maxCodeDepth(0),
+	peakRssBytes(0), cacheHits(0), cacheMisses(0) {
+	for (int i = 0; i < PHASE_COUNT; i++) {
+		phases[i].wallSeconds = phases[i].cpuSeconds = 0;
+	}
+	total.wallSeconds = total.cpuSeconds = 0;
+}
+
+/** Function Name: setCode(const vector<int>& freqs, const HCTree& tree)
+ *  Description: Fills in the entropy, average code length and maximum code
+ *               depth of coding freqs with tree
+ *  Return Value: None
+ */
+void RunStats::setCode(const vector<int>& freqs, const HCTree& tree) {
+	double totalFreq = 0;
+	double codeBits = 0;
+	for (int i = 0; i < ASCII_MAX; i++) {
+		totalFreq += freqs[i];
+		codeBits += (double)freqs[i] * tree.getCodeLength((byte)i);
+	}
+	entropyBits = 0;
+	for (int i = 0; i < ASCII_MAX; i++) {
+		if (freqs[i] != 0) {
+			entropyBits += freqs[i] / totalFreq * log2(totalFreq / freqs[i]);
+		}
+	}
+	averageCodeLength = totalFreq > 0 ? codeBits / totalFreq : 0;
+	maxCodeDepth = tree.getMaxCodeLength();
+}
+
+/** Function Name: getThroughput() const
+ *  Description: Raw bytes coded per second of the whole run
+ *  Return Value: The throughput in MB/s
+ */
+double RunStats::getThroughput() const {
+	unsigned long long rawBytes = decompress ? outputBytes : inputBytes;
+	if (total.wallSeconds <= 0) {
+		return 0;
+	}
+	return rawBytes / total.wallSeconds / (1 << 20);
+}
+
+/** Function Name: toJson() const
+ *  Description: Formats every field as one JSON object
+ *  Return Value: The JSON text
+ */
+string RunStats::toJson() const {
+	ostringstream json;
+	json << "{\"command\": \"";
+	/** Command names are plain words, but keep the JSON valid regardless */
+	for (size_t i = 0; i < command.size(); i++) {
+		if (command[i] == '"' || command[i] == '\\') {
+			json << '\\';
+		}
+		json << command[i];
+	}
+	json << "\", \"input_bytes\": " << inputBytes
+		<< ", \"output_bytes\": " << outputBytes
+		<< ", \"header_bytes\": " << headerBytes
+		<< ", \"entropy_bits\": " << entropyBits
+		<< ", \"average_code_length\": " << averageCodeLength
+		<< ", \"max_code_depth\": " << maxCodeDepth
+		<< ", \"phases\": {";
+	for (int i = 0; i < PHASE_COUNT; i++) {
+		json << (i == 0 ? "" : ", ") << "\"" << PHASE_NAMES[i]
+			<< "\": {\"wall_s\": " << phases[i].wallSeconds
+			<< ", \"cpu_s\": " << phases[i].cpuSeconds << "}";
+	}
+	json << "}, \"wall_s\": " << total.wallSeconds
+		<< ", \"cpu_s\": " << total.cpuSeconds
+		<< ", \"mb_per_s\": " << getThroughput()
+		<< ", \"peak_rss_bytes\": " << peakRssBytes
+		<< ", \"cache_hits\": " << cacheHits
+		<< ", \"cache_misses\": " << cacheMisses << "}";
+	return json.str();
+}
+
+/** Constructor
+ *  Description: Starts timing phase of stats, if stats is not nullptr
+ */
+PhaseTimer::PhaseTimer(RunStats* stats, int phase)
+	: phase(stats != nullptr ? &stats->phases[phase] : nullptr), cpuStart(0) {
+	if (this->phase != nullptr) {
+		wallStart = chrono::steady_clock::now();
+		cpuStart = processCpuSeconds();
+	}
+}
+
+/** Constructor
+ *  Description: Starts timing the whole run of stats, if stats is not
+ *               nullptr
+ */
+PhaseTimer::PhaseTimer(RunStats* stats)
+	: phase(stats != nullptr ? &stats->total : nullptr), cpuStart(0) {
+	if (phase != nullptr) {
+		wallStart = chrono::steady_clock::now();
+		cpuStart = processCpuSeconds();
+	}
+}
+
+/** Destructor
+ *  Description: Adds the time since construction to the phase
+ */
+PhaseTimer::~PhaseTimer() {
+	if (phase == nullptr) {
+		return;
+	}
+	phase->wallSeconds += chrono::duration<double>(
+		chrono::steady_clock::now() - wallStart).count();
+	phase->cpuSeconds += processCpuSeconds() - cpuStart;
+}
+
+/** Function Name: processCpuSeconds()
+ *  Description: CPU time used by every thread of the process so far
+ *  Return Value: The CPU time in seconds
+ */
+double processCpuSeconds() {
+#if defined(_WIN32)
+	/** clock() is wall time on Windows, ask for the process times instead */
+	FILETIME created, exited, kernel, user;
+	if (!GetProcessTimes(GetCurrentProcess(), &created, &exited, &kernel,
+		&user)) {
+		return 0;
+	}
+	ULARGE_INTEGER kernelTime, userTime;
+	kernelTime.LowPart = kernel.dwLowDateTime;
+	kernelTime.HighPart = kernel.dwHighDateTime;
+	userTime.LowPart = user.dwLowDateTime;
+	userTime.HighPart = user.dwHighDateTime;
+	return (kernelTime.QuadPart + userTime.QuadPart) / 1e7;
+#else
+	return (double)clock() / CLOCKS_PER_SEC;
+#endif
+}
+
+/** Function Name: peakRssBytes()
+ *  Description: Largest resident set of the process so far
+ *  Return Value: The size in bytes, or 0 if it cannot be read
+ */
+long long peakRssBytes() {
+#if defined(_WIN32)
+	PROCESS_MEMORY_COUNTERS counters;
+	if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters,
+		sizeof(counters))) {
+		return 0;
+	}
+	return (long long)counters.PeakWorkingSetSize;
+#else
+	struct rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) != 0) {
+		return 0;
+	}
+#if defined(__APPLE__)
+	/** macOS reports bytes, Linux kilobytes */
+	return (long long)usage.ru_maxrss;
+#else
+	return (long long)usage.ru_maxrss * 1024;
+#endif
+#endif
+}
@@ -0,0 +1,124 @@
+/** Filename: RunStats.hpp
+ *  Name: Loc Chuong
+ *  Description: Opt-in statistics of one compress or uncompress run: sizes,
+ *               how close the code came to the entropy, the wall and CPU
+ *               time of every phase, throughput, peak memory and how often
+ *               the table cache had the tree already. Filled in by the
+ *               commands when they are given a RunStats and printed as
+ *               JSON by the CLI with --stats.
+ *  Date: 10/18/2026
+ */
+
+#ifndef RUNSTATS_HPP
+#define RUNSTATS_HPP
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+class HCTree;
+
+#define PHASE_HISTOGRAM 0 /** Counting byte frequencies */
+#define PHASE_BUILD 1 /** Building or fetching the coding tree */
+#define PHASE_HEADER 2 /** Writing or reading the frequency header */
+#define PHASE_ENCODE 3 /** Encoding the payload */
+#define PHASE_DECODE 4 /** Decoding the payload */
+#define PHASE_IO 5 /** Reading input and writing output */
+#define PHASE_COUNT 6 /** Number of phases */
+
+using namespace std;
+
+/** Struct Name: PhaseTime
+ *  Description: Time spent in one phase
+ */
+struct PhaseTime {
+	double wallSeconds; /** Elapsed time */
+	double cpuSeconds; /** CPU time of the whole process */
+};
+
+/** Struct Name: RunStats
+ *  Description: Statistics of one run. Everything is 0 until the run
+ *               fills it in.
+ */
+struct RunStats {
+	string command; /** The command that ran */
+	bool decompress; /** Whether the raw bytes are the output */
+	unsigned long long inputBytes; /** Size of the file read */
+	unsigned long long outputBytes; /** Size of the file written */
+	unsigned long long headerBytes; /** Size of the frequency header */
+	double entropyBits; /** Shannon entropy of the raw bytes, per byte */
+	double averageCodeLength; /** Code bits spent per raw byte */
+	int maxCodeDepth; /** Length of the longest code */
+	PhaseTime phases[PHASE_COUNT]; /** Time spent in every phase */
+	PhaseTime total; /** Time spent in the whole run */
+	long long peakRssBytes; /** Largest resident set of the process */
+	unsigned long long cacheHits; /** Trees the table cache handed out */
+	unsigned long long cacheMisses; /** Trees the table cache had to build */
+
+	/** Constructor
+	 *  Description: Creates empty statistics
+	 */
+	RunStats();
+
+	/** Function Name: setCode(const vector<int>& freqs, const HCTree& tree)
+	 *  Description: Fills in the entropy, average code length and maximum
+	 *               code depth of coding freqs with tree
+	 *  Return Value: None
+	 */
+	void setCode(const vector<int>& freqs, const HCTree& tree);
+
+	/** Function Name: getThroughput() const
+	 *  Description: Raw bytes coded per second of the whole run
+	 *  Return Value: The throughput in MB/s
+	 */
+	double getThroughput() const;
+
+	/** Function Name: toJson() const
+	 *  Description: Formats every field as one JSON object
+	 *  Return Value: The JSON text
+	 */
+	string toJson() const;
+};
+
+/** Class Name: PhaseTimer
+ *  Description: Adds the wall and CPU time between its construction and
+ *               destruction to one phase of a RunStats. Does nothing when
+ *               given no RunStats.
+ */
+class PhaseTimer {
+private:
+	PhaseTime* phase; /** Where the time goes, or nullptr */
+	chrono::steady_clock::time_point wallStart; /** Wall time at start */
+	double cpuStart; /** CPU time at start */
+
+public:
+	/** Constructor
+	 *  Description: Starts timing phase of stats, if stats is not nullptr
+	 */
+	PhaseTimer(RunStats* stats, int phase);
+
+	/** Constructor
+	 *  Description: Starts timing the whole run of stats, if stats is not
+	 *               nullptr
+	 */
+	PhaseTimer(RunStats* stats);
+
+	/** Destructor
+	 *  Description: Adds the time since construction to the phase
+	 */
+	~PhaseTimer();
+};
+
+/** Function Name: processCpuSeconds()
+ *  Description: CPU time used by every thread of the process so far
+ *  Return Value: The CPU time in seconds
+ */
+double processCpuSeconds();
+
+/** Function Name: peakRssBytes()
+ *  Description: Largest resident set of the process so far
+ *  Return Value: The size in bytes, or 0 if it cannot be read
+ */
+long long peakRssBytes();
+
+#endif // RUNSTATS_HPP
@@ -0,0 +1,166 @@
+/** Filename: SizeEstimator.cpp
+ *  Name: Loc Chuong
+ *  Description: Sizes a buffer under compress() from its histogram alone,
+ *               sampling the buffer when it is very large.
+ *  Date: 10/18/2026
+ */
+
+#include "SizeEstimator.hpp"
+#include "StaticCodec.hpp"
+#include "Trace.hpp"
+#include <algorithm>
+
+/** Function Name: countBytes(const byte* data, size_t size, vector<int>& freqs)
+ *  Description: Adds the bytes of data to freqs. Four tables take turns so
+ *               runs of one byte do not wait on their own increments.
+ *  Return Value: None
+ */
+static void countBytes(const byte* data, size_t size, vector<int>& freqs) {
+	int counts[4][ASCII_MAX] = { { 0 } };
+	size_t i = 0;
+	for (; i + 4 <= size; i += 4) {
+		counts[0][data[i]]++;
+		counts[1][data[i + 1]]++;
+		counts[2][data[i + 2]]++;
+		counts[3][data[i + 3]]++;
+	}
+	for (; i < size; i++) {
+		counts[0][data[i]]++;
+	}
+	for (int c = 0; c < ASCII_MAX; c++) {
+		freqs[c] += counts[0][c] + counts[1][c] + counts[2][c] + counts[3][c];
+	}
+}
+
+/** Function Name: huffmanPayloadBits(const vector<int>& freqs)
+ *  Description: Merges the weights with two queues, the sorted leaves and
+ *               the merged weights, which come out in order on their own,
+ *               and adds up every merged weight
+ *  Return Value: The payload size in bits
+ */
+unsigned long long huffmanPayloadBits(const vector<int>& freqs) {
+	vector<unsigned long long> leaves;
+	for (size_t i = 0; i < freqs.size(); i++) {
+		if (freqs[i] != 0) {
+			leaves.push_back((unsigned long long)freqs[i]);
+		}
+	}
+	if (leaves.size() == 1) {
+		return leaves[0];
+	}
+	sort(leaves.begin(), leaves.end());
+	vector<unsigned long long> merged;
+	merged.reserve(leaves.size());
+	size_t nextLeaf = 0;
+	size_t nextMerged = 0;
+	unsigned long long bits = 0;
+	for (size_t m = 1; m < leaves.size(); m++) {
+		unsigned long long weight = 0;
+		for (int k = 0; k < 2; k++) {
+			if (nextLeaf < leaves.size() && (nextMerged == merged.size()
+				|| leaves[nextLeaf] <= merged[nextMerged])) {
+				weight += leaves[nextLeaf++];
+			}
+			else {
+				weight += merged[nextMerged++];
+			}
+		}
+		merged.push_back(weight);
+		bits += weight;
+	}
+	return bits;
+}
+
+/** Function Name: estimateSize(const vector<int>& freqs)
+ *  Description: The exact sizes of a buffer with histogram freqs
+ *  Return Value: The sizes
+ */
+SizeEstimate estimateSize(const vector<int>& freqs) {
+	TRACE_SPAN("estimate");
+	SizeEstimate estimate = { 0, 0, 0, 0, 0, false };
+	for (size_t i = 0; i < freqs.size(); i++) {
+		estimate.inputBytes += freqs[i];
+	}
+	/** compress() writes nothing at all for an empty file */
+	if (estimate.inputBytes == 0) {
+		return estimate;
+	}
+	estimate.headerBits = HCTree::headerBits(freqs);
+	estimate.payloadBits = huffmanPayloadBits(freqs);
+	estimate.compressedBytes =
+		(estimate.headerBits + estimate.payloadBits + 7) / 8;
+	unsigned long long staticBits =
+		StaticCodec<EnglishText>::estimateBits(freqs);
+	estimate.staticBytes = staticBits == STATIC_NO_ESTIMATE
+		? STATIC_NO_ESTIMATE : (staticBits + 7) / 8;
+	return estimate;
+}
+
+/** Function Name: estimateSize(const byte* data, size_t size,
+ *                              size_t sampleThreshold)
+ *  Description: Counts data and sizes it, from evenly spread chunks scaled
+ *               up to the whole buffer when it is over sampleThreshold.
+ *               Every byte seen in the sample keeps a count of at least 1.
+ *  Return Value: The sizes, exact unless sampled is set
+ */
+SizeEstimate estimateSize(const byte* data, size_t size,
+	size_t sampleThreshold) {
+	vector<int> freqs(ASCII_MAX, 0);
+	bool sampled = sampleThreshold != ESTIMATE_NO_SAMPLING
+		&& size > sampleThreshold
+		&& size > (size_t)ESTIMATE_SAMPLE_CHUNKS * ESTIMATE_CHUNK_SIZE;
+	if (!sampled) {
+		TRACE_SPAN("histogram");
+		countBytes(data, size, freqs);
+		return estimateSize(freqs);
+	}
+	{
+		TRACE_SPAN("sample");
+		size_t stride = size / ESTIMATE_SAMPLE_CHUNKS;
+		for (int c = 0; c < ESTIMATE_SAMPLE_CHUNKS; c++) {
+			countBytes(data + c * stride, ESTIMATE_CHUNK_SIZE, freqs);
+		}
+	}
+	double scale = (double)size / ((double)ESTIMATE_SAMPLE_CHUNKS
+		* ESTIMATE_CHUNK_SIZE);
+	for (int i = 0; i < ASCII_MAX; i++) {
+		if (freqs[i] != 0) {
+			freqs[i] = max(1, (int)(freqs[i] * scale + 0.5));
+		}
+	}
+	SizeEstimate estimate = estimateSize(freqs);
+	estimate.inputBytes = size;
+	estimate.sampled = true;
+	return estimate;
+}
+
+/** Function Name: scaleSample(vector<int>& freqs,
+ *                             unsigned long long sampleBytes,
+ *                             unsigned long long totalBytes)
+ *  Description: Scales the sample counts up, gives every missed byte a
+ *               pseudocount of 1, then moves the rounding onto the most
+ *               frequent byte so the counts add up to totalBytes
+ *  Return Value: False if the input is too small to scale to
+ */
+bool scaleSample(vector<int>& freqs, unsigned long long sampleBytes,
+	unsigned long long totalBytes) {
+	if (sampleBytes == 0 || totalBytes < (unsigned long long)freqs.size()) {
+		return false;
+	}
+	double scale = (double)totalBytes / sampleBytes;
+	long long sum = 0;
+	size_t largest = 0;
+	for (size_t i = 0; i < freqs.size(); i++) {
+		freqs[i] = max(1, (int)(freqs[i] * scale + 0.5));
+		sum += freqs[i];
+		if (freqs[i] > freqs[largest]) {
+			largest = i;
+		}
+	}
+	long long adjusted = freqs[largest] + ((long long)totalBytes - sum);
+	if (adjusted < 1) {
+		return false;
+	}
+	freqs[largest] = (int)adjusted;
+	return true;
+}
@@ -0,0 +1,86 @@
+/** Filename: SizeEstimator.hpp
+ *  Name: Loc Chuong
+ *  Description: Tells what compress() would write for a buffer without
+ *               coding it. Every Huffman tree for a histogram costs the
+ *               same number of bits, the sum of its merged weights, so the
+ *               payload size falls out of the merging alone: no nodes, no
+ *               codes, no tables. With the header size from the histogram
+ *               that gives the exact size of the file compress() writes.
+ *               Very large buffers can be sampled instead of counted whole,
+ *               which makes the size an estimate.
+ *  Date: 10/18/2026
+ */
+
+#ifndef SIZEESTIMATOR_HPP
+#define SIZEESTIMATOR_HPP
+
+#include <vector>
+#include "HCTree.hpp"
+
+#define ESTIMATE_SAMPLE_THRESHOLD (16 << 20) /** Larger buffers are sampled */
+#define ESTIMATE_SAMPLE_CHUNKS 64 /** Evenly spaced chunks a sample takes */
+#define ESTIMATE_CHUNK_SIZE (16 << 10) /** Bytes in each sampled chunk */
+#define ESTIMATE_NO_SAMPLING 0 /** Threshold that counts every byte */
+
+using namespace std;
+
+/** Struct Name: SizeEstimate
+ *  Description: The sizes one buffer would take in the ways it can be
+ *               stored
+ */
+struct SizeEstimate {
+	unsigned long long inputBytes; /** Size of the buffer */
+	unsigned long long headerBits; /** Frequency header of compress() */
+	unsigned long long payloadBits; /** Code bits of compress() */
+	unsigned long long compressedBytes; /** File compress() writes */
+	unsigned long long staticBytes; /** Coded with the EnglishText table */
+	bool sampled; /** Whether the sizes come from a sample */
+};
+
+/** Function Name: huffmanPayloadBits(const vector<int>& freqs)
+ *  Description: Number of code bits an optimal Huffman code spends on a
+ *               buffer with histogram freqs, the sum of the weights merged
+ *               while building it. A lone symbol costs 1 bit per byte, as
+ *               HCTree codes it.
+ *  Return Value: The payload size in bits
+ */
+unsigned long long huffmanPayloadBits(const vector<int>& freqs);
+
+/** Function Name: estimateSize(const vector<int>& freqs)
+ *  Description: The exact sizes of a buffer with histogram freqs
+ *  Return Value: The sizes
+ */
+SizeEstimate estimateSize(const vector<int>& freqs);
+
+/** Function Name: estimateSize(const byte* data, size_t size,
+ *                              size_t sampleThreshold)
+ *  Description: Counts data and sizes it. Buffers over sampleThreshold
+ *               bytes are sized from ESTIMATE_SAMPLE_CHUNKS chunks spread
+ *               evenly over them, scaled up to the whole buffer.
+ *  Parameters: data - The buffer
+ *              size - Number of bytes in data
+ *              sampleThreshold - Size above which to sample, or
+ *                                ESTIMATE_NO_SAMPLING to always count all
+ *  Return Value: The sizes, exact unless sampled is set
+ */
+SizeEstimate estimateSize(const byte* data, size_t size,
+	size_t sampleThreshold = ESTIMATE_SAMPLE_THRESHOLD);
+
+/** Function Name: scaleSample(vector<int>& freqs,
+ *                             unsigned long long sampleBytes,
+ *                             unsigned long long totalBytes)
+ *  Description: Turns the histogram of a sample into one a table for the
+ *               whole input can be built from. Every count is scaled up to
+ *               totalBytes, every byte the sample missed gets a pseudocount
+ *               of 1 so it still has a code, and the most frequent byte
+ *               takes up the rounding so the counts add up to totalBytes,
+ *               as the header of compress() needs.
+ *  Parameters: freqs - Counts of the sample, set to the scaled counts
+ *              sampleBytes - Number of bytes in the sample
+ *              totalBytes - Number of bytes in the whole input
+ *  Return Value: False if the input is too small to scale to
+ */
+bool scaleSample(vector<int>& freqs, unsigned long long sampleBytes,
+	unsigned long long totalBytes);
+
+#endif // SIZEESTIMATOR_HPP
@@ -0,0 +1,11 @@
+/** Filename: StaticCodec.cpp
+ *  Name: Loc Chuong
+ *  Description: Storage for the static distributions of StaticCodec.hpp.
+ *               Their tables are all computed at compile time.
+ *  Date: 10/18/2026
+ */
+
+#include "StaticCodec.hpp"
+
+constexpr int EnglishText::freqs[ASCII_MAX];
+constexpr StaticTable EnglishText::table;
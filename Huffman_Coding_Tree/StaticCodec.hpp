@@ -0,0 +1,463 @@
+/** Filename: StaticCodec.hpp
+ *  Name: Loc Chuong
+ *  Description: Huffman tables built at compile time for distributions known
+ *               in advance. buildStaticTable() is constexpr: it turns a
+ *               frequency array into code lengths limited to
+ *               STATIC_MAX_BITS, canonical codes and a one-lookup decode
+ *               table while the program compiles. StaticCodec<Distribution>
+ *               codes with the table of Distribution, so neither side
+ *               builds a tree or reads a header at run time. EnglishText is
+ *               the distribution of warandpeace.txt. The same steps run at
+ *               run time on a table owned by the caller, which is how
+ *               MessageCodec.hpp codes small messages without allocating.
+ *  Date: 10/18/2026
+ */
+
+#ifndef STATICCODEC_HPP
+#define STATICCODEC_HPP
+
+#include <vector>
+#include "HCTree.hpp"
+
+#define STATIC_MAX_BITS 12 /** Longest static code, the decode table index */
+#define STATIC_TABLE_SIZE (1 << STATIC_MAX_BITS) /** Decode table entries */
+#define STATIC_NO_ESTIMATE ~0ULL /** Cost of data a table cannot code */
+
+using namespace std;
+
+/** Struct Name: StaticDecodeEntry
+ *  Description: One slot of a static decode table, the symbol of every
+ *               STATIC_MAX_BITS bit window and the length of its code. A
+ *               length of 0 marks a window no code starts.
+ */
+struct StaticDecodeEntry {
+	byte symbol; /** Symbol whose code starts the window */
+	byte length; /** Length of that code, 0 if there is none */
+};
+
+/** Struct Name: StaticTable
+ *  Description: Everything StaticCodec needs to code with one distribution
+ */
+struct StaticTable {
+	byte lengths[ASCII_MAX]; /** Code length per symbol, 0 if it has none */
+	unsigned short codes[ASCII_MAX]; /** Canonical code per symbol */
+	StaticDecodeEntry decode[STATIC_TABLE_SIZE]; /** Lookup by next bits */
+	bool valid; /** False if the frequencies had no symbol at all */
+};
+
+/** Function Name: staticCodeLengths(const int (&freqs)[ASCII_MAX],
+ *                                   StaticTable& table)
+ *  Description: Fills table.lengths with Huffman code lengths. The symbols
+ *               are sorted by frequency and merged with two queues, leaves
+ *               and merged nodes, both already in order, so the merging
+ *               is linear and stays well inside compile-time step limits.
+ *  Return Value: The number of symbols with a code
+ */
+constexpr int staticCodeLengths(const int (&freqs)[ASCII_MAX],
+	StaticTable& table) {
+	int order[ASCII_MAX] = {};
+	int count = 0;
+	for (int s = 0; s < ASCII_MAX; s++) {
+		if (freqs[s] > 0) {
+			/** Insertion sort, lightest first and lower symbol first on ties */
+			int i = count++;
+			while (i > 0 && freqs[order[i - 1]] > freqs[s]) {
+				order[i] = order[i - 1];
+				i--;
+			}
+			order[i] = s;
+		}
+	}
+	if (count == 1) {
+		table.lengths[order[0]] = 1;
+		return count;
+	}
+	/** Nodes 0 to count - 1 are the sorted leaves, the rest are merged */
+	long long weight[2 * ASCII_MAX] = {};
+	int parent[2 * ASCII_MAX] = {};
+	int depth[2 * ASCII_MAX] = {};
+	for (int i = 0; i < count; i++) {
+		weight[i] = freqs[order[i]];
+	}
+	int nextLeaf = 0;
+	int nextMerged = count;
+	for (int merged = count; merged < 2 * count - 1; merged++) {
+		int picked[2] = {};
+		for (int k = 0; k < 2; k++) {
+			if (nextLeaf < count && (nextMerged == merged
+				|| weight[nextLeaf] <= weight[nextMerged])) {
+				picked[k] = nextLeaf++;
+			}
+			else {
+				picked[k] = nextMerged++;
+			}
+		}
+		weight[merged] = weight[picked[0]] + weight[picked[1]];
+		parent[picked[0]] = merged;
+		parent[picked[1]] = merged;
+	}
+	/** A parent is always made after its children, so walk down from the
+	 *  root and every parent's depth is known before its children's
+	 */
+	for (int i = 2 * count - 3; i >= 0; i--) {
+		depth[i] = depth[parent[i]] + 1;
+	}
+	for (int i = 0; i < count; i++) {
+		table.lengths[order[i]] = (byte)depth[i];
+	}
+	return count;
+}
+
+/** Function Name: staticLimitLengths(const int (&freqs)[ASCII_MAX],
+ *                                    StaticTable& table)
+ *  Description: Cuts every code longer than STATIC_MAX_BITS down to it, then
+ *               pays back the code space that took by lengthening the codes
+ *               that cost the fewest bits per unit of space freed, and
+ *               finally spends any space left over on shortening the most
+ *               frequent codes
+ *  Return Value: None
+ */
+constexpr void staticLimitLengths(const int (&freqs)[ASCII_MAX],
+	StaticTable& table) {
+	/** Code space in units of 2^-STATIC_MAX_BITS, full at the table size */
+	long long space = 0;
+	for (int s = 0; s < ASCII_MAX; s++) {
+		if (table.lengths[s] > STATIC_MAX_BITS) {
+			table.lengths[s] = STATIC_MAX_BITS;
+		}
+		if (table.lengths[s] != 0) {
+			space += 1LL << (STATIC_MAX_BITS - table.lengths[s]);
+		}
+	}
+	while (space > STATIC_TABLE_SIZE) {
+		long long excess = space - STATIC_TABLE_SIZE;
+		/** Lengthening s frees 2^(STATIC_MAX_BITS - length - 1) units for
+		 *  freqs[s] bits, compared as freqs[s] * 2^length. Freeing more than
+		 *  the excess is only done when nothing frees less.
+		 */
+		int pick = -1;
+		bool pickFits = false;
+		for (int s = 0; s < ASCII_MAX; s++) {
+			int length = table.lengths[s];
+			if (length == 0 || length == STATIC_MAX_BITS) {
+				continue;
+			}
+			bool fits = (1LL << (STATIC_MAX_BITS - length - 1)) <= excess;
+			if (pick < 0 || (fits && !pickFits)) {
+				pick = s;
+				pickFits = fits;
+				continue;
+			}
+			if (fits != pickFits) {
+				continue;
+			}
+			int pickLength = table.lengths[pick];
+			bool better = fits
+				? ((long long)freqs[s] << length)
+					< ((long long)freqs[pick] << pickLength)
+				: length > pickLength
+					|| (length == pickLength && freqs[s] < freqs[pick]);
+			if (better) {
+				pick = s;
+			}
+		}
+		table.lengths[pick]++;
+		space -= 1LL << (STATIC_MAX_BITS - table.lengths[pick]);
+	}
+	/** Shorten the most frequent codes that still fit in what is left */
+	bool shortened = true;
+	while (shortened) {
+		shortened = false;
+		int pick = -1;
+		for (int s = 0; s < ASCII_MAX; s++) {
+			int length = table.lengths[s];
+			if (length > 1 && space + (1LL << (STATIC_MAX_BITS - length))
+				<= STATIC_TABLE_SIZE && (pick < 0 || freqs[s] > freqs[pick])) {
+				pick = s;
+			}
+		}
+		if (pick >= 0) {
+			space += 1LL << (STATIC_MAX_BITS - table.lengths[pick]);
+			table.lengths[pick]--;
+			shortened = true;
+		}
+	}
+}
+
+/** Function Name: staticAssignCodes(StaticTable& table)
+ *  Description: Gives every symbol with a length in table.lengths its
+ *               canonical code, shorter codes first and then by symbol
+ *  Return Value: None
+ */
+constexpr void staticAssignCodes(StaticTable& table) {
+	int counts[STATIC_MAX_BITS + 1] = {};
+	for (int s = 0; s < ASCII_MAX; s++) {
+		counts[table.lengths[s]]++;
+	}
+	unsigned int next[STATIC_MAX_BITS + 1] = {};
+	unsigned int code = 0;
+	for (int length = 1; length <= STATIC_MAX_BITS; length++) {
+		next[length] = code;
+		code = (code + counts[length]) << 1;
+	}
+	for (int s = 0; s < ASCII_MAX; s++) {
+		if (table.lengths[s] != 0) {
+			table.codes[s] = (unsigned short)next[table.lengths[s]]++;
+		}
+	}
+}
+
+/** Function Name: staticFillDecode(StaticTable& table)
+ *  Description: Maps every window starting with a code to its symbol.
+ *               Canonical codes fill the windows from 0 up without gaps,
+ *               so only the ones past the last code are cleared.
+ *  PRECONDITION: staticAssignCodes() has been called and the lengths
+ *                do not overfill the code space
+ *  Return Value: None
+ */
+constexpr void staticFillDecode(StaticTable& table) {
+	int filled = 0;
+	for (int s = 0; s < ASCII_MAX; s++) {
+		int length = table.lengths[s];
+		if (length == 0) {
+			continue;
+		}
+		int first = table.codes[s] << (STATIC_MAX_BITS - length);
+		for (int i = 0; i < (1 << (STATIC_MAX_BITS - length)); i++) {
+			table.decode[first + i].symbol = (byte)s;
+			table.decode[first + i].length = (byte)length;
+		}
+		filled += 1 << (STATIC_MAX_BITS - length);
+	}
+	for (int i = filled; i < STATIC_TABLE_SIZE; i++) {
+		table.decode[i].symbol = 0;
+		table.decode[i].length = 0;
+	}
+}
+
+/** Function Name: buildStaticTable(const int (&freqs)[ASCII_MAX])
+ *  Description: Builds the code lengths, canonical codes and decode table
+ *               for freqs. Meant to run at compile time; symbols with a
+ *               frequency of 0 get no code.
+ *  Parameters: freqs - freqs[i] is the frequency of symbol i
+ *  Return Value: The table
+ */
+constexpr StaticTable buildStaticTable(const int (&freqs)[ASCII_MAX]) {
+	StaticTable table = {};
+	if (staticCodeLengths(freqs, table) == 0) {
+		return table;
+	}
+	staticLimitLengths(freqs, table);
+	staticAssignCodes(table);
+	staticFillDecode(table);
+	table.valid = true;
+	return table;
+}
+
+/** Function Name: staticEncodeBound(size_t size)
+ *  Description: Bytes staticEncode() may write for size bytes
+ *  Return Value: The bound in bytes
+ */
+inline size_t staticEncodeBound(size_t size) {
+	return (size * STATIC_MAX_BITS + 7) / 8 + sizeof(unsigned long long);
+}
+
+/** Function Name: staticEncode(const StaticTable& table, const byte* data,
+ *                              size_t size, byte* out)
+ *  Description: Writes the codes of size bytes to out, padded with 0 bits
+ *               to a whole byte. Writes no byte past the padded codes.
+ *  PRECONDITION: out holds staticEncodeBound(size) bytes, or the padded
+ *                size of the codes, and table has a code for every byte
+ *                of data
+ *  Return Value: The number of code bits written, without padding
+ */
+inline size_t staticEncode(const StaticTable& table, const byte* data,
+	size_t size, byte* out) {
+	unsigned long long buffer = 0;
+	int bits = 0;
+	size_t written = 0;
+	size_t total = 0;
+	for (size_t i = 0; i < size; i++) {
+		int length = table.lengths[data[i]];
+		buffer = (buffer << length) | table.codes[data[i]];
+		bits += length;
+		total += length;
+		/** Under 32 + STATIC_MAX_BITS bits are ever held */
+		if (bits >= 32) {
+			bits -= 32;
+			unsigned int word = (unsigned int)(buffer >> bits);
+			out[written] = (byte)(word >> 24);
+			out[written + 1] = (byte)(word >> 16);
+			out[written + 2] = (byte)(word >> 8);
+			out[written + 3] = (byte)word;
+			written += 4;
+		}
+	}
+	while (bits >= 8) {
+		bits -= 8;
+		out[written++] = (byte)(buffer >> bits);
+	}
+	if (bits > 0) {
+		out[written] = (byte)(buffer << (8 - bits));
+	}
+	return total;
+}
+
+/** Function Name: staticDecode(const StaticTable& table, const byte* in,
+ *                              size_t inSize, byte* out, size_t count)
+ *  Description: Decodes count bytes written by staticEncode(), one table
+ *               lookup per byte and up to four bytes per refill
+ *  Return Value: False if the codes run past the end of in or hit a
+ *                window no code starts
+ */
+inline bool staticDecode(const StaticTable& table, const byte* in,
+	size_t inSize, byte* out, size_t count) {
+	/** The next bits, first one in the top bit */
+	unsigned long long window = 0;
+	int available = 0;
+	size_t pos = 0;
+	unsigned long long used = 0;
+	size_t i = 0;
+	while (i < count) {
+		if (pos + sizeof(unsigned long long) <= inSize) {
+			/** Load 8 bytes and keep the whole ones that fit */
+			unsigned long long word = 0;
+			for (int k = 0; k < 8; k++) {
+				word = (word << 8) | in[pos + k];
+			}
+			window |= word >> available;
+			pos += (63 - available) >> 3;
+			available |= 56;
+		}
+		else {
+			/** Past the end of in the window fills with 0 bits */
+			while (available <= 56) {
+				byte next = pos < inSize ? in[pos] : 0;
+				pos++;
+				window |= (unsigned long long)next << (56 - available);
+				available += 8;
+			}
+		}
+		/** 56 bits always hold four codes */
+		for (int k = 0; k < 4 && i < count; k++, i++) {
+			const StaticDecodeEntry& entry =
+				table.decode[window >> (64 - STATIC_MAX_BITS)];
+			if (entry.length == 0) {
+				return false;
+			}
+			out[i] = entry.symbol;
+			window <<= entry.length;
+			available -= entry.length;
+			used += entry.length;
+		}
+	}
+	return used <= (unsigned long long)inSize * 8;
+}
+
+/** Class Name: StaticCodec
+ *  Description: Codes bytes with the compile-time table of Distribution,
+ *               which provides it as a static constexpr StaticTable named
+ *               table. The codes are written first bit first into the top
+ *               bit of each byte, like BitOutputStream.
+ */
+template <typename Distribution>
+class StaticCodec {
+public:
+	/** Function Name: encodeBound(size_t size)
+	 *  Description: Bytes encode() may write for size bytes
+	 *  Return Value: The bound in bytes
+	 */
+	static size_t encodeBound(size_t size) {
+		return staticEncodeBound(size);
+	}
+
+	/** Function Name: estimateBits(const vector<int>& freqs)
+	 *  Description: Bits encode() writes for bytes with histogram freqs
+	 *  Return Value: The size in bits, or STATIC_NO_ESTIMATE if freqs has
+	 *                a byte the table has no code for
+	 */
+	static unsigned long long estimateBits(const vector<int>& freqs) {
+		unsigned long long bits = 0;
+		for (int s = 0; s < ASCII_MAX; s++) {
+			if (freqs[s] == 0) {
+				continue;
+			}
+			if (Distribution::table.lengths[s] == 0) {
+				return STATIC_NO_ESTIMATE;
+			}
+			bits += (unsigned long long)freqs[s] * Distribution::table.lengths[s];
+		}
+		return bits;
+	}
+
+	/** Function Name: encode(const byte* data, size_t size, byte* out)
+	 *  Description: Writes the codes of size bytes to out, padded with 0
+	 *               bits to a whole byte
+	 *  PRECONDITION: out holds encodeBound(size) bytes and the table has a
+	 *                code for every byte of data
+	 *  Return Value: The number of code bits written, without padding
+	 */
+	static size_t encode(const byte* data, size_t size, byte* out) {
+		return staticEncode(Distribution::table, data, size, out);
+	}
+
+	/** Function Name: decode(const byte* in, size_t inSize, byte* out,
+	 *                        size_t count)
+	 *  Description: Decodes count bytes written by encode(), one table
+	 *               lookup per byte and up to four bytes per refill
+	 *  Return Value: False if the codes run past the end of in or hit a
+	 *                window no code starts
+	 */
+	static bool decode(const byte* in, size_t inSize, byte* out,
+		size_t count) {
+		return staticDecode(Distribution::table, in, inSize, out, count);
+	}
+};
+
+/** Struct Name: EnglishText
+ *  Description: Byte frequencies of warandpeace.txt, plus 1 so every byte
+ *               has a code, and the table built from them at compile time
+ */
+struct EnglishText {
+	static constexpr int freqs[ASCII_MAX] = {
+		1, 1, 1, 1, 1, 1, 1, 1,
+		1, 1, 65337, 1, 1, 1, 1, 1,
+		1, 1, 1, 1, 1, 1, 1, 1,
+		1, 1, 1, 1, 1, 1, 1, 1,
+		515621, 3924, 17969, 2, 3, 2, 1, 7525,
+		671, 671, 299, 1, 39887, 6035, 30805, 30,
+		171, 360, 139, 59, 24, 52, 56, 40,
+		175, 36, 999, 1146, 1, 3, 1, 3137,
+		3, 6211, 3590, 1772, 2016, 1869, 1940, 1301,
+		4011, 7403, 309, 1187, 708, 3268, 3603, 1598,
+		6153, 36, 2689, 2980, 6440, 278, 935, 2885,
+		350, 1266, 109, 2, 1, 2, 1, 1,
+		1, 199223, 31055, 59488, 116264, 312955, 52949, 50021,
+		163022, 166347, 2267, 19231, 95809, 58376, 180555, 191237,
+		39015, 2296, 145368, 159904, 219584, 65149, 25968, 56318,
+		3712, 45000, 2281, 1, 1, 1, 1, 1,
+		1, 1, 1, 1, 1, 1, 1, 1,
+		1, 1, 1, 1, 1, 1, 1, 1,
+		1, 1, 1, 1, 1, 1, 1, 1,
+		1, 1, 1, 1, 1, 1, 1, 1,
+		1, 1, 1, 1, 1, 1, 1, 1,
+		1, 1, 1, 1, 1, 1, 1, 1,
+		1, 1, 1, 1, 1, 1, 1, 1,
+		1, 1, 1, 1, 1, 1, 1, 1,
+		1, 1, 1, 1, 1, 1, 1, 1,
+		1, 1, 1, 1, 1, 1, 1, 1,
+		1, 1, 1, 1, 1, 1, 1, 1,
+		1, 1, 1, 1, 1, 1, 1, 1,
+		1, 1, 1, 1, 1, 1, 1, 1,
+		1, 1, 1, 1, 1, 1, 1, 1,
+		1, 1, 1, 1, 1, 1, 1, 1,
+		1, 1, 1, 1, 1, 1, 1, 1
+	};
+	static constexpr StaticTable table = buildStaticTable(freqs);
+};
+
+static_assert(EnglishText::table.valid, "English table has no codes");
+static_assert(EnglishText::table.lengths[' '] <= 3,
+	"Space should have one of the shortest English codes");
+
+#endif // STATICCODEC_HPP
@@ -0,0 +1,451 @@
+/** Filename: TokenModel.cpp
+ *  Name: Loc Chuong
+ *  Description: Word alphabet for the block format: a vocabulary picked
+ *               per block, a greedy longest match over a trie of it, and
+ *               decoding by whole-word copies.
+ *  Date: 10/19/2026
+ */
+
+#include "TokenModel.hpp"
+#include "HCTableCache.hpp"
+#include "BitKernels.hpp"
+#include "Trace.hpp"
+#include <algorithm>
+#include <climits>
+#include <cstring>
+
+#define WORD_HASH_SIZE (1 << 14) /** Slots counting the words of a block */
+#define WORD_SAVED_BITS 5 /** Code bits saved per byte a word absorbs */
+#define WORD_COST_BITS 24 /** Header bits of a word besides its bytes */
+#define FNV32_OFFSET 2166136261u /** FNV-1a start value */
+#define FNV32_PRIME 16777619u /** FNV-1a multiplier */
+
+/** Function Name: isLetter(byte b)
+ *  Description: Whether b is an ASCII letter
+ *  Return Value: True for A to Z and a to z
+ */
+static inline bool isLetter(byte b) {
+	return (unsigned int)((b | 0x20) - 'a') < 26;
+}
+
+/** Function Name: sameBytes(const byte* one, const byte* other,
+ *                           int length)
+ *  Description: Compares two words of at most TOKEN_MAX_LENGTH bytes in
+ *               line, cheaper than a memcmp call for words this short
+ *  Return Value: True if the words are equal
+ */
+static inline bool sameBytes(const byte* one, const byte* other, int length) {
+	for (int i = 0; i < length; i++) {
+		if (one[i] != other[i]) {
+			return false;
+		}
+	}
+	return true;
+}
+
+/** Function Name: findSlot(const byte* data, const byte* word, int length,
+ *                           unsigned int hash) const
+ *  Description: Probes slots linearly from hash for word, comparing the
+ *               bytes only when the hash and length match
+ *  Return Value: The slot holding word, or the empty slot it would go in
+ */
+unsigned int TokenModel::findSlot(const byte* data, const byte* word,
+	int length, unsigned int hash) const {
+	unsigned int slot = hash & (WORD_HASH_SIZE - 1);
+	while (slots[slot].count != 0 && (slots[slot].hash != hash
+		|| slots[slot].length != length
+		|| !sameBytes(data + slots[slot].start, word, length))) {
+		slot = (slot + 1) & (WORD_HASH_SIZE - 1);
+	}
+	return slot;
+}
+
+/** Constructor
+ *  Description: Creates a model with an empty vocabulary
+ */
+TokenModel::TokenModel() : wordCount(0), vocabularyBits(0) {
+	setWords(vector<vector<byte>>());
+}
+
+/** Function Name: setWords(const vector<vector<byte>>& words)
+ *  Description: Packs every byte, then every word, into strings and sizes
+ *               the vocabulary part of the header
+ *  Return Value: None
+ */
+void TokenModel::setWords(const vector<vector<byte>>& words) {
+	wordCount = (int)words.size();
+	strings.clear();
+	offsets.assign(TOKEN_ALPHABET, 0);
+	lengths.assign(TOKEN_ALPHABET, 0);
+	for (int b = 0; b < ASCII_MAX; b++) {
+		offsets[b] = (unsigned int)strings.size();
+		lengths[b] = 1;
+		strings.push_back((byte)b);
+	}
+	vocabularyBits = TOKEN_SYMBOL_BITS;
+	for (int i = 0; i < wordCount; i++) {
+		const vector<byte>& word = words[i];
+		offsets[ASCII_MAX + i] = (unsigned int)strings.size();
+		lengths[ASCII_MAX + i] = (byte)word.size();
+		strings.insert(strings.end(), word.begin(), word.end());
+		/** Only the bytes not shared with the word before are written */
+		size_t shared = 0;
+		if (i > 0) {
+			const vector<byte>& prev = words[i - 1];
+			while (shared < prev.size() && shared < word.size()
+				&& prev[shared] == word[shared]) {
+				shared++;
+			}
+		}
+		vocabularyBits += 2 * TOKEN_LENGTH_BITS
+			+ (int)(word.size() - shared) * BUFFER_SIZE;
+	}
+	/** Every copy may read TOKEN_MAX_LENGTH bytes past its start */
+	strings.resize(strings.size() + TOKEN_MAX_LENGTH, 0);
+}
+
+/** Function Name: looksLikeText(const vector<int>& freqs, size_t size)
+ *  Description: Whether at least half of the block is letters
+ *  Return Value: True if build() is worth trying
+ */
+bool TokenModel::looksLikeText(const vector<int>& freqs, size_t size) {
+	if (size < TOKEN_MIN_BLOCK) {
+		return false;
+	}
+	size_t letters = 0;
+	for (int i = 0; i < 26; i++) {
+		letters += freqs['A' + i] + freqs['a' + i];
+	}
+	return letters * 2 >= size;
+}
+
+/** Function Name: build(const byte* data, size_t size)
+ *  Description: Counts every word of data in slots, keeps the ones whose
+ *               occurrences save more code bits than their header entry
+ *               costs, most saving first, then splits data with them and
+ *               builds the table
+ *  Return Value: None
+ */
+void TokenModel::build(const byte* data, size_t size) {
+	{
+		TRACE_SPAN("vocabulary");
+		slots.assign(WORD_HASH_SIZE, WordSlot{ 0, 0, 0, 0, TOKEN_NONE });
+		occurrences.clear();
+		size_t used = 0;
+		size_t i = 0;
+		while (i < size) {
+			if (!isLetter(data[i])) {
+				i++;
+				continue;
+			}
+			size_t start = i > 0 && data[i - 1] == ' ' ? i - 1 : i;
+			size_t end = i;
+			while (end < size && isLetter(data[end])) {
+				end++;
+			}
+			i = end;
+			int length = (int)(end - start);
+			if (length < TOKEN_MIN_LENGTH || length > TOKEN_MAX_LENGTH) {
+				continue;
+			}
+			unsigned int hash = FNV32_OFFSET;
+			for (int k = 0; k < length; k++) {
+				hash = (hash ^ data[start + k]) * FNV32_PRIME;
+			}
+			unsigned int slot = findSlot(data, data + start, length, hash);
+			if (slots[slot].count != 0) {
+				slots[slot].count++;
+			}
+			/** Past half full the probes get long, so stop adding words */
+			else if (used < WORD_HASH_SIZE / 2) {
+				slots[slot] = WordSlot{ (unsigned int)start, hash, length, 1,
+					TOKEN_NONE };
+				used++;
+			}
+			else {
+				continue;
+			}
+			occurrences.push_back(make_pair((unsigned int)start, (int)slot));
+		}
+	}
+	/** Keep the words that pay for themselves, the biggest savings first */
+	vector<pair<long long, unsigned int>> kept;
+	for (unsigned int s = 0; s < WORD_HASH_SIZE; s++) {
+		const WordSlot& word = slots[s];
+		long long saved = (long long)word.count * (word.length - 1)
+			* WORD_SAVED_BITS;
+		long long cost = word.length * BUFFER_SIZE + WORD_COST_BITS;
+		if (word.count != 0 && saved > cost) {
+			kept.push_back(make_pair(cost - saved, s));
+		}
+	}
+	sort(kept.begin(), kept.end());
+	if (kept.size() > TOKEN_MAX_WORDS) {
+		kept.resize(TOKEN_MAX_WORDS);
+	}
+	/** Symbols go to the words in sorted order, as the header lists them */
+	vector<pair<vector<byte>, unsigned int>> sorted;
+	for (size_t k = 0; k < kept.size(); k++) {
+		const WordSlot& word = slots[kept[k].second];
+		sorted.push_back(make_pair(vector<byte>(data + word.start,
+			data + word.start + word.length), kept[k].second));
+	}
+	sort(sorted.begin(), sorted.end());
+	vector<vector<byte>> words(sorted.size());
+	prefixLengths.assign(1 << 16, 0);
+	for (size_t w = 0; w < sorted.size(); w++) {
+		words[w].swap(sorted[w].first);
+		slots[sorted[w].second].symbol = ASCII_MAX + (int)w;
+		prefixLengths[words[w][0] << 8 | words[w][1]] |=
+			(unsigned short)(1 << (words[w].size() - 1));
+	}
+	setWords(words);
+	/** Keep only the occurrences of the vocabulary, by symbol */
+	size_t found = 0;
+	for (size_t k = 0; k < occurrences.size(); k++) {
+		int symbol = slots[occurrences[k].second].symbol;
+		if (symbol != TOKEN_NONE) {
+			occurrences[found++] = make_pair(occurrences[k].first, symbol);
+		}
+	}
+	occurrences.resize(found);
+	tokenize(data, size);
+	tree = HCTableCache::global().acquire(freqs);
+}
+
+/** Function Name: longestWord(const byte* data, size_t size, size_t i,
+ *                              int& length) const
+ *  Description: Every word of the vocabulary is a space or letter followed
+ *               by letters, so the longest word at data[i] is the longest
+ *               prefix of the run there found in slots. Only the lengths
+ *               some word starting with the first two bytes has are looked
+ *               up, so inside a rare word most bytes cost one load.
+ *  Return Value: The symbol of the word, or TOKEN_NONE
+ */
+int TokenModel::longestWord(const byte* data, size_t size, size_t i,
+	int& length) const {
+	size_t letters = data[i] == ' ' ? i + 1 : i;
+	size_t end = letters;
+	while (end < size && end - i < TOKEN_MAX_LENGTH && isLetter(data[end])) {
+		end++;
+	}
+	int run = (int)(end - i);
+	if (end == letters || run < TOKEN_MIN_LENGTH) {
+		return TOKEN_NONE;
+	}
+	/** Bit k - 1 is set for the lengths k worth looking up */
+	unsigned int candidates = prefixLengths[data[i] << 8 | data[i + 1]]
+		& ((1u << run) - 1);
+	if (candidates == 0) {
+		return TOKEN_NONE;
+	}
+	/** hashes[k] is the hash of the first k bytes of the run */
+	unsigned int hashes[TOKEN_MAX_LENGTH + 1];
+	unsigned int hash = FNV32_OFFSET;
+	for (int k = 0; k < run; k++) {
+		hash = (hash ^ data[i + k]) * FNV32_PRIME;
+		hashes[k + 1] = hash;
+	}
+	for (int k = run; k >= TOKEN_MIN_LENGTH; k--) {
+		if (!(candidates >> (k - 1) & 1)) {
+			continue;
+		}
+		const WordSlot& word = slots[findSlot(data, data + i, k, hashes[k])];
+		if (word.count != 0 && word.symbol != TOKEN_NONE) {
+			length = k;
+			return word.symbol;
+		}
+	}
+	return TOKEN_NONE;
+}
+
+/** Function Name: tokenize(const byte* data, size_t size)
+ *  Description: A word counted by build() is a whole run, so where one of
+ *               the vocabulary starts it is the longest word there and its
+ *               symbol is already known, and no word from before it can
+ *               reach into it. Only the bytes between those occurrences
+ *               are split one at a time, searching the runs of rare words
+ *               for a shorter word.
+ *  Return Value: None
+ */
+void TokenModel::tokenize(const byte* data, size_t size) {
+	TRACE_SPAN("tokenize");
+	freqs.assign(TOKEN_ALPHABET, 0);
+	symbols.clear();
+	size_t i = 0;
+	for (size_t k = 0; k <= occurrences.size(); k++) {
+		size_t start = k < occurrences.size() ? occurrences[k].first : size;
+		while (i < start) {
+			int symbol = data[i];
+			int length = 1;
+			if (data[i] == ' ' || isLetter(data[i])) {
+				int wordLength = 0;
+				int word = longestWord(data, size, i, wordLength);
+				if (word != TOKEN_NONE) {
+					symbol = word;
+					length = wordLength;
+				}
+			}
+			symbols.push_back((unsigned short)symbol);
+			freqs[symbol]++;
+			i += length;
+		}
+		if (k < occurrences.size() && i == start) {
+			int symbol = occurrences[k].second;
+			symbols.push_back((unsigned short)symbol);
+			freqs[symbol]++;
+			i += lengths[symbol];
+		}
+	}
+}
+
+/** Function Name: headerBits() const
+ *  Description: Size of the vocabulary and the frequency header
+ *  Return Value: The header size in bits
+ */
+int TokenModel::headerBits() const {
+	return vocabularyBits + HCTree::headerBits(freqs, TOKEN_SYMBOL_BITS);
+}
+
+/** Function Name: payloadBits() const
+ *  Description: Number of code bits encode() writes, from the code lengths
+ *  Return Value: The payload size in bits
+ */
+unsigned long long TokenModel::payloadBits() const {
+	const vector<byte>& codeLengths = tree->getCodeLengthTable();
+	unsigned long long bits = 0;
+	for (int s = 0; s < TOKEN_ALPHABET; s++) {
+		bits += (unsigned long long)freqs[s] * codeLengths[s];
+	}
+	return bits;
+}
+
+/** Function Name: writeHeader(BitOutputStream& out) const
+ *  Description: Writes the vocabulary, each word as the bytes it shares
+ *               with the one before and the bytes after them, then the
+ *               frequency header
+ *  Return Value: None
+ */
+void TokenModel::writeHeader(BitOutputStream& out) const {
+	out.writeInt(wordCount, TOKEN_SYMBOL_BITS);
+	const byte* prev = nullptr;
+	int prevLength = 0;
+	for (int w = 0; w < wordCount; w++) {
+		const byte* word = strings.data() + offsets[ASCII_MAX + w];
+		int length = lengths[ASCII_MAX + w];
+		int shared = 0;
+		while (shared < prevLength && shared < length
+			&& prev[shared] == word[shared]) {
+			shared++;
+		}
+		out.writeInt(shared, TOKEN_LENGTH_BITS);
+		out.writeInt(length - shared - 1, TOKEN_LENGTH_BITS);
+		for (int k = shared; k < length; k++) {
+			out.writeByte(word[k]);
+		}
+		prev = word;
+		prevLength = length;
+	}
+	HCTree::writeHeader(freqs, out, TOKEN_SYMBOL_BITS);
+}
+
+/** Function Name: readHeader(BitInputStream& in)
+ *  Description: Reads the vocabulary and the frequency header, checking
+ *               every word fits and no symbol is past the vocabulary
+ *  Return Value: The number of symbols the table codes, -1 if malformed
+ */
+int TokenModel::readHeader(BitInputStream& in) {
+	int count = in.readInt(TOKEN_SYMBOL_BITS);
+	if (count < 0 || count > TOKEN_MAX_WORDS) {
+		return -1;
+	}
+	vector<vector<byte>> words(count);
+	for (int w = 0; w < count; w++) {
+		int shared = in.readInt(TOKEN_LENGTH_BITS);
+		int length = shared + in.readInt(TOKEN_LENGTH_BITS) + 1;
+		if (length < TOKEN_MIN_LENGTH || length > TOKEN_MAX_LENGTH
+			|| (w == 0 ? shared != 0 : shared > (int)words[w - 1].size())) {
+			return -1;
+		}
+		if (shared > 0) {
+			words[w].assign(words[w - 1].begin(),
+				words[w - 1].begin() + shared);
+		}
+		for (int k = shared; k < length; k++) {
+			words[w].push_back(in.readByte());
+		}
+	}
+	setWords(words);
+	HCTree::readHeader(in, freqs, TOKEN_SYMBOL_BITS);
+	long long total = 0;
+	for (int s = 0; s < TOKEN_ALPHABET; s++) {
+		if (freqs[s] < 0 || (freqs[s] != 0 && s >= ASCII_MAX + count)) {
+			return -1;
+		}
+		total += freqs[s];
+	}
+	/** An empty table cannot be built */
+	if (total == 0 || total > INT_MAX) {
+		return -1;
+	}
+	tree = HCTableCache::global().acquire(freqs);
+	return (int)total;
+}
+
+/** Function Name: encode(vector<byte>& out) const
+ *  Description: Appends the codes of the symbols to out, padded to a byte
+ *  Return Value: The number of code bits appended, without padding
+ */
+size_t TokenModel::encode(vector<byte>& out) const {
+	TRACE_SPAN("encode");
+	size_t start = out.size();
+	out.resize(start + encodeBound(*tree, symbols.size()));
+	size_t bits = encodeSymbols(*tree, symbols.data(), symbols.size(),
+		out.data() + start);
+	out.resize(start + (bits + 7) / 8);
+	return bits;
+}
+
+/** Function Name: decode(const byte* in, size_t inSize, byte* out,
+ *                        size_t size, size_t count)
+ *  Description: Decodes the symbols, then copies each one's bytes out of
+ *               strings. While a whole TOKEN_MAX_LENGTH fits in out every
+ *               copy is that fixed size, which compiles to one unaligned
+ *               load and store, and only the last few words are copied to
+ *               their exact length.
+ *  Return Value: False if the codes run past the end of in or the symbols
+ *                do not fill out exactly
+ */
+bool TokenModel::decode(const byte* in, size_t inSize, byte* out,
+	size_t size, size_t count) {
+	TRACE_SPAN("decode");
+	symbols.resize(count);
+	if (!decodeSymbols(*tree, in, inSize, symbols.data(), count)) {
+		return false;
+	}
+	const byte* table = strings.data();
+	size_t pos = 0;
+	size_t i = 0;
+	for (; i < count && pos + TOKEN_MAX_LENGTH <= size; i++) {
+		unsigned short symbol = symbols[i];
+		memcpy(out + pos, table + offsets[symbol], TOKEN_MAX_LENGTH);
+		pos += lengths[symbol];
+	}
+	for (; i < count; i++) {
+		unsigned short symbol = symbols[i];
+		if (pos + lengths[symbol] > size) {
+			return false;
+		}
+		memcpy(out + pos, table + offsets[symbol], lengths[symbol]);
+		pos += lengths[symbol];
+	}
+	return pos == size;
+}
+
+/** Function Name: getWordCount() const
+ *  Description: Getter for the number of words in the vocabulary
+ *  Return Value: The value of wordCount
+ */
+int TokenModel::getWordCount() const {
+	return wordCount;
+}
@@ -0,0 +1,188 @@
+/** Filename: TokenModel.hpp
+ *  Name: Loc Chuong
+ *  Description: Word alphabet for the block format. A byte alphabet spends
+ *               a code on every letter of " the" or " said", so text blocks
+ *               pick a vocabulary of their most frequent words, split the
+ *               block into words and single bytes with a greedy longest
+ *               match, and Huffman code those over an alphabet of up to
+ *               TOKEN_ALPHABET symbols. Decoding copies whole words out of
+ *               a packed string table instead of writing a byte per code.
+ *
+ *               Symbols below ASCII_MAX are the bytes themselves, and
+ *               symbol ASCII_MAX + i is the i-th word of the vocabulary.
+ *               The header is
+ *                 word count (TOKEN_SYMBOL_BITS bits)
+ *                 per word, in sorted order: bytes shared with the word
+ *                   before (4 bits) | bytes that follow minus 1 (4 bits) |
+ *                   those bytes
+ *                 frequency header with TOKEN_SYMBOL_BITS bits per symbol
+ *  Date: 10/19/2026
+ */
+
+#ifndef TOKENMODEL_HPP
+#define TOKENMODEL_HPP
+
+#include <memory>
+#include <vector>
+#include "HCTree.hpp"
+
+#define TOKEN_SYMBOL_BITS 12 /** Bits per symbol of the word alphabet */
+#define TOKEN_ALPHABET (1 << TOKEN_SYMBOL_BITS) /** Bytes and words */
+#define TOKEN_MAX_WORDS (TOKEN_ALPHABET - ASCII_MAX) /** Largest vocabulary */
+#define TOKEN_MIN_LENGTH 2 /** Shortest word, single bytes have symbols */
+#define TOKEN_MAX_LENGTH 16 /** Longest word, and bytes copied per word */
+#define TOKEN_LENGTH_BITS 4 /** Bits per length field of the vocabulary */
+#define TOKEN_MIN_BLOCK 4096 /** Smaller blocks are not worth a vocabulary */
+#define TOKEN_NONE -1 /** Symbol of a counted word left out of the vocabulary */
+
+using namespace std;
+
+/** Struct Name: WordSlot
+ *  Description: One distinct word of a block, a slot of the open
+ *               addressing table build() counts the words in
+ */
+struct WordSlot {
+	unsigned int start; /** Offset of its first occurrence */
+	unsigned int hash; /** FNV-1a hash of the word */
+	int length; /** Bytes in the word */
+	int count; /** Occurrences, 0 for an empty slot */
+	int symbol; /** Its symbol, or TOKEN_NONE if it is not in the vocabulary */
+};
+
+/** Class Name: TokenModel
+ *  Description: The vocabulary and table of one block. A word is a run of
+ *               letters with the space before it, if any, so a sentence
+ *               splits into a word per word and the punctuation between.
+ *               Words join the vocabulary when the bytes they save beat
+ *               the bytes they add to the header.
+ */
+class TokenModel {
+private:
+	vector<byte> strings; /** Every symbol's bytes, packed and padded */
+	vector<unsigned int> offsets; /** Start of each symbol in strings */
+	vector<byte> lengths; /** Bytes in each symbol */
+	int wordCount; /** Words in the vocabulary */
+	int vocabularyBits; /** Bits the vocabulary takes in the header */
+	vector<int> freqs; /** Histogram of the symbols */
+	vector<unsigned short> symbols; /** The block as symbols */
+	shared_ptr<const HCTree> tree; /** Table built from freqs */
+	vector<WordSlot> slots; /** Every word of the block build() counted */
+	vector<unsigned short> prefixLengths; /** Bit length - 1 is set for every
+	                                        *  word of that length starting
+	                                        *  with the two bytes indexed */
+	vector<pair<unsigned int, int>> occurrences; /** Start and slot of every
+	                                               *  word counted, in block
+	                                               *  order, then start and
+	                                               *  symbol of those in the
+	                                               *  vocabulary */
+
+	/** Function Name: findSlot(const byte* data, const byte* word,
+	 *                           int length, unsigned int hash) const
+	 *  Description: Looks word up in slots, whose words sit in data
+	 *  Return Value: The slot holding word, or the empty slot it would go in
+	 */
+	unsigned int findSlot(const byte* data, const byte* word, int length,
+		unsigned int hash) const;
+
+	/** Function Name: setWords(const vector<vector<byte>>& words)
+	 *  Description: Packs the bytes and the sorted words into strings
+	 *  Return Value: None
+	 */
+	void setWords(const vector<vector<byte>>& words);
+
+	/** Function Name: longestWord(const byte* data, size_t size,
+	 *                              size_t i, int& length) const
+	 *  Description: Finds the longest word of the vocabulary starting at
+	 *               data[i] by looking up every prefix of the run there
+	 *  Parameters: length - Set to the length of the word found
+	 *  Return Value: The symbol of the word, or TOKEN_NONE
+	 */
+	int longestWord(const byte* data, size_t size, size_t i,
+		int& length) const;
+
+	/** Function Name: tokenize(const byte* data, size_t size)
+	 *  Description: Splits data into symbols, at every byte taking the
+	 *               longest word of the vocabulary that starts there, and
+	 *               counts freqs
+	 *  PRECONDITION: slots holds the words of data and occurrences where
+	 *                the ones in the vocabulary are
+	 *  Return Value: None
+	 */
+	void tokenize(const byte* data, size_t size);
+
+public:
+	/** Constructor
+	 *  Description: Creates a model with an empty vocabulary
+	 */
+	TokenModel();
+
+	/** Function Name: looksLikeText(const vector<int>& freqs, size_t size)
+	 *  Description: Whether a block with histogram freqs is mostly letters,
+	 *               which is what makes building a vocabulary pay off
+	 *  Return Value: True if build() is worth trying
+	 */
+	static bool looksLikeText(const vector<int>& freqs, size_t size);
+
+	/** Function Name: build(const byte* data, size_t size)
+	 *  Description: Picks the vocabulary of data, splits data into symbols
+	 *               and builds their table
+	 *  PRECONDITION: size > 0
+	 *  Return Value: None
+	 */
+	void build(const byte* data, size_t size);
+
+	/** Function Name: headerBits() const
+	 *  Description: Size of the header writeHeader() writes
+	 *  Return Value: The header size in bits
+	 */
+	int headerBits() const;
+
+	/** Function Name: payloadBits() const
+	 *  Description: Number of code bits encode() writes for the block the
+	 *               model was built from
+	 *  Return Value: The payload size in bits
+	 */
+	unsigned long long payloadBits() const;
+
+	/** Function Name: writeHeader(BitOutputStream& out) const
+	 *  Description: Writes the header readHeader() rebuilds the model from
+	 *  Return Value: None
+	 */
+	void writeHeader(BitOutputStream& out) const;
+
+	/** Function Name: readHeader(BitInputStream& in)
+	 *  Description: Rebuilds a model from a header written by writeHeader()
+	 *  Return Value: The number of symbols the table codes, -1 if malformed
+	 */
+	int readHeader(BitInputStream& in);
+
+	/** Function Name: encode(vector<byte>& out) const
+	 *  Description: Appends the codes of the block the model was built from
+	 *               to out, padded to a byte
+	 *  Return Value: The number of code bits appended, without padding
+	 */
+	size_t encode(vector<byte>& out) const;
+
+	/** Function Name: decode(const byte* in, size_t inSize, byte* out,
+	 *                        size_t size, size_t count)
+	 *  Description: Decodes count symbols written by encode() and copies
+	 *               their bytes to out
+	 *  Parameters: in - The code bits
+	 *              inSize - Number of bytes in in
+	 *              out - Set to the decoded block
+	 *              size - Number of bytes out holds
+	 *              count - Number of symbols, as readHeader() returned
+	 *  Return Value: False if the codes run past the end of in or the
+	 *                symbols do not fill out exactly
+	 */
+	bool decode(const byte* in, size_t inSize, byte* out, size_t size,
+		size_t count);
+
+	/** Function Name: getWordCount() const
+	 *  Description: Getter for the number of words in the vocabulary
+	 *  Return Value: The value of wordCount
+	 */
+	int getWordCount() const;
+};
+
+#endif // TOKENMODEL_HPP
@@ -0,0 +1,100 @@
+/** Filename: Trace.cpp
+ *  Name: Loc Chuong
+ *  Description: Per-thread span rings and their Chrome trace JSON output.
+ *  Date: 10/18/2026
+ */
+
+#include "Trace.hpp"
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+atomic<bool> Trace::enabled(false);
+chrono::steady_clock::time_point Trace::origin = chrono::steady_clock::now();
+
+/** Every ring ever registered. Rings outlive their threads so spans of
+ *  finished workers still reach the dump.
+ */
+static mutex ringsLock;
+static vector<unique_ptr<TraceRing>> rings;
+
+/** Function Name: getRing()
+ *  Description: The ring of the calling thread, registered on first use
+ *  Return Value: The ring
+ */
+TraceRing& Trace::getRing() {
+	static thread_local TraceRing* ring = nullptr;
+	if (ring == nullptr) {
+		lock_guard<mutex> guard(ringsLock);
+		rings.push_back(unique_ptr<TraceRing>(new TraceRing()));
+		ring = rings.back().get();
+		ring->threadId = (int)rings.size();
+		ring->count = 0;
+	}
+	return *ring;
+}
+
+/** Function Name: start()
+ *  Description: Clears the rings and starts recording spans
+ *  Return Value: None
+ */
+void Trace::start() {
+	{
+		lock_guard<mutex> guard(ringsLock);
+		for (size_t i = 0; i < rings.size(); i++) {
+			rings[i]->count = 0;
+		}
+	}
+	origin = chrono::steady_clock::now();
+	enabled.store(true, memory_order_release);
+}
+
+/** Function Name: record(const char* name, long long startNs)
+ *  Description: Records a span of the calling thread ending now
+ *  Parameters: name - Static name of the span
+ *              startNs - When the span started, from now()
+ *  Return Value: None
+ */
+void Trace::record(const char* name, long long startNs) {
+	TraceRing& ring = getRing();
+	TraceEvent& event = ring.events[ring.count % TRACE_RING_SIZE];
+	event.name = name;
+	event.startNs = startNs;
+	event.durationNs = now() - startNs;
+	ring.count++;
+}
+
+/** Function Name: dump(string path)
+ *  Description: Stops recording and writes every ring to path as Chrome
+ *               trace JSON, as complete ("X") events in microseconds
+ *  Parameters: path - File to write
+ *  Return Value: False if the file could not be written
+ */
+bool Trace::dump(string path) {
+	enabled.store(false, memory_order_release);
+	ofstream out(path);
+	if (!out) {
+		return false;
+	}
+	out << fixed << setprecision(3) << "{\"traceEvents\": [";
+	bool first = true;
+	lock_guard<mutex> guard(ringsLock);
+	for (size_t i = 0; i < rings.size(); i++) {
+		TraceRing& ring = *rings[i];
+		/** A ring that wrapped only holds its newest TRACE_RING_SIZE spans */
+		unsigned long long begin = ring.count > TRACE_RING_SIZE ?
+			ring.count - TRACE_RING_SIZE : 0;
+		for (unsigned long long j = begin; j < ring.count; j++) {
+			const TraceEvent& event = ring.events[j % TRACE_RING_SIZE];
+			out << (first ? "\n" : ",\n") << "{\"name\": \"" << event.name
+				<< "\", \"ph\": \"X\", \"pid\": 1, \"tid\": " << ring.threadId
+				<< ", \"ts\": " << event.startNs / 1000.0
+				<< ", \"dur\": " << event.durationNs / 1000.0 << "}";
+			first = false;
+		}
+	}
+	out << "\n], \"displayTimeUnit\": \"ns\"}" << endl;
+	return (bool)out;
+}
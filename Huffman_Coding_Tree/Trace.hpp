@@ -0,0 +1,142 @@
+/** Filename: Trace.hpp
+ *  Name: Loc Chuong
+ *  Description: Scoped trace spans for seeing where each thread spends its
+ *               time. TRACE_SPAN("name") times the rest of the enclosing
+ *               block into a ring buffer owned by the calling thread, and
+ *               Trace::dump() writes every ring as Chrome trace JSON that
+ *               chrome://tracing and Perfetto open. Building with
+ *               HC_TRACE set to 0 removes the spans entirely; otherwise a
+ *               span costs one flag test until Trace::start() is called.
+ *  Date: 10/18/2026
+ */
+
+#ifndef TRACE_HPP
+#define TRACE_HPP
+
+#include <atomic>
+#include <chrono>
+#include <string>
+
+/** HC_TRACE set to 0 compiles every TRACE_SPAN away */
+#ifndef HC_TRACE
+#define HC_TRACE 1
+#endif
+
+#define TRACE_RING_SIZE (1 << 14) /** Spans kept per thread, oldest dropped */
+
+using namespace std;
+
+/** Struct Name: TraceEvent
+ *  Description: One finished span
+ */
+struct TraceEvent {
+	const char* name; /** Static name given to TRACE_SPAN */
+	long long startNs; /** Start, in ns since Trace::start() */
+	long long durationNs; /** Length of the span in ns */
+};
+
+/** Struct Name: TraceRing
+ *  Description: Ring buffer of the spans of one thread. Only its thread
+ *               writes it, so recording takes no lock.
+ */
+struct TraceRing {
+	int threadId; /** Small number naming the thread in the output */
+	TraceEvent events[TRACE_RING_SIZE]; /** The newest spans */
+	unsigned long long count; /** Spans ever recorded */
+};
+
+/** Class Name: Trace
+ *  Description: Runtime switch, clock and output of the trace spans
+ */
+class Trace {
+private:
+	static atomic<bool> enabled; /** Spans are recorded while set */
+	static chrono::steady_clock::time_point origin; /** Time 0 of the trace */
+
+	/** Function Name: getRing()
+	 *  Description: The ring of the calling thread, registered on first use
+	 *  Return Value: The ring
+	 */
+	static TraceRing& getRing();
+
+public:
+	/** Function Name: start()
+	 *  Description: Clears the rings and starts recording spans
+	 *  Return Value: None
+	 */
+	static void start();
+
+	/** Function Name: isEnabled()
+	 *  Description: Whether spans are being recorded
+	 *  Return Value: True if they are
+	 */
+	static bool isEnabled() {
+		return enabled.load(memory_order_relaxed);
+	}
+
+	/** Function Name: now()
+	 *  Description: Time since start()
+	 *  Return Value: The time in ns
+	 */
+	static long long now() {
+		return chrono::duration_cast<chrono::nanoseconds>(
+			chrono::steady_clock::now() - origin).count();
+	}
+
+	/** Function Name: record(const char* name, long long startNs)
+	 *  Description: Records a span of the calling thread ending now
+	 *  Parameters: name - Static name of the span
+	 *              startNs - When the span started, from now()
+	 *  Return Value: None
+	 */
+	static void record(const char* name, long long startNs);
+
+	/** Function Name: dump(string path)
+	 *  Description: Stops recording and writes every ring to path as Chrome
+	 *               trace JSON. Threads that recorded must be done by then.
+	 *  Parameters: path - File to write
+	 *  Return Value: False if the file could not be written
+	 */
+	static bool dump(string path);
+};
+
+/** Class Name: TraceSpan
+ *  Description: Records the time between its construction and destruction
+ *               as a span, when tracing is enabled. Use TRACE_SPAN().
+ */
+class TraceSpan {
+private:
+	const char* name; /** Name of the span, nullptr when not recording */
+	long long startNs; /** When the span started */
+
+public:
+	/** Constructor
+	 *  Description: Starts the span if tracing is enabled
+	 */
+	explicit TraceSpan(const char* name)
+		: name(Trace::isEnabled() ? name : nullptr), startNs(0) {
+		if (this->name != nullptr) {
+			startNs = Trace::now();
+		}
+	}
+
+	/** Destructor
+	 *  Description: Records the span if it was started
+	 */
+	~TraceSpan() {
+		if (name != nullptr) {
+			Trace::record(name, startNs);
+		}
+	}
+};
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+#if HC_TRACE
+/** Traces the rest of the enclosing block as a span called name */
+#define TRACE_SPAN(name) TraceSpan TRACE_CONCAT(traceSpan, __LINE__)(name)
+#else
+#define TRACE_SPAN(name) ((void)0)
+#endif
+
+#endif // TRACE_HPP